@@ -4,8 +4,11 @@
 
 #include "MinerCLI.h"
 #include "Version.h"
+#include "core/PipelineSlots.h"
 #include "core/TuningProfiles.h"
+#include "api/ShmStatsLayout.h"
 #include <boost/program_options.hpp>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -22,6 +25,9 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
         ("version,V", "Show version")
         ("verbose,v", "Verbose output")
         ("quiet,q", "Quiet output (errors only)")
+        ("log-rate-limit", po::value<std::string>(),
+         "Per-category log rate limits CAT=BURST/RATE[,...] (general, solution, device, network, api)")
+        ("no-log-rate-limit", "Disable suppression of repeated log messages")
     ;
 
     po::options_description mining("Mining options");
@@ -42,6 +48,12 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
     api.add_options()
         ("api-port", po::value<unsigned>()->default_value(0),
          "JSON-RPC API port (0 = disabled)")
+        ("api-events-interval", po::value<unsigned>()->default_value(1000),
+         "Interval for /events stat updates in milliseconds")
+        ("shm-stats", po::value<std::string>()->implicit_value(SHM_STATS_DEFAULT_PATH),
+         "Publish stats to a shared memory file for local agents")
+        ("gpu-sample-interval", po::value<unsigned>()->default_value(1000),
+         "GPU sensor sampling interval in milliseconds")
     ;
 
     po::options_description device("Device options");
@@ -61,14 +73,59 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
         ("profile", po::value<std::string>()->default_value("default"),
          "Tuning profile (default, nvidia-ampere, amd-rdna3, etc.)")
         ("list-profiles", "List available tuning profiles")
+        ("auto-tune", "Benchmark GPU settings per device and save the fastest to the tuning database")
+        ("tuning-db", po::value<std::string>(),
+         "Tuning database file (default: $XDG_CONFIG_HOME/tosminer/tuning.json or ~/.config/tosminer/tuning.json)")
         ("opencl-global-work", po::value<unsigned>(),
          "OpenCL global work size (overrides profile)")
         ("opencl-local-work", po::value<unsigned>(),
          "OpenCL local work size (overrides profile)")
+        ("opencl-nonce-loop", po::value<unsigned>(),
+         "Nonces per work item with the persistent OpenCL kernel, 0 = one-shot kernel (overrides profile)")
+        ("opencl-scratch", po::value<std::string>(),
+         "OpenCL scratchpad layout: local, contiguous, interleaved, blocked (overrides profile)")
+        ("pipeline-depth", po::value<unsigned>(),
+         "GPU batches kept in flight: OpenCL pipeline slots and CUDA streams, 1-8 (overrides profile)")
+        ("opencl-out-of-order", "Run one-shot OpenCL batches on an out-of-order queue where supported")
+        ("opencl-profiling", "Record OpenCL kernel and readback timestamps for device timelines and /trace")
+        ("batch-target", po::value<unsigned>()->default_value(0),
+         "Resize GPU batches so each kernel takes about this many ms (0 = fixed batch size)")
         ("cuda-grid", po::value<unsigned>(),
          "CUDA grid size (overrides profile)")
         ("cuda-block", po::value<unsigned>(),
          "CUDA block size (overrides profile)")
+        ("temp-target", po::value<int>()->default_value(0),
+         "Throttle devices to stay at or below this temperature in Celsius (0 = off)")
+        ("power-cap", po::value<int>()->default_value(0),
+         "Throttle devices to stay at or below this power draw in Watts; CPU threads share one package cap (0 = off)")
+        ("governor-hysteresis", po::value<int>()->default_value(3),
+         "Degrees below --temp-target before intensity is raised again")
+        ("min-intensity", po::value<unsigned>()->default_value(30),
+         "Lowest intensity the governor may set, in percent")
+        ("host-aware", "Park CPU mining threads while other tasks wait for CPU")
+        ("host-psi-high", po::value<double>()->default_value(10.0),
+         "CPU pressure (PSI some avg10, percent) above which CPU threads are parked")
+        ("host-psi-low", po::value<double>()->default_value(2.0),
+         "CPU pressure below which parked CPU threads return")
+        ("host-load-high", po::value<double>()->default_value(0.5),
+         "Load from other tasks per CPU above which CPU threads are parked")
+        ("host-min-threads", po::value<unsigned>()->default_value(0),
+         "CPU threads that are never parked")
+        ("cpu-share", po::value<unsigned>()->default_value(100),
+         "Most CPU mining may use, in percent of online CPUs")
+        ("anomaly-threshold", po::value<unsigned>()->default_value(15),
+         "Flag devices whose hash rate falls this many percent below their baseline")
+        ("anomaly-recover", "Restart devices that stop hashing")
+        ("integrity-check", po::value<unsigned>()->default_value(0),
+         "Re-hash this percent of GPU easy-target hits on the CPU (0 = off)")
+        ("no-self-test", "Skip the known-answer self-test run on each device at startup")
+        ("cl-cache-dir", po::value<std::string>(),
+         "Directory for compiled OpenCL kernels (default: $XDG_CACHE_HOME/tosminer or ~/.cache/tosminer)")
+        ("no-cl-cache", "Do not keep compiled OpenCL kernels on disk")
+        ("recovery-attempts", po::value<unsigned>()->default_value(5),
+         "Recovery attempts per failed device (0 = leave failed devices idle)")
+        ("recovery-backoff", po::value<unsigned>()->default_value(10),
+         "Seconds before the first recovery attempt (doubles per attempt, up to 10 minutes)")
     ;
 
     po::options_description benchmark("Benchmark options");
@@ -97,6 +154,13 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
         }
         config.verbose = vm.count("verbose") > 0;
         config.quiet = vm.count("quiet") > 0;
+        config.logRateLimit = vm.count("no-log-rate-limit") == 0;
+        if (vm.count("log-rate-limit")) {
+            const auto& spec = vm["log-rate-limit"].as<std::string>();
+            if (!parseLogRateLimits(spec, config.logRateLimits)) {
+                throw po::invalid_option_value(spec);
+            }
+        }
 
         // List profiles
         if (vm.count("list-profiles")) {
@@ -112,7 +176,12 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
             config.mode = MiningMode::ListDevices;
             return config;
         }
-        if (vm.count("benchmark")) {
+        if (vm.count("auto-tune")) {
+            config.mode = MiningMode::AutoTune;
+            if (vm.count("benchmark-iterations")) {
+                config.benchmarkIterations = vm["benchmark-iterations"].as<uint64_t>();
+            }
+        } else if (vm.count("benchmark")) {
             config.mode = MiningMode::Benchmark;
             if (vm.count("benchmark-iterations")) {
                 config.benchmarkIterations = vm["benchmark-iterations"].as<uint64_t>();
@@ -147,15 +216,28 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
             config.cudaDevices = parseDeviceList(vm["cuda-devices"].as<std::string>());
         }
 
-        // Performance options - apply profile first, then allow overrides
+        // Performance options - apply profile first, then allow overrides. Without
+        // any of them each GPU uses its tuning database entry or detected profile
         config.tuningProfile = vm["profile"].as<std::string>();
+        config.tuningExplicit = !vm["profile"].defaulted();
+        for (const char* option : {"opencl-global-work", "opencl-local-work", "opencl-nonce-loop",
+                                   "opencl-scratch", "pipeline-depth", "cuda-grid", "cuda-block"}) {
+            config.tuningExplicit = config.tuningExplicit || vm.count(option) > 0;
+        }
+        if (vm.count("tuning-db")) {
+            config.tuningDb = vm["tuning-db"].as<std::string>();
+        }
         const auto& profile = TuningProfiles::getProfile(config.tuningProfile);
 
         // Set defaults from profile
         config.openclGlobalWorkSize = profile.openclGlobalWorkSize;
         config.openclLocalWorkSize = profile.openclLocalWorkSize;
+        config.openclNonceLoop = profile.openclNonceLoop;
+        config.openclScratch = profile.openclScratch;
+        config.openclPipelineDepth = profile.openclPipelineDepth;
         config.cudaGridSize = profile.cudaGridSize;
         config.cudaBlockSize = profile.cudaBlockSize;
+        config.cudaStreams = profile.cudaStreams;
 
         // Allow manual overrides
         if (vm.count("opencl-global-work")) {
@@ -164,6 +246,26 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
         if (vm.count("opencl-local-work")) {
             config.openclLocalWorkSize = vm["opencl-local-work"].as<unsigned>();
         }
+        if (vm.count("opencl-nonce-loop")) {
+            config.openclNonceLoop = vm["opencl-nonce-loop"].as<unsigned>();
+        }
+        if (vm.count("opencl-scratch")) {
+            const auto& layout = vm["opencl-scratch"].as<std::string>();
+            if (!parseScratchLayout(layout, config.openclScratch)) {
+                throw po::invalid_option_value(layout);
+            }
+        }
+        if (vm.count("pipeline-depth")) {
+            unsigned depth = vm["pipeline-depth"].as<unsigned>();
+            if (depth < 1 || depth > MAX_PIPELINE_DEPTH) {
+                throw po::invalid_option_value(std::to_string(depth));
+            }
+            config.openclPipelineDepth = depth;
+            config.cudaStreams = depth;
+        }
+        config.openclOutOfOrder = vm.count("opencl-out-of-order") > 0;
+        config.openclProfiling = vm.count("opencl-profiling") > 0;
+        config.batchTarget = vm["batch-target"].as<unsigned>();
         if (vm.count("cuda-grid")) {
             config.cudaGridSize = vm["cuda-grid"].as<unsigned>();
         }
@@ -171,11 +273,56 @@ MinerConfig MinerCLI::parse(int argc, char* argv[]) {
             config.cudaBlockSize = vm["cuda-block"].as<unsigned>();
         }
 
+        // Power governor
+        config.governor.tempTarget = vm["temp-target"].as<int>();
+        config.governor.powerCap = vm["power-cap"].as<int>();
+        config.governor.hysteresis = vm["governor-hysteresis"].as<int>();
+        config.governor.minIntensity = vm["min-intensity"].as<unsigned>();
+
+        // Host load governor
+        config.hostLoad.hostAware = vm.count("host-aware") > 0;
+        config.hostLoad.psiHigh = vm["host-psi-high"].as<double>();
+        config.hostLoad.psiLow = vm["host-psi-low"].as<double>();
+        config.hostLoad.loadHigh = vm["host-load-high"].as<double>();
+        config.hostLoad.minThreads = vm["host-min-threads"].as<unsigned>();
+        config.hostLoad.cpuShare = vm["cpu-share"].as<unsigned>();
+
+        // Anomaly detection
+        config.anomaly.dropThreshold = std::min(100u, vm["anomaly-threshold"].as<unsigned>()) / 100.0;
+        config.anomaly.recover = vm.count("anomaly-recover") > 0;
+
+        // GPU result integrity sampling
+        config.integritySample = std::min(100u, vm["integrity-check"].as<unsigned>());
+
+        // Startup self-test
+        config.selfTest = vm.count("no-self-test") == 0;
+
+        // OpenCL binary cache
+        config.clCache = vm.count("no-cl-cache") == 0;
+        if (vm.count("cl-cache-dir")) {
+            config.clCacheDir = vm["cl-cache-dir"].as<std::string>();
+        }
+
+        // Failed-device recovery
+        config.recovery.maxAttempts = vm["recovery-attempts"].as<unsigned>();
+        config.recovery.initialBackoff = std::max(1u, vm["recovery-backoff"].as<unsigned>());
+
+        // A stalled device is restarted by marking it failed; without
+        // recovery it would stay isolated for good
+        if (config.anomaly.recover && !config.recovery.enabled()) {
+            throw po::error("--anomaly-recover requires --recovery-attempts above 0");
+        }
+
         // TLS options (strict by default, --tls-no-strict disables)
         config.tlsStrict = vm.count("tls-no-strict") == 0;
 
         // API options
         config.apiPort = vm["api-port"].as<unsigned>();
+        config.apiEventsInterval = vm["api-events-interval"].as<unsigned>();
+        config.gpuSampleInterval = vm["gpu-sample-interval"].as<unsigned>();
+        if (vm.count("shm-stats")) {
+            config.shmStatsPath = vm["shm-stats"].as<std::string>();
+        }
 
         // Stratum protocol
         config.stratumProtocol = vm["stratum-protocol"].as<std::string>();
@@ -199,6 +346,9 @@ General Options:
   -V, --version             Show version
   -v, --verbose             Verbose output
   -q, --quiet               Quiet output (errors only)
+  --log-rate-limit SPEC     Per-category log limits CAT=BURST/RATE[,...]
+                            (categories: general, solution, device, network, api)
+  --no-log-rate-limit       Log every message (disable storm suppression)
 
 Mining Options:
   -P, --pool URL            Pool URL (stratum+tcp://host:port or stratum+ssl://host:port)
@@ -212,6 +362,10 @@ TLS Options:
 
 API Options:
   --api-port PORT           JSON-RPC API port for monitoring (0 = disabled)
+  --api-events-interval MS  Interval for /events stat updates (default: 1000)
+  --shm-stats [PATH]        Publish stats to a shared memory file
+                            (default: /dev/shm/tosminer.stats)
+  --gpu-sample-interval MS  GPU sensor sampling interval (default: 1000)
 
 Device Options:
   -L, --list-devices        List available mining devices
@@ -225,10 +379,36 @@ Device Options:
 Performance Options:
   --profile NAME            Tuning profile (default, nvidia-ampere, amd-rdna3, etc.)
   --list-profiles           List all available tuning profiles
+  --auto-tune               Benchmark settings per GPU, save the fastest
+  --tuning-db FILE          Tuning database (default: ~/.config/tosminer/tuning.json)
   --opencl-global-work N    OpenCL global work size (overrides profile)
   --opencl-local-work N     OpenCL local work size (overrides profile)
+  --opencl-nonce-loop N     Persistent kernel nonces per work item (0 = one-shot)
+  --opencl-scratch LAYOUT   Scratchpad layout: local, contiguous, interleaved, blocked
+  --pipeline-depth N        GPU batches in flight, 1-8 (overrides profile)
+  --opencl-out-of-order     Out-of-order OpenCL queue for one-shot batches
+  --opencl-profiling        Device timelines for OpenCL batches (API, /trace)
+  --batch-target MS         Resize GPU batches to take about MS each (0 = fixed)
   --cuda-grid N             CUDA grid size (overrides profile)
   --cuda-block N            CUDA block size (overrides profile)
+  --temp-target C           Throttle to keep devices at or below C (0 = off)
+  --power-cap W             Throttle to keep each device (CPU: whole package) at or below W (0 = off)
+  --governor-hysteresis C   Degrees below target before raising (default: 3)
+  --min-intensity PCT       Lowest intensity the governor may set (default: 30)
+  --host-aware              Park CPU threads while other tasks wait for CPU
+  --host-psi-high PCT       CPU pressure to park threads at (default: 10)
+  --host-psi-low PCT        CPU pressure to unpark threads at (default: 2)
+  --host-load-high N        Other load per CPU to park threads at (default: 0.5)
+  --host-min-threads N      CPU threads that are never parked (default: 0)
+  --cpu-share PCT           Most CPU mining may use, % of online CPUs (default: 100)
+  --anomaly-threshold PCT   Hash rate drop that flags a device (default: 15)
+  --anomaly-recover         Restart devices that stop hashing
+  --integrity-check PCT     Re-hash PCT% of GPU easy-target hits on the CPU (0 = off)
+  --no-self-test            Skip the known-answer self-test at device startup
+  --cl-cache-dir DIR        Compiled OpenCL kernel cache (default: ~/.cache/tosminer)
+  --no-cl-cache             Do not keep compiled OpenCL kernels on disk
+  --recovery-attempts N     Recovery attempts per failed device (default: 5, 0 = off)
+  --recovery-backoff S      Seconds before the first recovery attempt (default: 10)
 
 Benchmark Options:
   -M, --benchmark           Run benchmark mode
@@ -237,6 +417,7 @@ Benchmark Options:
 Examples:
   tosminer --benchmark                     Run benchmark
   tosminer -L                              List devices
+  tosminer --auto-tune                     Tune each GPU (used by later runs)
   tosminer -G -P stratum+tcp://pool:3333 -u wallet.worker
                                            Mine with OpenCL
   tosminer -P stratum+ssl://pool:3334 -u wallet
@@ -287,4 +468,37 @@ std::vector<unsigned> MinerCLI::parseDeviceList(const std::string& str) {
     return result;
 }
 
+bool MinerCLI::parseLogRateLimits(const std::string& str,
+                                  std::vector<std::pair<LogCategory, LogRateLimit>>& out) {
+    std::stringstream ss(str);
+    std::string item;
+
+    while (std::getline(ss, item, ',')) {
+        size_t eq = item.find('=');
+        size_t slash = item.find('/');
+        if (eq == std::string::npos || slash == std::string::npos || slash < eq) {
+            return false;
+        }
+
+        LogCategory category;
+        if (!Log::parseCategory(item.substr(0, eq), category)) {
+            return false;
+        }
+
+        try {
+            LogRateLimit limit;
+            limit.burst = static_cast<unsigned>(std::stoul(item.substr(eq + 1, slash - eq - 1)));
+            limit.perSecond = std::stod(item.substr(slash + 1));
+            if (limit.perSecond < 0) {
+                return false;
+            }
+            out.emplace_back(category, limit);
+        } catch (...) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 }  // namespace tos
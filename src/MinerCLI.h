@@ -5,7 +5,10 @@
 #pragma once
 
 #include "core/Types.h"
+#include "opencl/ScratchLayout.h"
+#include "util/Log.h"
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace tos {
@@ -16,6 +19,7 @@ namespace tos {
 enum class MiningMode {
     Stratum,      // Connect to pool via stratum
     Benchmark,    // Run benchmark
+    AutoTune,     // Sweep GPU settings and store the best in the tuning database
     ListDevices   // List available devices
 };
 
@@ -41,10 +45,27 @@ struct MinerConfig {
 
     // Performance tuning
     std::string tuningProfile = "default";  // Tuning profile name
+    bool tuningExplicit = false;   // --profile or a work size flag given (tuning database not used)
+    std::string tuningDb;          // Tuning database file (empty = default location)
     unsigned openclGlobalWorkSize = 16384;
     unsigned openclLocalWorkSize = 1;
+    unsigned openclNonceLoop = 0;  // Persistent kernel nonces per work item (0 = one-shot kernel)
+    ScratchLayout openclScratch = ScratchLayout::Local;  // OpenCL scratchpad placement
+    unsigned openclPipelineDepth = 2;  // OpenCL batches in flight
+    bool openclOutOfOrder = false;     // One-shot OpenCL batches on an out-of-order queue
+    bool openclProfiling = false;      // Device timestamps for every OpenCL batch (timeline, /trace)
+    unsigned batchTarget = 0;      // GPU kernel time per batch in ms (0 = fixed batch size)
     unsigned cudaGridSize = 16384;
     unsigned cudaBlockSize = 1;
+    unsigned cudaStreams = 2;      // CUDA streams, one batch in flight each
+    GovernorConfig governor;  // Temperature/power caps (disabled by default)
+    HostLoadConfig hostLoad;  // CPU thread parking under host load (disabled by default)
+    AnomalyConfig anomaly;    // Hash rate anomaly detection
+    RecoveryConfig recovery;  // Failed-device retries with backoff
+    unsigned integritySample = 0;  // Percent of GPU easy-target hits to re-hash (0 = off)
+    bool selfTest = true;          // Known-answer test on each device before it mines
+    std::string clCacheDir;        // OpenCL binary cache directory (empty = default location)
+    bool clCache = true;           // Keep compiled OpenCL kernels on disk between runs
 
     // Benchmark options
     uint64_t benchmarkIterations = 1000;
@@ -54,6 +75,9 @@ struct MinerConfig {
 
     // API/Monitoring
     unsigned apiPort = 0;    // 0 = disabled, otherwise JSON-RPC port
+    unsigned apiEventsInterval = 1000;  // /events stat delta interval (ms)
+    std::string shmStatsPath;  // Empty = disabled, otherwise shared memory stats file
+    unsigned gpuSampleInterval = 1000;  // GPU sensor sampling interval (ms)
 
     // Stratum protocol variant
     std::string stratumProtocol = "stratum";  // stratum, ethproxy, ethereumstratum
@@ -61,6 +85,8 @@ struct MinerConfig {
     // Logging
     bool verbose = false;
     bool quiet = false;
+    bool logRateLimit = true;  // Suppress repeated warnings (log storms)
+    std::vector<std::pair<LogCategory, LogRateLimit>> logRateLimits;  // Per-category overrides
 
     // Help
     bool showHelp = false;
@@ -98,6 +124,14 @@ private:
      * Parse device list string (e.g., "0,1,2")
      */
     static std::vector<unsigned> parseDeviceList(const std::string& str);
+
+    /**
+     * Parse log rate limit list (e.g., "solution=10/0.5,network=5/0.2")
+     *
+     * @return false if any entry is malformed
+     */
+    static bool parseLogRateLimits(const std::string& str,
+                                   std::vector<std::pair<LogCategory, LogRateLimit>>& out);
 };
 
 }  // namespace tos
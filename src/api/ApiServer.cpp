@@ -8,16 +8,438 @@
 #include "util/GpuMonitor.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <functional>
+#include <deque>
+#include <array>
+#include <cstdlib>
 
 namespace asio = boost::asio;
 using tcp = asio::ip::tcp;
 
 namespace tos {
 
-ApiServer::ApiServer(unsigned port, Farm& farm, StratumClient& stratum)
+namespace {
+
+/**
+ * Escape a Prometheus label value
+ */
+std::string escapeLabel(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+/**
+ * Get the members of cur that differ from prev (recursing into objects)
+ */
+json diffState(const json& prev, const json& cur) {
+    json delta = json::object();
+    if (!prev.is_object()) {
+        return cur;
+    }
+    for (auto it = cur.begin(); it != cur.end(); ++it) {
+        auto old = prev.find(it.key());
+        if (old == prev.end()) {
+            delta[it.key()] = it.value();
+        } else if (it.value().is_object() && old->is_object()) {
+            json sub = diffState(*old, it.value());
+            if (!sub.empty()) {
+                delta[it.key()] = sub;
+            }
+        } else if (*old != it.value()) {
+            delta[it.key()] = it.value();
+        }
+    }
+    // Removed keys are sent as null
+    for (auto it = prev.begin(); it != prev.end(); ++it) {
+        if (!cur.contains(it.key())) {
+            delta[it.key()] = nullptr;
+        }
+    }
+    return delta;
+}
+
+/**
+ * Add windowed hash rates to a JSON object
+ */
+void addWindows(json& out, const HashRateWindows& w) {
+    out["hashrate_10s"] = w.s10;
+    out["hashrate_1m"] = w.m1;
+    out["hashrate_15m"] = w.m15;
+    out["hashrate_1h"] = w.h1;
+    out["hashrate_24h"] = w.h24;
+}
+
+/**
+ * Add a device timeline summary (milliseconds) to a JSON object
+ */
+void addTimeline(json& out, const TimelineStats& t) {
+    auto meanMs = [](const HistogramSnapshot& h) { return h.count > 0 ? h.sum * 1000.0 / h.count : 0.0; };
+    double busy = t.kernel.sum + t.idle.sum;
+    out["timeline"] = {
+        {"batches", t.kernel.count},
+        {"kernel_ms", meanMs(t.kernel)},
+        {"kernel_p99_ms", t.kernel.quantile(0.99) * 1000.0},
+        {"transfer_ms", meanMs(t.transfer)},
+        {"transfer_p99_ms", t.transfer.quantile(0.99) * 1000.0},
+        {"idle_ms", meanMs(t.idle)},
+        {"idle_p99_ms", t.idle.quantile(0.99) * 1000.0},
+        {"idle_ratio", busy > 0 ? t.idle.sum / busy : 0.0}
+    };
+}
+
+/**
+ * Get a query string parameter (no percent-decoding; values are simple tokens)
+ */
+std::string queryParam(const std::string& query, const std::string& name) {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        std::string pair = query.substr(pos, end - pos);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            return eq != std::string::npos ? pair.substr(eq + 1) : std::string();
+        }
+        pos = end + 1;
+    }
+    return std::string();
+}
+
+/**
+ * Parse a duration such as "10s", "1m", "15m", "1h"
+ *
+ * @return Seconds, or 0 if malformed
+ */
+double parseDuration(const std::string& text) {
+    if (text.empty()) {
+        return 0;
+    }
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    std::string unit(end);
+    if (value <= 0) {
+        return 0;
+    }
+    if (unit.empty() || unit == "s") return value;
+    if (unit == "m") return value * 60;
+    if (unit == "h") return value * 3600;
+    if (unit == "d") return value * 86400;
+    return 0;
+}
+
+/**
+ * Format seconds as the shortest duration label ("10s", "1m", "1h")
+ */
+std::string formatDuration(double seconds) {
+    std::ostringstream ss;
+    if (seconds >= 3600 && std::fmod(seconds, 3600) == 0) {
+        ss << seconds / 3600 << "h";
+    } else if (seconds >= 60 && std::fmod(seconds, 60) == 0) {
+        ss << seconds / 60 << "m";
+    } else {
+        ss << seconds << "s";
+    }
+    return ss.str();
+}
+
+/**
+ * Prometheus text exposition builder
+ */
+class MetricsWriter {
+public:
+    MetricsWriter() {
+        // Keep large counters (hash totals) exact
+        m_out << std::setprecision(15);
+    }
+
+    void family(const std::string& name, const std::string& help, const std::string& type) {
+        m_out << "# HELP " << name << " " << help << "\n";
+        m_out << "# TYPE " << name << " " << type << "\n";
+    }
+
+    void sample(const std::string& name, const std::string& labels, double value) {
+        m_out << name;
+        if (!labels.empty()) {
+            m_out << "{" << labels << "}";
+        }
+        m_out << " " << value << "\n";
+    }
+
+    void histogram(const std::string& name, const std::string& labels, const HistogramSnapshot& h) {
+        std::string prefix = labels.empty() ? std::string() : labels + ",";
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < h.bounds.size(); i++) {
+            cumulative += h.counts[i];
+            std::ostringstream le;
+            le << h.bounds[i];
+            sample(name + "_bucket", prefix + "le=\"" + le.str() + "\"", static_cast<double>(cumulative));
+        }
+        sample(name + "_bucket", prefix + "le=\"+Inf\"", static_cast<double>(h.count));
+        sample(name + "_sum", labels, h.sum);
+        sample(name + "_count", labels, static_cast<double>(h.count));
+    }
+
+    std::string str() const { return m_out.str(); }
+
+private:
+    std::ostringstream m_out;
+};
+
+}  // namespace
+
+/**
+ * A single keep-alive HTTP connection
+ *
+ * Reads request heads, answers every complete request already buffered
+ * (pipelining) with one write, then waits for more until the client
+ * closes, asks to close, or the idle timeout fires. A GET /events request
+ * turns the connection into a server-sent event stream.
+ */
+class ApiSession : public std::enable_shared_from_this<ApiSession> {
+public:
+    ApiSession(ApiServer& server, tcp::socket socket)
+        : m_server(server)
+        , m_socket(std::move(socket))
+        , m_buffer(ApiServer::MAX_REQUEST_SIZE)
+        , m_timer(m_socket.get_executor())
+    {
+        m_server.m_sessions.insert(this);
+    }
+
+    ~ApiSession() {
+        m_server.m_sessions.erase(this);
+    }
+
+    void start() {
+        readHead();
+    }
+
+    void close() {
+        boost::system::error_code ec;
+        m_timer.cancel();
+        m_socket.shutdown(tcp::socket::shutdown_both, ec);
+        m_socket.close(ec);
+
+        if (m_streaming) {
+            m_streaming = false;
+            m_server.m_subscribers.erase(shared_from_this());
+        }
+    }
+
+    /**
+     * Queue a serialized event frame (shared with all other subscribers)
+     */
+    void pushFrame(const std::shared_ptr<const std::string>& frame) {
+        if (!m_streaming) {
+            return;
+        }
+
+        // A subscriber that can't keep up is dropped rather than buffered forever
+        if (m_queue.size() >= ApiServer::MAX_QUEUED_EVENTS) {
+            Log::limited(LogLevel::Debug, LogCategory::Api, "api:events:slow",
+                         "Dropping slow event stream subscriber");
+            close();
+            return;
+        }
+
+        m_queue.push_back(frame);
+        if (m_queue.size() == 1) {
+            writeFrame();
+        }
+    }
+
+private:
+    void waitForRequest() {
+        // Pipelined requests may already be buffered
+        if (m_buffer.size() > 0) {
+            readHead();
+            return;
+        }
+
+        // Between requests the idle timeout applies until the next byte
+        auto self = shared_from_this();
+        armTimer(ApiServer::IDLE_TIMEOUT);
+        m_socket.async_wait(tcp::socket::wait_read,
+            [self](const boost::system::error_code& ec) {
+                self->m_timer.cancel();
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                self->readHead();
+            });
+    }
+
+    void readHead() {
+        auto self = shared_from_this();
+
+        // The whole head must arrive within the request timeout of its first
+        // byte (or of accept), so a client trickling it is cut off early
+        armTimer(ApiServer::REQUEST_TIMEOUT);
+
+        asio::async_read_until(m_socket, m_buffer, "\r\n\r\n",
+            [self](const boost::system::error_code& ec, size_t) {
+                self->onRead(ec);
+            });
+    }
+
+    void onRead(const boost::system::error_code& ec) {
+        m_timer.cancel();
+
+        if (ec) {
+            // EOF, timeout (socket closed), or head larger than MAX_REQUEST_SIZE
+            if (ec == asio::error::not_found) {
+                m_response = m_server.createResponse(431, R"({"error":"Request header too large"})", false);
+                writeResponse(false);
+            } else {
+                close();
+            }
+            return;
+        }
+
+        // Answer every complete request head in the buffer
+        m_response.clear();
+        bool keepAlive = true;
+        bool stream = false;
+        size_t answered = 0;
+
+        while (keepAlive && answered < ApiServer::MAX_PIPELINED) {
+            auto data = m_buffer.data();
+            std::string pending(asio::buffers_begin(data), asio::buffers_end(data));
+            size_t headEnd = pending.find("\r\n\r\n");
+            if (headEnd == std::string::npos) {
+                break;
+            }
+            m_buffer.consume(headEnd + 4);
+
+            HttpRequest request;
+            if (!ApiServer::parseRequest(pending.substr(0, headEnd), request)) {
+                m_response += m_server.createResponse(400, R"({"error":"Bad request"})", false);
+                keepAlive = false;
+                break;
+            }
+
+            if (request.method == "GET" && request.path == "/events") {
+                m_response += ApiServer::createStreamResponse();
+                stream = true;
+                break;
+            }
+
+            // Unsupported methods may carry a body we don't read; close after answering
+            keepAlive = request.keepAlive && request.method == "GET";
+            m_response += m_server.handleRequest(request);
+            answered++;
+        }
+
+        if (stream) {
+            writeStreamHead();
+        } else {
+            writeResponse(keepAlive);
+        }
+    }
+
+    void writeResponse(bool keepAlive) {
+        auto self = shared_from_this();
+        armTimer(ApiServer::REQUEST_TIMEOUT);
+
+        asio::async_write(m_socket, asio::buffer(m_response),
+            [self, keepAlive](const boost::system::error_code& ec, size_t) {
+                self->m_timer.cancel();
+                if (ec || !keepAlive) {
+                    self->close();
+                    return;
+                }
+
+                self->waitForRequest();
+            });
+    }
+
+    void armTimer(unsigned seconds) {
+        auto self = shared_from_this();
+        m_timer.expires_after(std::chrono::seconds(seconds));
+        m_timer.async_wait([self](const boost::system::error_code& ec) {
+            if (!ec) {
+                self->close();
+            }
+        });
+    }
+
+    void writeStreamHead() {
+        auto self = shared_from_this();
+
+        asio::async_write(m_socket, asio::buffer(m_response),
+            [self](const boost::system::error_code& ec, size_t) {
+                if (ec) {
+                    self->close();
+                    return;
+                }
+
+                self->m_streaming = true;
+                self->m_server.m_subscribers.insert(self);
+                self->m_server.onSubscribe(*self);
+                self->waitForClose();
+            });
+    }
+
+    void waitForClose() {
+        // Clients don't send anything on an event stream; any read
+        // completion (EOF or stray data) ends the subscription
+        auto self = shared_from_this();
+        m_socket.async_read_some(asio::buffer(m_probe),
+            [self](const boost::system::error_code&, size_t) {
+                self->close();
+            });
+    }
+
+    void writeFrame() {
+        auto self = shared_from_this();
+        asio::async_write(m_socket, asio::buffer(*m_queue.front()),
+            [self](const boost::system::error_code& ec, size_t) {
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                if (!self->m_streaming) {
+                    return;  // Closed meanwhile; the queue goes with the session
+                }
+                self->m_queue.pop_front();
+                if (!self->m_queue.empty()) {
+                    self->writeFrame();
+                }
+            });
+    }
+
+    ApiServer& m_server;
+    tcp::socket m_socket;
+    asio::streambuf m_buffer;
+    asio::steady_timer m_timer;
+    std::string m_response;
+
+    // Event stream state
+    bool m_streaming{false};
+    std::deque<std::shared_ptr<const std::string>> m_queue;
+    std::array<char, 64> m_probe;
+};
+
+ApiServer::ApiServer(unsigned port, Telemetry& telemetry)
     : m_port(port)
-    , m_farm(farm)
-    , m_stratum(stratum)
+    , m_telemetry(telemetry)
 {
 }
 
@@ -31,13 +453,34 @@ bool ApiServer::start() {
     }
 
     try {
-        m_acceptor = std::make_unique<tcp::acceptor>(
-            m_io, tcp::endpoint(tcp::v4(), m_port)
-        );
+        m_acceptor = std::make_unique<tcp::acceptor>(m_io);
+        tcp::endpoint endpoint(tcp::v4(), m_port);
+        m_acceptor->open(endpoint.protocol());
         m_acceptor->set_option(asio::socket_base::reuse_address(true));
+        m_acceptor->bind(endpoint);
+        m_acceptor->listen();
+
+        // Render from the latest snapshot now, then on every tick
+        if (auto snapshot = m_telemetry.latest()) {
+            render(*snapshot);
+        }
+        m_listenerId = m_telemetry.addListener([this](const TelemetrySnapshotPtr& snapshot) {
+            render(*snapshot);
+        });
 
         m_running = true;
-        m_thread = std::thread([this]() { acceptLoop(); });
+        doAccept();
+
+        m_lastEventFrame = std::chrono::steady_clock::now();
+        m_eventTimer = std::make_unique<asio::steady_timer>(m_io);
+        scheduleStatsEvent();
+        m_thread = std::thread([this]() {
+            try {
+                m_io.run();
+            } catch (const std::exception& e) {
+                Log::error("API server error: " + std::string(e.what()));
+            }
+        });
 
         Log::info("API server started on port " + std::to_string(m_port));
         return true;
@@ -53,116 +496,423 @@ void ApiServer::stop() {
     }
 
     m_running = false;
-    m_io.stop();
 
-    if (m_acceptor) {
+    m_telemetry.removeListener(m_listenerId);
+    m_listenerId = 0;
+
+    // Close acceptor and sessions on the IO thread, then stop the loop
+    asio::post(m_io, [this]() {
         boost::system::error_code ec;
-        m_acceptor->close(ec);
-    }
+        if (m_acceptor) {
+            m_acceptor->close(ec);
+        }
+        if (m_eventTimer) {
+            m_eventTimer->cancel();
+        }
+        std::vector<ApiSession*> sessions(m_sessions.begin(), m_sessions.end());
+        for (auto* session : sessions) {
+            session->close();
+        }
+        m_io.stop();
+    });
 
     if (m_thread.joinable()) {
         m_thread.join();
     }
 
+    // Release subscribers while the io_context is still alive
+    m_subscribers.clear();
+
     Log::info("API server stopped");
 }
 
-void ApiServer::acceptLoop() {
-    while (m_running) {
-        try {
-            auto socket = std::make_shared<tcp::socket>(m_io);
-            boost::system::error_code ec;
-            m_acceptor->accept(*socket, ec);
+void ApiServer::doAccept() {
+    m_acceptor->async_accept([this](const boost::system::error_code& ec, tcp::socket socket) {
+        if (!m_running) {
+            return;
+        }
 
-            if (ec) {
-                if (m_running) {
-                    Log::debug("API accept error: " + ec.message());
-                }
-                continue;
-            }
+        if (ec) {
+            Log::limited(LogLevel::Debug, LogCategory::Api, "api:accept",
+                         "API accept error: " + ec.message());
+        } else if (m_sessions.size() >= MAX_CONNECTIONS) {
+            // Over capacity: refuse without spending a session on it
+            Log::limited(LogLevel::Warning, LogCategory::Api, "api:limit",
+                         "API connection limit reached (" + std::to_string(MAX_CONNECTIONS) +
+                         "), refusing client");
+            auto refused = std::make_shared<tcp::socket>(std::move(socket));
+            auto response = std::make_shared<std::string>(
+                createResponse(503, R"({"error":"Too many connections"})", false));
+            asio::async_write(*refused, asio::buffer(*response),
+                [refused, response](const boost::system::error_code&, size_t) {
+                    boost::system::error_code ignored;
+                    refused->shutdown(tcp::socket::shutdown_both, ignored);
+                    refused->close(ignored);
+                });
+        } else {
+            std::make_shared<ApiSession>(*this, std::move(socket))->start();
+        }
+
+        doAccept();
+    });
+}
+
+bool ApiServer::parseRequest(const std::string& head, HttpRequest& request) {
+    std::istringstream is(head);
+    std::string line;
 
-            // Handle client in detached thread (simple approach)
-            std::thread([this, socket]() {
-                handleClient(socket);
-            }).detach();
+    // Request line: "GET /path?query HTTP/1.1"
+    if (!std::getline(is, line)) {
+        return false;
+    }
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+
+    std::string target;
+    std::istringstream requestLine(line);
+    if (!(requestLine >> request.method >> target >> request.version)) {
+        return false;
+    }
+    if (request.version.compare(0, 5, "HTTP/") != 0 || target.empty()) {
+        return false;
+    }
 
-        } catch (const std::exception& e) {
-            if (m_running) {
-                Log::debug("API server error: " + std::string(e.what()));
+    size_t q = target.find('?');
+    request.path = target.substr(0, q);
+    request.query = (q != std::string::npos) ? target.substr(q + 1) : std::string();
+
+    // Headers
+    while (std::getline(is, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        request.headers[name] = value;
+    }
+
+    // HTTP/1.1 defaults to keep-alive, HTTP/1.0 to close
+    std::string connection = request.header("connection");
+    std::transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+    if (request.version == "HTTP/1.0") {
+        request.keepAlive = connection == "keep-alive";
+    } else {
+        request.keepAlive = connection != "close";
+    }
+
+    return true;
+}
+
+std::string ApiServer::handleRequest(const HttpRequest& request) {
+    // Only handle GET requests
+    if (request.method != "GET") {
+        return createResponse(405, R"({"error":"Method not allowed"})", false);
+    }
+
+    // Route to appropriate handler
+    const std::string& path = request.path;
+    std::string route;
+    if (path == "/" || path == "/status") {
+        route = "/status";
+    } else if (path == "/stats" || path == "/devices" || path == "/health" || path == "/metrics") {
+        route = path;
+    } else if (path == "/history") {
+        // Query-dependent; read straight from the (small, locked) history
+        return getHistory(request);
+    } else if (path == "/trace") {
+        return getTrace(request);
+    } else {
+        return createResponse(404, R"({"error":"Not found"})", request.keepAlive);
+    }
+
+    auto rendered = std::atomic_load(&m_rendered);
+    if (!rendered) {
+        return createResponse(503, R"({"error":"Telemetry not ready"})", request.keepAlive);
+    }
+
+    auto it = rendered->find(route);
+    if (it == rendered->end()) {
+        return createResponse(404, R"({"error":"Not found"})", request.keepAlive);
+    }
+
+    const RenderedBody& entry = it->second;
+    if (request.header("if-none-match") == entry.etag) {
+        return createResponse(304, std::string(), request.keepAlive, entry.etag, entry.contentType);
+    }
+
+    return createResponse(200, entry.body, request.keepAlive, entry.etag, entry.contentType);
+}
+
+std::string ApiServer::getHistory(const HttpRequest& request) {
+    std::string deviceParam = queryParam(request.query, "device");
+    std::string resParam = queryParam(request.query, "res");
+
+    int device = -1;  // Farm total
+    if (!deviceParam.empty() && deviceParam != "total") {
+        char* end = nullptr;
+        long value = std::strtol(deviceParam.c_str(), &end, 10);
+        if (*end != '\0' || value < 0) {
+            return createResponse(400, R"({"error":"Invalid device"})", request.keepAlive);
+        }
+        device = static_cast<int>(value);
+    }
+
+    double resolution = resParam.empty() ? 60 : parseDuration(resParam);
+
+    std::vector<int64_t> samples;
+    if (!m_telemetry.getHistory(device, resolution, samples)) {
+        json error;
+        error["error"] = "Unknown device or resolution";
+        json available = json::array();
+        for (double r : m_telemetry.getHistoryResolutions()) {
+            available.push_back(formatDuration(r));
+        }
+        error["resolutions"] = available;
+        return createResponse(404, error.dump(), request.keepAlive);
+    }
+
+    json result;
+    result["device"] = device >= 0 ? json(device) : json("total");
+    result["resolution"] = formatDuration(resolution);
+    result["resolution_seconds"] = resolution;
+    result["samples"] = samples;  // H/s, oldest first; last sample is the most recent
+    return createResponse(200, result.dump(), request.keepAlive);
+}
+
+std::string ApiServer::getTrace(const HttpRequest& request) {
+    auto snapshot = m_telemetry.latest();
+    if (!snapshot) {
+        return createResponse(503, R"({"error":"Telemetry not ready"})", request.keepAlive);
+    }
+
+    std::string deviceParam = queryParam(request.query, "device");
+    int only = -1;  // All devices
+    if (!deviceParam.empty()) {
+        char* end = nullptr;
+        long value = std::strtol(deviceParam.c_str(), &end, 10);
+        if (*end != '\0' || value < 0 || static_cast<size_t>(value) >= snapshot->devices.size()) {
+            return createResponse(400, R"({"error":"Invalid device"})", request.keepAlive);
+        }
+        only = static_cast<int>(value);
+    }
+
+    std::vector<std::vector<BatchTiming>> batches(snapshot->devices.size());
+    uint64_t origin = UINT64_MAX;
+    for (size_t i = 0; i < batches.size(); i++) {
+        if (only < 0 || static_cast<int>(i) == only) {
+            batches[i] = m_telemetry.getRecentBatches(static_cast<unsigned>(i));
+            for (const auto& b : batches[i]) {
+                origin = std::min(origin, b.kernel.queued);
             }
         }
     }
+
+    // Chrome trace event format (chrome://tracing, Perfetto): one process
+    // per device, kernels and readbacks on separate tracks, times in us
+    auto us = [origin](uint64_t ns) { return ns > origin ? static_cast<double>(ns - origin) / 1000.0 : 0.0; };
+    json events = json::array();
+    for (size_t i = 0; i < batches.size(); i++) {
+        if (batches[i].empty()) {
+            continue;
+        }
+        int pid = static_cast<int>(i);
+        events.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", pid},
+                          {"args", {{"name", snapshot->devices[i].device.name}}}});
+        events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", 0},
+                          {"args", {{"name", "kernel"}}}});
+        events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", 1},
+                          {"args", {{"name", "transfer"}}}});
+
+        for (const auto& b : batches[i]) {
+            events.push_back({{"name", "kernel"}, {"ph", "X"}, {"pid", pid}, {"tid", 0},
+                              {"ts", us(b.kernel.start)}, {"dur", us(b.kernel.end) - us(b.kernel.start)},
+                              {"args", {{"start_nonce", b.startNonce}, {"size", b.size}, {"slot", b.slot},
+                                        {"queued_us", us(b.kernel.queued)},
+                                        {"submit_us", us(b.kernel.submit)}}}});
+            if (b.read.end > b.read.start && b.read.start != 0) {
+                events.push_back({{"name", "read"}, {"ph", "X"}, {"pid", pid}, {"tid", 1},
+                                  {"ts", us(b.read.start)}, {"dur", us(b.read.end) - us(b.read.start)},
+                                  {"args", {{"slot", b.slot}, {"queued_us", us(b.read.queued)}}}});
+            }
+        }
+    }
+
+    json result;
+    result["traceEvents"] = events;
+    result["displayTimeUnit"] = "ms";
+    return createResponse(200, result.dump(), request.keepAlive);
 }
 
-void ApiServer::handleClient(std::shared_ptr<tcp::socket> socket) {
-    try {
-        // Read request
-        asio::streambuf buffer;
-        boost::system::error_code ec;
-        asio::read_until(*socket, buffer, "\r\n\r\n", ec);
+void ApiServer::publishEvent(const std::string& type, const json& data) {
+    if (!m_running) {
+        return;
+    }
 
-        if (ec) {
+    auto frame = makeFrame(type, data);
+    asio::post(m_io, [this, frame]() {
+        broadcast(frame);
+    });
+}
+
+void ApiServer::scheduleStatsEvent() {
+    m_eventTimer->expires_after(std::chrono::milliseconds(s_eventIntervalMs));
+    m_eventTimer->async_wait([this](const boost::system::error_code& ec) {
+        if (ec || !m_running) {
             return;
         }
+        sendStatsEvent();
+        scheduleStatsEvent();
+    });
+}
 
-        std::istream is(&buffer);
-        std::string request;
-        std::getline(is, request);
+void ApiServer::sendStatsEvent() {
+    auto snapshot = m_telemetry.latest();
+    if (!snapshot) {
+        return;
+    }
 
-        // Generate response
-        std::string response = handleRequest(request);
+    // Track state even without subscribers so the first delta is small
+    json state = getEventState(*snapshot);
+    json delta = diffState(m_eventState, state);
+    m_eventState = std::move(state);
+
+    if (m_subscribers.empty()) {
+        return;
+    }
 
-        // Send response
-        asio::write(*socket, asio::buffer(response), ec);
+    auto now = std::chrono::steady_clock::now();
+    if (!delta.empty()) {
+        broadcast(makeFrame("stats", delta));
+    } else if (now - m_lastEventFrame >= std::chrono::seconds(EVENT_HEARTBEAT)) {
+        // Comment line keeps proxies from timing out an idle stream
+        broadcast(std::make_shared<const std::string>(": heartbeat\n\n"));
+    }
+}
 
-        // Close connection
-        socket->shutdown(tcp::socket::shutdown_both, ec);
-        socket->close(ec);
+void ApiServer::onSubscribe(ApiSession& session) {
+    if (m_eventState.is_null()) {
+        if (auto snapshot = m_telemetry.latest()) {
+            m_eventState = getEventState(*snapshot);
+        }
+    }
 
-    } catch (...) {
-        // Ignore client errors
+    // New subscribers start from the full state; later "stats" frames are deltas
+    if (!m_eventState.is_null()) {
+        session.pushFrame(makeFrame("snapshot", m_eventState));
     }
 }
 
-std::string ApiServer::handleRequest(const std::string& request) {
-    // Parse HTTP request line: "GET /path HTTP/1.1"
-    std::string method, path;
-    std::istringstream iss(request);
-    iss >> method >> path;
+void ApiServer::broadcast(const std::shared_ptr<const std::string>& frame) {
+    m_lastEventFrame = std::chrono::steady_clock::now();
 
-    // Only handle GET requests
-    if (method != "GET") {
-        return createResponse(405, R"({"error":"Method not allowed"})");
+    // pushFrame may drop a slow subscriber, which erases it from the set
+    std::vector<std::shared_ptr<ApiSession>> subscribers(m_subscribers.begin(), m_subscribers.end());
+    for (auto& session : subscribers) {
+        session->pushFrame(frame);
     }
+}
 
-    // Route to appropriate handler
-    json result;
-    if (path == "/" || path == "/status") {
-        result = getStatus();
-    } else if (path == "/stats") {
-        result = getStats();
-    } else if (path == "/devices") {
-        result = getDevices();
-    } else if (path == "/health") {
-        result = getHealth();
-    } else {
-        return createResponse(404, R"({"error":"Not found"})");
+std::shared_ptr<const std::string> ApiServer::makeFrame(const std::string& type, const json& data) {
+    std::ostringstream frame;
+    frame << "id: " << ++m_eventId << "\n";
+    frame << "event: " << type << "\n";
+    frame << "data: " << data.dump() << "\n\n";
+    return std::make_shared<const std::string>(frame.str());
+}
+
+json ApiServer::getEventState(const TelemetrySnapshot& snapshot) {
+    json state;
+    state["hashrate"] = std::llround(snapshot.hashRate.effectiveRate());
+    state["accepted"] = snapshot.stats.acceptedShares;
+    state["rejected"] = snapshot.stats.rejectedShares;
+    state["stale"] = snapshot.stats.staleShares;
+    state["connected"] = snapshot.pool.connected;
+    state["difficulty"] = snapshot.pool.difficulty;
+    state["active_miners"] = snapshot.activeMinerCount;
+
+    // Keyed by index so deltas address single devices
+    json devices = json::object();
+    for (const auto& entry : snapshot.devices) {
+        json device;
+        device["hashrate"] = std::llround(entry.hashRate.effectiveRate());
+        device["failed"] = entry.failed;
+        if (entry.gpu.valid && entry.gpu.temperature >= 0) {
+            device["temperature"] = entry.gpu.temperature;
+        }
+        devices[std::to_string(entry.device.index)] = device;
     }
+    state["devices"] = devices;
+
+    return state;
+}
+
+std::string ApiServer::createStreamResponse() {
+    std::ostringstream response;
+    response << "HTTP/1.1 200 OK\r\n";
+    response << "Content-Type: text/event-stream\r\n";
+    response << "Cache-Control: no-cache\r\n";
+    response << "Connection: keep-alive\r\n";
+    response << "Access-Control-Allow-Origin: *\r\n";
+    response << "\r\n";
+    response << "retry: 5000\n\n";
+    return response.str();
+}
+
+void ApiServer::render(const TelemetrySnapshot& snapshot) {
+    auto bodies = std::make_shared<RenderedBodies>();
+
+    auto add = [&bodies](const std::string& route, std::string body,
+                         const std::string& contentType = "application/json") {
+        RenderedBody& entry = (*bodies)[route];
+        entry.body = std::move(body);
+        entry.contentType = contentType;
 
-    return createResponse(200, result.dump(2));
+        // Content hash, so unchanged bodies keep their ETag across ticks
+        std::ostringstream etag;
+        etag << '"' << std::hex << std::hash<std::string>{}(entry.body) << '"';
+        entry.etag = etag.str();
+    };
+
+    add("/status", getStatus(snapshot).dump(2));
+    add("/stats", getStats(snapshot).dump(2));
+    add("/devices", getDevices(snapshot).dump(2));
+    json health = getHealth(snapshot);
+    add("/health", health.dump(2));
+    add("/metrics", getMetrics(snapshot), "text/plain; version=0.0.4");
+
+    std::atomic_store(&m_rendered, std::shared_ptr<const RenderedBodies>(std::move(bodies)));
+
+    // Push health transitions to event subscribers right away
+    std::string healthKey = health["overall"].get<std::string>();
+    for (const auto& device : health["devices"]) {
+        healthKey += "|" + device["status"].get<std::string>();
+    }
+    if (healthKey != m_lastHealthKey) {
+        if (!m_lastHealthKey.empty()) {
+            publishEvent("health", health);
+        }
+        m_lastHealthKey = healthKey;
+    }
 }
 
-json ApiServer::getStatus() {
-    auto hr = m_farm.getHashRate();
-    auto stats = m_farm.getStats();
+json ApiServer::getStatus(const TelemetrySnapshot& snapshot) {
+    const auto& hr = snapshot.hashRate;
+    const auto& stats = snapshot.stats;
 
     json status;
     status["version"] = VERSION_STRING;
     status["uptime"] = static_cast<uint64_t>(hr.duration);
-    status["mining"] = m_farm.isRunning();
-    status["paused"] = m_farm.isPaused();
-    status["connected"] = m_stratum.isConnected();
-    status["authorized"] = m_stratum.isAuthorized();
+    status["mining"] = snapshot.running;
+    status["paused"] = snapshot.paused;
+    status["connected"] = snapshot.pool.connected;
+    status["authorized"] = snapshot.pool.authorized;
 
     // Hash rate with appropriate unit (use EMA for stable display)
     double displayRate = hr.effectiveRate();
@@ -183,21 +933,22 @@ json ApiServer::getStatus() {
         {"stale", stats.staleShares}
     };
 
-    status["difficulty"] = m_stratum.getDifficulty();
-    status["miners"] = m_farm.minerCount();
-    status["active_miners"] = m_farm.activeMinerCount();
+    status["difficulty"] = snapshot.pool.difficulty;
+    status["miners"] = snapshot.minerCount;
+    status["active_miners"] = snapshot.activeMinerCount;
 
     return status;
 }
 
-json ApiServer::getStats() {
-    auto hr = m_farm.getHashRate();
-    auto stats = m_farm.getStats();
+json ApiServer::getStats(const TelemetrySnapshot& snapshot) {
+    const auto& hr = snapshot.hashRate;
+    const auto& stats = snapshot.stats;
 
     json result;
     result["hashrate"] = hr.effectiveRate();  // EMA rate for stability
     result["hashrate_instant"] = hr.rate;
     result["hashrate_ema"] = hr.emaRate;
+    addWindows(result, snapshot.windows);
     result["hashes"] = hr.count;
     result["duration"] = hr.duration;
     result["accepted"] = stats.acceptedShares;
@@ -211,22 +962,41 @@ json ApiServer::getStats() {
 
     // Pool stats
     result["pool"] = {
-        {"connected", m_stratum.isConnected()},
-        {"difficulty", m_stratum.getDifficulty()},
-        {"accepted", m_stratum.getAcceptedShares()},
-        {"rejected", m_stratum.getRejectedShares()}
+        {"connected", snapshot.pool.connected},
+        {"difficulty", snapshot.pool.difficulty},
+        {"accepted", snapshot.pool.accepted},
+        {"rejected", snapshot.pool.rejected}
     };
 
+    // CPU package sensors and CPU farm efficiency
+    const CpuStats& cpu = snapshot.cpu;
+    if (cpu.valid) {
+        json cpuJson;
+        cpuJson["hashrate"] = snapshot.cpuHashRate;
+        if (cpu.packagePower >= 0) {
+            cpuJson["power_watts"] = cpu.packagePower;
+            cpuJson["energy_joules"] = cpu.energy;
+            cpuJson["hashes_per_watt"] = snapshot.cpuHashesPerWatt;
+        }
+        if (cpu.temperature >= 0) {
+            cpuJson["temperature"] = cpu.temperature;
+        }
+        if (cpu.frequency >= 0) {
+            cpuJson["frequency_mhz"] = cpu.frequency;
+            cpuJson["frequency_max_mhz"] = cpu.frequencyMax;
+        }
+        result["cpu"] = cpuJson;
+    }
+
     return result;
 }
 
-json ApiServer::getDevices() {
+json ApiServer::getDevices(const TelemetrySnapshot& snapshot) {
     json devices = json::array();
-    auto descriptors = m_farm.getDevices();
 
-    for (size_t i = 0; i < descriptors.size(); i++) {
-        const auto& dev = descriptors[i];
-        auto hr = m_farm.getMinerHashRate(static_cast<unsigned>(i));
+    for (const auto& entry : snapshot.devices) {
+        const auto& dev = entry.device;
+        const auto& hr = entry.hashRate;
 
         json device;
         device["index"] = dev.index;
@@ -236,19 +1006,38 @@ json ApiServer::getDevices() {
         device["hashrate"] = hr.effectiveRate();  // EMA rate
         device["hashrate_instant"] = hr.rate;
         device["hashrate_ema"] = hr.emaRate;
+        addWindows(device, entry.windows);
         device["hashes"] = hr.count;
         device["memory_mb"] = dev.totalMemory / (1024 * 1024);
         device["compute_units"] = dev.computeUnits;
-        device["failed"] = m_farm.isMinerFailed(static_cast<unsigned>(i));
+        device["failed"] = entry.failed;
+        device["intensity"] = entry.intensity;
+        device["parked"] = entry.parked;
+        if (dev.type != MinerType::CPU) {
+            device["batch_size"] = entry.batchSize;
+            device["batch_ms"] = entry.batchTime * 1000.0;
+            device["output_overflows"] = entry.health.outputOverflows;
+        }
+        if (entry.timeline.kernel.count > 0) {
+            addTimeline(device, entry.timeline);
+        }
 
-        // Add GPU monitoring data if available
-        GpuStats gpuStats;
-        if (dev.type == MinerType::CUDA) {
-            gpuStats = GpuMonitor::instance().getNvidiaStats(dev.cudaDeviceIndex);
-        } else if (dev.type == MinerType::OpenCL) {
-            gpuStats = GpuMonitor::instance().getAmdStats(dev.clDeviceIndex);
+        // Integrity sampling: estimated share of counted hashes that are real
+        const DeviceHealth& health = entry.health;
+        if (health.integrityChecked > 0) {
+            double ratio = health.getIntegrityRatio();
+            device["integrity"] = {
+                {"checked", health.integrityChecked},
+                {"failed", health.integrityFailed},
+                {"hits", health.integrityHits},
+                {"expected_hits", health.integrityExpected},
+                {"ratio", ratio},
+                {"verified_hashrate", hr.effectiveRate() * ratio}
+            };
         }
 
+        // Add GPU monitoring data if available
+        const GpuStats& gpuStats = entry.gpu;
         if (gpuStats.valid) {
             if (gpuStats.temperature >= 0) {
                 device["temperature"] = gpuStats.temperature;
@@ -267,18 +1056,28 @@ json ApiServer::getDevices() {
             }
         }
 
+        // CPU threads share the package sensors
+        const CpuStats& cpu = snapshot.cpu;
+        if (dev.type == MinerType::CPU && cpu.valid) {
+            if (cpu.temperature >= 0) {
+                device["temperature"] = cpu.temperature;
+            }
+            if (cpu.frequency >= 0) {
+                device["clock_core"] = cpu.frequency;
+            }
+        }
+
         devices.push_back(device);
     }
 
     return devices;
 }
 
-json ApiServer::getHealth() {
+json ApiServer::getHealth(const TelemetrySnapshot& snapshot) {
     json health;
     health["overall"] = "healthy";  // Will be downgraded if any device is unhealthy
 
     json devices = json::array();
-    auto descriptors = m_farm.getDevices();
 
     bool anyUnhealthy = false;
     bool anyDegraded = false;
@@ -288,8 +1087,9 @@ json ApiServer::getHealth() {
     constexpr int TEMP_WARNING = 80;   // Start warning
     constexpr int TEMP_CRITICAL = 90;  // Critical temperature
 
-    for (size_t i = 0; i < descriptors.size(); i++) {
-        const auto& dev = descriptors[i];
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        const auto& entry = snapshot.devices[i];
+        const auto& dev = entry.device;
 
         json device;
         device["index"] = dev.index;
@@ -297,19 +1097,63 @@ json ApiServer::getHealth() {
 
         std::string status = "healthy";
 
-        if (m_farm.isMinerFailed(static_cast<unsigned>(i))) {
+        if (entry.failed) {
             status = "failed";
             anyUnhealthy = true;
         }
+        if (entry.parked) {
+            device["parked"] = true;
+        }
+        for (const auto& recovery : snapshot.recovery.devices) {
+            if (recovery.index == i && entry.failed) {
+                device["recovery"] = recovery.gaveUp ? "gave_up" : "pending";
+                device["recovery_attempts"] = recovery.attempts;
+                if (!recovery.gaveUp) {
+                    device["recovery_next_attempt"] = recovery.nextAttempt;
+                }
+            }
+        }
 
-        // Check GPU temperature
-        GpuStats gpuStats;
-        if (dev.type == MinerType::CUDA) {
-            gpuStats = GpuMonitor::instance().getNvidiaStats(dev.cudaDeviceIndex);
-        } else if (dev.type == MinerType::OpenCL) {
-            gpuStats = GpuMonitor::instance().getAmdStats(dev.clDeviceIndex);
+        // CPU verification of solutions and integrity samples
+        const DeviceHealth& h = entry.health;
+        if (h.integrityChecked > 0) {
+            device["integrity_checked"] = h.integrityChecked;
+            device["integrity_failed"] = h.integrityFailed;
+            device["integrity_ratio"] = h.getIntegrityRatio();
+        }
+        if (h.status == HealthStatus::Unhealthy || h.status == HealthStatus::Failed) {
+            if (status == "healthy") status = "unhealthy";
+            anyUnhealthy = true;
+        } else if (h.status == HealthStatus::Degraded) {
+            if (status == "healthy") status = "degraded";
+            anyDegraded = true;
+        }
+
+        // Rolling-window hash rate anomalies
+        const DeviceAnomaly& anomaly = entry.anomaly;
+        device["anomaly"] = DeviceAnomaly::name(anomaly.kind);
+        if (anomaly.kind != AnomalyKind::None) {
+            device["anomaly_reasons"] = anomaly.reasons;
+            device["anomaly_ticks"] = anomaly.ticks;
+            if (anomaly.kind == AnomalyKind::Stalled) {
+                if (status == "healthy") status = "stalled";
+                anyUnhealthy = true;
+            } else {
+                if (status == "healthy") status = DeviceAnomaly::name(anomaly.kind);
+                anyDegraded = true;
+            }
+        }
+        if (anomaly.baselineRate > 0) {
+            device["baseline_hashrate"] = anomaly.baselineRate;
+            device["recent_hashrate"] = anomaly.recentRate;
+        }
+        if (anomaly.peerRate > 0) {
+            device["peer_hashrate"] = anomaly.peerRate;
         }
 
+        // Check GPU temperature
+        const GpuStats& gpuStats = entry.gpu;
+
         if (gpuStats.valid && gpuStats.temperature >= 0) {
             device["temperature"] = gpuStats.temperature;
 
@@ -343,26 +1187,208 @@ json ApiServer::getHealth() {
     }
 
     health["devices"] = devices;
-    health["active_miners"] = m_farm.activeMinerCount();
-    health["total_miners"] = m_farm.minerCount();
+    health["active_miners"] = snapshot.activeMinerCount;
+    health["total_miners"] = snapshot.minerCount;
+
+    // Failed-device recovery attempts, most recent first
+    json history = json::array();
+    for (const auto& event : snapshot.recovery.history) {
+        history.push_back({
+            {"index", event.index},
+            {"device", event.device},
+            {"attempt", event.attempt},
+            {"success", event.success},
+            {"seconds_ago", event.age}
+        });
+    }
+    health["recovery"] = {
+        {"recoveries", snapshot.recovery.recoveries},
+        {"failures", snapshot.recovery.failures},
+        {"history", history}
+    };
 
     return health;
 }
 
-std::string ApiServer::createResponse(int status, const std::string& body) {
+std::string ApiServer::getMetrics(const TelemetrySnapshot& snapshot) {
+    MetricsWriter m;
+
+    m.family("tosminer_info", "Miner build information", "gauge");
+    m.sample("tosminer_info", "version=\"" + escapeLabel(VERSION_STRING) + "\"", 1);
+
+    m.family("tosminer_uptime_seconds", "Seconds since mining started", "gauge");
+    m.sample("tosminer_uptime_seconds", "", snapshot.hashRate.duration);
+
+    m.family("tosminer_hashrate_hs", "Total hash rate in hashes per second", "gauge");
+    m.sample("tosminer_hashrate_hs", "", snapshot.hashRate.effectiveRate());
+
+    m.family("tosminer_miners", "Number of miners by state", "gauge");
+    m.sample("tosminer_miners", "state=\"total\"", static_cast<double>(snapshot.minerCount));
+    m.sample("tosminer_miners", "state=\"active\"", static_cast<double>(snapshot.activeMinerCount));
+
+    m.family("tosminer_shares_total", "Shares submitted to the pool by result", "counter");
+    m.sample("tosminer_shares_total", "result=\"accepted\"", static_cast<double>(snapshot.stats.acceptedShares));
+    m.sample("tosminer_shares_total", "result=\"rejected\"", static_cast<double>(snapshot.stats.rejectedShares));
+    m.sample("tosminer_shares_total", "result=\"stale\"", static_cast<double>(snapshot.stats.staleShares));
+
+    m.family("tosminer_recovery_attempts_total", "Failed-device recovery attempts by result", "counter");
+    m.sample("tosminer_recovery_attempts_total", "result=\"success\"", static_cast<double>(snapshot.recovery.recoveries));
+    m.sample("tosminer_recovery_attempts_total", "result=\"failure\"", static_cast<double>(snapshot.recovery.failures));
+
+    m.family("tosminer_pool_connected", "1 if connected to the pool", "gauge");
+    m.sample("tosminer_pool_connected", "", snapshot.pool.connected ? 1 : 0);
+
+    m.family("tosminer_pool_authorized", "1 if authorized with the pool", "gauge");
+    m.sample("tosminer_pool_authorized", "", snapshot.pool.authorized ? 1 : 0);
+
+    m.family("tosminer_pool_difficulty", "Current stratum share difficulty", "gauge");
+    m.sample("tosminer_pool_difficulty", "", snapshot.pool.difficulty);
+
+    m.family("tosminer_share_submit_seconds", "Share submit round-trip time", "histogram");
+    m.histogram("tosminer_share_submit_seconds", "", snapshot.pool.submitLatency);
+
+    // CPU package sensors
+    const CpuStats& cpu = snapshot.cpu;
+    if (cpu.valid && cpu.packagePower >= 0) {
+        m.family("tosminer_cpu_power_watts", "CPU package power (RAPL, all packages)", "gauge");
+        m.sample("tosminer_cpu_power_watts", "", cpu.packagePower);
+        m.family("tosminer_cpu_energy_joules_total", "CPU package energy since start", "counter");
+        m.sample("tosminer_cpu_energy_joules_total", "", cpu.energy);
+        m.family("tosminer_cpu_hashes_per_watt", "CPU miner hash rate per package watt", "gauge");
+        m.sample("tosminer_cpu_hashes_per_watt", "", snapshot.cpuHashesPerWatt);
+    }
+    if (cpu.valid && cpu.temperature >= 0) {
+        m.family("tosminer_cpu_temperature_celsius", "Hottest CPU thermal zone", "gauge");
+        m.sample("tosminer_cpu_temperature_celsius", "", cpu.temperature);
+    }
+    if (cpu.valid && cpu.frequency >= 0) {
+        m.family("tosminer_cpu_frequency_mhz", "Average CPU core frequency", "gauge");
+        m.sample("tosminer_cpu_frequency_mhz", "", cpu.frequency);
+    }
+
+    // Per-device series
+    std::vector<std::string> labels;
+    for (const auto& entry : snapshot.devices) {
+        const auto& dev = entry.device;
+        std::string type = dev.type == MinerType::CPU ? "CPU" :
+                           dev.type == MinerType::OpenCL ? "OpenCL" : "CUDA";
+        labels.push_back("device=\"" + std::to_string(dev.index) + "\",type=\"" + type +
+                         "\",name=\"" + escapeLabel(dev.name) + "\"");
+    }
+
+    auto perDevice = [&](const char* name, const char* help, const char* type,
+                         const std::function<bool(const DeviceTelemetry&, double&)>& value) {
+        bool header = false;
+        for (size_t i = 0; i < snapshot.devices.size(); i++) {
+            double v = 0;
+            if (!value(snapshot.devices[i], v)) {
+                continue;
+            }
+            if (!header) {
+                m.family(name, help, type);
+                header = true;
+            }
+            m.sample(name, labels[i], v);
+        }
+    };
+
+    perDevice("tosminer_device_hashrate_hs", "Device instantaneous hash rate", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.hashRate.rate; return true; });
+    perDevice("tosminer_device_hashrate_ema_hs", "Device EMA-smoothed hash rate", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.hashRate.emaRate; return true; });
+    perDevice("tosminer_device_hashes_total", "Hashes computed by the device", "counter",
+        [](const DeviceTelemetry& d, double& v) { v = static_cast<double>(d.hashRate.count); return true; });
+    perDevice("tosminer_device_failed", "1 if the device is isolated as failed", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.failed ? 1 : 0; return true; });
+    perDevice("tosminer_device_intensity_percent", "Device intensity set by the power governor", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.intensity; return true; });
+    perDevice("tosminer_device_batch_nonces", "Nonces in the device's last GPU batch", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = static_cast<double>(d.batchSize); return d.batchSize > 0; });
+    perDevice("tosminer_device_parked", "1 if the device is parked by the host load governor", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.parked ? 1 : 0; return true; });
+    perDevice("tosminer_device_hardware_errors_total", "Device/kernel errors", "counter",
+        [](const DeviceTelemetry& d, double& v) { v = static_cast<double>(d.health.hardwareErrors); return true; });
+    perDevice("tosminer_device_output_overflows_total", "GPU batches with more solutions than output slots", "counter",
+        [](const DeviceTelemetry& d, double& v) {
+            v = static_cast<double>(d.health.outputOverflows);
+            return d.device.type != MinerType::CPU;
+        });
+
+    m.family("tosminer_device_solutions_total", "Device solutions by CPU verification result", "counter");
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        const auto& h = snapshot.devices[i].health;
+        m.sample("tosminer_device_solutions_total", labels[i] + ",result=\"valid\"", static_cast<double>(h.validSolutions));
+        m.sample("tosminer_device_solutions_total", labels[i] + ",result=\"invalid\"", static_cast<double>(h.invalidSolutions));
+        m.sample("tosminer_device_solutions_total", labels[i] + ",result=\"duplicate\"", static_cast<double>(h.duplicateSolutions));
+    }
+
+    m.family("tosminer_device_integrity_checks_total", "Easy-target hits re-hashed on the CPU by result", "counter");
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        const auto& h = snapshot.devices[i].health;
+        m.sample("tosminer_device_integrity_checks_total", labels[i] + ",result=\"pass\"",
+                 static_cast<double>(h.integrityChecked - h.integrityFailed));
+        m.sample("tosminer_device_integrity_checks_total", labels[i] + ",result=\"fail\"",
+                 static_cast<double>(h.integrityFailed));
+    }
+    perDevice("tosminer_device_integrity_ratio", "Estimated share of counted hashes computed correctly", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.health.getIntegrityRatio(); return d.health.integrityChecked > 0; });
+
+    perDevice("tosminer_device_temperature_celsius", "GPU core temperature", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.gpu.temperature; return d.gpu.valid && d.gpu.temperature >= 0; });
+    perDevice("tosminer_device_power_watts", "GPU power draw", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.gpu.powerUsage; return d.gpu.valid && d.gpu.powerUsage >= 0; });
+    perDevice("tosminer_device_fan_percent", "GPU fan speed", "gauge",
+        [](const DeviceTelemetry& d, double& v) { v = d.gpu.fanSpeed; return d.gpu.valid && d.gpu.fanSpeed >= 0; });
+
+    m.family("tosminer_device_job_switch_seconds", "Time from new job to the device mining it", "histogram");
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        m.histogram("tosminer_device_job_switch_seconds", labels[i], snapshot.devices[i].jobSwitchLatency);
+    }
+
+    // Device timelines, only for profiled devices
+    using TimelineField = HistogramSnapshot TimelineStats::*;
+    auto timeline = [&](const char* name, const char* help, TimelineField field) {
+        m.family(name, help, "histogram");
+        for (size_t i = 0; i < snapshot.devices.size(); i++) {
+            const TimelineStats& t = snapshot.devices[i].timeline;
+            if (t.kernel.count > 0) {
+                m.histogram(name, labels[i], t.*field);
+            }
+        }
+    };
+    timeline("tosminer_device_kernel_seconds", "Device kernel execution time per batch", &TimelineStats::kernel);
+    timeline("tosminer_device_transfer_seconds", "Device result readback time per batch", &TimelineStats::transfer);
+    timeline("tosminer_device_idle_seconds", "Device idle time between batch kernels", &TimelineStats::idle);
+
+    return m.str();
+}
+
+std::string ApiServer::createResponse(int status, const std::string& body, bool keepAlive,
+                                     const std::string& etag, const std::string& contentType) {
     std::string statusText;
     switch (status) {
         case 200: statusText = "OK"; break;
+        case 304: statusText = "Not Modified"; break;
+        case 400: statusText = "Bad Request"; break;
         case 404: statusText = "Not Found"; break;
         case 405: statusText = "Method Not Allowed"; break;
+        case 431: statusText = "Request Header Fields Too Large"; break;
+        case 503: statusText = "Service Unavailable"; break;
         default: statusText = "Error"; break;
     }
 
     std::ostringstream response;
     response << "HTTP/1.1 " << status << " " << statusText << "\r\n";
-    response << "Content-Type: application/json\r\n";
+    response << "Content-Type: " << contentType << "\r\n";
     response << "Content-Length: " << body.length() << "\r\n";
-    response << "Connection: close\r\n";
+    if (!etag.empty()) {
+        response << "ETag: " << etag << "\r\n";
+        response << "Cache-Control: no-cache\r\n";
+    }
+    response << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n";
+    if (keepAlive) {
+        response << "Keep-Alive: timeout=" << IDLE_TIMEOUT << "\r\n";
+    }
     response << "Access-Control-Allow-Origin: *\r\n";
     response << "\r\n";
     response << body;
@@ -6,27 +6,64 @@
 
 #pragma once
 
-#include "core/Farm.h"
-#include "stratum/StratumClient.h"
+#include "core/Telemetry.h"
 #include <boost/asio.hpp>
 #include <nlohmann/json.hpp>
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <set>
 #include <thread>
 #include <memory>
 #include <string>
+#include <unordered_set>
 
 namespace tos {
 
 using json = nlohmann::json;
 
+class ApiSession;
+
+/**
+ * Parsed HTTP request head
+ */
+struct HttpRequest {
+    std::string method;
+    std::string path;       // Path without query string
+    std::string query;      // Raw query string (after '?')
+    std::string version;    // e.g. "HTTP/1.1"
+    std::map<std::string, std::string> headers;  // Lower-case names
+    bool keepAlive{false};
+
+    /**
+     * Get header value (name must be lower-case)
+     */
+    std::string header(const std::string& name) const {
+        auto it = headers.find(name);
+        return it != headers.end() ? it->second : std::string();
+    }
+};
+
 /**
  * Simple JSON-RPC API Server
  *
+ * Event-driven HTTP/1.1 server running on a single IO thread. Connections
+ * are kept alive and may pipeline requests; each connection has idle and
+ * request timeouts and the total number of connections is capped.
+ *
+ * Response bodies are rendered once per telemetry tick into an immutable
+ * set of buffers that is swapped atomically; handlers only copy bytes out
+ * and answer If-None-Match with 304 when the ETag is unchanged.
+ *
  * Provides HTTP endpoints for monitoring:
  * - GET /           - Basic status
  * - GET /stats      - Mining statistics
  * - GET /devices    - Device information
  * - GET /health     - Device health status
+ * - GET /metrics    - Prometheus text exposition
+ * - GET /events     - Server-sent event stream (stat deltas, job/share/health events)
+ * - GET /history    - Hash rate history (?device=N&res=1m)
+ * - GET /trace      - Profiled OpenCL batches as a Chrome trace (?device=N)
  */
 class ApiServer {
 public:
@@ -34,10 +71,9 @@ public:
      * Constructor
      *
      * @param port Port to listen on
-     * @param farm Reference to mining farm
-     * @param stratum Reference to stratum client
+     * @param telemetry Telemetry sampler providing miner state
      */
-    ApiServer(unsigned port, Farm& farm, StratumClient& stratum);
+    ApiServer(unsigned port, Telemetry& telemetry);
 
     /**
      * Destructor
@@ -70,56 +106,175 @@ public:
      */
     unsigned getPort() const { return m_port; }
 
+    /**
+     * Push an event to all /events subscribers immediately (thread-safe)
+     *
+     * The frame is serialized once and shared by every subscriber.
+     *
+     * @param type Event name (e.g. "job", "share", "health")
+     * @param data Event payload
+     */
+    void publishEvent(const std::string& type, const json& data);
+
+    /**
+     * Set interval for stat delta events in milliseconds (default 1000)
+     */
+    static void setEventInterval(unsigned ms) { s_eventIntervalMs = ms > 0 ? ms : 1000; }
+
+    /**
+     * Get interval for stat delta events in milliseconds
+     */
+    static unsigned getEventInterval() { return s_eventIntervalMs; }
+
+    /**
+     * Parse an HTTP request head (request line + headers)
+     *
+     * @return false if the request line is malformed
+     */
+    static bool parseRequest(const std::string& head, HttpRequest& request);
+
+    // Connection limits
+    static constexpr size_t MAX_CONNECTIONS = 64;
+    static constexpr size_t MAX_REQUEST_SIZE = 8192;     // Request head size limit
+    static constexpr size_t MAX_PIPELINED = 16;          // Requests answered per write
+    static constexpr unsigned REQUEST_TIMEOUT = 5;       // Seconds to receive a request head from its first byte
+    static constexpr unsigned IDLE_TIMEOUT = 30;         // Seconds a keep-alive connection may idle
+
+    // Event stream limits
+    static constexpr size_t MAX_QUEUED_EVENTS = 64;      // Frames queued per subscriber before dropping it
+    static constexpr unsigned EVENT_HEARTBEAT = 15;      // Seconds between keep-alive comments
+
 private:
+    friend class ApiSession;
+
+    /**
+     * Post next asynchronous accept
+     */
+    void doAccept();
+
+    /**
+     * Route a request and return the full HTTP response
+     */
+    std::string handleRequest(const HttpRequest& request);
+
+    /**
+     * Schedule the next stat delta event (IO thread)
+     */
+    void scheduleStatsEvent();
+
+    /**
+     * Send changed stats to subscribers, or a heartbeat if nothing changed (IO thread)
+     */
+    void sendStatsEvent();
+
+    /**
+     * Send the full current state to a new subscriber (IO thread)
+     */
+    void onSubscribe(ApiSession& session);
+
+    /**
+     * Queue a frame on every subscriber (IO thread)
+     */
+    void broadcast(const std::shared_ptr<const std::string>& frame);
+
+    /**
+     * Serialize an event frame
+     */
+    std::shared_ptr<const std::string> makeFrame(const std::string& type, const json& data);
+
+    /**
+     * Get compact state used for stat delta events
+     */
+    static json getEventState(const TelemetrySnapshot& snapshot);
+
     /**
-     * Accept loop
+     * Response head that starts an event stream
      */
-    void acceptLoop();
+    static std::string createStreamResponse();
 
     /**
-     * Handle a client connection
+     * Get hash rate history response for ?device=N&res=1m
      */
-    void handleClient(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
+    std::string getHistory(const HttpRequest& request);
 
     /**
-     * Parse HTTP request and return response
+     * Get recent profiled batches as a Chrome trace for ?device=N (all if omitted)
      */
-    std::string handleRequest(const std::string& request);
+    std::string getTrace(const HttpRequest& request);
+
+    /**
+     * Render all endpoint bodies from a snapshot and publish them
+     * (called on the telemetry thread)
+     */
+    void render(const TelemetrySnapshot& snapshot);
 
     /**
      * Get basic status JSON
      */
-    json getStatus();
+    static json getStatus(const TelemetrySnapshot& snapshot);
 
     /**
      * Get mining statistics JSON
      */
-    json getStats();
+    static json getStats(const TelemetrySnapshot& snapshot);
 
     /**
      * Get device information JSON
      */
-    json getDevices();
+    static json getDevices(const TelemetrySnapshot& snapshot);
 
     /**
      * Get device health JSON
      */
-    json getHealth();
+    static json getHealth(const TelemetrySnapshot& snapshot);
+
+    /**
+     * Get Prometheus metrics (text exposition format 0.0.4)
+     */
+    static std::string getMetrics(const TelemetrySnapshot& snapshot);
 
     /**
      * Create HTTP response
      */
-    std::string createResponse(int status, const std::string& body);
+    std::string createResponse(int status, const std::string& body, bool keepAlive,
+                               const std::string& etag = std::string(),
+                               const std::string& contentType = "application/json");
 
 private:
     unsigned m_port;
-    Farm& m_farm;
-    StratumClient& m_stratum;
+    Telemetry& m_telemetry;
+    unsigned m_listenerId{0};
+
+    // Pre-rendered endpoint bodies, replaced as a whole every tick
+    struct RenderedBody {
+        std::string body;
+        std::string etag;
+        std::string contentType;
+    };
+    using RenderedBodies = std::map<std::string, RenderedBody>;
+    std::shared_ptr<const RenderedBodies> m_rendered;
+
+    // Last health state pushed as an event (telemetry thread only)
+    std::string m_lastHealthKey;
+
+    // Event stream state (IO thread only)
+    json m_eventState;
+    std::chrono::steady_clock::time_point m_lastEventFrame;
+    std::atomic<uint64_t> m_eventId{0};
+
+    // Open sessions (IO thread only; declared before m_io so it outlives pending handlers)
+    std::unordered_set<ApiSession*> m_sessions;
+
+    // Event stream subscribers (IO thread only; owned here, destroyed before m_sessions)
+    std::set<std::shared_ptr<ApiSession>> m_subscribers;
 
     boost::asio::io_context m_io;
     std::unique_ptr<boost::asio::ip::tcp::acceptor> m_acceptor;
+    std::unique_ptr<boost::asio::steady_timer> m_eventTimer;
     std::thread m_thread;
     std::atomic<bool> m_running{false};
+
+    static inline unsigned s_eventIntervalMs = 1000;
 };
 
 }  // namespace tos
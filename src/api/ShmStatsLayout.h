@@ -0,0 +1,210 @@
+/**
+ * TOS Miner - Shared Memory Stats Layout
+ *
+ * Layout of the stats block tosminer publishes to a memory-mapped file
+ * (default /dev/shm/tosminer.stats) once per telemetry tick. Readers map
+ * the file read-only and copy the block under the sequence lock with
+ * shmStatsRead(), or the equivalent in another language:
+ *
+ *   do {
+ *       s1 = load(block->seq);               // then acquire fence
+ *       if (s1 & 1) continue;                // writer active
+ *       memcpy(&copy, block, sizeof(copy));
+ *       atomic_thread_fence(acquire);
+ *       s2 = load(block->seq);
+ *   } while (s1 != s2 || (s1 & 1));
+ *
+ * The layout is versioned: readers must check magic, version and size
+ * before using the data. Fields are only ever appended within a version.
+ * All integers are host byte order; strings are NUL-terminated.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace tos {
+
+constexpr uint32_t SHM_STATS_MAGIC = 0x4D534F54;   // "TOSM" (little-endian)
+constexpr uint32_t SHM_STATS_VERSION = 2;
+constexpr uint32_t SHM_STATS_MAX_DEVICES = 32;
+constexpr uint32_t SHM_STATS_NAME_LEN = 64;
+constexpr const char* SHM_STATS_DEFAULT_PATH = "/dev/shm/tosminer.stats";
+
+/**
+ * Device type (matches MinerType)
+ */
+enum ShmDeviceType : uint32_t {
+    SHM_DEVICE_CPU = 0,
+    SHM_DEVICE_OPENCL = 1,
+    SHM_DEVICE_CUDA = 2
+};
+
+/**
+ * Per-device stats
+ *
+ * Sensor fields are -1 when unavailable.
+ */
+struct ShmDeviceStats {
+    uint32_t index;                 // Device index within its backend
+    uint32_t type;                  // ShmDeviceType
+    char name[SHM_STATS_NAME_LEN];
+
+    // Hash rate (H/s)
+    double hashrate;                // Instantaneous (lifetime average)
+    double hashrateEma;             // 30 s EMA
+    double hashrate10s;
+    double hashrate1m;
+    double hashrate15m;
+    uint64_t hashes;                // Total hashes computed
+
+    // Health
+    uint32_t failed;                // 1 if isolated from work distribution
+    uint32_t health;                // 0 healthy, 1 degraded, 2 unhealthy, 3 failed
+    uint64_t validSolutions;
+    uint64_t invalidSolutions;
+    uint64_t duplicateSolutions;
+    uint64_t hardwareErrors;
+
+    // GPU sensors
+    int32_t temperature;            // Celsius
+    int32_t fanSpeed;               // Percent
+    int32_t powerUsage;             // Watts
+    int32_t clockCore;              // MHz
+};
+
+/**
+ * Pool state
+ */
+struct ShmPoolStats {
+    uint32_t connected;
+    uint32_t authorized;
+    double difficulty;
+    uint64_t accepted;
+    uint64_t rejected;
+};
+
+/**
+ * Complete stats block (file contents)
+ */
+struct ShmStatsBlock {
+    // Header: fixed for all versions
+    uint32_t magic;                 // SHM_STATS_MAGIC
+    uint32_t version;               // SHM_STATS_VERSION
+    uint32_t size;                  // sizeof(ShmStatsBlock) written by the miner
+    uint32_t pid;                   // Publishing process
+    uint32_t seq;                   // Sequence lock: odd while an update is in progress
+    uint32_t deviceCount;
+    uint64_t sequence;              // Telemetry snapshot sequence number
+    uint64_t updatedMs;             // Wall clock of last update (ms since epoch)
+    uint32_t running;               // 0 once the miner has shut down
+    uint32_t paused;
+    uint32_t truncatedDevices;      // Devices left out beyond SHM_STATS_MAX_DEVICES
+    uint32_t reserved;
+
+    // Farm totals
+    double hashrate;
+    double hashrate10s;
+    double hashrate1m;
+    double hashrate15m;
+    uint64_t hashes;
+    uint64_t acceptedShares;
+    uint64_t rejectedShares;
+    uint64_t staleShares;
+    uint32_t minerCount;
+    uint32_t activeMinerCount;
+
+    ShmPoolStats pool;
+
+    ShmDeviceStats devices[SHM_STATS_MAX_DEVICES];
+};
+
+static_assert(std::is_standard_layout<ShmStatsBlock>::value,
+              "Shared memory block must be standard layout");
+static_assert(sizeof(uint32_t) == 4 && alignof(uint32_t) == 4,
+              "Sequence word must be naturally aligned for atomic access");
+
+/**
+ * Sequence word access
+ *
+ * seq is a plain uint32_t so the layout has no std::atomic in it (its
+ * representation is not specified across compilers or languages). It is
+ * only ever read and written whole with these relaxed atomic accesses;
+ * ordering against the data comes from the fences in the functions below.
+ */
+inline uint32_t shmLoadSeq(const uint32_t& seq) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&seq, __ATOMIC_RELAXED);
+#else
+    return *static_cast<const volatile uint32_t*>(&seq);
+#endif
+}
+
+inline void shmStoreSeq(uint32_t& seq, uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&seq, value, __ATOMIC_RELAXED);
+#else
+    *static_cast<volatile uint32_t*>(&seq) = value;
+#endif
+}
+
+/**
+ * Begin an update: make the sequence odd
+ *
+ * The release fence keeps the data stores that follow from becoming
+ * visible before the odd sequence.
+ *
+ * @return Sequence to pass to shmStatsEndWrite()
+ */
+inline uint32_t shmStatsBeginWrite(ShmStatsBlock* block) {
+    uint32_t seq = shmLoadSeq(block->seq);
+    shmStoreSeq(block->seq, seq + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+    return seq;
+}
+
+/**
+ * End an update: make the sequence even again
+ *
+ * The release fence keeps the data stores before it from becoming
+ * visible after the new sequence.
+ */
+inline void shmStatsEndWrite(ShmStatsBlock* block, uint32_t seq) {
+    std::atomic_thread_fence(std::memory_order_release);
+    shmStoreSeq(block->seq, seq + 2);
+}
+
+/**
+ * Copy the block under the sequence lock
+ *
+ * The acquire fence after the first load keeps the copy from being read
+ * before it; the one after the copy keeps the second load from being
+ * read before the copy. Equal even sequences mean no update overlapped.
+ *
+ * @param attempts Copies to try before giving up
+ * @return false if no consistent copy could be taken
+ */
+inline bool shmStatsRead(const ShmStatsBlock* block, ShmStatsBlock& copy, int attempts = 1000) {
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        uint32_t s1 = shmLoadSeq(block->seq);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s1 & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::memcpy(static_cast<void*>(&copy), static_cast<const void*>(block), sizeof(copy));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (shmLoadSeq(block->seq) == s1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace tos
@@ -0,0 +1,230 @@
+/**
+ * TOS Miner - Shared Memory Stats Publisher Implementation
+ */
+
+#include "ShmStatsPublisher.h"
+#include "util/Log.h"
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tos {
+
+ShmStatsPublisher::ShmStatsPublisher(const std::string& path, Telemetry& telemetry)
+    : m_path(path)
+    , m_telemetry(telemetry)
+{
+}
+
+ShmStatsPublisher::~ShmStatsPublisher() {
+    stop();
+}
+
+bool ShmStatsPublisher::start() {
+#ifdef _WIN32
+    Log::warning("Shared memory stats are not supported on this platform");
+    return false;
+#else
+    if (m_block) {
+        return true;
+    }
+
+    // Always a new file: never follow a symlink or reuse a file someone
+    // else created at the path
+    m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0644);
+    if (m_fd < 0 && errno == EEXIST && removeStale()) {
+        m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0644);
+    }
+    if (m_fd < 0) {
+        Log::error("Failed to create shared stats file " + m_path + ": " + std::strerror(errno));
+        return false;
+    }
+
+    if (::ftruncate(m_fd, sizeof(ShmStatsBlock)) != 0) {
+        Log::error("Failed to size shared stats file " + m_path + ": " + std::strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        ::unlink(m_path.c_str());
+        return false;
+    }
+
+    void* addr = ::mmap(nullptr, sizeof(ShmStatsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (addr == MAP_FAILED) {
+        Log::error("Failed to map shared stats file " + m_path + ": " + std::strerror(errno));
+        ::close(m_fd);
+        m_fd = -1;
+        ::unlink(m_path.c_str());
+        return false;
+    }
+
+    // Zero the block, then write the header; magic last so readers never
+    // see a valid magic over a half-initialized block
+    std::memset(addr, 0, sizeof(ShmStatsBlock));
+    m_block = new (addr) ShmStatsBlock();
+    m_block->version = SHM_STATS_VERSION;
+    m_block->size = sizeof(ShmStatsBlock);
+    m_block->pid = static_cast<uint32_t>(::getpid());
+    std::atomic_thread_fence(std::memory_order_release);
+    m_block->magic = SHM_STATS_MAGIC;
+    m_truncationLogged = false;
+
+    if (auto snapshot = m_telemetry.latest()) {
+        publish(*snapshot);
+    }
+    m_listenerId = m_telemetry.addListener([this](const TelemetrySnapshotPtr& snapshot) {
+        publish(*snapshot);
+    });
+
+    Log::info("Publishing shared stats to " + m_path);
+    return true;
+#endif
+}
+
+void ShmStatsPublisher::stop() {
+#ifndef _WIN32
+    if (!m_block) {
+        return;
+    }
+
+    m_telemetry.removeListener(m_listenerId);
+    m_listenerId = 0;
+
+    // Tell readers still holding the mapping that the data is final
+    uint32_t seq = shmStatsBeginWrite(m_block);
+    m_block->running = 0;
+    shmStatsEndWrite(m_block, seq);
+
+    ::munmap(m_block, sizeof(ShmStatsBlock));
+    m_block = nullptr;
+    ::close(m_fd);
+    m_fd = -1;
+    ::unlink(m_path.c_str());
+#endif
+}
+
+void ShmStatsPublisher::publish(const TelemetrySnapshot& snapshot) {
+    ShmStatsBlock* b = m_block;
+    if (!b) {
+        return;
+    }
+
+    uint32_t total = static_cast<uint32_t>(snapshot.devices.size());
+    if (total > SHM_STATS_MAX_DEVICES && !m_truncationLogged) {
+        Log::warning("Shared stats hold " + std::to_string(SHM_STATS_MAX_DEVICES) + " of " +
+                     std::to_string(total) + " devices, the rest are left out");
+        m_truncationLogged = true;
+    }
+
+    // Sequence lock: odd while writing
+    uint32_t seq = shmStatsBeginWrite(b);
+
+    b->sequence = snapshot.sequence;
+    b->updatedMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    b->running = snapshot.running ? 1 : 0;
+    b->paused = snapshot.paused ? 1 : 0;
+
+    b->hashrate = snapshot.hashRate.effectiveRate();
+    b->hashrate10s = snapshot.windows.s10;
+    b->hashrate1m = snapshot.windows.m1;
+    b->hashrate15m = snapshot.windows.m15;
+    b->hashes = snapshot.hashRate.count;
+    b->acceptedShares = snapshot.stats.acceptedShares;
+    b->rejectedShares = snapshot.stats.rejectedShares;
+    b->staleShares = snapshot.stats.staleShares;
+    b->minerCount = static_cast<uint32_t>(snapshot.minerCount);
+    b->activeMinerCount = static_cast<uint32_t>(snapshot.activeMinerCount);
+
+    b->pool.connected = snapshot.pool.connected ? 1 : 0;
+    b->pool.authorized = snapshot.pool.authorized ? 1 : 0;
+    b->pool.difficulty = snapshot.pool.difficulty;
+    b->pool.accepted = snapshot.pool.accepted;
+    b->pool.rejected = snapshot.pool.rejected;
+
+    uint32_t count = 0;
+    for (const auto& entry : snapshot.devices) {
+        if (count >= SHM_STATS_MAX_DEVICES) {
+            break;
+        }
+
+        ShmDeviceStats& d = b->devices[count++];
+        d.index = entry.device.index;
+        d.type = entry.device.type == MinerType::CPU ? SHM_DEVICE_CPU :
+                 entry.device.type == MinerType::OpenCL ? SHM_DEVICE_OPENCL : SHM_DEVICE_CUDA;
+        std::memset(d.name, 0, sizeof(d.name));
+        std::strncpy(d.name, entry.device.name.c_str(), sizeof(d.name) - 1);
+
+        d.hashrate = entry.hashRate.rate;
+        d.hashrateEma = entry.hashRate.emaRate;
+        d.hashrate10s = entry.windows.s10;
+        d.hashrate1m = entry.windows.m1;
+        d.hashrate15m = entry.windows.m15;
+        d.hashes = entry.hashRate.count;
+
+        d.failed = entry.failed ? 1 : 0;
+        d.health = static_cast<uint32_t>(entry.health.status);
+        d.validSolutions = entry.health.validSolutions;
+        d.invalidSolutions = entry.health.invalidSolutions;
+        d.duplicateSolutions = entry.health.duplicateSolutions;
+        d.hardwareErrors = entry.health.hardwareErrors;
+
+        bool gpu = entry.gpu.valid;
+        d.temperature = gpu ? entry.gpu.temperature : -1;
+        d.fanSpeed = gpu ? entry.gpu.fanSpeed : -1;
+        d.powerUsage = gpu ? entry.gpu.powerUsage : -1;
+        d.clockCore = gpu ? entry.gpu.clockCore : -1;
+    }
+    b->deviceCount = count;
+    b->truncatedDevices = total - count;
+
+    shmStatsEndWrite(b, seq);
+}
+
+bool ShmStatsPublisher::removeStale() {
+#ifdef _WIN32
+    return false;
+#else
+    // Left behind by a miner that didn't shut down cleanly: only a regular
+    // file of ours that no live process is publishing to is removed
+    int fd = ::open(m_path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    bool ours = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == ::geteuid();
+    ShmStatsBlock header;
+    std::memset(&header, 0, sizeof(header));
+    ssize_t got = ours ? ::pread(fd, &header, offsetof(ShmStatsBlock, deviceCount), 0) : -1;
+    ::close(fd);
+
+    if (!ours) {
+        Log::error("Shared stats path " + m_path + " exists and is not a stats file of this user");
+        return false;
+    }
+    bool stats = got == static_cast<ssize_t>(offsetof(ShmStatsBlock, deviceCount)) &&
+                 header.magic == SHM_STATS_MAGIC;
+    if (!stats && st.st_size != 0) {
+        Log::error("Shared stats path " + m_path + " exists and is not a stats file");
+        return false;
+    }
+    if (stats && header.pid != 0 && ::kill(static_cast<pid_t>(header.pid), 0) == 0) {
+        Log::error("Shared stats file " + m_path + " is in use by process " + std::to_string(header.pid));
+        return false;
+    }
+
+    Log::info("Removing stale shared stats file " + m_path);
+    return ::unlink(m_path.c_str()) == 0;
+#endif
+}
+
+}  // namespace tos
@@ -0,0 +1,85 @@
+/**
+ * TOS Miner - Shared Memory Stats Publisher
+ *
+ * Publishes telemetry snapshots into a memory-mapped file for local
+ * monitoring agents (see ShmStatsLayout.h for the layout and read protocol)
+ */
+
+#pragma once
+
+#include "ShmStatsLayout.h"
+#include "core/Telemetry.h"
+#include <string>
+
+namespace tos {
+
+/**
+ * Shared memory stats publisher
+ *
+ * Writes the stats block on the telemetry thread once per tick. Readers
+ * never interact with the miner: they map the file and copy under the
+ * sequence lock.
+ */
+class ShmStatsPublisher {
+public:
+    /**
+     * Constructor
+     *
+     * @param path File to publish to (e.g. /dev/shm/tosminer.stats)
+     * @param telemetry Telemetry sampler providing snapshots
+     */
+    ShmStatsPublisher(const std::string& path, Telemetry& telemetry);
+
+    /**
+     * Destructor
+     */
+    ~ShmStatsPublisher();
+
+    // Non-copyable
+    ShmStatsPublisher(const ShmStatsPublisher&) = delete;
+    ShmStatsPublisher& operator=(const ShmStatsPublisher&) = delete;
+
+    /**
+     * Create and map the file and start publishing
+     *
+     * The file is always created anew: an existing path is only replaced
+     * if it is a stale stats file of this user, and symlinks are refused.
+     *
+     * @return true if the file was mapped
+     */
+    bool start();
+
+    /**
+     * Stop publishing, mark the block as not running and remove the file
+     */
+    void stop();
+
+    /**
+     * Get file path
+     */
+    const std::string& getPath() const { return m_path; }
+
+private:
+    /**
+     * Copy a snapshot into the mapped block under the sequence lock
+     */
+    void publish(const TelemetrySnapshot& snapshot);
+
+    /**
+     * Remove a stats file left by a miner that is no longer running
+     *
+     * @return true if the path was removed
+     */
+    bool removeStale();
+
+private:
+    std::string m_path;
+    Telemetry& m_telemetry;
+    unsigned m_listenerId{0};
+
+    int m_fd{-1};
+    ShmStatsBlock* m_block{nullptr};
+    bool m_truncationLogged{false};
+};
+
+}  // namespace tos
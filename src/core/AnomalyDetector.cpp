@@ -0,0 +1,258 @@
+/**
+ * TOS Miner - Hash Rate Anomaly Detector Implementation
+ */
+
+#include "AnomalyDetector.h"
+#include "Telemetry.h"
+#include "util/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace tos {
+
+namespace {
+
+// Consistency constant: 1.4826 * MAD estimates sigma for normal data
+constexpr double MAD_SCALE = 1.4826;
+
+std::string formatRate(double rate) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (rate >= 1000000) {
+        ss << rate / 1000000 << " MH/s";
+    } else if (rate >= 1000) {
+        ss << rate / 1000 << " KH/s";
+    } else {
+        ss << rate << " H/s";
+    }
+    return ss.str();
+}
+
+std::string percentBelow(double value, double reference) {
+    return std::to_string(static_cast<int>(std::lround((1.0 - value / reference) * 100))) + "%";
+}
+
+}  // namespace
+
+AnomalyDetector::AnomalyDetector(const AnomalyConfig& config)
+    : m_config(config)
+{
+    m_config.spanTicks = std::max(1u, m_config.spanTicks);
+    m_config.recentTicks = std::max(1u, m_config.recentTicks);
+    m_config.warmupTicks = std::min(m_config.warmupTicks, m_config.windowTicks);
+}
+
+double AnomalyDetector::median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0;
+    }
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double upper = values[mid];
+    if (values.size() % 2 == 1) {
+        return upper;
+    }
+    double lower = *std::max_element(values.begin(), values.begin() + mid);
+    return (lower + upper) / 2;
+}
+
+double AnomalyDetector::mad(const std::vector<double>& values) {
+    double center = median(values);
+    std::vector<double> deviations;
+    deviations.reserve(values.size());
+    for (double v : values) {
+        deviations.push_back(std::fabs(v - center));
+    }
+    return median(std::move(deviations));
+}
+
+void AnomalyDetector::reset(DeviceState& state) {
+    state.counts.clear();
+    state.recent.clear();
+    state.flatTicks = 0;
+}
+
+void AnomalyDetector::update(TelemetrySnapshot& snapshot) {
+    if (m_devices.size() < snapshot.devices.size()) {
+        m_devices.resize(snapshot.devices.size());
+    }
+
+    // Pass 1: rate samples and stall counting
+    bool anyHashing = false;
+    std::vector<bool> active(snapshot.devices.size(), false);
+
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        DeviceTelemetry& dev = snapshot.devices[i];
+        DeviceState& state = m_devices[i];
+
+        if (dev.failed || dev.parked || !snapshot.running || snapshot.paused) {
+            reset(state);
+            state.anomaly = DeviceAnomaly();
+            continue;
+        }
+        active[i] = true;
+
+        // Counter reset (restarted miner): start over
+        uint64_t count = dev.hashRate.count;
+        if (!state.counts.empty() && count < state.counts.back().first) {
+            reset(state);
+        }
+
+        bool advanced = !state.counts.empty() && count > state.counts.back().first;
+        state.flatTicks = advanced || state.counts.empty() ? 0 : state.flatTicks + 1;
+        anyHashing = anyHashing || advanced;
+
+        state.counts.emplace_back(count, snapshot.sampledAt);
+        if (state.counts.size() > m_config.spanTicks + 1) {
+            state.counts.pop_front();
+        }
+
+        // Rate over the span, scaled to full intensity
+        if (state.counts.size() == m_config.spanTicks + 1) {
+            const auto& first = state.counts.front();
+            double elapsed = std::chrono::duration<double>(snapshot.sampledAt - first.second).count();
+            if (elapsed > 0) {
+                double rate = static_cast<double>(count - first.first) / elapsed;
+                rate = rate * 100.0 / std::max(1u, dev.intensity);
+
+                state.recent.push_back(rate);
+                if (state.recent.size() > m_config.recentTicks) {
+                    // Flagged samples never enter the baseline
+                    if (state.anomaly.kind == AnomalyKind::None) {
+                        state.baseline.push_back(state.recent.front());
+                        if (state.baseline.size() > m_config.windowTicks) {
+                            state.baseline.pop_front();
+                        }
+                    }
+                    state.recent.pop_front();
+                }
+            }
+        }
+    }
+
+    // Pass 2: classify
+    std::vector<DeviceAnomaly> results(snapshot.devices.size());
+    std::vector<double> recentMedians(snapshot.devices.size(), -1);
+
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        if (!active[i]) {
+            continue;
+        }
+        DeviceTelemetry& dev = snapshot.devices[i];
+        DeviceState& state = m_devices[i];
+        DeviceAnomaly& result = results[i];
+
+        bool warm = state.recent.size() == m_config.recentTicks;
+        std::vector<double> baseline(state.baseline.begin(), state.baseline.end());
+        result.baselineRate = median(baseline);
+        if (warm) {
+            result.recentRate = median(std::vector<double>(state.recent.begin(), state.recent.end()));
+            recentMedians[i] = result.recentRate;
+        }
+
+        // Stalled: only once the device has hashed, and only if work exists
+        if (state.flatTicks >= m_config.stallTicks && !state.baseline.empty() &&
+            (anyHashing || snapshot.pool.connected)) {
+            result.kind = AnomalyKind::Stalled;
+            result.reasons.push_back("no hashes for " + std::to_string(state.flatTicks) + " ticks");
+            continue;
+        }
+
+        // Nothing hashed anywhere this tick: no work, not a device fault
+        if (!anyHashing) {
+            recentMedians[i] = -1;
+            continue;
+        }
+
+        if (!warm || state.baseline.size() < m_config.warmupTicks || result.baselineRate <= 0) {
+            continue;
+        }
+
+        double drop = result.baselineRate - result.recentRate;
+        double sigma = MAD_SCALE * mad(baseline);
+        if (drop > result.baselineRate * m_config.dropThreshold && drop > m_config.madThreshold * sigma) {
+            result.kind = AnomalyKind::Degraded;
+            result.reasons.push_back(formatRate(result.recentRate) + ", " +
+                                     percentBelow(result.recentRate, result.baselineRate) +
+                                     " below baseline " + formatRate(result.baselineRate));
+
+            const GpuStats& gpu = dev.gpu;
+            if (gpu.valid && gpu.temperature >= m_config.throttleTemp) {
+                result.kind = AnomalyKind::Throttled;
+                result.reasons.push_back("temperature " + std::to_string(gpu.temperature) + "C");
+            } else if (gpu.valid && gpu.clockCore > 0 && state.peakClock > 0 &&
+                       gpu.clockCore * 10 < state.peakClock * 9) {
+                result.kind = AnomalyKind::Throttled;
+                result.reasons.push_back("core clock " + std::to_string(gpu.clockCore) + " MHz, peak " +
+                                         std::to_string(state.peakClock) + " MHz");
+            }
+        } else if (dev.gpu.valid && dev.gpu.clockCore > state.peakClock) {
+            state.peakClock = dev.gpu.clockCore;
+        }
+    }
+
+    // Pass 3: compare against same-model peers
+    std::map<std::pair<int, std::string>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        if (recentMedians[i] >= 0 && results[i].kind != AnomalyKind::Stalled) {
+            const auto& device = snapshot.devices[i].device;
+            groups[{static_cast<int>(device.type), device.name}].push_back(i);
+        }
+    }
+
+    for (const auto& group : groups) {
+        if (group.second.size() < 2) {
+            continue;
+        }
+        for (size_t i : group.second) {
+            std::vector<double> others;
+            for (size_t j : group.second) {
+                if (j != i) {
+                    others.push_back(recentMedians[j]);
+                }
+            }
+            DeviceAnomaly& result = results[i];
+            result.peerRate = median(others);
+            if (result.peerRate > 0 && result.recentRate < result.peerRate * (1.0 - m_config.peerThreshold)) {
+                if (result.kind == AnomalyKind::None) {
+                    result.kind = AnomalyKind::Degraded;
+                }
+                result.reasons.push_back(percentBelow(result.recentRate, result.peerRate) +
+                                         " below peers " + formatRate(result.peerRate));
+            }
+        }
+    }
+
+    // Publish, logging state changes
+    for (size_t i = 0; i < snapshot.devices.size(); i++) {
+        if (!active[i]) {
+            continue;
+        }
+        DeviceTelemetry& dev = snapshot.devices[i];
+        DeviceAnomaly& previous = m_devices[i].anomaly;
+        DeviceAnomaly& result = results[i];
+
+        result.ticks = result.kind == previous.kind ? previous.ticks + 1 : 1;
+        if (result.kind != previous.kind) {
+            std::string name = dev.device.shortName();
+            if (result.kind == AnomalyKind::None) {
+                Log::info(name + ": Hash rate back to normal");
+            } else {
+                std::string reasons;
+                for (const auto& reason : result.reasons) {
+                    reasons += (reasons.empty() ? "" : "; ") + reason;
+                }
+                Log::warning(name + ": Hash rate anomaly: " + DeviceAnomaly::name(result.kind) +
+                             " (" + reasons + ")");
+            }
+        }
+
+        previous = result;
+        dev.anomaly = result;
+    }
+}
+
+}  // namespace tos
@@ -0,0 +1,86 @@
+/**
+ * TOS Miner - Hash Rate Anomaly Detector
+ *
+ * Rolling-window detection of devices that run slower than their own
+ * recent history or their same-model peers, or stop hashing entirely.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace tos {
+
+struct TelemetrySnapshot;
+
+/**
+ * Anomaly detector
+ *
+ * Runs once per telemetry tick. Each tick adds one rate sample per
+ * device, taken over the last spanTicks ticks and scaled to 100%
+ * intensity so governor changes don't read as anomalies. Samples move
+ * from a recent window into a baseline window; while a device is flagged
+ * they are dropped instead, so a lasting drop stays flagged.
+ *
+ * - Degraded: recent median below baseline median by dropThreshold and
+ *   by madThreshold robust standard deviations (1.4826 * MAD).
+ * - Throttled: degraded while hot (throttleTemp) or down-clocked by more
+ *   than 10% from the highest clock seen.
+ * - Below peers: recent median below the median of other devices with
+ *   the same type and name by peerThreshold (reported as degraded).
+ * - Stalled: hash count unchanged for stallTicks while another device
+ *   hashed or the pool is connected.
+ *
+ * Parked and failed devices are skipped and start over when they return.
+ */
+class AnomalyDetector {
+public:
+    /**
+     * Constructor
+     *
+     * @param config Detector settings
+     */
+    explicit AnomalyDetector(const AnomalyConfig& config = AnomalyConfig());
+
+    /**
+     * Run one detection step and fill in each device's anomaly state
+     *
+     * @param snapshot Current telemetry (updated in place)
+     */
+    void update(TelemetrySnapshot& snapshot);
+
+    /**
+     * Get detector settings
+     */
+    const AnomalyConfig& getConfig() const { return m_config; }
+
+    /**
+     * Median of values (0 if empty)
+     */
+    static double median(std::vector<double> values);
+
+    /**
+     * Median absolute deviation from the median (0 if empty)
+     */
+    static double mad(const std::vector<double>& values);
+
+private:
+    struct DeviceState {
+        std::deque<std::pair<uint64_t, std::chrono::steady_clock::time_point>> counts;
+        std::deque<double> recent;
+        std::deque<double> baseline;
+        unsigned flatTicks{0};          // Ticks without new hashes
+        int peakClock{0};               // Highest core clock seen while normal
+        DeviceAnomaly anomaly;
+    };
+
+    void reset(DeviceState& state);
+
+    AnomalyConfig m_config;
+    std::vector<DeviceState> m_devices;
+};
+
+}  // namespace tos
@@ -0,0 +1,91 @@
+/**
+ * TOS Miner - Auto-Tuner Implementation
+ */
+
+#include "AutoTuner.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace tos {
+
+void AutoTuner::addAxis(const std::string& name, std::vector<unsigned> values, Apply apply) {
+    m_axes.push_back({name, std::move(values), std::move(apply)});
+}
+
+TuningProfile AutoTuner::run(const TuningProfile& start, const Measure& measure) {
+    m_measured.clear();
+
+    Point best(m_axes.size(), -1);
+    m_bestRate = measureAt(best, start, measure);
+
+    for (unsigned pass = 0; pass < c_maxPasses; pass++) {
+        bool changed = false;
+        for (size_t a = 0; a < m_axes.size(); a++) {
+            Point candidate = best;
+            for (size_t v = 0; v < m_axes[a].values.size(); v++) {
+                candidate[a] = static_cast<int>(v);
+                double rate = measureAt(candidate, start, measure);
+                if (rate > m_bestRate * (1.0 + c_minGain)) {
+                    best = candidate;
+                    m_bestRate = rate;
+                    changed = true;
+                }
+            }
+        }
+        if (!changed) {
+            break;
+        }
+    }
+
+    return profileAt(best, start);
+}
+
+double AutoTuner::measureAt(const Point& point, const TuningProfile& start, const Measure& measure) {
+    TuningProfile profile = profileAt(point, start);
+    auto key = settings(profile);
+    auto it = m_measured.find(key);
+    if (it != m_measured.end()) {
+        return it->second;
+    }
+    double rate = measure(profile);
+    m_measured[key] = rate;
+    return rate;
+}
+
+TuningProfile AutoTuner::profileAt(const Point& point, const TuningProfile& start) const {
+    TuningProfile profile = start;
+    for (size_t a = 0; a < m_axes.size(); a++) {
+        if (point[a] >= 0) {
+            m_axes[a].apply(profile, m_axes[a].values[point[a]]);
+        }
+    }
+    return profile;
+}
+
+std::vector<unsigned> AutoTuner::settings(const TuningProfile& profile) {
+    return {profile.openclGlobalWorkSize, profile.openclLocalWorkSize, profile.openclNonceLoop,
+            static_cast<unsigned>(profile.openclScratch), profile.openclPipelineDepth,
+            profile.cudaGridSize, profile.cudaBlockSize, profile.cudaStreams};
+}
+
+std::vector<unsigned> AutoTuner::powersAround(unsigned base, unsigned below, unsigned above,
+                                              unsigned minimum, unsigned maximum) {
+    std::vector<unsigned> values;
+    base = std::max(1u, base);
+    for (unsigned i = below; i > 0; i--) {
+        values.push_back(base >> std::min(i, 31u));
+    }
+    for (unsigned i = 0; i <= above; i++) {
+        uint64_t value = static_cast<uint64_t>(base) << std::min(i, 31u);
+        values.push_back(static_cast<unsigned>(std::min<uint64_t>(value, maximum)));
+    }
+
+    for (auto& value : values) {
+        value = std::min(maximum, std::max(minimum, value));
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    return values;
+}
+
+}  // namespace tos
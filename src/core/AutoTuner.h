@@ -0,0 +1,112 @@
+/**
+ * TOS Miner - Auto-Tuner
+ *
+ * Searches GPU settings for the highest measured hash rate
+ */
+
+#pragma once
+
+#include "TuningProfiles.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Coordinate-descent search over tuning parameters
+ *
+ * Each axis is one setting (e.g. local work size) with candidate values.
+ * Starting from a profile, the tuner sweeps one axis at a time with the
+ * others held at the best values found so far, and repeats the sweep until
+ * a pass changes nothing. That measures a few dozen candidates instead of
+ * every combination. A candidate must beat the current best by c_minGain
+ * to replace it, so run-to-run noise does not pick a different setting
+ * each pass. Measurements are remembered, so no candidate runs twice.
+ *
+ * The measure function builds and benchmarks the device; it returns 0 for
+ * settings the device cannot run, which are skipped.
+ */
+class AutoTuner {
+public:
+    /**
+     * Apply an axis value to a profile
+     */
+    using Apply = std::function<void(TuningProfile& profile, unsigned value)>;
+
+    /**
+     * Benchmark a profile
+     *
+     * @return Hashes per second, 0 if the device cannot run it
+     */
+    using Measure = std::function<double(const TuningProfile& profile)>;
+
+    /**
+     * Add a setting to search
+     *
+     * @param name Setting name (for logging)
+     * @param values Candidate values
+     * @param apply Sets the value on a profile
+     */
+    void addAxis(const std::string& name, std::vector<unsigned> values, Apply apply);
+
+    /**
+     * Search from a starting profile
+     *
+     * @param start Starting settings (kept if no candidate runs faster)
+     * @param measure Benchmark function
+     * @return Best settings found
+     */
+    TuningProfile run(const TuningProfile& start, const Measure& measure);
+
+    /**
+     * Get hash rate of the best settings (0 if nothing ran)
+     */
+    double bestRate() const { return m_bestRate; }
+
+    /**
+     * Get number of candidates benchmarked by the last run
+     */
+    unsigned measurements() const { return static_cast<unsigned>(m_measured.size()); }
+
+    /**
+     * Powers of two around a base value, clamped to [minimum, maximum]
+     *
+     * @param base Centre value
+     * @param below Halvings below base
+     * @param above Doublings above base
+     * @param minimum Smallest value
+     * @param maximum Largest value
+     * @return Distinct values in ascending order
+     */
+    static std::vector<unsigned> powersAround(unsigned base, unsigned below, unsigned above,
+                                              unsigned minimum, unsigned maximum);
+
+private:
+    struct Axis {
+        std::string name;
+        std::vector<unsigned> values;
+        Apply apply;
+    };
+
+    // Candidate value index per axis (-1 = the start profile's own value)
+    using Point = std::vector<int>;
+
+    double measureAt(const Point& point, const TuningProfile& start, const Measure& measure);
+    TuningProfile profileAt(const Point& point, const TuningProfile& start) const;
+
+    // Tuned fields of a profile (candidates with equal settings are measured once)
+    static std::vector<unsigned> settings(const TuningProfile& profile);
+
+    std::vector<Axis> m_axes;
+    std::map<std::vector<unsigned>, double> m_measured;
+    double m_bestRate = 0;
+
+    // Relative gain a candidate needs over the current best
+    static constexpr double c_minGain = 0.02;
+    // Sweeps over all axes at most
+    static constexpr unsigned c_maxPasses = 3;
+};
+
+}  // namespace tos
@@ -0,0 +1,57 @@
+/**
+ * TOS Miner - Batch Sizer Implementation
+ */
+
+#include "BatchSizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tos {
+
+void BatchSizer::configure(size_t initial, size_t minSize, size_t maxSize, size_t granularity) {
+    m_granularity = std::max<size_t>(1, granularity);
+    m_max = std::max(m_granularity, maxSize - maxSize % m_granularity);
+    size_t minRounded = (minSize + m_granularity - 1) / m_granularity * m_granularity;
+    m_min = std::min(m_max, std::max(m_granularity, minRounded));
+    m_size = clamp(static_cast<double>(initial));
+    m_perNonce = 0;
+    m_warmup = true;
+}
+
+bool BatchSizer::record(size_t batch, double seconds) {
+    if (batch == 0 || seconds <= 0) {
+        return false;
+    }
+    if (m_warmup) {
+        m_warmup = false;
+        return false;
+    }
+
+    double perNonce = seconds / static_cast<double>(batch);
+    m_perNonce = m_perNonce > 0 ? c_alpha * perNonce + (1.0 - c_alpha) * m_perNonce : perNonce;
+
+    if (!enabled()) {
+        return false;
+    }
+
+    double ideal = m_target / m_perNonce;
+    double current = static_cast<double>(m_size);
+    if (ideal <= current * c_tolerance && ideal >= current / c_tolerance) {
+        return false;
+    }
+
+    size_t next = clamp(std::min(current * 2.0, std::max(current / 2.0, ideal)));
+    if (next == m_size) {
+        return false;
+    }
+    m_size = next;
+    return true;
+}
+
+size_t BatchSizer::clamp(double size) const {
+    size_t rounded = static_cast<size_t>(std::max(0.0, std::floor(size)));
+    rounded -= rounded % m_granularity;
+    return std::min(m_max, std::max(m_min, rounded));
+}
+
+}  // namespace tos
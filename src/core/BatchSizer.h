@@ -0,0 +1,98 @@
+/**
+ * TOS Miner - Batch Sizer
+ *
+ * Grows or shrinks GPU batches so each kernel launch takes about a
+ * target duration.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace tos {
+
+/**
+ * Batch size controller
+ *
+ * Long batches delay job switches (the device finishes the old job's
+ * batch first) and short ones spend more time on launch overhead. The
+ * backend reports each completed batch's size and kernel time; the sizer
+ * keeps a moving estimate of the time per nonce and moves the batch
+ * towards target / time per nonce:
+ *
+ * - The first batch after configure() is ignored (kernel warm-up).
+ * - Nothing changes while the batch is within tolerance of the ideal
+ *   size, so timing noise does not make it oscillate.
+ * - Each step at most doubles or halves the batch.
+ * - Sizes are multiples of the granularity within [minSize, maxSize].
+ *
+ * With no target the size stays at the initial value. Not thread-safe;
+ * owned by the mining thread.
+ */
+class BatchSizer {
+public:
+    /**
+     * Set bounds and starting size (resets the timing estimate)
+     *
+     * @param initial Starting batch size
+     * @param minSize Smallest batch
+     * @param maxSize Largest batch (e.g. what device buffers hold)
+     * @param granularity Batch sizes are multiples of this (e.g. work group size)
+     */
+    void configure(size_t initial, size_t minSize, size_t maxSize, size_t granularity = 1);
+
+    /**
+     * Set target kernel duration
+     *
+     * @param seconds Target per batch, 0 = fixed size
+     */
+    void setTarget(double seconds) { m_target = seconds; }
+
+    /**
+     * Get target kernel duration in seconds (0 = fixed size)
+     */
+    double getTarget() const { return m_target; }
+
+    /**
+     * Check whether the size adapts to batch durations
+     */
+    bool enabled() const { return m_target > 0; }
+
+    /**
+     * Get the current batch size
+     */
+    size_t size() const { return m_size; }
+
+    /**
+     * Record a completed batch
+     *
+     * @param batch Nonces the batch covered
+     * @param seconds Kernel time of the batch
+     * @return true if the batch size changed
+     */
+    bool record(size_t batch, double seconds);
+
+    /**
+     * Get estimated kernel time per nonce in seconds (0 before the first sample)
+     */
+    double perNonce() const { return m_perNonce; }
+
+private:
+    size_t clamp(double size) const;
+
+    double m_target = 0;
+    size_t m_size = 1;
+    size_t m_min = 1;
+    size_t m_max = 1;
+    size_t m_granularity = 1;
+
+    double m_perNonce = 0;
+    bool m_warmup = true;
+
+    // Moving average weight of the newest batch
+    static constexpr double c_alpha = 0.3;
+    // Ideal size may differ this much (ratio) before the batch is resized
+    static constexpr double c_tolerance = 1.25;
+};
+
+}  // namespace tos
@@ -0,0 +1,92 @@
+/**
+ * TOS Miner - Device Timeline Implementation
+ */
+
+#include "DeviceTimeline.h"
+#include <algorithm>
+
+namespace tos {
+
+namespace {
+
+uint64_t toHost(uint64_t device, int64_t offset) {
+    return device != 0 ? static_cast<uint64_t>(static_cast<int64_t>(device) + offset) : 0;
+}
+
+CommandTiming toHost(const CommandTiming& command, int64_t offset) {
+    return {toHost(command.queued, offset), toHost(command.submit, offset),
+            toHost(command.start, offset), toHost(command.end, offset)};
+}
+
+}  // namespace
+
+DeviceTimeline::DeviceTimeline() {
+    m_recent.reserve(RECENT);
+}
+
+void DeviceTimeline::record(const BatchTiming& timing, std::chrono::steady_clock::time_point enqueuedAt) {
+    const CommandTiming& kernel = timing.kernel;
+    if (kernel.queued == 0 || kernel.start == 0 || kernel.end < kernel.start) {
+        return;
+    }
+
+    Guard lock(m_mutex);
+
+    m_kernel.observe(std::chrono::nanoseconds(kernel.end - kernel.start));
+    if (timing.read.end > timing.read.start && timing.read.start != 0) {
+        m_transfer.observe(std::chrono::nanoseconds(timing.read.end - timing.read.start));
+    }
+
+    // A kernel that ran before one already recorded (batches completed out
+    // of order) says nothing about the gap
+    if (m_lastKernelEnd != 0 && kernel.end > m_lastKernelEnd) {
+        uint64_t gap = kernel.start > m_lastKernelEnd ? kernel.start - m_lastKernelEnd : 0;
+        m_idle.observe(std::chrono::nanoseconds(gap));
+    }
+    m_lastKernelEnd = std::max(m_lastKernelEnd, kernel.end);
+
+    int64_t host = std::chrono::duration_cast<std::chrono::nanoseconds>(enqueuedAt.time_since_epoch()).count();
+    int64_t offset = host - static_cast<int64_t>(kernel.queued);
+    if (!m_synced || offset > m_offset) {
+        m_offset = offset;
+        m_synced = true;
+    }
+
+    BatchTiming mapped = timing;
+    mapped.kernel = toHost(timing.kernel, m_offset);
+    mapped.read = toHost(timing.read, m_offset);
+    if (m_recent.size() < RECENT) {
+        m_recent.push_back(mapped);
+    } else {
+        m_recent[m_next] = mapped;
+    }
+    m_next = (m_next + 1) % RECENT;
+}
+
+void DeviceTimeline::restart() {
+    Guard lock(m_mutex);
+    m_lastKernelEnd = 0;
+    m_offset = 0;
+    m_synced = false;
+}
+
+TimelineStats DeviceTimeline::stats() const {
+    TimelineStats stats;
+    stats.kernel = m_kernel.snapshot();
+    stats.transfer = m_transfer.snapshot();
+    stats.idle = m_idle.snapshot();
+    return stats;
+}
+
+std::vector<BatchTiming> DeviceTimeline::recent() const {
+    Guard lock(m_mutex);
+    if (m_recent.size() < RECENT) {
+        return m_recent;
+    }
+
+    std::vector<BatchTiming> ordered(m_recent.begin() + m_next, m_recent.end());
+    ordered.insert(ordered.end(), m_recent.begin(), m_recent.begin() + m_next);
+    return ordered;
+}
+
+}  // namespace tos
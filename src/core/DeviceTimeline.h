@@ -0,0 +1,114 @@
+/**
+ * TOS Miner - Device Timeline
+ *
+ * Device-side timestamps of GPU batches from profiling events, aggregated
+ * into kernel, transfer and idle histograms and kept for the trace export.
+ */
+
+#pragma once
+
+#include "util/Guards.h"
+#include "util/Histogram.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Profiled command timestamps in nanoseconds (CL_PROFILING_COMMAND_*)
+ */
+struct CommandTiming {
+    uint64_t queued = 0;
+    uint64_t submit = 0;
+    uint64_t start = 0;
+    uint64_t end = 0;
+};
+
+/**
+ * One profiled batch: its kernel and the readback of its results
+ *
+ * Recorded in device time; DeviceTimeline::recent() returns host
+ * steady_clock time.
+ */
+struct BatchTiming {
+    uint64_t startNonce = 0;
+    uint64_t size = 0;
+    unsigned slot = 0;          // Pipeline slot
+    CommandTiming kernel;
+    CommandTiming read;         // All zero if the readback was not profiled
+};
+
+/**
+ * Histogram snapshots of a device timeline
+ */
+struct TimelineStats {
+    HistogramSnapshot kernel;   // Kernel start -> end
+    HistogramSnapshot transfer; // Readback start -> end
+    HistogramSnapshot idle;     // Previous kernel end -> next kernel start
+};
+
+/**
+ * Device timeline
+ *
+ * The idle gap is measured between kernels on the device clock, so it
+ * shows time the device spent waiting for the host; kernels that overlap
+ * count as no gap. Device timestamps are mapped to the host clock with
+ * the host time taken just before each kernel was enqueued: that time is
+ * never later than the kernel's QUEUED timestamp, so the largest
+ * host - QUEUED difference seen is the closest offset.
+ *
+ * Thread-safe: recorded by the mining thread, read by telemetry and the API.
+ */
+class DeviceTimeline {
+public:
+    // Batches kept for the trace export
+    static constexpr size_t RECENT = 256;
+
+    DeviceTimeline();
+
+    // Non-copyable
+    DeviceTimeline(const DeviceTimeline&) = delete;
+    DeviceTimeline& operator=(const DeviceTimeline&) = delete;
+
+    /**
+     * Record a completed batch
+     *
+     * @param timing Device timestamps (ignored if the kernel's are incomplete)
+     * @param enqueuedAt Host time just before the kernel was enqueued
+     */
+    void record(const BatchTiming& timing, std::chrono::steady_clock::time_point enqueuedAt);
+
+    /**
+     * Forget the device clock (new context or queue); histograms are kept
+     */
+    void restart();
+
+    /**
+     * Get the histograms
+     */
+    TimelineStats stats() const;
+
+    /**
+     * Get recent batches in host steady_clock nanoseconds, oldest first
+     */
+    std::vector<BatchTiming> recent() const;
+
+private:
+    mutable std::mutex m_mutex;
+
+    LatencyHistogram m_kernel{100};    // 100us .. ~1.6s
+    LatencyHistogram m_transfer{10};   // 10us .. ~164ms
+    LatencyHistogram m_idle{10};
+
+    std::vector<BatchTiming> m_recent;  // Ring of RECENT entries
+    size_t m_next = 0;
+
+    // Device clock state since the last restart
+    uint64_t m_lastKernelEnd = 0;
+    int64_t m_offset = 0;              // Host ns - device ns
+    bool m_synced = false;
+};
+
+}  // namespace tos
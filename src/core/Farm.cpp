@@ -4,6 +4,7 @@
 
 #include "Farm.h"
 #include "util/Log.h"
+#include <iomanip>
 #include <sstream>
 #include <future>
 #include <vector>
@@ -27,6 +28,7 @@ Farm::~Farm() {
 
 void Farm::addMiner(std::unique_ptr<Miner> miner) {
     Guard lock(m_minersMutex);
+    miner->setNonceSlot(static_cast<unsigned>(m_miners.size()));
     m_miners.push_back(std::move(miner));
 }
 
@@ -40,6 +42,11 @@ bool Farm::isMinerFailed(unsigned index) const {
     return m_failedMiners.find(index) != m_failedMiners.end();
 }
 
+bool Farm::isMinerRunning(unsigned index) const {
+    Guard lock(m_minersMutex);
+    return index < m_miners.size() && m_miners[index]->isRunning();
+}
+
 void Farm::markMinerFailed(unsigned index) {
     {
         Guard lock(m_failedMinersMutex);
@@ -66,50 +73,93 @@ unsigned Farm::recoverFailedMiners() {
         }
     }
 
-    if (toRecover.empty()) {
-        return 0;
+    unsigned recovered = 0;
+    for (unsigned idx : toRecover) {
+        if (recoverMiner(idx)) {
+            recovered++;
+        }
     }
 
-    unsigned recovered = 0;
-    Guard lock(m_minersMutex);
+    return recovered;
+}
 
-    for (unsigned idx : toRecover) {
-        if (idx >= m_miners.size()) continue;
+bool Farm::initMiner(Miner& miner) {
+    auto begin = std::chrono::steady_clock::now();
+    if (!miner.init()) {
+        Log::error("Failed to initialize " + miner.getName());
+        return false;
+    }
+    double initMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
 
-        auto& miner = m_miners[idx];
-        Log::info("Attempting to recover " + miner->getName() + "...");
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(0) << "init " << initMs << " ms";
 
-        // Stop, reinit, and restart
-        miner->stop();
+    // A device that computes wrong hashes would only waste power
+    if (Miner::isSelfTestEnabled()) {
+        if (!miner.selfTest()) {
+            Log::error(miner.getName() + " failed its self-test and is excluded (" + ss.str() + ")");
+            return false;
+        }
+        ss << ", self-test " << miner.getSelfTestTime() << " ms";
+    }
 
-        if (miner->init()) {
-            miner->setSolutionCallback([this](const Solution& sol, const std::string& jobId) {
-                onSolution(sol, jobId);
-            });
-
-            // Give it current work
-            {
-                Guard workLock(m_workMutex);
-                if (m_currentWork.valid) {
-                    miner->setWork(m_currentWork);
-                }
-            }
+    Log::info(miner.getName() + " initialized successfully (" + ss.str() + ")");
+    return true;
+}
 
-            miner->start();
+bool Farm::recoverMiner(unsigned index) {
+    // Miners are never removed once added, so the pointer stays valid
+    // without holding m_minersMutex through the slow reinitialization
+    Miner* miner = nullptr;
+    {
+        Guard lock(m_minersMutex);
+        if (index < m_miners.size()) {
+            miner = m_miners[index].get();
+        }
+    }
+    if (!miner || !isMinerFailed(index)) {
+        return false;
+    }
 
-            {
-                Guard failLock(m_failedMinersMutex);
-                m_failedMiners.erase(idx);
-            }
+    // Serializes with stop() so a miner isn't restarted after the farm stopped
+    Guard recoveryLock(m_recoveryMutex);
+    if (!m_running) {
+        return false;
+    }
 
-            Log::info(miner->getName() + " recovered successfully");
-            recovered++;
-        } else {
-            Log::error("Failed to recover " + miner->getName());
+    Log::info("Attempting to recover " + miner->getName() + "...");
+
+    miner->stop();
+    if (!initMiner(*miner)) {
+        Log::error("Failed to recover " + miner->getName());
+        return false;
+    }
+
+    miner->resetHealth();
+    miner->setSolutionCallback([this](const Solution& sol, const std::string& jobId) {
+        onSolution(sol, jobId);
+    });
+
+    // Rejoin work distribution and take the current work in one step under
+    // the miners lock, so a job set meanwhile reaches this miner either way.
+    // The miner's nonce slot was left unscanned while it was failed.
+    {
+        Guard lock(m_minersMutex);
+        {
+            Guard failLock(m_failedMinersMutex);
+            m_failedMiners.erase(index);
+        }
+        {
+            Guard workLock(m_workMutex);
+            if (m_currentWork.valid) {
+                miner->setWork(m_currentWork);
+            }
         }
+        miner->start(m_paused || m_parkedMiners.count(index) > 0);
     }
 
-    return recovered;
+    Log::info(miner->getName() + " recovered successfully");
+    return true;
 }
 
 bool Farm::start() {
@@ -144,7 +194,7 @@ bool Farm::start() {
 
     for (size_t i = 0; i < m_miners.size(); i++) {
         initFutures.push_back(std::async(std::launch::async, [this, i]() {
-            return m_miners[i]->init();
+            return initMiner(*m_miners[i]);
         }));
     }
 
@@ -155,16 +205,20 @@ bool Farm::start() {
         if (success) {
             m_miners[i]->start();
             started++;
-            Log::info(m_miners[i]->getName() + " initialized successfully");
         } else {
-            Log::error("Failed to initialize " + m_miners[i]->getName());
+            Guard failLock(m_failedMinersMutex);
+            m_failedMiners.insert(static_cast<unsigned>(i));
         }
     }
 
     if (started > 0) {
         m_running = true;
         m_paused = false;
-        Log::info("Farm started with " + std::to_string(started) + " active miner(s)");
+        std::ostringstream ss;
+        ss << "Farm started with " << started << " active miner(s) in " << std::fixed << std::setprecision(0)
+           << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count()
+           << " ms";
+        Log::info(ss.str());
         return true;
     }
 
@@ -182,6 +236,9 @@ void Farm::stop() {
     m_running = false;
     m_paused = false;
 
+    // Wait for an in-flight recovery (it checks m_running before restarting)
+    Guard recoveryLock(m_recoveryMutex);
+
     Guard lock(m_minersMutex);
     for (auto& miner : m_miners) {
         miner->stop();
@@ -211,8 +268,11 @@ void Farm::resume() {
     }
 
     Guard lock(m_minersMutex);
-    for (auto& miner : m_miners) {
-        miner->resume();
+    for (size_t i = 0; i < m_miners.size(); i++) {
+        unsigned index = static_cast<unsigned>(i);
+        if (!m_parkedMiners.count(index) && !isMinerFailed(index)) {
+            m_miners[i]->resume();
+        }
     }
 
     m_paused = false;
@@ -229,14 +289,11 @@ void Farm::setWork(const WorkPackage& work) {
         activeCount = static_cast<unsigned>(m_miners.size() - m_failedMiners.size());
     }
 
-    if (activeCount == 0) {
-        Log::warning("No active miners to receive work");
-        return;
-    }
-
-    // Create a copy with totalDevices set to active miner count
+    // Split the nonce space over all miners by nonce slot (farm index).
+    // A failed miner's range is left unscanned, and a recovered miner
+    // rejoins the current job in its own range without overlapping others.
     WorkPackage distributedWork = work;
-    distributedWork.totalDevices = activeCount;
+    distributedWork.totalDevices = static_cast<unsigned>(m_miners.size());
 
     {
         Guard workLock(m_workMutex);
@@ -247,6 +304,12 @@ void Farm::setWork(const WorkPackage& work) {
         m_currentWork = distributedWork;
     }
 
+    // Kept as the current work for miners that recover later
+    if (activeCount == 0) {
+        Log::warning("No active miners to receive work");
+        return;
+    }
+
     // Only distribute to non-failed miners
     for (size_t i = 0; i < m_miners.size(); i++) {
         if (!isMinerFailed(static_cast<unsigned>(i))) {
@@ -300,6 +363,108 @@ HashRate Farm::getMinerHashRate(unsigned index) const {
     return HashRate();
 }
 
+DeviceHealth Farm::getMinerHealth(unsigned index) const {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        return m_miners[index]->getHealth();
+    }
+
+    return DeviceHealth();
+}
+
+HistogramSnapshot Farm::getMinerJobSwitchLatency(unsigned index) const {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        return m_miners[index]->getJobSwitchLatency();
+    }
+
+    return HistogramSnapshot();
+}
+
+TimelineStats Farm::getMinerTimelineStats(unsigned index) const {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        return m_miners[index]->getTimelineStats();
+    }
+
+    return TimelineStats();
+}
+
+std::vector<BatchTiming> Farm::getMinerRecentBatches(unsigned index) const {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        return m_miners[index]->getRecentBatches();
+    }
+
+    return {};
+}
+
+uint64_t Farm::getMinerBatchSize(unsigned index) const {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        return m_miners[index]->getBatchSize();
+    }
+
+    return 0;
+}
+
+double Farm::getMinerBatchTime(unsigned index) const {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        return m_miners[index]->getBatchTime();
+    }
+
+    return 0;
+}
+
+void Farm::setMinerIntensity(unsigned index, unsigned percent) {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        m_miners[index]->setIntensity(percent);
+    }
+}
+
+unsigned Farm::getMinerIntensity(unsigned index) const {
+    Guard lock(m_minersMutex);
+
+    if (index < m_miners.size()) {
+        return m_miners[index]->getIntensity();
+    }
+
+    return 100;
+}
+
+void Farm::setMinerParked(unsigned index, bool parked) {
+    Guard lock(m_minersMutex);
+
+    if (index >= m_miners.size()) {
+        return;
+    }
+
+    if (parked) {
+        m_parkedMiners.insert(index);
+        m_miners[index]->pause();
+    } else {
+        m_parkedMiners.erase(index);
+        // Farm pause and failure isolation still apply
+        if (!m_paused && !isMinerFailed(index)) {
+            m_miners[index]->resume();
+        }
+    }
+}
+
+bool Farm::isMinerParked(unsigned index) const {
+    Guard lock(m_minersMutex);
+    return m_parkedMiners.count(index) > 0;
+}
+
 void Farm::resetStats() {
     m_stats.reset();
     m_startTime = std::chrono::steady_clock::now();
@@ -66,6 +66,14 @@ public:
      */
     bool isMinerFailed(unsigned index) const;
 
+    /**
+     * Check if a miner's mining thread is running
+     *
+     * False for a miner that was never started or whose loop gave up
+     * on the device.
+     */
+    bool isMinerRunning(unsigned index) const;
+
     /**
      * Mark a miner as failed (isolate it from work distribution)
      */
@@ -77,6 +85,17 @@ public:
      */
     unsigned recoverFailedMiners();
 
+    /**
+     * Attempt to recover one failed miner
+     *
+     * Reinitializes the device without holding farm-wide locks, gives it
+     * the current work and returns it to work distribution.
+     *
+     * @param index Miner index
+     * @return true if the miner was failed and is mining again
+     */
+    bool recoverMiner(unsigned index);
+
     /**
      * Start all miners
      *
@@ -157,6 +176,81 @@ public:
      */
     HashRate getMinerHashRate(unsigned index) const;
 
+    /**
+     * Get health metrics for specific miner
+     *
+     * @param index Miner index
+     */
+    DeviceHealth getMinerHealth(unsigned index) const;
+
+    /**
+     * Get job switch latency histogram for specific miner
+     *
+     * @param index Miner index
+     */
+    HistogramSnapshot getMinerJobSwitchLatency(unsigned index) const;
+
+    /**
+     * Get device timeline histograms for specific miner
+     *
+     * @param index Miner index
+     */
+    TimelineStats getMinerTimelineStats(unsigned index) const;
+
+    /**
+     * Get recently profiled batches for specific miner (host steady_clock ns)
+     *
+     * @param index Miner index
+     */
+    std::vector<BatchTiming> getMinerRecentBatches(unsigned index) const;
+
+    /**
+     * Get nonces in a specific miner's most recent batch (0 for CPU miners)
+     *
+     * @param index Miner index
+     */
+    uint64_t getMinerBatchSize(unsigned index) const;
+
+    /**
+     * Get kernel time of a specific miner's most recent batch in seconds
+     *
+     * @param index Miner index
+     */
+    double getMinerBatchTime(unsigned index) const;
+
+    /**
+     * Set intensity of a specific miner
+     *
+     * @param index Miner index
+     * @param percent Intensity 1-100
+     */
+    void setMinerIntensity(unsigned index, unsigned percent);
+
+    /**
+     * Get intensity of a specific miner in percent
+     *
+     * @param index Miner index
+     */
+    unsigned getMinerIntensity(unsigned index) const;
+
+    /**
+     * Park or unpark a specific miner
+     *
+     * A parked miner is paused and stays paused across Farm::resume()
+     * and failure recovery until it is unparked.
+     *
+     * @param index Miner index
+     * @param parked true to park, false to unpark
+     */
+    void setMinerParked(unsigned index, bool parked);
+
+    /**
+     * Check if a miner is parked
+     *
+     * @param index Miner index
+     */
+    bool isMinerParked(unsigned index) const;
+
     /**
      * Get mining statistics (returns copyable snapshot)
      */
@@ -207,6 +301,13 @@ private:
      */
     void onSolution(const Solution& solution, const std::string& jobId);
 
+    /**
+     * Initialize a miner and run its self-test, logging the timings
+     *
+     * @return true if the miner is ready to start
+     */
+    bool initMiner(Miner& miner);
+
 private:
     // List of miners
     std::vector<std::unique_ptr<Miner>> m_miners;
@@ -237,6 +338,12 @@ private:
     // Failed miners tracking (for device isolation)
     std::set<unsigned> m_failedMiners;
     mutable std::mutex m_failedMinersMutex;
+
+    // Parked miners (host load), guarded by m_minersMutex
+    std::set<unsigned> m_parkedMiners;
+
+    // Held while a miner is reinitialized (see recoverMiner)
+    std::mutex m_recoveryMutex;
 };
 
 }  // namespace tos
@@ -0,0 +1,119 @@
+/**
+ * TOS Miner - Host Load Governor Implementation
+ */
+
+#include "HostLoadGovernor.h"
+#include "util/Log.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace tos {
+
+HostLoadGovernor::HostLoadGovernor(const HostLoadConfig& config, std::vector<unsigned> cpuMiners,
+                                   unsigned onlineCpus, Actuator actuator)
+    : m_config(config)
+    , m_miners(std::move(cpuMiners))
+    , m_onlineCpus(std::max(1u, onlineCpus))
+    , m_actuator(std::move(actuator))
+{
+    unsigned count = static_cast<unsigned>(m_miners.size());
+    unsigned share = std::min(100u, m_config.cpuShare);
+
+    // Budget in whole threads; a non-zero share always allows one
+    m_budget = std::min(count, m_onlineCpus * share / 100);
+    if (share > 0 && count > 0) {
+        m_budget = std::max(1u, m_budget);
+    }
+    m_config.minThreads = std::min(m_config.minThreads, m_budget);
+    m_config.shrinkTicks = std::max(1u, m_config.shrinkTicks);
+    m_active = count;
+}
+
+void HostLoadGovernor::update(const HostLoad& load) {
+    Guard lock(m_mutex);
+
+    if (!m_started) {
+        m_started = true;
+        if (m_active > m_budget) {
+            apply(m_budget, std::to_string(m_config.cpuShare) + "% CPU share budget");
+        }
+        return;
+    }
+
+    if (!m_config.hostAware || !load.valid) {
+        return;
+    }
+
+    m_ticks++;
+
+    bool havePsi = load.psiSome10 >= 0;
+    double others = -1;
+    bool settling = false;
+    if (load.runnable >= 0) {
+        // The thread sampling the load is runnable too
+        double now = std::max(0, load.runnable - static_cast<int>(m_active) - 1) /
+                     static_cast<double>(m_onlineCpus);
+        m_others = m_others < 0 ? now : m_others + (now - m_others) * RUNNABLE_SMOOTHING;
+        others = m_others;
+    } else if (load.load1 >= 0) {
+        if (m_ticks >= LOAD1_SETTLE_TICKS) {
+            others = std::max(0.0, load.load1 - m_active) / m_onlineCpus;
+        } else {
+            settling = true;
+        }
+    }
+
+    std::ostringstream reason;
+    reason << std::fixed << std::setprecision(1);
+
+    bool busy = false;
+    if (havePsi && load.psiSome10 > m_config.psiHigh) {
+        busy = true;
+        reason << "CPU pressure " << load.psiSome10 << "% above " << m_config.psiHigh << "%";
+    } else if (others > m_config.loadHigh) {
+        busy = true;
+        reason << std::setprecision(2) << "other load " << others << " per CPU above " << m_config.loadHigh;
+    }
+
+    bool idle = !busy && !settling && (!havePsi || load.psiSome10 < m_config.psiLow) &&
+                (others < 0 || others < m_config.loadHigh / 2);
+    m_idleTicks = idle ? m_idleTicks + 1 : 0;
+
+    if (busy && m_active > m_config.minThreads && m_ticks >= m_config.shrinkTicks) {
+        unsigned cut = std::max(1u, m_active / 4);
+        apply(std::max(m_config.minThreads, m_active - std::min(m_active, cut)), reason.str());
+    } else if (idle && m_active < m_budget && m_idleTicks >= m_config.growTicks &&
+               m_ticks >= m_config.shrinkTicks) {
+        apply(m_active + 1, "host idle");
+        m_idleTicks = 0;
+    }
+}
+
+void HostLoadGovernor::apply(unsigned target, const std::string& reason) {
+    if (target == m_active) {
+        return;
+    }
+
+    Log::info("Host load: " + std::to_string(m_active) + " -> " + std::to_string(target) +
+              " CPU thread(s) (" + reason + ")");
+
+    // Threads below target run, the rest are parked
+    for (unsigned i = 0; i < m_miners.size(); i++) {
+        bool wasParked = i >= m_active;
+        bool parked = i >= target;
+        if (parked != wasParked && m_actuator) {
+            m_actuator(m_miners[i], parked);
+        }
+    }
+
+    m_active = target;
+    m_ticks = 0;
+}
+
+unsigned HostLoadGovernor::getActiveThreads() const {
+    Guard lock(m_mutex);
+    return m_active;
+}
+
+}  // namespace tos
@@ -0,0 +1,93 @@
+/**
+ * TOS Miner - Host Load Governor
+ *
+ * Parks CPU mining threads when other tasks on the host are waiting for
+ * CPU and brings them back once the host is idle again.
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "util/HostLoad.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Host load governor
+ *
+ * Runs one control step per telemetry tick. The number of active CPU
+ * threads never exceeds the CPU share budget. With host awareness on:
+ *
+ * - Busy (PSI some avg10 above psiHigh, or load from other tasks above
+ *   loadHigh per CPU): park a quarter of the active threads (at least
+ *   one), at most once every shrinkTicks.
+ * - Idle (PSI below psiLow and other load below loadHigh / 2) for
+ *   growTicks in a row: unpark one thread.
+ *
+ * Shrinking is fast and growing slow, so mining yields quickly when
+ * real work arrives and does not chase short idle gaps. Load from other
+ * tasks is the number of runnable tasks minus active threads (and the
+ * sampling thread), smoothed over a few ticks; parked threads drop out
+ * of it at once. Without a runnable count the 1 minute load average is
+ * used instead, but only LOAD1_SETTLE_TICKS after the last change, since
+ * until then it still counts threads that were just parked.
+ */
+class HostLoadGovernor {
+public:
+    using Actuator = std::function<void(unsigned index, bool parked)>;
+
+    /**
+     * Constructor
+     *
+     * @param config Governor settings
+     * @param cpuMiners Farm indices of the CPU miners, unparked first
+     * @param onlineCpus Number of online CPUs
+     * @param actuator Parks/unparks a miner (e.g. Farm::setMinerParked)
+     */
+    HostLoadGovernor(const HostLoadConfig& config, std::vector<unsigned> cpuMiners,
+                     unsigned onlineCpus, Actuator actuator);
+
+    /**
+     * Run one control step (the first step applies the CPU share budget)
+     *
+     * @param load Current host load
+     */
+    void update(const HostLoad& load);
+
+    /**
+     * Get number of unparked CPU threads
+     */
+    unsigned getActiveThreads() const;
+
+    /**
+     * Get most CPU threads the budget allows
+     */
+    unsigned getBudget() const { return m_budget; }
+
+    // Ticks the 1 minute load average needs to stop counting a change
+    static constexpr unsigned LOAD1_SETTLE_TICKS = 60;
+    // Weight of each new runnable sample in the smoothed other load
+    static constexpr double RUNNABLE_SMOOTHING = 0.5;
+
+private:
+    void apply(unsigned target, const std::string& reason);
+
+    HostLoadConfig m_config;
+    std::vector<unsigned> m_miners;
+    unsigned m_onlineCpus;
+    Actuator m_actuator;
+
+    unsigned m_budget{0};
+    unsigned m_active{0};
+    unsigned m_ticks{0};            // Ticks since the last change
+    unsigned m_idleTicks{0};        // Consecutive idle ticks
+    double m_others{-1};            // Smoothed runnable load from other tasks per CPU
+    bool m_started{false};
+    mutable std::mutex m_mutex;
+};
+
+}  // namespace tos
@@ -5,8 +5,10 @@
 #include "Miner.h"
 #include "toshash/TosHash.h"
 #include "util/Log.h"
-#include <sstream>
+#include <cmath>
 #include <cstring>
+#include <iomanip>
+#include <sstream>
 
 namespace tos {
 
@@ -15,9 +17,51 @@ namespace tos {
 thread_local TosHash t_hasher;
 thread_local ScratchPad t_scratch;
 
+namespace {
+
+// Known-answer self-test vectors: header pattern, first nonce, nonce count
+struct SelfTestVector {
+    enum class Header { Zero, Counting, Random } header;
+    uint64_t startNonce;
+    unsigned count;
+};
+
+const SelfTestVector c_selfTestVectors[] = {
+    {SelfTestVector::Header::Zero, 0, 4},
+    {SelfTestVector::Header::Counting, 0xFFFFFFFEULL, 4},          // Carry into the high word
+    {SelfTestVector::Header::Random, 0xFEDCBA9876543210ULL, 4},
+};
+
+WorkPackage selfTestWork(SelfTestVector::Header header) {
+    WorkPackage work;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < work.header.size(); i++) {
+        switch (header) {
+            case SelfTestVector::Header::Zero:
+                work.header[i] = 0;
+                break;
+            case SelfTestVector::Header::Counting:
+                work.header[i] = static_cast<uint8_t>(i);
+                break;
+            case SelfTestVector::Header::Random:
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                work.header[i] = static_cast<uint8_t>(state);
+                break;
+        }
+    }
+    work.target.fill(0xFF);
+    work.valid = true;
+    return work;
+}
+
+}  // namespace
+
 Miner::Miner(unsigned index, const DeviceDescriptor& device)
     : m_index(index)
     , m_device(device)
+    , m_nonceSlot(index)
 {
 }
 
@@ -25,13 +69,18 @@ Miner::~Miner() {
     stop();
 }
 
-void Miner::start() {
+void Miner::start(bool paused) {
     if (m_running) {
         return;
     }
 
+    // Reap a thread that exited on its own
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
     m_running = true;
-    m_paused = false;
+    m_paused = paused;
     m_hashCount = 0;
     m_startTime = std::chrono::steady_clock::now();
 
@@ -42,18 +91,17 @@ void Miner::start() {
         } catch (const std::exception& e) {
             Log::error(getName() + " error: " + e.what());
         }
+        // A loop that gave up on the device leaves the miner stopped
+        m_running = false;
         Log::info(getName() + " stopped");
     });
 }
 
 void Miner::stop() {
-    if (!m_running) {
-        return;
-    }
-
     m_running = false;
     m_paused = false;
 
+    // Join even if the thread already exited on its own, so start() can run again
     if (m_thread.joinable()) {
         m_thread.join();
     }
@@ -71,11 +119,58 @@ void Miner::setWork(const WorkPackage& work) {
     // Clear submitted nonces when starting a new job
     if (jobChanged) {
         clearSubmittedNonces();
+
+        // Keep the earliest pending change if jobs arrive faster than the loop
+        int64_t expected = 0;
+        m_jobChangedAt.compare_exchange_strong(
+            expected, std::chrono::steady_clock::now().time_since_epoch().count());
     }
 
     m_newWork = true;
 }
 
+void Miner::clearNewWorkFlag() {
+    m_newWork = false;
+
+    int64_t changedAt = m_jobChangedAt.exchange(0);
+    if (changedAt != 0) {
+        auto now = std::chrono::steady_clock::now();
+        m_jobSwitchLatency.observe(
+            now - std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(changedAt)));
+    }
+}
+
+void Miner::recordBatch(uint64_t nonces, double seconds) {
+    m_lastBatchSize = nonces;
+    m_lastBatchTime = seconds;
+
+    if (seconds > 0 && m_batchSizer.record(static_cast<size_t>(nonces), seconds)) {
+        Log::debug(getName() + ": Batch size " + std::to_string(m_batchSizer.size()) + " (" +
+                   std::to_string(static_cast<int>(seconds * 1000)) + " ms for " + std::to_string(nonces) + " nonces)");
+    }
+}
+
+void Miner::throttle(std::chrono::steady_clock::duration busy) {
+    unsigned intensity = m_intensity;
+    if (intensity >= 100) {
+        return;
+    }
+
+    // Idle for (100 - intensity)% of each busy+idle cycle
+    auto idle = busy * (100 - intensity) / intensity;
+    auto until = std::chrono::steady_clock::now() + idle;
+
+    // Sleep in slices so new work and stop requests aren't delayed
+    while (m_running && !m_paused && !hasNewWork()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= until) {
+            break;
+        }
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+            until - now, std::chrono::milliseconds(10)));
+    }
+}
+
 void Miner::setSolutionCallback(SolutionCallback callback) {
     Guard lock(m_callbackMutex);
     m_solutionCallback = std::move(callback);
@@ -144,23 +239,31 @@ void Miner::updateHashCount(uint64_t count) {
     m_hashRateCalc.update(m_hashCount.load());
 }
 
-void Miner::submitSolution(const Solution& solution) {
+void Miner::submitSolution(const Solution& solution, const std::string& jobId) {
     Guard lock(m_callbackMutex);
     if (m_solutionCallback) {
-        m_solutionCallback(solution, m_work.jobId);
+        m_solutionCallback(solution, jobId);
     }
 }
 
 bool Miner::verifySolution(uint64_t nonce) {
     // Get current work
-    WorkPackage work = getWork();
+    return verifySolution(nonce, getWork());
+}
+
+bool Miner::verifySolution(uint64_t nonce, const WorkPackage& work) {
     if (!work.valid) {
         return false;
     }
 
+    // Submitted nonces are tracked for the current job only (cleared on a
+    // job change), so a previous job's solution skips the duplicate check
+    bool currentJob = work.jobId == getWork().jobId;
+
     // Check for duplicate before expensive verification
-    if (isDuplicateNonce(nonce)) {
-        Log::warning(getName() + ": Duplicate nonce " + std::to_string(nonce) + " (GPU fault?)");
+    if (currentJob && isDuplicateNonce(nonce)) {
+        Log::limited(LogLevel::Warning, LogCategory::Solution, getName() + ":duplicate",
+                     getName() + ": Duplicate nonce " + std::to_string(nonce) + " (GPU fault?)");
         {
             Guard lock(m_healthMutex);
             m_health.duplicateSolutions++;
@@ -170,31 +273,21 @@ bool Miner::verifySolution(uint64_t nonce) {
 
     // Validate nonce is within device's allocated range
     if (work.totalDevices > 1) {
-        uint64_t deviceStart = work.getDeviceStartNonce(m_index);
+        uint64_t deviceStart = work.getDeviceStartNonce(m_nonceSlot);
         uint64_t rangeSize = UINT64_MAX / work.totalDevices;
         uint64_t deviceEnd = deviceStart + rangeSize;
 
         // Check if nonce is outside this device's range
         if (nonce < deviceStart || (deviceEnd > deviceStart && nonce >= deviceEnd)) {
-            Log::warning(getName() + ": Nonce " + std::to_string(nonce) +
-                        " outside device range [" + std::to_string(deviceStart) +
-                        ", " + std::to_string(deviceEnd) + ") - possible GPU fault");
+            Log::limited(LogLevel::Warning, LogCategory::Solution, getName() + ":range",
+                         getName() + ": Nonce " + std::to_string(nonce) +
+                         " outside device range [" + std::to_string(deviceStart) +
+                         ", " + std::to_string(deviceEnd) + ") - possible GPU fault");
             return false;
         }
     }
 
-    // Prepare input with nonce
-    std::array<uint8_t, INPUT_SIZE> input;
-    std::memcpy(input.data(), work.header.data(), INPUT_SIZE);
-
-    // Set nonce at NONCE_OFFSET (bytes 40-47, big-endian)
-    for (int i = 0; i < 8; i++) {
-        input[NONCE_OFFSET + i] = static_cast<uint8_t>(nonce >> ((7 - i) * 8));
-    }
-
-    // Compute hash using thread-local hasher
-    Hash256 hash;
-    t_hasher.hash(input.data(), hash.data(), t_scratch);
+    Hash256 hash = computeHash(work, nonce);
 
     // Check if hash meets target
     if (meetsTarget(hash, work.target)) {
@@ -205,22 +298,154 @@ bool Miner::verifySolution(uint64_t nonce) {
         solution.deviceIndex = m_index;  // Track which device found it
 
         // Record this nonce to prevent duplicate submissions
-        recordSubmittedNonce(nonce);
+        if (currentJob) {
+            recordSubmittedNonce(nonce);
+        }
 
         // Update health metrics
         recordValidSolution();
 
-        Log::info(getName() + ": Verified solution nonce=" + std::to_string(nonce));
-        submitSolution(solution);
+        Log::info(getName() + ": Verified solution nonce=" + std::to_string(nonce) +
+                  (currentJob ? "" : " (previous job " + work.jobId + ")"));
+        submitSolution(solution, work.jobId);
         return true;
     } else {
         // Invalid solution - GPU reported false positive
         recordInvalidSolution();
-        Log::warning(getName() + ": Invalid solution discarded (nonce=" + std::to_string(nonce) + ")");
+        Log::limited(LogLevel::Warning, LogCategory::Solution, getName() + ":invalid",
+                     getName() + ": Invalid solution discarded (nonce=" + std::to_string(nonce) + ")");
         return false;
     }
 }
 
+Hash256 Miner::computeHash(const WorkPackage& work, uint64_t nonce) const {
+    // Prepare input with nonce
+    std::array<uint8_t, INPUT_SIZE> input;
+    std::memcpy(input.data(), work.header.data(), INPUT_SIZE);
+
+    // Set nonce at NONCE_OFFSET (bytes 40-47, big-endian)
+    for (int i = 0; i < 8; i++) {
+        input[NONCE_OFFSET + i] = static_cast<uint8_t>(nonce >> ((7 - i) * 8));
+    }
+
+    // Compute hash using thread-local hasher
+    Hash256 hash;
+    t_hasher.hash(input.data(), hash.data(), t_scratch);
+    return hash;
+}
+
+unsigned Miner::integrityBits(uint64_t batchSize) {
+    unsigned log2 = 0;
+    while (log2 < 63 && (uint64_t(1) << (log2 + 1)) <= batchSize) {
+        log2++;
+    }
+    return std::max(1u, log2 > 2 ? log2 - 2 : 1u);
+}
+
+Hash256 Miner::integrityTarget(unsigned bits) {
+    Hash256 target;
+    target.fill(0xFF);
+    for (unsigned i = 0; i < std::min(bits, 256u); i++) {
+        target[i / 8] &= static_cast<uint8_t>(~(0x80u >> (i % 8)));
+    }
+    return target;
+}
+
+void Miner::checkIntegrity(const WorkPackage& work, uint64_t hashes, unsigned bits,
+                           uint32_t hits, const uint32_t* nonces, uint32_t count) {
+    unsigned sample = s_integritySample;
+    if (sample == 0 || !work.valid) {
+        return;
+    }
+
+    Hash256 target = integrityTarget(bits);
+    uint64_t checked = 0;
+    uint64_t failed = 0;
+    uint64_t recent = 0;    // Results of this batch, oldest in the highest bit
+
+    for (uint32_t i = 0; i < count; i++) {
+        // Deterministic sampling: sample percent of all reported hits
+        m_integrityCredit += sample;
+        if (m_integrityCredit < 100) {
+            continue;
+        }
+        m_integrityCredit -= 100;
+
+        uint64_t nonce = nonces[i * 2] | (static_cast<uint64_t>(nonces[i * 2 + 1]) << 32);
+        bool ok = meetsTarget(computeHash(work, nonce), target);
+        checked++;
+        recent <<= 1;
+        if (!ok) {
+            failed++;
+            recent |= 1;
+            Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":integrity",
+                         getName() + ": Integrity check failed (nonce=" + std::to_string(nonce) +
+                         " does not meet the " + std::to_string(bits) + "-bit check target)");
+        }
+    }
+
+    Guard lock(m_healthMutex);
+    m_health.integrityHits += hits;
+    m_health.integrityExpected += std::ldexp(static_cast<double>(hashes), -static_cast<int>(bits));
+    if (checked == 0) {
+        return;
+    }
+    m_health.integrityChecked += checked;
+    m_health.integrityFailed += failed;
+    m_integrityRecent = checked >= 64 ? recent : (m_integrityRecent << checked) | recent;
+    m_integrityRecentCount = static_cast<unsigned>(std::min<uint64_t>(64, m_integrityRecentCount + checked));
+    updateHealthStatus();
+}
+
+bool Miner::hashBatch(const WorkPackage& work, uint64_t startNonce, unsigned count,
+                      std::vector<Hash256>& hashes) {
+    hashes.resize(count);
+    for (unsigned i = 0; i < count; i++) {
+        hashes[i] = computeHash(work, startNonce + i);
+    }
+    return true;
+}
+
+bool Miner::selfTest() {
+    auto start = std::chrono::steady_clock::now();
+    unsigned checked = 0;
+    bool passed = true;
+
+    for (size_t v = 0; v < sizeof(c_selfTestVectors) / sizeof(c_selfTestVectors[0]) && passed; v++) {
+        const SelfTestVector& vector = c_selfTestVectors[v];
+        WorkPackage work = selfTestWork(vector.header);
+
+        std::vector<Hash256> hashes;
+        if (!hashBatch(work, vector.startNonce, vector.count, hashes) || hashes.size() != vector.count) {
+            Log::error(getName() + ": Self-test failed: device could not hash vector " + std::to_string(v));
+            passed = false;
+            break;
+        }
+
+        for (unsigned i = 0; i < vector.count; i++) {
+            uint64_t nonce = vector.startNonce + i;
+            Hash256 expected = computeHash(work, nonce);
+            if (hashes[i] != expected) {
+                Log::error(getName() + ": Self-test failed: vector " + std::to_string(v) + ", nonce " +
+                           std::to_string(nonce) + " hashed to " + toHex(hashes[i]) + ", expected " +
+                           toHex(expected));
+                passed = false;
+                break;
+            }
+            checked++;
+        }
+    }
+
+    m_selfTestMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (passed) {
+        std::ostringstream ss;
+        ss << getName() << ": Self-test passed (" << checked << " known answers, "
+           << std::fixed << std::setprecision(0) << m_selfTestMs.load() << " ms)";
+        Log::info(ss.str());
+    }
+    return passed;
+}
+
 WorkPackage Miner::getWork() const {
     Guard lock(m_workMutex);
     return m_work;
@@ -264,6 +489,13 @@ DeviceHealth Miner::getHealth() const {
     return m_health;
 }
 
+void Miner::resetHealth() {
+    Guard lock(m_healthMutex);
+    m_health = DeviceHealth();
+    m_integrityRecent = 0;
+    m_integrityRecentCount = 0;
+}
+
 void Miner::recordValidSolution() {
     Guard lock(m_healthMutex);
     m_health.validSolutions++;
@@ -283,6 +515,11 @@ void Miner::recordHardwareError() {
     updateHealthStatus();
 }
 
+void Miner::recordOutputOverflow() {
+    Guard lock(m_healthMutex);
+    m_health.outputOverflows++;
+}
+
 void Miner::updateHealthStatus() {
     // Must be called with m_healthMutex held
 
@@ -304,37 +541,74 @@ void Miner::updateHealthStatus() {
     // Update last hash update time
     m_health.lastHashUpdate = std::chrono::steady_clock::now();
 
+    HealthStatus previous = m_health.status;
+    HealthStatus status = HealthStatus::Healthy;
+    std::ostringstream reason;
+    reason << std::fixed << std::setprecision(1);
+
     // Determine health status based on metrics
     double validity = m_health.getValidityRate();
     uint64_t totalSolutions = m_health.validSolutions + m_health.invalidSolutions;
 
     // Need some solutions before making judgments
-    if (totalSolutions < 5) {
-        m_health.status = HealthStatus::Healthy;
-        return;
-    }
+    if (totalSolutions >= 5) {
+        reason << "validity=" << validity * 100 << "%, errors=" << m_health.hardwareErrors;
 
-    // Check for failure conditions
-    if (m_health.hardwareErrors > 50 || validity < 0.5) {
-        m_health.status = HealthStatus::Failed;
-        Log::error(getName() + ": Device marked as FAILED (validity=" +
-                   std::to_string(validity * 100) + "%, errors=" +
-                   std::to_string(m_health.hardwareErrors) + ")");
+        // Check for failure conditions
+        if (m_health.hardwareErrors > 50 || validity < 0.5) {
+            status = HealthStatus::Failed;
+        }
+        // Check for unhealthy conditions
+        else if (validity < VALIDITY_THRESHOLD_UNHEALTHY || m_health.hardwareErrors > 20) {
+            status = HealthStatus::Unhealthy;
+        }
+        // Check for degraded conditions
+        else if (validity < VALIDITY_THRESHOLD_DEGRADED || m_health.hardwareErrors > 5) {
+            status = HealthStatus::Degraded;
+        }
     }
-    // Check for unhealthy conditions
-    else if (validity < VALIDITY_THRESHOLD_UNHEALTHY || m_health.hardwareErrors > 20) {
-        m_health.status = HealthStatus::Unhealthy;
-        Log::warning(getName() + ": Device health UNHEALTHY (validity=" +
-                     std::to_string(validity * 100) + "%)");
+
+    // Recent integrity samples: wrong hashes mean the device computes garbage
+    if (m_integrityRecentCount >= INTEGRITY_MIN_CHECKS) {
+        uint64_t window = m_integrityRecentCount >= 64 ? ~uint64_t(0) : (uint64_t(1) << m_integrityRecentCount) - 1;
+        unsigned failures = 0;
+        for (uint64_t bits = m_integrityRecent & window; bits; bits &= bits - 1) {
+            failures++;
+        }
+        double passed = 1.0 - static_cast<double>(failures) / m_integrityRecentCount;
+
+        HealthStatus integrity = HealthStatus::Healthy;
+        if (passed < 0.5) {
+            integrity = HealthStatus::Failed;
+        } else if (passed < VALIDITY_THRESHOLD_UNHEALTHY) {
+            integrity = HealthStatus::Unhealthy;
+        } else if (passed < VALIDITY_THRESHOLD_DEGRADED) {
+            integrity = HealthStatus::Degraded;
+        }
+        if (static_cast<int>(integrity) > static_cast<int>(status)) {
+            status = integrity;
+            reason.str("");
+            reason << "integrity=" << passed * 100 << "% of last " << m_integrityRecentCount << " samples";
+        }
     }
-    // Check for degraded conditions
-    else if (validity < VALIDITY_THRESHOLD_DEGRADED || m_health.hardwareErrors > 5) {
-        m_health.status = HealthStatus::Degraded;
-        Log::debug(getName() + ": Device health degraded (validity=" +
-                   std::to_string(validity * 100) + "%)");
+
+    m_health.status = status;
+    if (status == previous) {
+        return;
     }
-    else {
-        m_health.status = HealthStatus::Healthy;
+
+    switch (status) {
+        case HealthStatus::Failed:
+            Log::error(getName() + ": Device marked as FAILED (" + reason.str() + ")");
+            break;
+        case HealthStatus::Unhealthy:
+            Log::warning(getName() + ": Device health UNHEALTHY (" + reason.str() + ")");
+            break;
+        case HealthStatus::Degraded:
+            Log::debug(getName() + ": Device health degraded (" + reason.str() + ")");
+            break;
+        default:
+            break;
     }
 }
 
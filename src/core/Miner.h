@@ -8,14 +8,20 @@
 
 #include "Types.h"
 #include "WorkPackage.h"
+#include "BatchSizer.h"
+#include "DeviceTimeline.h"
 #include "util/Guards.h"
 #include "util/MovingAverage.h"
+#include "util/Histogram.h"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 #include <thread>
 #include <unordered_set>
+#include <vector>
 
 namespace tos {
 
@@ -43,6 +49,9 @@ struct DeviceDescriptor {
     // For GPU: compute units / multiprocessors
     unsigned computeUnits;
 
+    // For GPU: driver version (keys tuned settings; empty if unknown)
+    std::string driverVersion;
+
     // For OpenCL
     std::string clPlatformName;
     unsigned clPlatformIndex;
@@ -64,6 +73,18 @@ struct DeviceDescriptor {
         , cudaComputeCapabilityMajor(0)
         , cudaComputeCapabilityMinor(0)
     {}
+
+    /**
+     * Short name used in log lines (same as Miner::getName())
+     */
+    std::string shortName() const {
+        switch (type) {
+            case MinerType::CPU: return "CPU" + std::to_string(index);
+            case MinerType::OpenCL: return "CL" + std::to_string(index);
+            case MinerType::CUDA: return "CU" + std::to_string(index);
+            default: return "??" + std::to_string(index);
+        }
+    }
 };
 
 /**
@@ -103,11 +124,18 @@ struct DeviceHealth {
     uint64_t validSolutions{0};
     uint64_t invalidSolutions{0};
     uint64_t duplicateSolutions{0};
+    uint64_t outputOverflows{0};     // Batches with more solutions than buffer slots
 
     // Error statistics
     uint64_t hardwareErrors{0};      // Device/kernel errors
     uint64_t communicationErrors{0}; // Data transfer errors
 
+    // Integrity sampling (easy-target hits re-hashed on the CPU)
+    uint64_t integrityHits{0};       // Easy-target hits reported by the device
+    double integrityExpected{0};     // Hits expected for the hashes counted
+    uint64_t integrityChecked{0};    // Hits re-hashed on the CPU
+    uint64_t integrityFailed{0};     // ...that did not meet the easy target
+
     // Performance metrics
     double peakHashRate{0};          // Highest observed hash rate
     double currentHashRate{0};       // Current hash rate
@@ -123,6 +151,17 @@ struct DeviceHealth {
         return total > 0 ? static_cast<double>(validSolutions) / total : 1.0;
     }
 
+    // Estimated fraction of counted hashes that were computed correctly:
+    // easy-target hit yield times the verified fraction (1.0 until sampled)
+    double getIntegrityRatio() const {
+        if (integrityChecked == 0 || integrityExpected <= 0) {
+            return 1.0;
+        }
+        double yield = static_cast<double>(integrityHits) / integrityExpected;
+        double verified = 1.0 - static_cast<double>(integrityFailed) / integrityChecked;
+        return yield * verified;
+    }
+
     // Get error rate per solution
     double getErrorRate() const {
         uint64_t total = validSolutions + invalidSolutions;
@@ -175,8 +214,10 @@ public:
 
     /**
      * Start mining
+     *
+     * @param paused Start paused (farm paused or miner parked)
      */
-    void start();
+    void start(bool paused = false);
 
     /**
      * Stop mining
@@ -257,6 +298,136 @@ public:
      */
     bool isHealthy() const { return m_health.status == HealthStatus::Healthy; }
 
+    /**
+     * Get job switch latency histogram (new job set -> picked up by mining loop)
+     */
+    HistogramSnapshot getJobSwitchLatency() const { return m_jobSwitchLatency.snapshot(); }
+
+    /**
+     * Get device kernel, transfer and idle histograms (empty unless profiled)
+     */
+    TimelineStats getTimelineStats() const { return m_timeline.stats(); }
+
+    /**
+     * Get recently profiled batches in host steady_clock nanoseconds, oldest first
+     */
+    std::vector<BatchTiming> getRecentBatches() const { return m_timeline.recent(); }
+
+    /**
+     * Set mining intensity
+     *
+     * Sets the duty cycle: after each batch the device idles for
+     * (100 - percent)% of the cycle (see throttle). Takes effect on the
+     * next batch.
+     *
+     * @param percent Intensity 1-100 (100 = full speed)
+     */
+    void setIntensity(unsigned percent) {
+        m_intensity = std::min(100u, std::max(1u, percent));
+    }
+
+    /**
+     * Get mining intensity in percent
+     */
+    unsigned getIntensity() const { return m_intensity; }
+
+    /**
+     * Get nonces in the device's most recent batch (0 for CPU miners)
+     */
+    uint64_t getBatchSize() const { return m_lastBatchSize; }
+
+    /**
+     * Get kernel time of the most recent batch in seconds (0 if not measured)
+     */
+    double getBatchTime() const { return m_lastBatchTime; }
+
+    /**
+     * Set target kernel duration for GPU batches
+     *
+     * GPU backends time each batch and resize later ones to take about
+     * this long (see BatchSizer). Takes effect at the next init().
+     *
+     * @param ms Target per batch in milliseconds, 0 = fixed batch size
+     */
+    static void setBatchTarget(unsigned ms) { s_batchTargetMs = ms; }
+
+    /**
+     * Get target kernel duration in milliseconds (0 = fixed batch size)
+     */
+    static unsigned getBatchTarget() { return s_batchTargetMs; }
+
+    /**
+     * Set nonce range slot
+     *
+     * Each job's nonce space is split into WorkPackage::totalDevices
+     * ranges; the miner scans range number slot. Farm assigns one slot
+     * per miner. Defaults to the miner index.
+     */
+    void setNonceSlot(unsigned slot) { m_nonceSlot = slot; }
+
+    /**
+     * Get nonce range slot
+     */
+    unsigned getNonceSlot() const { return m_nonceSlot; }
+
+    /**
+     * Reset health metrics (e.g. after the device was reinitialized)
+     */
+    void resetHealth();
+
+    /**
+     * Set integrity sampling (GPU backends)
+     *
+     * Each batch also reports nonces whose hash meets an easy internal
+     * target (about four per batch). This share of them is hashed again
+     * on the CPU to catch devices computing wrong hashes long before a
+     * real share would. Easy-target hits are never submitted.
+     *
+     * @param percent Share of easy-target hits to verify, 0 = off
+     */
+    static void setIntegritySample(unsigned percent) { s_integritySample = std::min(100u, percent); }
+
+    /**
+     * Get integrity sampling percentage (0 = off)
+     */
+    static unsigned getIntegritySample() { return s_integritySample; }
+
+    /**
+     * Easy-target difficulty in bits for a batch size (about four hits per batch)
+     */
+    static unsigned integrityBits(uint64_t batchSize);
+
+    /**
+     * Target met by hashes with at least bits leading zero bits
+     */
+    static Hash256 integrityTarget(unsigned bits);
+
+    /**
+     * Run the known-answer self-test
+     *
+     * Hashes fixed headers and nonces on the device and compares them
+     * with the CPU reference. Farm runs it after init() and excludes
+     * devices that fail.
+     *
+     * @return true if every device hash matches the reference
+     */
+    bool selfTest();
+
+    /**
+     * Get duration of the last self-test in milliseconds
+     */
+    double getSelfTestTime() const { return m_selfTestMs; }
+
+    /**
+     * Enable or disable the startup self-test (default: enabled)
+     */
+    static void setSelfTestEnabled(bool enabled) { s_selfTest = enabled; }
+
+    /**
+     * Check if the startup self-test is enabled
+     */
+    static bool isSelfTestEnabled() { return s_selfTest; }
+
 protected:
     /**
      * Main mining loop - implemented by subclasses
@@ -278,8 +449,9 @@ protected:
      * Submit a found solution (after verification)
      *
      * @param solution The valid solution
+     * @param jobId Job the solution was found for
      */
-    void submitSolution(const Solution& solution);
+    void submitSolution(const Solution& solution, const std::string& jobId);
 
     /**
      * Verify and submit a solution
@@ -290,6 +462,70 @@ protected:
      */
     bool verifySolution(uint64_t nonce);
 
+    /**
+     * Verify and submit a solution for the work its batch was computed for
+     *
+     * Batches of the previous job may still finish after a job switch;
+     * their solutions are checked against and submitted for that job.
+     *
+     * @param nonce The nonce to verify
+     * @param work Work the batch was computed for
+     * @return true if solution was valid and submitted
+     */
+    bool verifySolution(uint64_t nonce, const WorkPackage& work);
+
+    /**
+     * Record a batch's easy-target hits and re-hash a sample on the CPU
+     *
+     * @param work Work the batch was computed for
+     * @param hashes Hashes in the batch
+     * @param bits Easy-target difficulty the batch used
+     * @param hits Hits counted by the device (may exceed the nonces reported)
+     * @param nonces Reported hit nonces as (low, high) 32-bit pairs
+     * @param count Number of nonces reported
+     */
+    void checkIntegrity(const WorkPackage& work, uint64_t hashes, unsigned bits,
+                        uint32_t hits, const uint32_t* nonces, uint32_t count);
+
+    /**
+     * Compute the hash of work with nonce on the CPU
+     */
+    Hash256 computeHash(const WorkPackage& work, uint64_t nonce) const;
+
+    /**
+     * Hash consecutive nonces on the device (used by the self-test)
+     *
+     * The default hashes on the CPU; GPU backends run their kernel.
+     *
+     * @param work Work with the header to hash
+     * @param startNonce First nonce
+     * @param count Number of nonces
+     * @param hashes Output, one hash per nonce
+     * @return true if the device computed the batch
+     */
+    virtual bool hashBatch(const WorkPackage& work, uint64_t startNonce, unsigned count,
+                           std::vector<Hash256>& hashes);
+
+    /**
+     * Record a completed GPU batch and let the batch sizer adjust
+     *
+     * @param nonces Nonces the batch covered
+     * @param seconds Kernel time, 0 if not measured
+     */
+    void recordBatch(uint64_t nonces, double seconds);
+
+    /**
+     * Idle after a batch to hold the duty cycle at the current intensity
+     *
+     * Sleeps busy * (100 - intensity) / intensity, in slices so new work,
+     * pause and stop requests aren't delayed. GPU backends pass the
+     * batch's kernel time and keep a single batch in flight while
+     * throttled, so the device itself idles.
+     *
+     * @param busy Time the device spent on the batch
+     */
+    void throttle(std::chrono::steady_clock::duration busy);
+
     /**
      * Get current work package (thread-safe copy)
      */
@@ -301,9 +537,9 @@ protected:
     bool hasNewWork() const { return m_newWork; }
 
     /**
-     * Clear new work flag
+     * Clear new work flag (records job switch latency for a new job)
      */
-    void clearNewWorkFlag() { m_newWork = false; }
+    void clearNewWorkFlag();
 
 protected:
     // Miner index
@@ -328,6 +564,24 @@ protected:
     // New work available flag
     std::atomic<bool> m_newWork{false};
 
+    // Job switch latency (steady_clock ticks of the pending job change, 0 = none)
+    std::atomic<int64_t> m_jobChangedAt{0};
+    LatencyHistogram m_jobSwitchLatency;
+
+    // Device-side batch timestamps (profiling backends only)
+    DeviceTimeline m_timeline;
+
+    // Intensity in percent (set by the power governor)
+    std::atomic<unsigned> m_intensity{100};
+
+    // Batch size controller (mining thread only) and the last batch, for reporting
+    BatchSizer m_batchSizer;
+    std::atomic<uint64_t> m_lastBatchSize{0};
+    std::atomic<double> m_lastBatchTime{0};
+
+    // Nonce range slot (see setNonceSlot)
+    std::atomic<unsigned> m_nonceSlot;
+
     // Hash counting (using SpinLock for high-frequency updates)
     std::atomic<uint64_t> m_hashCount{0};
     std::chrono::steady_clock::time_point m_startTime;
@@ -393,15 +647,37 @@ protected:
      */
     void recordHardwareError();
 
+    /**
+     * Record a batch whose solutions overflowed the output buffer
+     */
+    void recordOutputOverflow();
+
     /**
      * Update health status based on metrics
      */
     void updateHealthStatus();
 
+    // Recent integrity results (bit set = failed), newest in bit 0; guarded by m_healthMutex
+    uint64_t m_integrityRecent{0};
+    unsigned m_integrityRecentCount{0};
+
+    // Sampling accumulator (mining thread only)
+    unsigned m_integrityCredit{0};
+
+    static inline std::atomic<unsigned> s_integritySample{0};
+
+    // Duration of the last self-test
+    std::atomic<double> m_selfTestMs{0};
+
+    static inline std::atomic<bool> s_selfTest{true};
+
+    static inline std::atomic<unsigned> s_batchTargetMs{0};
+
     // Health thresholds
     static constexpr double VALIDITY_THRESHOLD_DEGRADED = 0.95;   // <95% valid = degraded
     static constexpr double VALIDITY_THRESHOLD_UNHEALTHY = 0.80;  // <80% valid = unhealthy
     static constexpr double HASHRATE_DROP_THRESHOLD = 0.5;        // 50% drop = concerning
+    static constexpr unsigned INTEGRITY_MIN_CHECKS = 16;          // Samples before judging integrity
 };
 
 }  // namespace tos
@@ -0,0 +1,108 @@
+/**
+ * TOS Miner - Output Sizer Implementation
+ */
+
+#include "OutputSizer.h"
+#include <algorithm>
+
+namespace tos {
+
+uint32_t OutputSizer::sized(uint32_t count) {
+    uint32_t size = 1;
+    while (size < count && size < MAX_OUTPUT_CAPACITY) {
+        size <<= 1;
+    }
+    uint64_t capacity = static_cast<uint64_t>(size) * HEADROOM;
+    return static_cast<uint32_t>(std::min<uint64_t>(MAX_OUTPUT_CAPACITY,
+                                                    std::max<uint64_t>(MIN_OUTPUT_CAPACITY, capacity)));
+}
+
+bool OutputSizer::record(uint32_t count, uint32_t capacity) {
+    m_peak = std::max(m_peak, count);
+    m_batches++;
+
+    uint32_t wanted = sized(count);
+    if (wanted > m_capacity) {
+        m_capacity = wanted;
+        m_peak = 0;
+        m_batches = 0;
+    } else if (m_batches >= WINDOW) {
+        m_capacity = sized(m_peak);
+        m_peak = 0;
+        m_batches = 0;
+    }
+
+    return count > capacity;
+}
+
+void OutputSizer::reset() {
+    m_capacity = MIN_OUTPUT_CAPACITY;
+    m_peak = 0;
+    m_batches = 0;
+}
+
+std::vector<NonceRange> OutputSizer::split(const NonceRange& range, unsigned parts, uint64_t granularity) {
+    granularity = std::max<uint64_t>(1, granularity);
+    uint64_t units = range.size / granularity;
+    parts = static_cast<unsigned>(std::min<uint64_t>(std::max(1u, parts), std::max<uint64_t>(1, units)));
+
+    // Spread whole units; the last range takes any remainder
+    std::vector<NonceRange> ranges;
+    uint64_t start = range.start;
+    uint64_t end = range.start + range.size;
+    for (unsigned i = 0; i < parts; i++) {
+        uint64_t size = i + 1 < parts ? (units / parts + (i < units % parts ? 1 : 0)) * granularity
+                                      : end - start;
+        ranges.push_back({start, size});
+        start += size;
+    }
+    return ranges;
+}
+
+RescanResult OutputSizer::rescan(const NonceRange& range, uint64_t granularity, std::set<uint64_t>& seen,
+                                 const RangeSearch& search, std::vector<uint64_t>& found) {
+    RescanResult result;
+
+    struct Pending {
+        NonceRange range;
+        unsigned depth;
+    };
+    std::vector<Pending> pending;
+    for (const NonceRange& part : split(range, RESCAN_SPLIT, granularity)) {
+        pending.push_back({part, 1});
+    }
+
+    std::vector<uint64_t> nonces;
+    while (!pending.empty()) {
+        Pending next = pending.back();
+        pending.pop_back();
+
+        nonces.clear();
+        uint32_t count = 0;
+        result.launches++;
+        if (!search(next.range, nonces, count)) {
+            result.ok = false;
+            return result;
+        }
+
+        // Take what fit; a part that overflowed again is searched in smaller
+        // ranges, which find these nonces again (skipped as seen)
+        for (uint64_t nonce : nonces) {
+            if (seen.insert(nonce).second) {
+                found.push_back(nonce);
+            }
+        }
+        if (count > nonces.size()) {
+            if (next.depth < RESCAN_DEPTH && next.range.size > granularity) {
+                for (const NonceRange& part : split(next.range, RESCAN_SPLIT, granularity)) {
+                    pending.push_back({part, next.depth + 1});
+                }
+            } else {
+                result.unresolved++;
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace tos
@@ -0,0 +1,123 @@
+/**
+ * TOS Miner - Output Sizer
+ *
+ * Sizes GPU solution buffers to the observed hit rate and re-searches
+ * nonce ranges whose solutions did not fit.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <vector>
+
+namespace tos {
+
+// Solution slots a GPU batch may be given; device buffers hold the maximum
+constexpr uint32_t MIN_OUTPUT_CAPACITY = 64;
+constexpr uint32_t MAX_OUTPUT_CAPACITY = 1024;
+
+/**
+ * Nonces searched by one launch
+ */
+struct NonceRange {
+    uint64_t start = 0;
+    uint64_t size = 0;
+};
+
+/**
+ * Outcome of re-searching an overflowed range
+ */
+struct RescanResult {
+    bool ok = true;           // false if a launch failed
+    unsigned launches = 0;    // Ranges searched
+    unsigned unresolved = 0;  // Ranges that still overflowed at the split limit
+};
+
+/**
+ * Solution buffer capacity controller
+ *
+ * The kernels count every hit but store only as many as the batch's
+ * capacity, so a count above the capacity means solutions were dropped.
+ * The backend records each batch's count:
+ *
+ * - A batch using more than 1/HEADROOM of the capacity grows it at once,
+ *   to HEADROOM times the count rounded up to a power of two.
+ * - Every WINDOW batches the capacity shrinks to the same headroom over
+ *   the window's peak count.
+ * - Capacity stays within [MIN_OUTPUT_CAPACITY, MAX_OUTPUT_CAPACITY].
+ *
+ * Not thread-safe; owned by the mining thread.
+ */
+class OutputSizer {
+public:
+    /**
+     * Search one range on the device with MAX_OUTPUT_CAPACITY slots
+     *
+     * Stores the nonces the device returned in nonces and the hits it
+     * counted (possibly more) in count; returns false on a device error.
+     */
+    using RangeSearch = std::function<bool(const NonceRange& range, std::vector<uint64_t>& nonces,
+                                           uint32_t& count)>;
+
+    /**
+     * Get the capacity for the next batch
+     */
+    uint32_t capacity() const { return m_capacity; }
+
+    /**
+     * Record a completed batch's solution count
+     *
+     * @param count Hits the kernel counted
+     * @param capacity Capacity the batch ran with
+     * @return true if the batch overflowed (count above its capacity)
+     */
+    bool record(uint32_t count, uint32_t capacity);
+
+    /**
+     * Return to the minimum capacity
+     */
+    void reset();
+
+    /**
+     * Split a range into up to parts ranges that are multiples of granularity
+     *
+     * @param range Range to split (size a multiple of granularity)
+     * @param parts Ranges wanted
+     * @param granularity Launch size granularity (e.g. work group size)
+     */
+    static std::vector<NonceRange> split(const NonceRange& range, unsigned parts, uint64_t granularity);
+
+    /**
+     * Re-search an overflowed range in smaller launches
+     *
+     * The range is split into RESCAN_SPLIT parts; parts that overflow
+     * again are split further, up to RESCAN_DEPTH levels.
+     *
+     * @param range Range whose solutions overflowed
+     * @param granularity Launch size granularity
+     * @param seen Nonces already taken from the range (updated)
+     * @param search Runs one range on the device
+     * @param found Nonces not seen before (appended)
+     */
+    static RescanResult rescan(const NonceRange& range, uint64_t granularity, std::set<uint64_t>& seen,
+                               const RangeSearch& search, std::vector<uint64_t>& found);
+
+    // Batches between shrink steps
+    static constexpr unsigned WINDOW = 64;
+    // Capacity kept per hit counted
+    static constexpr uint32_t HEADROOM = 4;
+    // Ranges an overflowed range is split into, and how many times
+    static constexpr unsigned RESCAN_SPLIT = 8;
+    static constexpr unsigned RESCAN_DEPTH = 2;
+
+private:
+    static uint32_t sized(uint32_t count);
+
+    uint32_t m_capacity = MIN_OUTPUT_CAPACITY;
+    uint32_t m_peak = 0;
+    unsigned m_batches = 0;
+};
+
+}  // namespace tos
@@ -0,0 +1,123 @@
+/**
+ * TOS Miner - GPU Pipeline Slots
+ *
+ * Tracks which of a GPU backend's batch slots (buffers plus their events,
+ * streams or queue entries) are in flight
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace tos {
+
+// Most batches a GPU backend keeps in flight
+constexpr unsigned MAX_PIPELINE_DEPTH = 8;
+
+/**
+ * Slot bookkeeping for an N-deep batch pipeline
+ *
+ * A backend owns one set of buffers per slot. Launching a batch takes a
+ * free slot; once its results are processed the slot is released and can
+ * be reused. Slots may complete and be released in any order, so
+ * inFlight() lists them in launch order for backends that look for any
+ * finished batch before waiting on the oldest.
+ */
+class PipelineSlots {
+public:
+    /**
+     * @param depth Number of slots (clamped to 1 .. MAX_PIPELINE_DEPTH)
+     */
+    explicit PipelineSlots(unsigned depth = 2) { reset(depth); }
+
+    /**
+     * Resize to depth slots, all free
+     */
+    void reset(unsigned depth) {
+        m_launched.assign(clampDepth(depth), 0);
+        m_next = 1;
+    }
+
+    /**
+     * Release every slot (results discarded)
+     */
+    void clear() { std::fill(m_launched.begin(), m_launched.end(), 0); }
+
+    /**
+     * Get number of slots
+     */
+    unsigned depth() const { return static_cast<unsigned>(m_launched.size()); }
+
+    /**
+     * Get number of slots in flight
+     */
+    unsigned busy() const {
+        return static_cast<unsigned>(std::count_if(m_launched.begin(), m_launched.end(),
+                                                   [](uint64_t l) { return l != 0; }));
+    }
+
+    bool empty() const { return busy() == 0; }
+    bool full() const { return busy() == depth(); }
+
+    /**
+     * Take a free slot for a new batch
+     *
+     * @return Slot index, or -1 if all slots are in flight
+     */
+    int acquire() {
+        for (size_t i = 0; i < m_launched.size(); i++) {
+            if (m_launched[i] == 0) {
+                m_launched[i] = m_next++;
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Free a slot after its batch was processed
+     */
+    void release(unsigned slot) {
+        if (slot < m_launched.size()) {
+            m_launched[slot] = 0;
+        }
+    }
+
+    /**
+     * Slots in flight, oldest launch first
+     */
+    std::vector<unsigned> inFlight() const {
+        std::vector<unsigned> slots;
+        for (size_t i = 0; i < m_launched.size(); i++) {
+            if (m_launched[i] != 0) {
+                slots.push_back(static_cast<unsigned>(i));
+            }
+        }
+        std::sort(slots.begin(), slots.end(),
+                  [this](unsigned a, unsigned b) { return m_launched[a] < m_launched[b]; });
+        return slots;
+    }
+
+    /**
+     * Get the oldest slot in flight (-1 if none)
+     */
+    int oldest() const {
+        auto slots = inFlight();
+        return slots.empty() ? -1 : static_cast<int>(slots.front());
+    }
+
+    /**
+     * Clamp a requested depth to 1 .. MAX_PIPELINE_DEPTH
+     */
+    static unsigned clampDepth(unsigned depth) {
+        return std::min(MAX_PIPELINE_DEPTH, std::max(1u, depth));
+    }
+
+private:
+    std::vector<uint64_t> m_launched;  // Launch sequence per slot, 0 = free
+    uint64_t m_next = 1;
+};
+
+}  // namespace tos
@@ -0,0 +1,180 @@
+/**
+ * TOS Miner - Power Governor Implementation
+ */
+
+#include "PowerGovernor.h"
+#include "util/Log.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace tos {
+
+PowerGovernor::PowerGovernor(const GovernorConfig& config, Actuator actuator)
+    : m_config(config)
+    , m_actuator(std::move(actuator))
+{
+    m_config.minIntensity = std::min(100u, std::max(1u, m_config.minIntensity));
+    m_config.step = std::max(1u, m_config.step);
+    m_config.hysteresis = std::max(0, m_config.hysteresis);
+}
+
+void PowerGovernor::update(const TelemetrySnapshot& snapshot) {
+    std::vector<GovernorDecision> decisions;
+
+    {
+        Guard lock(m_mutex);
+
+        if (m_devices.size() < snapshot.devices.size()) {
+            m_devices.resize(snapshot.devices.size());
+        }
+
+        std::vector<unsigned> cpuMiners;
+        for (size_t i = 0; i < snapshot.devices.size(); i++) {
+            const DeviceTelemetry& dev = snapshot.devices[i];
+            unsigned index = static_cast<unsigned>(i);
+
+            if (dev.failed) {
+                continue;
+            }
+            if (dev.device.type == MinerType::CPU) {
+                cpuMiners.push_back(index);
+                continue;
+            }
+            if (!dev.gpu.valid) {
+                continue;
+            }
+
+            double rate = dev.windows.s10 > 0 ? dev.windows.s10 : dev.hashRate.effectiveRate();
+            GovernorDecision decision{index, 0, 0, {}};
+            if (step(m_devices[i], dev.gpu.temperature, dev.gpu.powerUsage, rate, decision)) {
+                Log::info(dev.device.shortName() + ": Governor " + std::to_string(decision.from) + "% -> " +
+                          std::to_string(decision.to) + "% (" + decision.reason + ")");
+                decisions.push_back(decision);
+            }
+        }
+
+        // CPU threads share the package sensors, so one decision made from
+        // package temperature and power applies to all of them
+        if (!cpuMiners.empty() && snapshot.cpu.valid) {
+            int power = snapshot.cpu.packagePower >= 0
+                ? static_cast<int>(std::lround(snapshot.cpu.packagePower)) : -1;
+            GovernorDecision decision{0, 0, 0, {}};
+            if (step(m_cpu, snapshot.cpu.temperature, power, snapshot.cpuHashRate, decision)) {
+                Log::info("CPU: Governor " + std::to_string(decision.from) + "% -> " +
+                          std::to_string(decision.to) + "% (" + decision.reason + ", " +
+                          std::to_string(cpuMiners.size()) + " thread(s))");
+            }
+
+            // Also brings threads that joined or recovered since in line
+            for (unsigned index : cpuMiners) {
+                DeviceState& state = m_devices[index];
+                if (state.intensity != m_cpu.intensity) {
+                    decisions.push_back({index, state.intensity, m_cpu.intensity,
+                                         decision.reason.empty() ? "CPU package" : decision.reason});
+                    state.intensity = m_cpu.intensity;
+                }
+            }
+        }
+    }
+
+    // Apply outside the lock
+    for (const auto& decision : decisions) {
+        if (m_actuator) {
+            m_actuator(decision);
+        }
+    }
+}
+
+bool PowerGovernor::step(DeviceState& state, int temp, int power, double rate, GovernorDecision& decision) {
+    bool haveTemp = m_config.tempTarget > 0 && temp >= 0;
+    bool havePower = m_config.powerCap > 0 && power >= 0;
+    if (!haveTemp && !havePower) {
+        return false;
+    }
+
+    if (state.ceilingTicks > 0 && --state.ceilingTicks == 0) {
+        state.ceiling = 100;
+    }
+
+    if (state.settle > 0) {
+        state.settle--;
+        return false;
+    }
+
+    double efficiency = power > 0 && rate > 0 ? rate / power : 0;
+
+    auto decide = [&](unsigned to, const std::string& reason) {
+        if (to == state.intensity) {
+            return false;
+        }
+        decision.from = state.intensity;
+        decision.to = to;
+        decision.reason = reason;
+        state.intensity = to;
+        state.settle = m_config.settleTicks;
+        return true;
+    };
+
+    // Over a cap: step down, harder the further over
+    bool overTemp = haveTemp && temp > m_config.tempTarget;
+    bool overPower = havePower && power > m_config.powerCap;
+    if (overTemp || overPower) {
+        unsigned steps = 1;
+        std::string reason;
+        if (overTemp) {
+            unsigned over = static_cast<unsigned>(temp - m_config.tempTarget);
+            steps = std::max(steps, 1 + over / static_cast<unsigned>(std::max(1, m_config.hysteresis)));
+            reason = std::to_string(temp) + "C above " + std::to_string(m_config.tempTarget) + "C target";
+        }
+        if (overPower) {
+            unsigned overPct = static_cast<unsigned>((power - m_config.powerCap) * 100 / m_config.powerCap);
+            steps = std::max(steps, 1 + overPct / 5);
+            reason += (reason.empty() ? "" : ", ") + std::to_string(power) + "W above " +
+                      std::to_string(m_config.powerCap) + "W cap";
+        }
+
+        unsigned cut = std::min(state.intensity, m_config.step * steps);
+        state.raisedFromEfficiency = 0;
+        return decide(std::max(m_config.minIntensity, state.intensity - cut), reason);
+    }
+
+    // Last raise cost efficiency: undo it and hold there for a while
+    if (state.raisedFromEfficiency > 0 && efficiency > 0) {
+        double before = state.raisedFromEfficiency;
+        state.raisedFromEfficiency = 0;
+
+        if (efficiency < before * (1.0 - m_config.efficiencyTolerance)) {
+            unsigned to = std::max(m_config.minIntensity, state.intensity - std::min(state.intensity, m_config.step));
+            state.ceiling = to;
+            state.ceilingTicks = m_config.holdTicks;
+
+            std::ostringstream reason;
+            reason << std::fixed << std::setprecision(1)
+                   << "efficiency fell from " << before << " to " << efficiency << " H/s/W";
+            return decide(to, reason.str());
+        }
+    }
+
+    // Comfortably under all caps: step up towards the ceiling
+    bool cool = !haveTemp || temp <= m_config.tempTarget - m_config.hysteresis;
+    bool underPower = !havePower || power * 100 <= m_config.powerCap * 95;
+    unsigned limit = std::min(100u, state.ceiling);
+
+    if (cool && underPower && state.intensity < limit) {
+        std::string reason = haveTemp
+            ? std::to_string(temp) + "C below " + std::to_string(m_config.tempTarget) + "C target"
+            : std::to_string(power) + "W below " + std::to_string(m_config.powerCap) + "W cap";
+        state.raisedFromEfficiency = efficiency;
+        return decide(std::min(limit, state.intensity + m_config.step), reason);
+    }
+    return false;
+}
+
+unsigned PowerGovernor::getIntensity(unsigned index) const {
+    Guard lock(m_mutex);
+    return index < m_devices.size() ? m_devices[index].intensity : 100;
+}
+
+}  // namespace tos
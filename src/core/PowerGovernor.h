@@ -0,0 +1,98 @@
+/**
+ * TOS Miner - Power Governor
+ *
+ * Closed-loop intensity control that keeps each device under a
+ * temperature and/or power cap while favouring hash rate per watt.
+ */
+
+#pragma once
+
+#include "Telemetry.h"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tos {
+
+/**
+ * A single governor decision (logged and passed to the actuator)
+ */
+struct GovernorDecision {
+    unsigned index;                 // Miner index
+    unsigned from;                  // Previous intensity
+    unsigned to;                    // New intensity
+    std::string reason;
+};
+
+/**
+ * Power governor
+ *
+ * Runs one control step per telemetry snapshot. For each device with
+ * sensor data:
+ *
+ * - Above the temperature target or power cap: step intensity down,
+ *   in larger steps the further over the cap it is.
+ * - Below target - hysteresis and under the power cap (with a 5% band):
+ *   step intensity up, unless the previous raise cost more than
+ *   efficiencyTolerance of H/s per watt, in which case the raise is
+ *   undone and that level becomes a ceiling for holdTicks.
+ * - Otherwise hold.
+ *
+ * After each change the device is left alone for settleTicks so that
+ * temperature and the 10 s hash rate window reflect the new level.
+ *
+ * CPU miners have no sensors of their own: all CPU threads are governed
+ * together from the package temperature and power (CpuMonitor), so the
+ * power cap applies to the whole package rather than to each thread.
+ */
+class PowerGovernor {
+public:
+    using Actuator = std::function<void(const GovernorDecision&)>;
+
+    /**
+     * Constructor
+     *
+     * @param config Governor settings
+     * @param actuator Applies decisions (e.g. Farm::setMinerIntensity)
+     */
+    PowerGovernor(const GovernorConfig& config, Actuator actuator);
+
+    /**
+     * Run one control step
+     *
+     * @param snapshot Current telemetry (sensors, hash rates)
+     */
+    void update(const TelemetrySnapshot& snapshot);
+
+    /**
+     * Get current intensity of a device in percent (100 if unknown)
+     */
+    unsigned getIntensity(unsigned index) const;
+
+    /**
+     * Get governor settings
+     */
+    const GovernorConfig& getConfig() const { return m_config; }
+
+private:
+    struct DeviceState {
+        unsigned intensity{100};
+        unsigned settle{0};             // Ticks until the next decision
+        unsigned ceiling{100};          // Efficiency ceiling
+        unsigned ceilingTicks{0};       // Ticks until the ceiling expires
+        double raisedFromEfficiency{0}; // H/s per W before the last raise (0 = none pending)
+    };
+
+    // One control step on a reading; fills decision (not index) on a change
+    bool step(DeviceState& state, int temp, int power, double rate, GovernorDecision& decision);
+
+    GovernorConfig m_config;
+    Actuator m_actuator;
+
+    std::vector<DeviceState> m_devices;
+    DeviceState m_cpu;                  // Shared by all CPU miners
+    mutable std::mutex m_mutex;
+};
+
+}  // namespace tos
@@ -0,0 +1,223 @@
+/**
+ * TOS Miner - Failed Device Recovery Supervisor Implementation
+ */
+
+#include "RecoverySupervisor.h"
+#include "util/Log.h"
+#include <algorithm>
+#include <vector>
+
+namespace tos {
+
+namespace {
+
+double seconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double>(d).count();
+}
+
+}  // namespace
+
+RecoverySupervisor::RecoverySupervisor(Farm& farm, const RecoveryConfig& config)
+    : m_farm(farm)
+    , m_config(config)
+{
+    m_config.initialBackoff = std::max(1u, m_config.initialBackoff);
+    m_config.maxBackoff = std::max(m_config.initialBackoff, m_config.maxBackoff);
+}
+
+RecoverySupervisor::~RecoverySupervisor() {
+    stop();
+}
+
+void RecoverySupervisor::start() {
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&RecoverySupervisor::run, this);
+}
+
+void RecoverySupervisor::stop() {
+    if (!m_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void RecoverySupervisor::run() {
+    while (m_running) {
+        try {
+            poll();
+        } catch (const std::exception& e) {
+            Log::limited(LogLevel::Error, LogCategory::General, "recovery:poll",
+                         "Device recovery failed: " + std::string(e.what()));
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait_for(lock, std::chrono::seconds(1), [this]() { return !m_running; });
+    }
+}
+
+RecoverySupervisor::Clock::duration RecoverySupervisor::backoff(unsigned attempts) const {
+    uint64_t delay = m_config.initialBackoff;
+    for (unsigned i = 0; i < attempts && delay < m_config.maxBackoff; i++) {
+        delay *= 2;
+    }
+    return std::chrono::seconds(std::min<uint64_t>(delay, m_config.maxBackoff));
+}
+
+std::string RecoverySupervisor::deviceName(unsigned index) const {
+    auto devices = m_farm.getDevices();
+    return index < devices.size() ? devices[index].shortName() : "Miner " + std::to_string(index);
+}
+
+void RecoverySupervisor::poll(Clock::time_point now) {
+    if (!m_farm.isRunning()) {
+        return;
+    }
+
+    unsigned count = static_cast<unsigned>(m_farm.minerCount());
+
+    // Isolate devices that failed without the farm noticing
+    for (unsigned i = 0; i < count; i++) {
+        if (m_farm.isMinerFailed(i)) {
+            continue;
+        }
+        if (m_farm.getMinerHealth(i).status == HealthStatus::Failed) {
+            m_farm.markMinerFailed(i);
+        } else if (!m_farm.isMinerRunning(i) && m_farm.isRunning()) {
+            Log::warning(deviceName(i) + ": Mining thread exited");
+            m_farm.markMinerFailed(i);
+        }
+    }
+
+    // Schedule newly failed devices, collect due attempts
+    std::vector<unsigned> due;
+    {
+        Guard lock(m_mutex);
+        for (unsigned i = 0; i < count; i++) {
+            bool failed = m_farm.isMinerFailed(i);
+            auto it = m_devices.find(i);
+
+            if (!failed) {
+                // Recovered elsewhere (e.g. Farm::recoverFailedMiners)
+                if (it != m_devices.end() && (it->second.pending || it->second.gaveUp)) {
+                    it->second.pending = false;
+                    it->second.gaveUp = false;
+                    it->second.attempts = 0;
+                }
+                continue;
+            }
+
+            DeviceState& state = m_devices[i];
+            if (state.gaveUp) {
+                continue;
+            }
+            if (!state.pending) {
+                // A device that fails soon after recovering keeps its backoff
+                if (!state.recovered || now - state.recoveredAt >= std::chrono::seconds(m_config.stableSeconds)) {
+                    state.attempts = 0;
+                }
+                if (state.attempts >= m_config.maxAttempts) {
+                    state.gaveUp = true;
+                    Log::error(deviceName(i) + ": Failed again after " + std::to_string(state.attempts) +
+                               " recovery attempt(s), giving up");
+                    continue;
+                }
+                state.pending = true;
+                state.nextAttempt = now + backoff(state.attempts);
+                Log::warning(deviceName(i) + ": Failed, recovery attempt " + std::to_string(state.attempts + 1) +
+                             " of " + std::to_string(m_config.maxAttempts) + " in " +
+                             std::to_string(static_cast<int>(seconds(state.nextAttempt - now))) + "s");
+            }
+            if (now >= state.nextAttempt) {
+                due.push_back(i);
+            }
+        }
+    }
+
+    // Reinitializing a device can take seconds: no supervisor lock held
+    for (unsigned i : due) {
+        bool success = m_farm.recoverMiner(i);
+        std::string name = deviceName(i);
+
+        Guard lock(m_mutex);
+        DeviceState& state = m_devices[i];
+        state.attempts++;
+
+        m_history.push_back({i, name, state.attempts, success, now});
+        while (m_history.size() > std::max(1u, m_config.historySize)) {
+            m_history.pop_front();
+        }
+
+        if (success) {
+            m_recoveries++;
+            state.pending = false;
+            state.recovered = true;
+            state.recoveredAt = now;
+        } else if (!m_farm.isRunning()) {
+            // Farm stopped meanwhile: not the device's fault
+            state.attempts--;
+            m_history.pop_back();
+        } else {
+            m_failures++;
+            if (state.attempts >= m_config.maxAttempts) {
+                state.pending = false;
+                state.gaveUp = true;
+                Log::error(name + ": Recovery failed " + std::to_string(state.attempts) +
+                           " time(s), giving up");
+            } else {
+                state.nextAttempt = now + backoff(state.attempts);
+                Log::warning(name + ": Recovery attempt " + std::to_string(state.attempts) +
+                             " failed, retrying in " +
+                             std::to_string(static_cast<int>(seconds(state.nextAttempt - now))) + "s");
+            }
+        }
+    }
+}
+
+RecoveryTelemetry RecoverySupervisor::getTelemetry(Clock::time_point now) const {
+    RecoveryTelemetry result;
+
+    Guard lock(m_mutex);
+    result.recoveries = m_recoveries;
+    result.failures = m_failures;
+
+    for (const auto& entry : m_devices) {
+        const DeviceState& state = entry.second;
+        if (!state.pending && !state.gaveUp) {
+            continue;
+        }
+        DeviceRecovery device;
+        device.index = entry.first;
+        device.device = deviceName(entry.first);
+        device.gaveUp = state.gaveUp;
+        device.attempts = state.attempts;
+        device.nextAttempt = state.pending ? std::max(0.0, seconds(state.nextAttempt - now)) : 0;
+        result.devices.push_back(device);
+    }
+
+    for (auto it = m_history.rbegin(); it != m_history.rend(); ++it) {
+        RecoveryEvent event;
+        event.index = it->index;
+        event.device = it->device;
+        event.attempt = it->attempt;
+        event.success = it->success;
+        event.age = std::max(0.0, seconds(now - it->time));
+        result.history.push_back(event);
+    }
+
+    return result;
+}
+
+}  // namespace tos
@@ -0,0 +1,132 @@
+/**
+ * TOS Miner - Failed Device Recovery Supervisor
+ *
+ * Retries failed devices in the background with exponential backoff.
+ */
+
+#pragma once
+
+#include "Farm.h"
+#include "Types.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace tos {
+
+/**
+ * Recovery supervisor
+ *
+ * Polls the farm once per second. A device counts as failed when the farm
+ * isolated it (markMinerFailed, init failure at start), its health status
+ * is Failed, or its mining loop gave up and exited. Failed devices are
+ * reinitialized through Farm::recoverMiner() after initialBackoff seconds,
+ * doubling up to maxBackoff after each failed attempt, and left failed
+ * after maxAttempts.
+ *
+ * A device that fails again within stableSeconds of a recovery continues
+ * its backoff sequence instead of starting over, so a flapping device
+ * still runs out of attempts.
+ */
+class RecoverySupervisor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Constructor
+     *
+     * @param farm Farm to supervise
+     * @param config Backoff and attempt limits
+     */
+    explicit RecoverySupervisor(Farm& farm, const RecoveryConfig& config = RecoveryConfig());
+
+    /**
+     * Destructor
+     */
+    ~RecoverySupervisor();
+
+    // Non-copyable
+    RecoverySupervisor(const RecoverySupervisor&) = delete;
+    RecoverySupervisor& operator=(const RecoverySupervisor&) = delete;
+
+    /**
+     * Start the supervisor thread
+     */
+    void start();
+
+    /**
+     * Stop the supervisor thread (waits for an attempt in progress)
+     */
+    void stop();
+
+    /**
+     * Detect failures and run due recovery attempts
+     *
+     * Called once per second by the supervisor thread; tests call it
+     * directly instead of start(). Attempts run on the calling thread.
+     *
+     * @param now Current time
+     */
+    void poll(Clock::time_point now = Clock::now());
+
+    /**
+     * Get recovery state and history
+     *
+     * @param now Current time (for relative times)
+     */
+    RecoveryTelemetry getTelemetry(Clock::time_point now = Clock::now()) const;
+
+    /**
+     * Delay before an attempt
+     *
+     * @param attempts Attempts already made
+     */
+    Clock::duration backoff(unsigned attempts) const;
+
+    /**
+     * Get supervisor settings
+     */
+    const RecoveryConfig& getConfig() const { return m_config; }
+
+private:
+    struct DeviceState {
+        bool pending{false};            // Failed, waiting for an attempt
+        bool gaveUp{false};
+        unsigned attempts{0};
+        Clock::time_point nextAttempt;
+        Clock::time_point recoveredAt;  // Last successful attempt
+        bool recovered{false};
+    };
+
+    struct Event {
+        unsigned index;
+        std::string device;
+        unsigned attempt;
+        bool success;
+        Clock::time_point time;
+    };
+
+    void run();
+
+    std::string deviceName(unsigned index) const;
+
+    Farm& m_farm;
+    RecoveryConfig m_config;
+
+    mutable std::mutex m_mutex;
+    std::map<unsigned, DeviceState> m_devices;
+    std::deque<Event> m_history;        // Oldest first
+    uint64_t m_recoveries{0};
+    uint64_t m_failures{0};
+
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+};
+
+}  // namespace tos
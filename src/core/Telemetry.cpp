@@ -0,0 +1,262 @@
+/**
+ * TOS Miner - Telemetry Sampler Implementation
+ */
+
+#include "Telemetry.h"
+#include "util/Log.h"
+#include <algorithm>
+
+namespace tos {
+
+Telemetry::Telemetry(Farm& farm)
+    : m_farm(farm)
+{
+}
+
+Telemetry::~Telemetry() {
+    stop();
+}
+
+void Telemetry::setPoolSource(PoolSource source) {
+    Guard lock(m_sampleMutex);
+    m_poolSource = std::move(source);
+}
+
+void Telemetry::setRecoverySource(RecoverySource source) {
+    Guard lock(m_sampleMutex);
+    m_recoverySource = std::move(source);
+}
+
+void Telemetry::setAnomalyConfig(const AnomalyConfig& config) {
+    Guard lock(m_sampleMutex);
+    m_anomalies = AnomalyDetector(config);
+}
+
+unsigned Telemetry::addListener(Listener listener) {
+    Guard lock(m_listenersMutex);
+    unsigned id = m_nextListenerId++;
+    m_listeners.emplace_back(id, std::move(listener));
+    return id;
+}
+
+void Telemetry::removeListener(unsigned id) {
+    Guard lock(m_listenersMutex);
+    m_listeners.erase(
+        std::remove_if(m_listeners.begin(), m_listeners.end(),
+                       [id](const std::pair<unsigned, Listener>& l) { return l.first == id; }),
+        m_listeners.end());
+}
+
+void Telemetry::start() {
+    if (m_running) {
+        return;
+    }
+
+    // Consumers get a valid snapshot immediately
+    sample();
+
+    m_running = true;
+    m_thread = std::thread(&Telemetry::run, this);
+}
+
+void Telemetry::stop() {
+    if (!m_running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void Telemetry::run() {
+    auto next = std::chrono::steady_clock::now();
+
+    while (m_running) {
+        next += std::chrono::milliseconds(s_intervalMs);
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait_until(lock, next, [this]() { return !m_running; });
+        }
+        if (!m_running) {
+            break;
+        }
+
+        try {
+            sample();
+        } catch (const std::exception& e) {
+            Log::limited(LogLevel::Error, LogCategory::General, "telemetry:sample",
+                         "Telemetry sample failed: " + std::string(e.what()));
+        }
+
+        // Don't try to catch up after a long stall (e.g. suspend)
+        auto now = std::chrono::steady_clock::now();
+        if (now > next + std::chrono::milliseconds(s_intervalMs)) {
+            next = now;
+        }
+    }
+}
+
+TelemetrySnapshotPtr Telemetry::sample() {
+    TelemetrySnapshotPtr published;
+
+    {
+        Guard lock(m_sampleMutex);
+
+        auto snap = std::make_shared<TelemetrySnapshot>();
+        snap->sequence = ++m_sequence;
+        snap->sampledAt = std::chrono::steady_clock::now();
+
+        snap->running = m_farm.isRunning();
+        snap->paused = m_farm.isPaused();
+        snap->minerCount = m_farm.minerCount();
+        snap->activeMinerCount = m_farm.activeMinerCount();
+        snap->hashRate = m_farm.getHashRate();
+        snap->stats = m_farm.getStats();
+
+        if (m_poolSource) {
+            snap->pool = m_poolSource();
+        }
+        if (m_recoverySource) {
+            snap->recovery = m_recoverySource();
+        }
+
+        // Sensor readings come from the GpuMonitor sampler cache
+        auto descriptors = m_farm.getDevices();
+        bool monitor = GpuMonitor::instance().isAvailable();
+        snap->devices.reserve(descriptors.size());
+
+        for (size_t i = 0; i < descriptors.size(); i++) {
+            DeviceTelemetry dev;
+            dev.device = descriptors[i];
+            dev.hashRate = m_farm.getMinerHashRate(static_cast<unsigned>(i));
+            dev.failed = m_farm.isMinerFailed(static_cast<unsigned>(i));
+            dev.intensity = m_farm.getMinerIntensity(static_cast<unsigned>(i));
+            dev.batchSize = m_farm.getMinerBatchSize(static_cast<unsigned>(i));
+            dev.batchTime = m_farm.getMinerBatchTime(static_cast<unsigned>(i));
+            dev.parked = m_farm.isMinerParked(static_cast<unsigned>(i));
+            dev.health = m_farm.getMinerHealth(static_cast<unsigned>(i));
+            dev.jobSwitchLatency = m_farm.getMinerJobSwitchLatency(static_cast<unsigned>(i));
+            dev.timeline = m_farm.getMinerTimelineStats(static_cast<unsigned>(i));
+
+            if (monitor) {
+                if (dev.device.type == MinerType::CUDA) {
+                    dev.gpu = GpuMonitor::instance().getNvidiaStats(dev.device.cudaDeviceIndex);
+                } else if (dev.device.type == MinerType::OpenCL) {
+                    dev.gpu = GpuMonitor::instance().getAmdStats(dev.device.clDeviceIndex);
+                }
+            }
+
+            snap->devices.push_back(std::move(dev));
+        }
+
+        updateHistory(*snap);
+        m_anomalies.update(*snap);
+
+        // CPU efficiency: package power covers every core, mining or not
+        if (CpuMonitor::instance().isAvailable()) {
+            snap->cpu = CpuMonitor::instance().sample(snap->sampledAt);
+        }
+        for (const auto& dev : snap->devices) {
+            if (dev.device.type == MinerType::CPU) {
+                snap->cpuHashRate += dev.windows.s10 > 0 ? dev.windows.s10 : dev.hashRate.effectiveRate();
+            }
+        }
+        if (snap->cpu.packagePower > 0) {
+            snap->cpuHashesPerWatt = snap->cpuHashRate / snap->cpu.packagePower;
+        }
+
+        published = snap;
+        std::atomic_store(&m_latest, published);
+    }
+
+    // Notify outside the sample lock. Holding the listener lock while
+    // calling means removeListener() waits for an in-flight callback.
+    {
+        Guard lock(m_listenersMutex);
+        for (const auto& l : m_listeners) {
+            l.second(published);
+        }
+    }
+
+    return published;
+}
+
+void Telemetry::updateHistory(TelemetrySnapshot& snap) {
+    Guard lock(m_historyMutex);
+
+    double base = s_intervalMs / 1000.0;
+    bool first = m_lastCounts.empty();
+
+    if (m_histories.size() != snap.devices.size()) {
+        m_histories.assign(snap.devices.size(), HashRateHistory(base));
+        m_totalHistory = HashRateHistory(base);
+        m_lastCounts.assign(snap.devices.size(), 0);
+        first = true;
+    }
+
+    double elapsed = std::chrono::duration<double>(snap.sampledAt - m_lastSampleTime).count();
+    m_lastSampleTime = snap.sampledAt;
+
+    // Rates from count deltas: exact over the tick regardless of miner EMA
+    double total = 0;
+    for (size_t i = 0; i < snap.devices.size(); i++) {
+        uint64_t count = snap.devices[i].hashRate.count;
+        if (!first && elapsed > 0) {
+            // Counter reset (miner restarted) counts from zero
+            uint64_t delta = count >= m_lastCounts[i] ? count - m_lastCounts[i] : count;
+            double rate = static_cast<double>(delta) / elapsed;
+            m_histories[i].add(rate);
+            total += rate;
+        }
+        m_lastCounts[i] = count;
+        snap.devices[i].windows = m_histories[i].windows();
+    }
+
+    if (!first && elapsed > 0) {
+        m_totalHistory.add(total);
+    }
+    snap.windows = m_totalHistory.windows();
+}
+
+bool Telemetry::getHistory(int device, double resolution, std::vector<int64_t>& samples) const {
+    Guard lock(m_historyMutex);
+
+    const HashRateHistory* history = &m_totalHistory;
+    if (device >= 0) {
+        if (static_cast<size_t>(device) >= m_histories.size()) {
+            return false;
+        }
+        history = &m_histories[device];
+    }
+
+    int tier = history->findTier(resolution);
+    if (tier < 0) {
+        return false;
+    }
+
+    samples = history->samples(static_cast<size_t>(tier));
+    return true;
+}
+
+std::vector<double> Telemetry::getHistoryResolutions() const {
+    Guard lock(m_historyMutex);
+
+    std::vector<double> resolutions;
+    for (size_t i = 0; i < HashRateHistory::TIERS; i++) {
+        resolutions.push_back(m_totalHistory.resolution(i));
+    }
+    return resolutions;
+}
+
+std::vector<BatchTiming> Telemetry::getRecentBatches(unsigned device) const {
+    return m_farm.getMinerRecentBatches(device);
+}
+
+}  // namespace tos
@@ -0,0 +1,246 @@
+/**
+ * TOS Miner - Telemetry Sampler
+ *
+ * Gathers farm, device, GPU sensor and pool state once per tick and
+ * publishes it as an immutable snapshot shared by all consumers
+ * (API, console output).
+ */
+
+#pragma once
+
+#include "Farm.h"
+#include "Miner.h"
+#include "Types.h"
+#include "AnomalyDetector.h"
+#include "util/CpuMonitor.h"
+#include "util/GpuMonitor.h"
+#include "util/Histogram.h"
+#include "util/HashRateHistory.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Pool connection state at sample time
+ */
+struct PoolTelemetry {
+    bool connected{false};
+    bool authorized{false};
+    double difficulty{0};
+    uint64_t accepted{0};
+    uint64_t rejected{0};
+    HistogramSnapshot submitLatency;    // Share submit round trip
+};
+
+/**
+ * Per-device state at sample time
+ */
+struct DeviceTelemetry {
+    DeviceDescriptor device;
+    HashRate hashRate;
+    HashRateWindows windows;      // Windowed averages from the history
+    bool failed{false};
+    unsigned intensity{100};      // Percent (power governor)
+    uint64_t batchSize{0};        // Nonces in the last GPU batch (batch sizer)
+    double batchTime{0};          // Kernel time of the last GPU batch, seconds
+    bool parked{false};           // Parked by the host load governor
+    DeviceAnomaly anomaly;        // Hash rate anomaly state
+    DeviceHealth health;
+    HistogramSnapshot jobSwitchLatency;
+    TimelineStats timeline;       // Device kernel/transfer/idle times (OpenCL profiling)
+    GpuStats gpu;                 // valid == false if no sensor data
+};
+
+/**
+ * Immutable view of the miner taken at one telemetry tick
+ */
+struct TelemetrySnapshot {
+    uint64_t sequence{0};                                // Increments every tick
+    std::chrono::steady_clock::time_point sampledAt;
+
+    bool running{false};
+    bool paused{false};
+    size_t minerCount{0};
+    size_t activeMinerCount{0};
+
+    HashRate hashRate;                                   // Farm total
+    HashRateWindows windows;                             // Farm total, windowed
+    MiningStatsSnapshot stats;
+    PoolTelemetry pool;
+    RecoveryTelemetry recovery;                          // Empty without a recovery source
+
+    std::vector<DeviceTelemetry> devices;                // Indexed by miner index
+
+    CpuStats cpu;                                        // valid == false if no sensor data
+    double cpuHashRate{0};                               // CPU miners, 10 s window
+    double cpuHashesPerWatt{0};                          // 0 if package power unknown
+};
+
+using TelemetrySnapshotPtr = std::shared_ptr<const TelemetrySnapshot>;
+
+/**
+ * Telemetry sampler
+ *
+ * Runs a background thread that samples the farm at a fixed interval.
+ * Each sample is published atomically and handed to registered listeners
+ * on the sampler thread, so consumers can derive their own views (e.g.
+ * pre-rendered API bodies) once per tick instead of once per request.
+ *
+ * Each tick also feeds per-device multi-resolution hash rate histories,
+ * computed from hash count deltas between ticks.
+ */
+class Telemetry {
+public:
+    using Listener = std::function<void(const TelemetrySnapshotPtr&)>;
+    using PoolSource = std::function<PoolTelemetry()>;
+    using RecoverySource = std::function<RecoveryTelemetry()>;
+
+    /**
+     * Constructor
+     *
+     * @param farm Farm to sample
+     */
+    explicit Telemetry(Farm& farm);
+
+    /**
+     * Destructor
+     */
+    ~Telemetry();
+
+    // Non-copyable
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    /**
+     * Set pool state source (keeps core independent of the stratum client)
+     */
+    void setPoolSource(PoolSource source);
+
+    /**
+     * Set failed-device recovery state source
+     */
+    void setRecoverySource(RecoverySource source);
+
+    /**
+     * Set hash rate anomaly detector settings (resets its history)
+     */
+    void setAnomalyConfig(const AnomalyConfig& config);
+
+    /**
+     * Register a listener called after every sample (on the sampler thread;
+     * listeners must not add or remove listeners)
+     *
+     * @return Listener id for removeListener()
+     */
+    unsigned addListener(Listener listener);
+
+    /**
+     * Remove a previously registered listener
+     */
+    void removeListener(unsigned id);
+
+    /**
+     * Start the sampler thread (takes an initial sample synchronously)
+     */
+    void start();
+
+    /**
+     * Stop the sampler thread
+     */
+    void stop();
+
+    /**
+     * Take a sample now and publish it
+     */
+    TelemetrySnapshotPtr sample();
+
+    /**
+     * Get hash rate history samples, oldest first
+     *
+     * @param device Miner index, or -1 for the farm total
+     * @param resolution Tier resolution in seconds (e.g. 60 for 1m)
+     * @param samples Output rates in H/s
+     * @return false if the device or resolution doesn't exist
+     */
+    bool getHistory(int device, double resolution, std::vector<int64_t>& samples) const;
+
+    /**
+     * Get available history resolutions in seconds
+     */
+    std::vector<double> getHistoryResolutions() const;
+
+    /**
+     * Get a device's recently profiled batches, oldest first
+     *
+     * @param device Miner index
+     * @return Batches in host steady_clock nanoseconds (empty unless profiled)
+     */
+    std::vector<BatchTiming> getRecentBatches(unsigned device) const;
+
+    /**
+     * Get the most recent snapshot (nullptr before the first sample)
+     */
+    TelemetrySnapshotPtr latest() const {
+        return std::atomic_load(&m_latest);
+    }
+
+    /**
+     * Set sampling interval in milliseconds (default 1000)
+     */
+    static void setInterval(unsigned ms) { s_intervalMs = ms > 0 ? ms : 1000; }
+
+    /**
+     * Get sampling interval in milliseconds
+     */
+    static unsigned getInterval() { return s_intervalMs; }
+
+private:
+    /**
+     * Sampler thread loop
+     */
+    void run();
+
+    /**
+     * Feed histories from a new snapshot and fill in its windowed rates
+     */
+    void updateHistory(TelemetrySnapshot& snap);
+
+private:
+    Farm& m_farm;
+
+    PoolSource m_poolSource;
+    RecoverySource m_recoverySource;
+    std::vector<std::pair<unsigned, Listener>> m_listeners;
+    unsigned m_nextListenerId{1};
+    std::mutex m_listenersMutex;
+
+    // Serializes sample() between the sampler thread and direct callers
+    std::mutex m_sampleMutex;
+    uint64_t m_sequence{0};
+    AnomalyDetector m_anomalies;        // Guarded by m_sampleMutex
+
+    std::shared_ptr<const TelemetrySnapshot> m_latest;
+
+    // Hash rate histories (index = miner index), fed from count deltas
+    std::vector<HashRateHistory> m_histories;
+    HashRateHistory m_totalHistory;
+    std::vector<uint64_t> m_lastCounts;
+    std::chrono::steady_clock::time_point m_lastSampleTime;
+    mutable std::mutex m_historyMutex;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+
+    static inline unsigned s_intervalMs = 1000;
+};
+
+}  // namespace tos
@@ -0,0 +1,204 @@
+/**
+ * TOS Miner - Tuning Database Implementation
+ */
+
+#include "TuningDatabase.h"
+#include <nlohmann/json.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace tos {
+
+using json = nlohmann::json;
+
+namespace {
+
+const char* backendName(MinerType backend) {
+    return backend == MinerType::CUDA ? "cuda" : "opencl";
+}
+
+bool sameKey(const TuningEntry& entry, MinerType backend, const std::string& device, const std::string& driver) {
+    return entry.backend == backend && entry.device == device && entry.driver == driver;
+}
+
+}  // namespace
+
+std::string TuningDatabase::defaultPath() {
+    const char* xdg = std::getenv("XDG_CONFIG_HOME");
+    if (xdg && *xdg) {
+        return std::string(xdg) + "/tosminer/tuning.json";
+    }
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + "/.config/tosminer/tuning.json";
+    }
+    return "";
+}
+
+bool TuningDatabase::load() {
+    m_entries.clear();
+    if (m_path.empty()) {
+        return true;
+    }
+
+    std::ifstream in(m_path);
+    if (!in) {
+        return true;  // Nothing tuned yet
+    }
+
+    std::vector<TuningEntry> entries;
+    try {
+        json root = json::parse(in);
+        if (root.value("version", 0) != c_version) {
+            return false;
+        }
+
+        for (const auto& item : root.at("devices")) {
+            TuningEntry entry;
+            std::string backend = item.at("backend").get<std::string>();
+            if (backend != "opencl" && backend != "cuda") {
+                continue;
+            }
+            entry.backend = backend == "cuda" ? MinerType::CUDA : MinerType::OpenCL;
+            entry.device = item.at("device").get<std::string>();
+            entry.driver = item.value("driver", std::string());
+            entry.hashRate = item.value("hash_rate", 0.0);
+            entry.tunedAt = item.value("tuned_at", int64_t(0));
+
+            entry.profile = TuningProfiles::getProfile("default");
+            entry.profile.name = "tuned";
+            entry.profile.description = "Auto-tuned for " + entry.device;
+            if (entry.backend == MinerType::OpenCL) {
+                const auto& cl = item.at("opencl");
+                entry.profile.openclGlobalWorkSize = cl.at("global_work").get<unsigned>();
+                entry.profile.openclLocalWorkSize = cl.at("local_work").get<unsigned>();
+                entry.profile.openclNonceLoop = cl.value("nonce_loop", 0u);
+                entry.profile.openclPipelineDepth = cl.value("pipeline_depth", 2u);
+                if (!parseScratchLayout(cl.at("scratch").get<std::string>(), entry.profile.openclScratch)) {
+                    continue;
+                }
+            } else {
+                const auto& cu = item.at("cuda");
+                entry.profile.cudaGridSize = cu.at("grid").get<unsigned>();
+                entry.profile.cudaBlockSize = cu.at("block").get<unsigned>();
+                entry.profile.cudaStreams = cu.value("streams", 2u);
+            }
+
+            // A zero size would make the miner fall back to built-in defaults silently
+            if (entry.profile.openclGlobalWorkSize == 0 || entry.profile.openclLocalWorkSize == 0 ||
+                entry.profile.cudaGridSize == 0 || entry.profile.cudaBlockSize == 0) {
+                continue;
+            }
+            entries.push_back(entry);
+        }
+    } catch (const json::exception&) {
+        return false;
+    }
+
+    m_entries = std::move(entries);
+    return true;
+}
+
+bool TuningDatabase::save() const {
+    if (m_path.empty()) {
+        return false;
+    }
+
+    json devices = json::array();
+    for (const auto& entry : m_entries) {
+        json item = {
+            {"backend", backendName(entry.backend)},
+            {"device", entry.device},
+            {"driver", entry.driver},
+            {"hash_rate", entry.hashRate},
+            {"tuned_at", entry.tunedAt}
+        };
+        if (entry.backend == MinerType::OpenCL) {
+            item["opencl"] = {
+                {"global_work", entry.profile.openclGlobalWorkSize},
+                {"local_work", entry.profile.openclLocalWorkSize},
+                {"nonce_loop", entry.profile.openclNonceLoop},
+                {"pipeline_depth", entry.profile.openclPipelineDepth},
+                {"scratch", scratchLayoutName(entry.profile.openclScratch)}
+            };
+        } else {
+            item["cuda"] = {
+                {"grid", entry.profile.cudaGridSize},
+                {"block", entry.profile.cudaBlockSize},
+                {"streams", entry.profile.cudaStreams}
+            };
+        }
+        devices.push_back(item);
+    }
+    json root = {{"version", c_version}, {"devices", devices}};
+
+    // Write a temporary file and rename it into place so readers never see a partial file
+    std::error_code ec;
+    std::filesystem::path file(m_path);
+    if (file.has_parent_path()) {
+        std::filesystem::create_directories(file.parent_path(), ec);
+    }
+#ifndef _WIN32
+    std::string temp = m_path + ".tmp" + std::to_string(::getpid());
+#else
+    std::string temp = m_path + ".tmp";
+#endif
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << root.dump(2) << "\n";
+        if (!out.flush()) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, file, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    return true;
+}
+
+const TuningEntry* TuningDatabase::find(MinerType backend, const std::string& device,
+                                        const std::string& driver) const {
+    for (const auto& entry : m_entries) {
+        if (sameKey(entry, backend, device, driver)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void TuningDatabase::store(const TuningEntry& entry) {
+    for (auto& existing : m_entries) {
+        if (sameKey(existing, entry.backend, entry.device, entry.driver)) {
+            existing = entry;
+            return;
+        }
+    }
+    m_entries.push_back(entry);
+}
+
+TuningProfile TuningDatabase::select(MinerType backend, const std::string& device, const std::string& driver,
+                                     std::string& source) const {
+    if (const TuningEntry* entry = find(backend, device, driver)) {
+        source = "auto-tuned settings";
+        return entry->profile;
+    }
+
+    bool otherDriver = false;
+    for (const auto& entry : m_entries) {
+        otherDriver = otherDriver || (entry.backend == backend && entry.device == device);
+    }
+
+    std::string name = TuningProfiles::detect(device);
+    source = "profile " + name + (otherDriver ? " (tuned with another driver, run --auto-tune again)" : "");
+    return TuningProfiles::getProfile(name);
+}
+
+}  // namespace tos
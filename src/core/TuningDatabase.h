@@ -0,0 +1,105 @@
+/**
+ * TOS Miner - Tuning Database
+ *
+ * Auto-tuned GPU settings kept on disk per device and driver
+ */
+
+#pragma once
+
+#include "TuningProfiles.h"
+#include "Types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Tuned settings for one device
+ */
+struct TuningEntry {
+    MinerType backend{MinerType::OpenCL};  // OpenCL or CUDA
+    std::string device;         // Device name as enumerated
+    std::string driver;         // Driver version as enumerated
+    TuningProfile profile;      // Tuned values (only the backend's fields are stored)
+    double hashRate{0};         // Benchmark rate of the tuned settings (H/s)
+    int64_t tunedAt{0};         // Unix time of the sweep
+};
+
+/**
+ * JSON file of auto-tuned settings, keyed by backend, device name and driver
+ *
+ * A driver update changes kernel performance, so entries only apply to
+ * the driver they were tuned with. Devices without an entry fall back to
+ * the profile detected from their name (see TuningProfiles::detect). The
+ * file is replaced atomically on save. Not thread-safe.
+ */
+class TuningDatabase {
+public:
+    /**
+     * @param path Database file ("" = in memory only)
+     */
+    explicit TuningDatabase(std::string path = "") : m_path(std::move(path)) {}
+
+    /**
+     * Default database file ($XDG_CONFIG_HOME/tosminer/tuning.json or
+     * ~/.config/tosminer/tuning.json)
+     */
+    static std::string defaultPath();
+
+    /**
+     * Get database file
+     */
+    const std::string& path() const { return m_path; }
+
+    /**
+     * Read the database file, replacing entries in memory
+     *
+     * @return false if the file exists but cannot be parsed (no entries loaded)
+     */
+    bool load();
+
+    /**
+     * Write all entries to the database file
+     *
+     * @return false if the file could not be written
+     */
+    bool save() const;
+
+    /**
+     * Find the entry for a device
+     *
+     * @return Entry, or nullptr if the device was not tuned with this driver
+     */
+    const TuningEntry* find(MinerType backend, const std::string& device, const std::string& driver) const;
+
+    /**
+     * Add or replace the entry for entry's backend, device and driver
+     */
+    void store(const TuningEntry& entry);
+
+    /**
+     * Settings for a device: its tuned entry, else the profile detected from its name
+     *
+     * @param backend OpenCL or CUDA
+     * @param device Device name
+     * @param driver Driver version
+     * @param source Output description of where the settings came from (for logging)
+     * @return Settings to use
+     */
+    TuningProfile select(MinerType backend, const std::string& device, const std::string& driver,
+                         std::string& source) const;
+
+    /**
+     * Get all entries
+     */
+    const std::vector<TuningEntry>& entries() const { return m_entries; }
+
+private:
+    std::string m_path;
+    std::vector<TuningEntry> m_entries;
+
+    static constexpr int c_version = 1;
+};
+
+}  // namespace tos
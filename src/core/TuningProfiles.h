@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "opencl/ScratchLayout.h"
+#include <cctype>
 #include <string>
 #include <map>
 #include <vector>
@@ -23,18 +25,24 @@ struct TuningProfile {
     // OpenCL parameters
     unsigned openclGlobalWorkSize{16384};
     unsigned openclLocalWorkSize{1};
+    unsigned openclNonceLoop{0};  // Nonces per work item in the persistent kernel (0 = one-shot kernel)
+    ScratchLayout openclScratch{ScratchLayout::Local};  // Scratchpad placement
+    unsigned openclPipelineDepth{2};  // Batches in flight (1 .. MAX_PIPELINE_DEPTH)
 
     // CUDA parameters
     unsigned cudaGridSize{16384};
     unsigned cudaBlockSize{1};
-    unsigned cudaStreams{2};
+    unsigned cudaStreams{2};  // Streams, one batch in flight each (1 .. MAX_PIPELINE_DEPTH)
 
     TuningProfile() = default;
     TuningProfile(const std::string& n, const std::string& desc,
                   unsigned oclGlobal, unsigned oclLocal,
-                  unsigned cuGrid, unsigned cuBlock, unsigned cuStreams = 2)
+                  unsigned cuGrid, unsigned cuBlock, unsigned cuStreams = 2,
+                  unsigned oclNonceLoop = 0, ScratchLayout oclScratch = ScratchLayout::Local,
+                  unsigned oclPipelineDepth = 2)
         : name(n), description(desc)
-        , openclGlobalWorkSize(oclGlobal), openclLocalWorkSize(oclLocal)
+        , openclGlobalWorkSize(oclGlobal), openclLocalWorkSize(oclLocal), openclNonceLoop(oclNonceLoop)
+        , openclScratch(oclScratch), openclPipelineDepth(oclPipelineDepth)
         , cudaGridSize(cuGrid), cudaBlockSize(cuBlock), cudaStreams(cuStreams)
     {}
 };
@@ -74,6 +82,78 @@ public:
         }
     }
 
+    /**
+     * Pick the closest profile for a device from its name
+     *
+     * Matches marketing names (e.g. "NVIDIA GeForce RTX 3080", "AMD Radeon
+     * RX 6800") and the gfx codenames AMD's OpenCL runtime reports.
+     *
+     * @param deviceName Device name as enumerated by the backend
+     * @return Profile name ("default" if nothing matches)
+     */
+    static std::string detect(const std::string& deviceName) {
+        std::string name;
+        for (char c : deviceName) {
+            name += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        auto has = [&name](const char* part) { return name.find(part) != std::string::npos; };
+
+        // Model number after a prefix, e.g. "RTX " -> 3080 (0 if absent)
+        auto model = [&name](const char* prefix) -> unsigned {
+            size_t pos = name.find(prefix);
+            if (pos == std::string::npos) {
+                return 0;
+            }
+            pos += std::char_traits<char>::length(prefix);
+            unsigned value = 0;
+            while (pos < name.size() && std::isdigit(static_cast<unsigned char>(name[pos]))) {
+                value = value * 10 + static_cast<unsigned>(name[pos++] - '0');
+            }
+            return value;
+        };
+
+        // NVIDIA (Quadro RTX 4000-8000 are Turing, not Ada)
+        if (has("QUADRO RTX")) return "nvidia-turing";
+        if (unsigned rtx = model("RTX ")) {
+            if (rtx >= 4000) return "nvidia-ada";
+            if (rtx >= 3000) return "nvidia-ampere";
+            return "nvidia-turing";
+        }
+        if (unsigned gtx = model("GTX ")) {
+            return gtx >= 1600 ? "nvidia-turing" : "nvidia-pascal";
+        }
+        if (has("NVIDIA") || has("TESLA")) {
+            if (has(" L4") || has(" L40")) return "nvidia-ada";
+            if (has(" A100") || has(" A10") || has(" A30") || has(" A40")) return "nvidia-ampere";
+            if (has(" T4")) return "nvidia-turing";
+            if (has(" P100") || has(" P40") || has(" P4")) return "nvidia-pascal";
+        }
+
+        // AMD marketing names
+        if (unsigned rx = model("RX ")) {
+            if (rx >= 7000) return "amd-rdna3";
+            if (rx >= 6000) return "amd-rdna2";
+            if (rx >= 5000) return "amd-navi";
+            if (rx >= 400 && rx < 1000) return "amd-polaris";
+        }
+        if (has("VEGA") || has("RADEON VII")) return "amd-vega";
+
+        // AMD codenames (gfx1100 = RDNA3, gfx1030 = RDNA2, gfx1010 = RDNA, gfx90x = Vega, gfx80x = Polaris)
+        if (unsigned gfx = model("GFX")) {
+            if (gfx >= 1100) return "amd-rdna3";
+            if (gfx >= 1030) return "amd-rdna2";
+            if (gfx >= 1010) return "amd-navi";
+            if (gfx >= 900) return "amd-vega";
+            if (gfx >= 800) return "amd-polaris";
+        }
+        if (has("ELLESMERE") || has("BAFFIN") || has("POLARIS")) return "amd-polaris";
+
+        // Intel
+        if (has("INTEL") && has("ARC")) return "intel-arc";
+
+        return "default";
+    }
+
 private:
     static const std::map<std::string, TuningProfile>& profiles() {
         static const std::map<std::string, TuningProfile> s_profiles = {
@@ -88,70 +168,90 @@ private:
             {"nvidia-pascal", TuningProfile(
                 "nvidia-pascal", "NVIDIA Pascal (GTX 10xx)",
                 32768, 1,
-                32768, 128, 2
+                32768, 128, 2,
+                0, ScratchLayout::Interleaved
             )},
             {"nvidia-turing", TuningProfile(
                 "nvidia-turing", "NVIDIA Turing (RTX 20xx, GTX 16xx)",
                 65536, 1,
-                65536, 256, 4
+                65536, 256, 4,
+                0, ScratchLayout::Interleaved
             )},
             {"nvidia-ampere", TuningProfile(
                 "nvidia-ampere", "NVIDIA Ampere (RTX 30xx)",
                 131072, 1,
-                131072, 256, 4
+                131072, 256, 4,
+                0, ScratchLayout::Interleaved
             )},
             {"nvidia-ada", TuningProfile(
                 "nvidia-ada", "NVIDIA Ada Lovelace (RTX 40xx)",
                 262144, 1,
-                262144, 512, 4
+                262144, 512, 4,
+                0, ScratchLayout::Interleaved
             )},
 
             // AMD profiles
             {"amd-polaris", TuningProfile(
                 "amd-polaris", "AMD Polaris (RX 4xx, RX 5xx)",
                 16384, 64,
-                16384, 1, 2
+                16384, 1, 2,
+                0, ScratchLayout::Interleaved
             )},
             {"amd-vega", TuningProfile(
                 "amd-vega", "AMD Vega (Vega 56/64, VII)",
                 32768, 64,
-                32768, 1, 2
+                32768, 1, 2,
+                0, ScratchLayout::Interleaved
             )},
             {"amd-navi", TuningProfile(
                 "amd-navi", "AMD RDNA (RX 5xxx)",
                 65536, 64,
-                65536, 1, 2
+                65536, 1, 2,
+                0, ScratchLayout::Interleaved
             )},
             {"amd-rdna2", TuningProfile(
                 "amd-rdna2", "AMD RDNA2 (RX 6xxx)",
                 131072, 64,
-                131072, 1, 2
+                131072, 1, 2,
+                0, ScratchLayout::Interleaved
             )},
             {"amd-rdna3", TuningProfile(
                 "amd-rdna3", "AMD RDNA3 (RX 7xxx)",
                 262144, 64,
-                262144, 1, 2
+                262144, 1, 2,
+                0, ScratchLayout::Interleaved
             )},
 
             // Intel profiles
             {"intel-arc", TuningProfile(
                 "intel-arc", "Intel Arc (A7xx)",
                 32768, 32,
-                32768, 1, 2
+                32768, 1, 2,
+                0, ScratchLayout::Blocked
+            )},
+
+            // Persistent OpenCL kernel: fewer launches, jobs switch mid-launch
+            {"opencl-persistent", TuningProfile(
+                "opencl-persistent", "Persistent OpenCL kernel, 32 nonces per work item per launch",
+                16384, 1,
+                16384, 1, 2,
+                32
             )},
 
             // Low-end / power-saving
             {"low-power", TuningProfile(
                 "low-power", "Low power consumption, reduced performance",
                 8192, 1,
-                8192, 64, 1
+                8192, 64, 1,
+                0, ScratchLayout::Local, 1
             )},
 
             // Maximum throughput (may increase power)
             {"max-throughput", TuningProfile(
                 "max-throughput", "Maximum throughput, high power consumption",
                 524288, 1,
-                524288, 512, 4
+                524288, 512, 4,
+                0, ScratchLayout::Local, 4
             )}
         };
         return s_profiles;
@@ -120,6 +120,111 @@ struct MiningStats {
     }
 };
 
+// Power governor settings (see PowerGovernor)
+struct GovernorConfig {
+    int tempTarget{0};              // Celsius, 0 = no temperature cap
+    int powerCap{0};                // Watts per device, 0 = no power cap
+    int hysteresis{3};              // Degrees below target before raising again
+    unsigned minIntensity{30};      // Never throttle below this (percent)
+    unsigned step{5};               // Intensity change per decision (percent)
+    unsigned settleTicks{10};       // Ticks to wait after a change (thermal lag)
+    unsigned holdTicks{120};        // Ticks to keep an efficiency ceiling
+    double efficiencyTolerance{0.05};  // Allowed H/s/W loss when raising
+
+    bool enabled() const { return tempTarget > 0 || powerCap > 0; }
+};
+
+// Host load governor settings (see HostLoadGovernor)
+struct HostLoadConfig {
+    bool hostAware{false};          // Park CPU threads under host load
+    double psiHigh{10.0};           // PSI some avg10 (%) above which threads are parked
+    double psiLow{2.0};             // PSI some avg10 (%) below which threads return
+    double loadHigh{0.5};           // Load from other tasks per CPU above which threads are parked
+    unsigned cpuShare{100};         // Hard budget: percent of online CPUs CPU mining may use
+    unsigned minThreads{0};         // Never park below this many threads
+    unsigned shrinkTicks{5};        // Ticks between parking decisions
+    unsigned growTicks{30};         // Ticks of idle host before unparking a thread
+
+    bool enabled() const { return hostAware || cpuShare < 100; }
+};
+
+// Hash rate anomaly detector settings (see AnomalyDetector)
+struct AnomalyConfig {
+    unsigned spanTicks{5};          // Ticks each rate sample spans (smooths batch granularity)
+    unsigned recentTicks{15};       // Recent window compared against the baseline
+    unsigned windowTicks{300};      // Baseline window
+    unsigned warmupTicks{60};       // Baseline samples needed before judging
+    unsigned stallTicks{30};        // Ticks without hashes before a device counts as stalled
+    double dropThreshold{0.15};     // Flag when the recent median falls this far below baseline
+    double madThreshold{3.0};       // ...and by this many robust standard deviations
+    double peerThreshold{0.20};     // Flag when this far below same-model peers
+    int throttleTemp{85};           // Celsius at which a drop counts as thermal throttling
+    bool recover{false};            // Restart stalled devices
+    unsigned recoverTicks{60};      // Stalled ticks before a restart
+};
+
+// Hash rate anomaly state of a device
+enum class AnomalyKind {
+    None,           // Normal
+    Degraded,       // Slower than its own baseline or its peers
+    Throttled,      // Slower, with hot or down-clocked sensors
+    Stalled         // No hashes while other devices or the pool have work
+};
+
+struct DeviceAnomaly {
+    AnomalyKind kind{AnomalyKind::None};
+    std::vector<std::string> reasons;
+    double recentRate{0};           // Median of the recent window (H/s at 100% intensity)
+    double baselineRate{0};         // Median of the baseline window
+    double peerRate{0};             // Median of same-model peers (0 = no peers)
+    unsigned ticks{0};              // Ticks in the current state
+
+    static const char* name(AnomalyKind kind) {
+        switch (kind) {
+            case AnomalyKind::Degraded: return "degraded";
+            case AnomalyKind::Throttled: return "throttled";
+            case AnomalyKind::Stalled: return "stalled";
+            default: return "normal";
+        }
+    }
+};
+
+// Failed-device recovery settings (see RecoverySupervisor)
+struct RecoveryConfig {
+    unsigned maxAttempts{5};        // Attempts per device before giving up, 0 = no recovery
+    unsigned initialBackoff{10};    // Seconds before the first attempt
+    unsigned maxBackoff{600};       // Cap on the doubling delay between attempts
+    unsigned stableSeconds{300};    // Mining this long after a recovery resets the attempt count
+    unsigned historySize{50};       // Recovery attempts kept for /health
+
+    bool enabled() const { return maxAttempts > 0; }
+};
+
+// Recovery state of a failed device
+struct DeviceRecovery {
+    unsigned index{0};              // Miner index
+    std::string device;             // Short device name
+    bool gaveUp{false};             // Out of attempts (stays failed)
+    unsigned attempts{0};           // Attempts so far
+    double nextAttempt{0};          // Seconds until the next attempt
+};
+
+// One recovery attempt
+struct RecoveryEvent {
+    unsigned index{0};
+    std::string device;
+    unsigned attempt{0};            // 1-based
+    bool success{false};
+    double age{0};                  // Seconds ago
+};
+
+struct RecoveryTelemetry {
+    std::vector<DeviceRecovery> devices;    // Failed devices
+    std::vector<RecoveryEvent> history;     // Most recent first
+    uint64_t recoveries{0};                 // Successful attempts
+    uint64_t failures{0};                   // Failed attempts
+};
+
 // Mutex guard type
 using Guard = std::lock_guard<std::mutex>;
 
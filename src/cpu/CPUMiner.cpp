@@ -80,7 +80,7 @@ void CPUMiner::mineLoop() {
             }
 
             // Get device-specific starting nonce (non-overlapping range)
-            nonce = work.getDeviceStartNonce(m_index);
+            nonce = work.getDeviceStartNonce(m_nonceSlot);
 
             // Clear submitted nonces for new job
             clearSubmittedNonces();
@@ -94,6 +94,7 @@ void CPUMiner::mineLoop() {
         }
 
         // Mine a batch of nonces
+        auto batchStart = std::chrono::steady_clock::now();
         for (uint64_t i = 0; i < BATCH_SIZE && m_running && !hasNewWork(); i++, nonce++) {
             // Compute hash and check against target
             Solution sol = m_hasher.search(work, nonce, m_scratch);
@@ -115,6 +116,8 @@ void CPUMiner::mineLoop() {
         // Update hash count
         hashCount += BATCH_SIZE;
         updateHashCount(BATCH_SIZE);
+
+        throttle(std::chrono::steady_clock::now() - batchStart);
     }
 }
 
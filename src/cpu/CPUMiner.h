@@ -10,6 +10,7 @@
 #include "toshash/TosHash.h"
 #include <vector>
 #include <thread>
+#include <chrono>
 
 namespace tos {
 
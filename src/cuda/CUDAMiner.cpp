@@ -7,38 +7,47 @@
 #include "CUDAMiner.h"
 #include "core/WorkPackage.h"
 #include "util/Log.h"
+#include <array>
 #include <sstream>
 #include <chrono>
 #include <thread>
+#include <algorithm>
+#include <set>
 
 // External kernel launch functions (defined in .cu file)
 extern "C" {
     cudaError_t toshash_set_header(const uint8_t* header);
     cudaError_t toshash_set_target(const uint8_t* target);
+    cudaError_t toshash_set_check_target(const uint8_t* target);
 }
 
-// Kernel declaration
-extern "C" __global__ void toshash_search(uint32_t* g_output, uint64_t start_nonce);
+// Kernel declarations
+extern "C" __global__ void toshash_search(uint32_t* g_output, uint64_t start_nonce, uint32_t max_outputs,
+                                          uint32_t max_checks);
+extern "C" __global__ void toshash_benchmark(uint64_t* g_hashes, uint64_t start_nonce, uint32_t store_hashes);
 
 namespace tos {
 
 // Static members
 unsigned CUDAMiner::s_gridSizeMultiplier = 0;  // 0 = auto-tune based on GPU
 unsigned CUDAMiner::s_blockSize = 1;  // Threads per block (1 for 64KB shared memory per thread)
+unsigned CUDAMiner::s_streamCount = 2;  // Two batches in flight by default
 
 CUDAMiner::CUDAMiner(unsigned index, const DeviceDescriptor& device)
     : Miner(index, device)
-    , m_currentStream(0)
-    , m_batchCount(0)
     , m_gridSize(0)
     , m_blockSize(1)
 {
     // Initialize pointers to null
-    for (unsigned i = 0; i < c_numStreams; i++) {
+    for (unsigned i = 0; i < c_maxStreams; i++) {
         m_streams[i] = nullptr;
+        m_kernelStart[i] = nullptr;
+        m_kernelStop[i] = nullptr;
         d_output[i] = nullptr;
         m_output[i] = nullptr;
         m_batchNonce[i] = 0;
+        m_batchSize[i] = 0;
+        m_batchOutputs[i] = MIN_OUTPUT_CAPACITY;
     }
 }
 
@@ -79,13 +88,27 @@ bool CUDAMiner::init() {
         return false;
     }
 
-    // Create multiple streams for pipelining
-    for (unsigned i = 0; i < c_numStreams; i++) {
+    // Create multiple streams for pipelining (kernels keep their scratchpads
+    // in shared memory, so batches on different streams can overlap)
+    m_slots.reset(m_tuned ? m_tuning.cudaStreams : s_streamCount);
+    for (unsigned i = 0; i < m_slots.depth(); i++) {
         err = cudaStreamCreate(&m_streams[i]);
         if (err != cudaSuccess) {
             Log::error(getName() + ": Failed to create CUDA stream " + std::to_string(i) + ": " + cudaGetErrorString(err));
             return false;
         }
+
+        // Batch sizer times each kernel between two events on its stream
+        if (getBatchTarget() > 0) {
+            err = cudaEventCreate(&m_kernelStart[i]);
+            if (err == cudaSuccess) {
+                err = cudaEventCreate(&m_kernelStop[i]);
+            }
+            if (err != cudaSuccess) {
+                Log::error(getName() + ": Failed to create CUDA events: " + cudaGetErrorString(err));
+                return false;
+            }
+        }
     }
 
     // Allocate buffers
@@ -97,11 +120,12 @@ bool CUDAMiner::init() {
     // TOS Hash requires 64KB shared memory per thread, so blockSize = 1
     // Grid size should scale with number of SMs and available memory
 
-    m_blockSize = s_blockSize;  // Fixed at 1 due to shared memory requirement
+    m_blockSize = m_tuned ? m_tuning.cudaBlockSize : s_blockSize;
+    unsigned gridSize = m_tuned ? m_tuning.cudaGridSize : s_gridSizeMultiplier;
 
-    if (s_gridSizeMultiplier > 0) {
-        // User specified grid size
-        m_gridSize = s_gridSizeMultiplier;
+    if (gridSize > 0) {
+        // User specified or tuned grid size
+        m_gridSize = gridSize;
     } else {
         // Auto-tune: scale grid size based on SMs
         // Each SM can run multiple blocks concurrently
@@ -138,10 +162,27 @@ bool CUDAMiner::init() {
         }
     }
 
-    Log::info(getName() + ": Initialized with " + std::to_string(c_numStreams) +
+    // Batch sizer works in nonces, whole blocks at a time
+    m_batchSizer.configure(static_cast<size_t>(m_gridSize) * m_blockSize,
+                           static_cast<size_t>(m_gridSize / BATCH_SHRINK) * m_blockSize,
+                           static_cast<size_t>(m_gridSize) * BATCH_GROWTH * m_blockSize, m_blockSize);
+    m_batchSizer.setTarget(getBatchTarget() / 1000.0);
+
+    // Integrity check target (fixed per device)
+    m_integrityBits = integrityBits(static_cast<uint64_t>(m_gridSize) * m_blockSize);
+    Hash256 checkTarget = integrityTarget(m_integrityBits);
+    err = toshash_set_check_target(checkTarget.data());
+    if (err != cudaSuccess) {
+        Log::error(getName() + ": Failed to set check target: " + cudaGetErrorString(err));
+        return false;
+    }
+
+    Log::info(getName() + ": Initialized with " + std::to_string(m_slots.depth()) +
               " streams (grid: " + std::to_string(m_gridSize) +
               ", block: " + std::to_string(m_blockSize) +
-              ", SMs: " + std::to_string(props.multiProcessorCount) + ")");
+              ", SMs: " + std::to_string(props.multiProcessorCount) +
+              (m_batchSizer.enabled() ? ", batches sized for " + std::to_string(getBatchTarget()) + " ms"
+                                      : std::string()) + ")");
 
     return true;
 }
@@ -153,28 +194,29 @@ std::string CUDAMiner::getName() const {
 bool CUDAMiner::allocateBuffers() {
     cudaError_t err;
 
-    for (unsigned i = 0; i < c_numStreams; i++) {
+    for (unsigned i = 0; i < m_slots.depth(); i++) {
         // Allocate device output buffer
-        err = cudaMalloc(&d_output[i], OUTPUT_SIZE);
+        err = cudaMalloc(&d_output[i], outputSize(MAX_OUTPUT_CAPACITY));
         if (err != cudaSuccess) {
             Log::error(getName() + ": Failed to allocate device buffer " + std::to_string(i) + ": " + cudaGetErrorString(err));
             return false;
         }
 
         // Allocate pinned host memory for async transfers
-        err = cudaMallocHost(&m_output[i], OUTPUT_SIZE);
+        err = cudaMallocHost(&m_output[i], outputSize(MAX_OUTPUT_CAPACITY));
         if (err != cudaSuccess) {
             Log::error(getName() + ": Failed to allocate pinned host buffer " + std::to_string(i) + ": " + cudaGetErrorString(err));
             return false;
         }
     }
 
-    Log::info(getName() + ": Buffers allocated (" + std::to_string(c_numStreams) + " streams)");
+    m_outputSizer.reset();
+    Log::info(getName() + ": Buffers allocated (" + std::to_string(m_slots.depth()) + " streams)");
     return true;
 }
 
 void CUDAMiner::freeBuffers() {
-    for (unsigned i = 0; i < c_numStreams; i++) {
+    for (unsigned i = 0; i < c_maxStreams; i++) {
         if (d_output[i]) {
             cudaFree(d_output[i]);
             d_output[i] = nullptr;
@@ -183,6 +225,14 @@ void CUDAMiner::freeBuffers() {
             cudaFreeHost(m_output[i]);
             m_output[i] = nullptr;
         }
+        if (m_kernelStart[i]) {
+            cudaEventDestroy(m_kernelStart[i]);
+            m_kernelStart[i] = nullptr;
+        }
+        if (m_kernelStop[i]) {
+            cudaEventDestroy(m_kernelStop[i]);
+            m_kernelStop[i] = nullptr;
+        }
         if (m_streams[i]) {
             cudaStreamDestroy(m_streams[i]);
             m_streams[i] = nullptr;
@@ -192,24 +242,19 @@ void CUDAMiner::freeBuffers() {
 
 void CUDAMiner::mineLoop() {
     uint64_t nonce = 0;
-    uint64_t batchSize = m_gridSize * m_blockSize;
 
     // Set device for this thread
     cudaSetDevice(m_device.cudaDeviceIndex);
 
     // Reset state
-    m_currentStream = 0;
-    m_batchCount = 0;
+    m_slots.clear();
 
     while (m_running) {
         // Check for pause
         if (m_paused) {
             // Wait for all streams to complete before pausing
-            for (unsigned i = 0; i < c_numStreams; i++) {
-                cudaStreamSynchronize(m_streams[i]);
-            }
+            drainStreams();
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            m_batchCount = 0;
             continue;
         }
 
@@ -224,9 +269,7 @@ void CUDAMiner::mineLoop() {
             }
 
             // Wait for all streams to complete before switching work
-            for (unsigned i = 0; i < c_numStreams; i++) {
-                cudaStreamSynchronize(m_streams[i]);
-            }
+            drainStreams();
 
             // Upload new header and target to constant memory
             cudaError_t err;
@@ -244,54 +287,34 @@ void CUDAMiner::mineLoop() {
             }
 
             // Get device-specific starting nonce (non-overlapping range)
-            nonce = work.getDeviceStartNonce(m_index);
-            m_currentStream = 0;
-            m_batchCount = 0;
+            nonce = work.getDeviceStartNonce(m_nonceSlot);
+            m_deviceWork = work;
         }
 
         // Multi-stream pipeline:
-        // - Launch new batch on current stream
-        // - If we have c_numStreams batches in flight, wait for oldest and process
-
-        unsigned streamIdx = m_currentStream;
-
-        // If we have filled all streams, wait for current stream to complete
-        // (it's the oldest in the ring buffer)
-        if (m_batchCount >= c_numStreams) {
-            cudaError_t err = cudaStreamSynchronize(m_streams[streamIdx]);
-            if (err != cudaSuccess) {
-                Log::error(getName() + ": Stream sync failed: " + cudaGetErrorString(err));
-
-                // Track errors and attempt recovery if needed
-                if (recordError()) {
-                    Log::warning(getName() + ": Attempting recovery...");
-                    freeBuffers();
-                    if (!init()) {
-                        Log::error(getName() + ": Recovery failed, stopping");
-                        m_running = false;
-                        break;
-                    }
-                    Log::info(getName() + ": Recovery successful");
-                }
-
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                m_batchCount = 0;
-                continue;
+        // - Launch a new batch on every idle stream
+        // - Process whichever stream finishes first (the oldest if none has)
+        bool launched = true;
+        int slot;
+        while (m_slots.busy() < launchLimit() && (slot = m_slots.acquire()) >= 0) {
+            unsigned streamIdx = static_cast<unsigned>(slot);
+            unsigned gridSize = batchGridSize();
+            uint32_t outputs = m_outputSizer.capacity();
+            m_launchedAt[streamIdx] = std::chrono::steady_clock::now();
+            if (!launchBatch(nonce, streamIdx, gridSize, outputs)) {
+                launched = false;
+                break;
             }
-
-            // Clear error counter on successful operation
-            clearErrors();
-
-            // Process results from this stream (oldest batch)
-            processSolutions(streamIdx, m_batchNonce[streamIdx]);
-
-            // Update hash count
-            updateHashCount(batchSize);
+            uint64_t batchSize = static_cast<uint64_t>(gridSize) * m_blockSize;
+            m_batchNonce[streamIdx] = nonce;
+            m_batchSize[streamIdx] = batchSize;
+            m_batchOutputs[streamIdx] = outputs;
+            nonce += batchSize;
         }
 
-        // Launch new batch on this stream
-        if (!launchBatch(nonce, streamIdx)) {
+        if (!launched) {
             // Kernel launch failed - track error and attempt recovery if needed
+            drainStreams();
             if (recordError()) {
                 Log::warning(getName() + ": Attempting recovery after launch failure...");
                 freeBuffers();
@@ -303,35 +326,247 @@ void CUDAMiner::mineLoop() {
                 Log::info(getName() + ": Recovery successful");
             }
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            m_batchCount = 0;
             continue;
         }
-        m_batchNonce[streamIdx] = nonce;
 
-        // Advance to next stream and nonce
-        m_currentStream = (m_currentStream + 1) % c_numStreams;
-        nonce += batchSize;
-        m_batchCount++;
+        unsigned streamIdx = 0;
+        cudaError_t err = waitForStream(streamIdx);
+        if (err != cudaSuccess) {
+            Log::error(getName() + ": Stream sync failed: " + cudaGetErrorString(err));
+            m_slots.clear();
+
+            // Track errors and attempt recovery if needed
+            if (recordError()) {
+                Log::warning(getName() + ": Attempting recovery...");
+                freeBuffers();
+                if (!init()) {
+                    Log::error(getName() + ": Recovery failed, stopping");
+                    m_running = false;
+                    break;
+                }
+                Log::info(getName() + ": Recovery successful");
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        // Clear error counter on successful operation
+        clearErrors();
+        auto busy = busyTime(streamIdx);
+
+        // Process results from the finished stream
+        bool overflowed = processSolutions(streamIdx);
+        processChecks(streamIdx, m_batchSize[streamIdx]);
+
+        // Update hash count; the batch sizer adjusts the next batches
+        updateHashCount(m_batchSize[streamIdx]);
+        recordBatch(m_batchSize[streamIdx], kernelTime(streamIdx));
+
+        // Solutions were dropped: search the batch again in smaller launches
+        if (overflowed) {
+            rescanBatch(streamIdx);
+        }
+
+        m_slots.release(streamIdx);
+        throttle(busy);
     }
 
     // Drain remaining batches on exit
-    for (unsigned i = 0; i < c_numStreams; i++) {
-        cudaStreamSynchronize(m_streams[i]);
+    drainStreams();
+}
+
+cudaError_t CUDAMiner::waitForStream(unsigned& streamIdx) {
+    // Streams are listed oldest first: take the first one already idle, so
+    // a batch that finished early is not held up behind an older one
+    auto streams = m_slots.inFlight();
+    for (unsigned i : streams) {
+        cudaError_t err = cudaStreamQuery(m_streams[i]);
+        if (err == cudaSuccess) {
+            streamIdx = i;
+            return cudaSuccess;
+        }
+        if (err != cudaErrorNotReady) {
+            return err;
+        }
+    }
+
+    streamIdx = streams.front();
+    return cudaStreamSynchronize(m_streams[streamIdx]);
+}
+
+void CUDAMiner::drainStreams() {
+    for (unsigned i = 0; i < m_slots.depth(); i++) {
+        if (m_streams[i]) {
+            cudaStreamSynchronize(m_streams[i]);
+        }
+    }
+    m_slots.clear();
+}
+
+unsigned CUDAMiner::batchGridSize() const {
+    uint64_t blocks = m_batchSizer.size() / std::max(1u, m_blockSize);
+    return std::max(1u, static_cast<unsigned>(blocks));
+}
+
+unsigned CUDAMiner::launchLimit() const {
+    return getIntensity() < 100 ? 1 : m_slots.depth();
+}
+
+std::chrono::steady_clock::duration CUDAMiner::busyTime(unsigned streamIdx) const {
+    // Kernel time when timed, else launch to results copied back
+    double seconds = kernelTime(streamIdx);
+    if (seconds > 0) {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds));
+    }
+    return std::chrono::steady_clock::now() - m_launchedAt[streamIdx];
+}
+
+double CUDAMiner::kernelTime(unsigned streamIdx) const {
+    if (!m_kernelStart[streamIdx]) {
+        return 0;
+    }
+    float ms = 0;
+    if (cudaEventElapsedTime(&ms, m_kernelStart[streamIdx], m_kernelStop[streamIdx]) != cudaSuccess) {
+        return 0;
+    }
+    return ms / 1000.0;
+}
+
+double CUDAMiner::benchmark(uint64_t minHashes) {
+    cudaError_t err = cudaSetDevice(m_device.cudaDeviceIndex);
+
+    // Header contents do not affect the work per hash; a zero target is never met
+    std::array<uint8_t, INPUT_SIZE> pattern;
+    for (size_t i = 0; i < INPUT_SIZE; i++) {
+        pattern[i] = static_cast<uint8_t>(i);
+    }
+    Hash256 target{};
+    if (err == cudaSuccess) {
+        err = toshash_set_header(pattern.data());
+    }
+    if (err == cudaSuccess) {
+        err = toshash_set_target(target.data());
+    }
+
+    // Warm-up batch absorbs first-use costs (module load, clocks ramping)
+    uint64_t batch = static_cast<uint64_t>(m_gridSize) * m_blockSize;
+    bool ok = err == cudaSuccess && launchBatch(0, 0, m_gridSize, MIN_OUTPUT_CAPACITY);
+    if (ok) {
+        err = cudaStreamSynchronize(m_streams[0]);
+        ok = err == cudaSuccess;
+    }
+
+    // Same loop as mining: keep every stream busy, recycle whichever finishes
+    m_slots.clear();
+    uint64_t nonce = batch;
+    uint64_t hashes = 0;
+    auto started = std::chrono::steady_clock::now();
+    while (ok && (hashes < minHashes || hashes < 2 * batch)) {
+        int slot;
+        while (ok && (slot = m_slots.acquire()) >= 0) {
+            ok = launchBatch(nonce, static_cast<unsigned>(slot), m_gridSize, MIN_OUTPUT_CAPACITY);
+            nonce += batch;
+        }
+
+        unsigned streamIdx = 0;
+        if (ok) {
+            err = waitForStream(streamIdx);
+            ok = err == cudaSuccess;
+        }
+        if (ok) {
+            hashes += batch;
+            m_slots.release(streamIdx);
+        }
+    }
+    if (ok) {
+        for (unsigned i : m_slots.inFlight()) {
+            err = cudaStreamSynchronize(m_streams[i]);
+            ok = ok && err == cudaSuccess;
+            hashes += batch;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    drainStreams();
+
+    // Put the mining work back
+    if (m_deviceWork.valid) {
+        toshash_set_header(m_deviceWork.header.data());
+        toshash_set_target(m_deviceWork.target.data());
     }
+
+    if (!ok) {
+        if (err != cudaSuccess) {
+            Log::error(getName() + ": Benchmark error: " + cudaGetErrorString(err));
+        }
+        return 0.0;
+    }
+    return seconds > 0 ? static_cast<double>(hashes) / seconds : 0.0;
 }
 
-bool CUDAMiner::launchBatch(uint64_t startNonce, unsigned streamIdx) {
+bool CUDAMiner::hashBatch(const WorkPackage& work, uint64_t startNonce, unsigned count,
+                          std::vector<Hash256>& hashes) {
+    // Runs before the mining thread starts: the header is re-uploaded with the first job
+    cudaError_t err = cudaSetDevice(m_device.cudaDeviceIndex);
+    if (err == cudaSuccess) {
+        err = toshash_set_header(work.header.data());
+    }
+
+    uint64_t* d_hashes = nullptr;
+    if (err == cudaSuccess) {
+        err = cudaMalloc(&d_hashes, count * 4 * sizeof(uint64_t));
+    }
+    if (err == cudaSuccess) {
+        toshash_benchmark<<<count, 1>>>(d_hashes, startNonce, 1);
+        err = cudaGetLastError();
+    }
+
+    std::vector<uint64_t> words(count * 4);
+    if (err == cudaSuccess) {
+        err = cudaMemcpy(words.data(), d_hashes, words.size() * sizeof(uint64_t), cudaMemcpyDeviceToHost);
+    }
+    if (d_hashes) {
+        cudaFree(d_hashes);
+    }
+    if (err != cudaSuccess) {
+        Log::error(getName() + ": Self-test kernel error: " + cudaGetErrorString(err));
+        return false;
+    }
+
+    // Kernel stores each hash as four little-endian words
+    hashes.resize(count);
+    for (unsigned i = 0; i < count; i++) {
+        for (unsigned b = 0; b < HASH_SIZE; b++) {
+            hashes[i][b] = static_cast<uint8_t>(words[i * 4 + b / 8] >> ((b % 8) * 8));
+        }
+    }
+    return true;
+}
+
+bool CUDAMiner::launchBatch(uint64_t startNonce, unsigned streamIdx, unsigned gridSize, uint32_t outputs) {
     cudaError_t err;
 
-    // Clear output buffer (async)
+    // Clear output counters (async)
+    uint32_t maxChecks = getIntegritySample() > 0 ? MAX_CHECKS : 0;
     err = cudaMemsetAsync(d_output[streamIdx], 0, sizeof(uint32_t), m_streams[streamIdx]);
+    if (err == cudaSuccess && maxChecks > 0) {
+        err = cudaMemsetAsync(d_output[streamIdx] + checkOffset(outputs), 0, sizeof(uint32_t), m_streams[streamIdx]);
+    }
     if (err != cudaSuccess) {
         Log::error(getName() + ": cudaMemsetAsync failed: " + cudaGetErrorString(err));
         return false;
     }
 
-    // Launch kernel
-    toshash_search<<<m_gridSize, m_blockSize, 0, m_streams[streamIdx]>>>(d_output[streamIdx], startNonce);
+    // Launch kernel (between the batch sizer's timing events)
+    if (m_kernelStart[streamIdx]) {
+        cudaEventRecord(m_kernelStart[streamIdx], m_streams[streamIdx]);
+    }
+    toshash_search<<<gridSize, m_blockSize, 0, m_streams[streamIdx]>>>(d_output[streamIdx], startNonce, outputs,
+                                                                       maxChecks);
+    if (m_kernelStop[streamIdx]) {
+        cudaEventRecord(m_kernelStop[streamIdx], m_streams[streamIdx]);
+    }
 
     // Check for kernel launch errors
     err = cudaGetLastError();
@@ -340,9 +575,9 @@ bool CUDAMiner::launchBatch(uint64_t startNonce, unsigned streamIdx) {
         return false;
     }
 
-    // Async copy results back to pinned host memory
+    // Async copy results back to pinned host memory (only the slots this batch was given)
     err = cudaMemcpyAsync(m_output[streamIdx], d_output[streamIdx],
-                          OUTPUT_SIZE, cudaMemcpyDeviceToHost, m_streams[streamIdx]);
+                          outputSize(outputs), cudaMemcpyDeviceToHost, m_streams[streamIdx]);
     if (err != cudaSuccess) {
         Log::error(getName() + ": cudaMemcpyAsync failed: " + cudaGetErrorString(err));
         return false;
@@ -355,31 +590,103 @@ uint32_t CUDAMiner::readResults(unsigned streamIdx) {
     return m_output[streamIdx][0];  // Solution count
 }
 
-void CUDAMiner::processSolutions(unsigned streamIdx, uint64_t startNonce) {
+void CUDAMiner::readNonces(unsigned streamIdx, uint32_t count, std::vector<uint64_t>& nonces) const {
+    const uint32_t* output = m_output[streamIdx];
+    for (uint32_t i = 0; i < count; i++) {
+        nonces.push_back(output[1 + i * 2] | (static_cast<uint64_t>(output[1 + i * 2 + 1]) << 32));
+    }
+}
+
+void CUDAMiner::verifyNonces(const std::vector<uint64_t>& nonces) {
+    for (uint64_t solNonce : nonces) {
+        // Basic sanity check on nonce value
+        if (solNonce == 0 || solNonce == UINT64_MAX) {
+            Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":suspicious",
+                         getName() + ": Suspicious nonce value " + std::to_string(solNonce) + ", skipping");
+            continue;
+        }
+
+        // Verify on CPU before submitting
+        verifySolution(solNonce);
+    }
+}
+
+bool CUDAMiner::processSolutions(unsigned streamIdx) {
     uint32_t solutionCount = readResults(streamIdx);
+    uint32_t outputs = m_batchOutputs[streamIdx];
+
+    // More solutions than nonces can only be a device fault: take the
+    // stored ones, but do not size buffers or rescan for it
+    bool overflowed = false;
+    if (solutionCount > m_batchSize[streamIdx]) {
+        Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":count",
+                     getName() + ": GPU returned invalid solution count " + std::to_string(solutionCount) +
+                     " for " + std::to_string(m_batchSize[streamIdx]) + " nonces");
+    } else {
+        overflowed = m_outputSizer.record(solutionCount, outputs);
+    }
 
-    // Bounds check - cap solution count to prevent buffer overflow
-    if (solutionCount > MAX_OUTPUTS) {
-        Log::warning(getName() + ": GPU returned invalid solution count " +
-                    std::to_string(solutionCount) + ", capping to " + std::to_string(MAX_OUTPUTS));
-        solutionCount = MAX_OUTPUTS;
+    std::vector<uint64_t> nonces;
+    readNonces(streamIdx, std::min(solutionCount, outputs), nonces);
+    verifyNonces(nonces);
+    return overflowed;
+}
+
+void CUDAMiner::rescanBatch(unsigned streamIdx) {
+    uint32_t outputs = m_batchOutputs[streamIdx];
+    recordOutputOverflow();
+    Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":overflow",
+                 getName() + ": " + std::to_string(readResults(streamIdx)) + " solutions in a batch with " +
+                 std::to_string(outputs) + " slots, rescanning " + std::to_string(m_batchSize[streamIdx]) + " nonces");
+
+    // Nonces the batch returned were already submitted
+    std::vector<uint64_t> returned;
+    readNonces(streamIdx, outputs, returned);
+    std::set<uint64_t> seen(returned.begin(), returned.end());
+
+    std::vector<uint64_t> found;
+    RescanResult result = OutputSizer::rescan(
+        {m_batchNonce[streamIdx], m_batchSize[streamIdx]}, m_blockSize, seen,
+        [&](const NonceRange& range, std::vector<uint64_t>& nonces, uint32_t& hits) {
+            return searchRange(range, streamIdx, nonces, hits);
+        },
+        found);
+
+    if (!result.ok) {
+        Log::error(getName() + ": Rescan launch failed");
+    } else if (result.unresolved > 0) {
+        Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":unresolved",
+                     getName() + ": Rescan still overflowed in " + std::to_string(result.unresolved) +
+                     " ranges, some solutions lost");
     }
+    verifyNonces(found);
+}
 
-    if (solutionCount > 0) {
-        for (uint32_t i = 0; i < solutionCount; i++) {
-            uint64_t solNonce = m_output[streamIdx][1 + i * 2] |
-                               (static_cast<uint64_t>(m_output[streamIdx][1 + i * 2 + 1]) << 32);
+bool CUDAMiner::searchRange(const NonceRange& range, unsigned streamIdx, std::vector<uint64_t>& nonces,
+                            uint32_t& count) {
+    unsigned gridSize = static_cast<unsigned>(range.size / std::max(1u, m_blockSize));
+    if (!launchBatch(range.start, streamIdx, std::max(1u, gridSize), MAX_OUTPUT_CAPACITY)) {
+        return false;
+    }
+    cudaError_t err = cudaStreamSynchronize(m_streams[streamIdx]);
+    if (err != cudaSuccess) {
+        Log::error(getName() + ": Rescan sync failed: " + cudaGetErrorString(err));
+        return false;
+    }
 
-            // Basic sanity check on nonce value
-            if (solNonce == 0 || solNonce == UINT64_MAX) {
-                Log::warning(getName() + ": Suspicious nonce value " + std::to_string(solNonce) + ", skipping");
-                continue;
-            }
+    count = readResults(streamIdx);
+    readNonces(streamIdx, std::min(count, MAX_OUTPUT_CAPACITY), nonces);
+    return true;
+}
 
-            // Verify on CPU before submitting
-            verifySolution(solNonce);
-        }
+void CUDAMiner::processChecks(unsigned streamIdx, uint64_t hashes) {
+    if (getIntegritySample() == 0) {
+        return;
     }
+
+    const uint32_t* checks = m_output[streamIdx] + checkOffset(m_batchOutputs[streamIdx]);
+    uint32_t hits = checks[0];
+    checkIntegrity(m_deviceWork, hashes, m_integrityBits, hits, checks + 1, std::min(hits, MAX_CHECKS));
 }
 
 std::vector<DeviceDescriptor> CUDAMiner::enumDevices() {
@@ -392,6 +699,13 @@ std::vector<DeviceDescriptor> CUDAMiner::enumDevices() {
         return devices;
     }
 
+    // Driver version as major.minor (e.g. 12040 -> "12.4")
+    int driver = 0;
+    std::string driverVersion;
+    if (cudaDriverGetVersion(&driver) == cudaSuccess && driver > 0) {
+        driverVersion = std::to_string(driver / 1000) + "." + std::to_string((driver % 1000) / 10);
+    }
+
     for (int i = 0; i < deviceCount; i++) {
         cudaDeviceProp props;
         err = cudaGetDeviceProperties(&props, i);
@@ -406,6 +720,7 @@ std::vector<DeviceDescriptor> CUDAMiner::enumDevices() {
         desc.name = props.name;
         desc.totalMemory = props.totalGlobalMem;
         desc.computeUnits = props.multiProcessorCount;
+        desc.driverVersion = driverVersion;
         desc.cudaDeviceIndex = i;
         desc.cudaComputeCapabilityMajor = props.major;
         desc.cudaComputeCapabilityMinor = props.minor;
@@ -9,7 +9,11 @@
 #ifdef WITH_CUDA
 
 #include "core/Miner.h"
+#include "core/OutputSizer.h"
+#include "core/PipelineSlots.h"
+#include "core/TuningProfiles.h"
 #include <cuda_runtime.h>
+#include <chrono>
 #include <vector>
 
 namespace tos {
@@ -63,12 +67,52 @@ public:
         s_blockSize = size;
     }
 
+    /**
+     * Set number of streams, each with one batch in flight (1 .. MAX_PIPELINE_DEPTH)
+     */
+    static void setStreamCount(unsigned streams) {
+        s_streamCount = PipelineSlots::clampDepth(streams);
+    }
+
+    /**
+     * Use per-device settings instead of the global ones (call before init)
+     *
+     * @param profile Grid size, block size and streams (OpenCL fields ignored)
+     */
+    void setTuning(const TuningProfile& profile) {
+        m_tuning = profile;
+        m_tuned = true;
+    }
+
+    /**
+     * Get number of streams in the pipeline (valid after init)
+     */
+    unsigned getStreamCount() const { return m_slots.depth(); }
+
+    /**
+     * Measure raw hash rate through the search pipeline (no solutions, no pool)
+     *
+     * Runs the mining kernel on every stream against an unreachable target,
+     * so the stream count shows up in the result. Leaves the current work
+     * on the device.
+     *
+     * @param minHashes Hash at least this many nonces after a warm-up batch
+     * @return Hashes per second, 0 on error
+     */
+    double benchmark(uint64_t minHashes);
+
 protected:
     /**
      * Main mining loop
      */
     void mineLoop() override;
 
+    /**
+     * Hash consecutive nonces with the benchmark kernel (self-test)
+     */
+    bool hashBatch(const WorkPackage& work, uint64_t startNonce, unsigned count,
+                   std::vector<Hash256>& hashes) override;
+
 private:
     /**
      * Allocate GPU buffers
@@ -80,14 +124,70 @@ private:
      */
     void freeBuffers();
 
+    /**
+     * Get batch sizer's grid size
+     */
+    unsigned batchGridSize() const;
+
+    /**
+     * Get batches that may be in flight: one while throttled (intensity
+     * below 100), so the idle time after it leaves the device idle
+     */
+    unsigned launchLimit() const;
+
+    /**
+     * Get the time a finished batch kept the device busy (duty cycle)
+     */
+    std::chrono::steady_clock::duration busyTime(unsigned streamIdx) const;
+
+    /**
+     * Get kernel time of the last batch on a stream in seconds (0 if not timed)
+     */
+    double kernelTime(unsigned streamIndex) const;
+
+    /**
+     * Wait for a batch to finish, taking any idle stream before the oldest
+     *
+     * @param streamIndex Output: stream of the finished batch (still marked in flight)
+     * @return cudaSuccess, or the error the stream reported
+     */
+    cudaError_t waitForStream(unsigned& streamIndex);
+
+    /**
+     * Wait for every stream and drop the results in flight
+     */
+    void drainStreams();
+
     /**
      * Launch a batch on specified stream
      *
      * @param startNonce Starting nonce
      * @param streamIndex Which stream to use
+     * @param gridSize Number of blocks to launch
+     * @param outputs Solution slots to store (up to MAX_OUTPUT_CAPACITY)
      * @return true if launch succeeded, false on error
      */
-    bool launchBatch(uint64_t startNonce, unsigned streamIndex);
+    bool launchBatch(uint64_t startNonce, unsigned streamIndex, unsigned gridSize, uint32_t outputs);
+
+    /**
+     * Re-search a batch whose solutions overflowed its output buffer
+     *
+     * Runs synchronously on the batch's stream, skipping the nonces the
+     * batch already returned.
+     */
+    void rescanBatch(unsigned streamIndex);
+
+    /**
+     * Search a nonce range synchronously on a stream (rescans)
+     *
+     * @param range Nonces to search (size a multiple of the block size)
+     * @param streamIndex Stream whose buffers to use
+     * @param nonces Solutions stored by the device
+     * @param count Solutions the device counted
+     * @return true if the launch succeeded
+     */
+    bool searchRange(const NonceRange& range, unsigned streamIndex, std::vector<uint64_t>& nonces,
+                     uint32_t& count);
 
     /**
      * Read results from specified stream
@@ -97,43 +197,94 @@ private:
      */
     uint32_t readResults(unsigned streamIndex);
 
+    /**
+     * Read solution nonces from a stream's host copy
+     *
+     * @param streamIndex Stream containing results
+     * @param count Solutions to read
+     * @param nonces Output nonces (appended)
+     */
+    void readNonces(unsigned streamIndex, uint32_t count, std::vector<uint64_t>& nonces) const;
+
+    /**
+     * Verify and submit solution nonces, skipping implausible values
+     */
+    void verifyNonces(const std::vector<uint64_t>& nonces);
+
     /**
      * Process solutions from specified stream
      *
      * @param streamIndex Stream containing results
-     * @param startNonce Starting nonce for this batch
+     * @return true if solutions overflowed the batch's output slots
+     */
+    bool processSolutions(unsigned streamIndex);
+
+    /**
+     * Pass a batch's easy-target hits to integrity sampling
+     *
+     * @param streamIndex Stream containing results
+     * @param hashes Nonces covered by the batch
      */
-    void processSolutions(unsigned streamIndex, uint64_t startNonce);
+    void processChecks(unsigned streamIndex, uint64_t hashes);
 
 private:
     // Multi-stream constants
-    static constexpr unsigned c_numStreams = 2;
+    static constexpr unsigned c_maxStreams = MAX_PIPELINE_DEPTH;
+
+    // CUDA streams (multi-stream pipeline); the first m_slots.depth() are used
+    cudaStream_t m_streams[c_maxStreams];
+    PipelineSlots m_slots;
 
-    // CUDA streams (multi-stream pipeline)
-    cudaStream_t m_streams[c_numStreams];
+    // Kernel start/stop events (per stream, batch sizer on)
+    cudaEvent_t m_kernelStart[c_maxStreams];
+    cudaEvent_t m_kernelStop[c_maxStreams];
 
     // GPU buffers (per stream)
-    uint32_t* d_output[c_numStreams];
+    uint32_t* d_output[c_maxStreams];
 
     // Host-side output buffers (per stream, pinned memory for async transfer)
-    uint32_t* m_output[c_numStreams];
+    uint32_t* m_output[c_maxStreams];
+
+    // Work uploaded to the device (mining thread only)
+    WorkPackage m_deviceWork;
+
+    // Integrity check target difficulty (see Miner::setIntegritySample)
+    unsigned m_integrityBits = 1;
 
     // Batch tracking
-    uint64_t m_batchNonce[c_numStreams];  // Starting nonce for each stream's batch
-    unsigned m_currentStream = 0;
-    uint64_t m_batchCount = 0;
+    uint64_t m_batchNonce[c_maxStreams];  // Starting nonce for each stream's batch
+    uint64_t m_batchSize[c_maxStreams];   // Nonces covered by each stream's batch
+    uint32_t m_batchOutputs[c_maxStreams];  // Solution slots each stream's batch was given
+    std::chrono::steady_clock::time_point m_launchedAt[c_maxStreams];  // Host time of each launch
 
-    // Grid and block dimensions
+    // Solution slots for the next batch (see OutputSizer)
+    OutputSizer m_outputSizer;
+
+    // Grid and block dimensions; m_gridSize is the configured or auto-tuned
+    // size, the batch sizer picks the current one
     unsigned m_gridSize;
     unsigned m_blockSize;
 
-    // Maximum solutions per batch
-    static constexpr uint32_t MAX_OUTPUTS = 64;
-    static constexpr size_t OUTPUT_SIZE = (1 + MAX_OUTPUTS * 2) * sizeof(uint32_t);
+    // Batch sizer range relative to m_gridSize
+    static constexpr unsigned BATCH_GROWTH = 4;
+    static constexpr unsigned BATCH_SHRINK = 16;
+
+    // Maximum integrity check hits per batch, stored after the batch's solution slots;
+    // buffers are sized for the most slots
+    static constexpr uint32_t MAX_CHECKS = 32;
+    static constexpr uint32_t checkOffset(uint32_t outputs) { return 1 + outputs * 2; }
+    static constexpr size_t outputSize(uint32_t outputs) {
+        return (checkOffset(outputs) + 1 + MAX_CHECKS * 2) * sizeof(uint32_t);
+    }
+
+    // Per-device settings (see setTuning), else the static ones below
+    TuningProfile m_tuning;
+    bool m_tuned = false;
 
     // Static configuration
     static unsigned s_gridSizeMultiplier;
     static unsigned s_blockSize;
+    static unsigned s_streamCount;
 };
 
 }  // namespace tos
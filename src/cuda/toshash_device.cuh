@@ -0,0 +1,276 @@
+/**
+ * TOS Hash V3 - CUDA Device Functions
+ *
+ * Hash stages used by the CUDA kernels. Plain C++ outside nvcc, so the
+ * conformance test can run the CUDA code path against the CPU reference
+ * on machines without a GPU.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#ifdef __CUDACC__
+    #define TOS_DEVICE __device__ __forceinline__
+    #define TOS_CONSTANT __constant__
+#else
+    #define TOS_DEVICE inline
+    #define TOS_CONSTANT static const
+#endif
+
+namespace tos {
+namespace cuda {
+
+// TOS Hash V3 parameters
+constexpr uint32_t MEMORY_SIZE = 8192;        // 64KB / 8 bytes = 8192 uint64
+constexpr uint32_t MIXING_ROUNDS = 8;
+constexpr uint32_t MEMORY_PASSES = 4;
+constexpr uint64_t MIX_CONST = 0x517cc1b727220a95ULL;
+constexpr uint32_t INPUT_SIZE = 112;
+constexpr uint32_t HASH_SIZE = 32;
+constexpr uint32_t NONCE_OFFSET = 40;         // Nonce bytes 40-47, big-endian
+
+// Blake3 flags
+constexpr uint32_t BLAKE3_CHUNK_START = 1;
+constexpr uint32_t BLAKE3_CHUNK_END = 2;
+constexpr uint32_t BLAKE3_ROOT = 8;
+
+// Blake3 IV
+TOS_CONSTANT uint32_t BLAKE3_IV[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+// Blake3 message schedule
+TOS_CONSTANT uint8_t MSG_SCHEDULE[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13}
+};
+
+// Strides for stage 3
+TOS_CONSTANT uint64_t STRIDES[4] = {1, 64, 256, 1024};
+
+// Rotate functions
+TOS_DEVICE uint64_t rotl64(uint64_t x, uint32_t r) {
+    r &= 63;
+    return (x << r) | (x >> ((64 - r) & 63));
+}
+
+TOS_DEVICE uint64_t rotr64(uint64_t x, uint32_t r) {
+    r &= 63;
+    return (x >> r) | (x << ((64 - r) & 63));
+}
+
+TOS_DEVICE uint32_t rotr32(uint32_t x, uint32_t r) {
+    return (x >> r) | (x << (32 - r));
+}
+
+// TOS Hash mixing function
+TOS_DEVICE uint64_t toshash_mix(uint64_t a, uint64_t b, uint64_t round) {
+    uint32_t rot = (uint32_t)((round * 7) % 64);
+    uint64_t x = a + b;
+    uint64_t y = a ^ rotl64(b, rot);
+    uint64_t z = x * MIX_CONST;
+    return z ^ rotr64(y, rot / 2);
+}
+
+// Blake3 G function
+TOS_DEVICE void blake3_g(uint32_t* state, uint32_t a, uint32_t b, uint32_t c, uint32_t d,
+                         uint32_t mx, uint32_t my) {
+    state[a] = state[a] + state[b] + mx;
+    state[d] = rotr32(state[d] ^ state[a], 16);
+    state[c] = state[c] + state[d];
+    state[b] = rotr32(state[b] ^ state[c], 12);
+    state[a] = state[a] + state[b] + my;
+    state[d] = rotr32(state[d] ^ state[a], 8);
+    state[c] = state[c] + state[d];
+    state[b] = rotr32(state[b] ^ state[c], 7);
+}
+
+// Blake3 round
+TOS_DEVICE void blake3_round(uint32_t* state, const uint32_t* m, uint32_t round) {
+    // Column step
+    blake3_g(state, 0, 4, 8, 12, m[MSG_SCHEDULE[round][0]], m[MSG_SCHEDULE[round][1]]);
+    blake3_g(state, 1, 5, 9, 13, m[MSG_SCHEDULE[round][2]], m[MSG_SCHEDULE[round][3]]);
+    blake3_g(state, 2, 6, 10, 14, m[MSG_SCHEDULE[round][4]], m[MSG_SCHEDULE[round][5]]);
+    blake3_g(state, 3, 7, 11, 15, m[MSG_SCHEDULE[round][6]], m[MSG_SCHEDULE[round][7]]);
+
+    // Diagonal step
+    blake3_g(state, 0, 5, 10, 15, m[MSG_SCHEDULE[round][8]], m[MSG_SCHEDULE[round][9]]);
+    blake3_g(state, 1, 6, 11, 12, m[MSG_SCHEDULE[round][10]], m[MSG_SCHEDULE[round][11]]);
+    blake3_g(state, 2, 7, 8, 13, m[MSG_SCHEDULE[round][12]], m[MSG_SCHEDULE[round][13]]);
+    blake3_g(state, 3, 4, 9, 14, m[MSG_SCHEDULE[round][14]], m[MSG_SCHEDULE[round][15]]);
+}
+
+// Blake3 compression of one 64-byte block into the chaining value
+TOS_DEVICE void blake3_compress(uint32_t* cv, const uint32_t* m, uint32_t block_len, uint32_t flags) {
+    uint32_t state[16];
+    for (int i = 0; i < 8; i++) {
+        state[i] = cv[i];
+    }
+    state[8] = BLAKE3_IV[0];
+    state[9] = BLAKE3_IV[1];
+    state[10] = BLAKE3_IV[2];
+    state[11] = BLAKE3_IV[3];
+    state[12] = 0;  // counter low
+    state[13] = 0;  // counter high
+    state[14] = block_len;
+    state[15] = flags;
+
+    for (uint32_t round = 0; round < 7; round++) {
+        blake3_round(state, m, round);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        cv[i] = state[i] ^ state[i + 8];
+    }
+}
+
+// Blake3 hash of a single-chunk input (up to 1024 bytes; we hash 112 and 32)
+TOS_DEVICE void blake3_hash(const uint8_t* input, uint32_t input_len, uint8_t* output) {
+    uint32_t cv[8];
+    for (int i = 0; i < 8; i++) {
+        cv[i] = BLAKE3_IV[i];
+    }
+
+    uint32_t blocks = input_len == 0 ? 1 : (input_len + 63) / 64;
+    for (uint32_t block = 0; block < blocks; block++) {
+        uint32_t offset = block * 64;
+        uint32_t block_len = input_len - offset < 64 ? input_len - offset : 64;
+
+        // Message words, little-endian, zero padded
+        uint32_t m[16];
+        for (int i = 0; i < 16; i++) {
+            m[i] = 0;
+        }
+        for (uint32_t i = 0; i < block_len; i++) {
+            m[i / 4] |= ((uint32_t)input[offset + i]) << ((i % 4) * 8);
+        }
+
+        uint32_t flags = 0;
+        if (block == 0) flags |= BLAKE3_CHUNK_START;
+        if (block == blocks - 1) flags |= BLAKE3_CHUNK_END | BLAKE3_ROOT;
+        blake3_compress(cv, m, block_len, flags);
+    }
+
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 4; j++) {
+            output[i * 4 + j] = (uint8_t)(cv[i] >> (j * 8));
+        }
+    }
+}
+
+// Header with the nonce at NONCE_OFFSET (big-endian), as the CPU hashes it
+TOS_DEVICE void prepare_input(const uint8_t* header, uint64_t nonce, uint8_t* input) {
+    for (uint32_t i = 0; i < INPUT_SIZE; i++) {
+        input[i] = header[i];
+    }
+    for (int i = 0; i < 8; i++) {
+        input[NONCE_OFFSET + i] = (uint8_t)(nonce >> ((7 - i) * 8));
+    }
+}
+
+// Stage 1: Initialize scratchpad
+TOS_DEVICE void stage1_init(const uint8_t* input, uint32_t input_len, uint64_t* scratch) {
+    uint8_t hash[32];
+    blake3_hash(input, input_len, hash);
+
+    uint64_t state[4];
+    for (int i = 0; i < 4; i++) {
+        state[i] = 0;
+        for (int j = 0; j < 8; j++) {
+            state[i] |= ((uint64_t)hash[i * 8 + j]) << (j * 8);
+        }
+    }
+
+    for (uint32_t i = 0; i < MEMORY_SIZE; i++) {
+        uint32_t idx = i % 4;
+        state[idx] = toshash_mix(state[idx], state[(idx + 1) % 4], i);
+        scratch[i] = state[idx];
+    }
+}
+
+// Stage 2: Sequential memory mixing
+TOS_DEVICE void stage2_mix(uint64_t* scratch) {
+    for (uint32_t pass = 0; pass < MEMORY_PASSES; pass++) {
+        if (pass % 2 == 0) {
+            uint64_t carry = scratch[MEMORY_SIZE - 1];
+            for (uint32_t i = 0; i < MEMORY_SIZE; i++) {
+                uint64_t prev = (i > 0) ? scratch[i - 1] : scratch[MEMORY_SIZE - 1];
+                scratch[i] = toshash_mix(scratch[i], prev ^ carry, pass);
+                carry = scratch[i];
+            }
+        } else {
+            uint64_t carry = scratch[0];
+            for (uint32_t i = MEMORY_SIZE; i > 0; i--) {
+                uint32_t idx = i - 1;
+                uint64_t next = (idx < MEMORY_SIZE - 1) ? scratch[idx + 1] : scratch[0];
+                scratch[idx] = toshash_mix(scratch[idx], next ^ carry, pass);
+                carry = scratch[idx];
+            }
+        }
+    }
+}
+
+// Stage 3: Strided memory mixing
+TOS_DEVICE void stage3_strided(uint64_t* scratch) {
+    for (uint32_t round = 0; round < MIXING_ROUNDS; round++) {
+        uint64_t stride = STRIDES[round % 4];
+
+        for (uint32_t i = 0; i < MEMORY_SIZE; i++) {
+            uint32_t j = (i + stride) % MEMORY_SIZE;
+            uint32_t k = (i + stride * 2) % MEMORY_SIZE;
+
+            uint64_t a = scratch[i];
+            uint64_t b = scratch[j];
+            uint64_t c = scratch[k];
+
+            scratch[i] = toshash_mix(a, b ^ c, round);
+        }
+    }
+}
+
+// Stage 4: Finalize
+TOS_DEVICE void stage4_finalize(const uint64_t* scratch, uint8_t* output) {
+    uint64_t folded[4] = {0, 0, 0, 0};
+    for (uint32_t i = 0; i < MEMORY_SIZE; i++) {
+        folded[i % 4] ^= scratch[i];
+    }
+
+    uint8_t bytes[32];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 8; j++) {
+            bytes[i * 8 + j] = (uint8_t)((folded[i] >> (j * 8)) & 0xFF);
+        }
+    }
+
+    blake3_hash(bytes, 32, output);
+}
+
+// Scratchpad checksum for conformance traces (see TosHash::checksum)
+TOS_DEVICE uint64_t scratch_checksum(const uint64_t* scratch) {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < MEMORY_SIZE; i++) {
+        sum = rotl64(sum, 1) ^ scratch[i];
+    }
+    return sum;
+}
+
+// Full TOS Hash V3 of header with nonce
+TOS_DEVICE void toshash_hash(const uint8_t* header, uint64_t nonce, uint64_t* scratch, uint8_t* hash) {
+    uint8_t input[INPUT_SIZE];
+    prepare_input(header, nonce, input);
+
+    stage1_init(input, INPUT_SIZE, scratch);
+    stage2_mix(scratch);
+    stage3_strided(scratch);
+    stage4_finalize(scratch, hash);
+}
+
+}  // namespace cuda
+}  // namespace tos
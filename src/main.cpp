@@ -7,14 +7,23 @@
 #include "MinerCLI.h"
 #include "core/Farm.h"
 #include "core/Miner.h"
+#include "core/Telemetry.h"
+#include "core/PowerGovernor.h"
+#include "core/HostLoadGovernor.h"
+#include "core/RecoverySupervisor.h"
+#include "core/AutoTuner.h"
+#include "core/TuningDatabase.h"
 #include "toshash/TosHash.h"
 #include "stratum/StratumClient.h"
 #include "api/ApiServer.h"
+#include "api/ShmStatsPublisher.h"
 #include "util/Log.h"
 #include "util/GpuMonitor.h"
+#include "util/CpuMonitor.h"
 
 #ifdef WITH_OPENCL
 #include "opencl/CLMiner.h"
+#include "opencl/CLProgramCache.h"
 #endif
 
 #ifdef WITH_CUDA
@@ -29,6 +38,7 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <ctime>
 
 using namespace tos;
 
@@ -94,6 +104,62 @@ void listDevices() {
     std::cout << std::endl;
 }
 
+#ifdef WITH_OPENCL
+/**
+ * Point the compiled kernel cache at the configured directory; identical
+ * devices still share one build without it
+ */
+void configureProgramCache(const MinerConfig& config) {
+    if (config.clCache) {
+        CLProgramCache::setDirectory(config.clCacheDir.empty() ? CLProgramCache::defaultDirectory()
+                                                               : config.clCacheDir);
+    } else {
+        CLProgramCache::setDirectory("");
+    }
+}
+
+/**
+ * Benchmark each OpenCL device under every scratchpad layout
+ */
+void runOpenCLBenchmark(const MinerConfig& config) {
+    CLMiner::setGlobalWorkSizeMultiplier(config.openclGlobalWorkSize);
+    CLMiner::setLocalWorkSize(config.openclLocalWorkSize);
+    CLMiner::setPipelineDepth(config.openclPipelineDepth);
+    CLMiner::setOutOfOrder(config.openclOutOfOrder);
+    CLMiner::setProfiling(config.openclProfiling);
+
+    for (const auto& dev : CLMiner::enumDevices()) {
+        if (!config.openclDevices.empty() &&
+            std::find(config.openclDevices.begin(), config.openclDevices.end(), dev.index) ==
+                config.openclDevices.end()) {
+            continue;
+        }
+
+        std::cout << "\nOpenCL " << dev.index << " (" << dev.name << "):\n";
+        for (ScratchLayout layout : {ScratchLayout::Local, ScratchLayout::Contiguous,
+                                     ScratchLayout::Interleaved, ScratchLayout::Blocked}) {
+            CLMiner::setScratchLayout(layout);
+            CLMiner miner(dev.index, dev);
+            std::cout << "  " << std::left << std::setw(12) << scratchLayoutName(layout) << std::right;
+
+            if (!miner.init()) {
+                std::cout << "failed to initialize\n";
+                continue;
+            }
+            if (miner.getScratchLayout() != layout) {
+                std::cout << "not supported on this device\n";
+                continue;
+            }
+
+            double rate = miner.benchmark(config.benchmarkIterations);
+            std::cout << rate << " H/s\n";
+        }
+    }
+
+    CLMiner::setScratchLayout(config.openclScratch);
+}
+#endif
+
 void runBenchmark(const MinerConfig& config) {
     Log::info("Starting benchmark...");
 
@@ -112,10 +178,9 @@ void runBenchmark(const MinerConfig& config) {
     double usPerHash = 1000000.0 / hashRate;
     std::cout << "Time per hash: " << usPerHash << " µs\n";
 
-    // GPU benchmark would go here
 #ifdef WITH_OPENCL
     if (config.useOpenCL) {
-        Log::info("OpenCL benchmark not yet implemented");
+        runOpenCLBenchmark(config);
     }
 #endif
 
@@ -128,23 +193,247 @@ void runBenchmark(const MinerConfig& config) {
     std::cout << std::endl;
 }
 
+/**
+ * Open the tuning database selected on the command line
+ */
+TuningDatabase openTuningDatabase(const MinerConfig& config) {
+    TuningDatabase database(config.tuningDb.empty() ? TuningDatabase::defaultPath() : config.tuningDb);
+    if (!database.load()) {
+        Log::warning("Tuning database " + database.path() + " is unreadable, ignoring it");
+    }
+    return database;
+}
+
+/**
+ * Starting point of a device's sweep: the command line profile if given,
+ * else the profile detected from the device name
+ */
+TuningProfile tuningStart(const MinerConfig& config, const std::string& deviceName) {
+    if (!config.tuningExplicit) {
+        return TuningProfiles::getProfile(TuningProfiles::detect(deviceName));
+    }
+    TuningProfile profile = TuningProfiles::getProfile(config.tuningProfile);
+    profile.openclGlobalWorkSize = config.openclGlobalWorkSize;
+    profile.openclLocalWorkSize = config.openclLocalWorkSize;
+    profile.openclNonceLoop = config.openclNonceLoop;
+    profile.openclScratch = config.openclScratch;
+    profile.openclPipelineDepth = config.openclPipelineDepth;
+    profile.cudaGridSize = config.cudaGridSize;
+    profile.cudaBlockSize = config.cudaBlockSize;
+    profile.cudaStreams = config.cudaStreams;
+    return profile;
+}
+
+/**
+ * Record a device's sweep result in the database
+ */
+void storeTuning(TuningDatabase& database, const DeviceDescriptor& dev, const TuningProfile& profile,
+                 double hashRate) {
+    TuningEntry entry;
+    entry.backend = dev.type;
+    entry.device = dev.name;
+    entry.driver = dev.driverVersion;
+    entry.profile = profile;
+    entry.profile.name = "tuned";
+    entry.profile.description = "Auto-tuned for " + dev.name;
+    entry.hashRate = hashRate;
+    entry.tunedAt = static_cast<int64_t>(std::time(nullptr));
+    database.store(entry);
+}
+
+/**
+ * Benchmark GPU settings per device and save the fastest to the tuning database
+ *
+ * OpenCL sweeps scratchpad layout, local and global work size and pipeline
+ * depth; CUDA sweeps the grid size and stream count. Each candidate builds
+ * the device from scratch, must pass the known-answer self-test, and then
+ * runs the mining pipeline against an unreachable target (see AutoTuner).
+ * Candidates that hash wrong are never ranked or saved.
+ */
+void runAutoTune(const MinerConfig& config) {
+    TuningDatabase database = openTuningDatabase(config);
+    unsigned tuned = 0;
+
+    std::cout << std::fixed << std::setprecision(2);
+
+#ifdef WITH_OPENCL
+    if (config.useOpenCL) {
+        configureProgramCache(config);
+        CLMiner::setOutOfOrder(config.openclOutOfOrder);
+        CLMiner::setProfiling(config.openclProfiling);
+
+        for (const auto& dev : CLMiner::enumDevices()) {
+            if (!config.openclDevices.empty() &&
+                std::find(config.openclDevices.begin(), config.openclDevices.end(), dev.index) ==
+                    config.openclDevices.end()) {
+                continue;
+            }
+
+            TuningProfile start = tuningStart(config, dev.name);
+            std::cout << "\nTuning OpenCL " << dev.index << " (" << dev.name << ")\n";
+
+            AutoTuner tuner;
+            tuner.addAxis("scratch", {static_cast<unsigned>(ScratchLayout::Local),
+                                      static_cast<unsigned>(ScratchLayout::Contiguous),
+                                      static_cast<unsigned>(ScratchLayout::Interleaved),
+                                      static_cast<unsigned>(ScratchLayout::Blocked)},
+                          [](TuningProfile& p, unsigned v) { p.openclScratch = static_cast<ScratchLayout>(v); });
+            tuner.addAxis("local", {1, 32, 64, 128, 256},
+                          [](TuningProfile& p, unsigned v) { p.openclLocalWorkSize = v; });
+            tuner.addAxis("global", AutoTuner::powersAround(start.openclGlobalWorkSize, 2, 2, 1024, 1u << 20),
+                          [](TuningProfile& p, unsigned v) { p.openclGlobalWorkSize = v; });
+            tuner.addAxis("depth", {1, 2, 3, 4},
+                          [](TuningProfile& p, unsigned v) { p.openclPipelineDepth = v; });
+
+            TuningProfile best = tuner.run(start, [&](const TuningProfile& p) {
+                std::cout << "  " << std::left << std::setw(12) << scratchLayoutName(p.openclScratch)
+                          << " local " << std::setw(4) << p.openclLocalWorkSize
+                          << " global " << std::setw(8) << p.openclGlobalWorkSize
+                          << " depth " << std::setw(2) << p.openclPipelineDepth << std::right;
+
+                CLMiner miner(dev.index, dev);
+                miner.setTuning(p);
+                if (!miner.init() || miner.getScratchLayout() != p.openclScratch) {
+                    std::cout << "not supported\n";
+                    return 0.0;
+                }
+                if (!miner.selfTest()) {
+                    std::cout << "wrong hashes\n";
+                    return 0.0;
+                }
+                double rate = miner.benchmark(config.benchmarkIterations);
+                std::cout << rate << " H/s\n";
+                return rate;
+            });
+
+            if (tuner.bestRate() <= 0) {
+                std::cout << "  No setting ran on this device\n";
+                continue;
+            }
+            std::cout << "  Best: " << scratchLayoutName(best.openclScratch)
+                      << ", local " << best.openclLocalWorkSize
+                      << ", global " << best.openclGlobalWorkSize
+                      << ", depth " << best.openclPipelineDepth
+                      << " (" << tuner.bestRate() << " H/s, " << tuner.measurements() << " runs)\n";
+            storeTuning(database, dev, best, tuner.bestRate());
+            tuned++;
+        }
+    }
+#endif
+
+#ifdef WITH_CUDA
+    if (config.useCUDA) {
+        for (const auto& dev : CUDAMiner::enumDevices()) {
+            if (!config.cudaDevices.empty() &&
+                std::find(config.cudaDevices.begin(), config.cudaDevices.end(), dev.index) ==
+                    config.cudaDevices.end()) {
+                continue;
+            }
+
+            TuningProfile start = tuningStart(config, dev.name);
+            std::cout << "\nTuning CUDA " << dev.index << " (" << dev.name << ")\n";
+
+            // Threads in a block share one scratchpad, so the block size is not swept
+            AutoTuner tuner;
+            tuner.addAxis("grid", AutoTuner::powersAround(start.cudaGridSize, 2, 2, 1024, 1u << 20),
+                          [](TuningProfile& p, unsigned v) { p.cudaGridSize = v; });
+            tuner.addAxis("streams", {1, 2, 3, 4},
+                          [](TuningProfile& p, unsigned v) { p.cudaStreams = v; });
+
+            TuningProfile best = tuner.run(start, [&](const TuningProfile& p) {
+                std::cout << "  grid " << std::left << std::setw(8) << p.cudaGridSize
+                          << " streams " << std::setw(2) << p.cudaStreams << std::right;
+
+                CUDAMiner miner(dev.index, dev);
+                miner.setTuning(p);
+                if (!miner.init()) {
+                    std::cout << "not supported\n";
+                    return 0.0;
+                }
+                if (!miner.selfTest()) {
+                    std::cout << "wrong hashes\n";
+                    return 0.0;
+                }
+                double rate = miner.benchmark(config.benchmarkIterations);
+                std::cout << rate << " H/s\n";
+                return rate;
+            });
+
+            if (tuner.bestRate() <= 0) {
+                std::cout << "  No setting ran on this device\n";
+                continue;
+            }
+            std::cout << "  Best: grid " << best.cudaGridSize
+                      << ", streams " << best.cudaStreams
+                      << " (" << tuner.bestRate() << " H/s, " << tuner.measurements() << " runs)\n";
+            storeTuning(database, dev, best, tuner.bestRate());
+            tuned++;
+        }
+    }
+#endif
+
+    if (tuned == 0) {
+        Log::error("No GPU was tuned");
+        return;
+    }
+    if (!database.save()) {
+        Log::error("Failed to write tuning database " + database.path());
+        return;
+    }
+    std::cout << "\nSaved " << tuned << " device(s) to " << database.path() << "\n";
+}
+
 void runMining(const MinerConfig& config) {
     Log::info("Starting TOS Miner...");
 
-    // Initialize GPU monitoring
+    // Initialize GPU monitoring (sensors are sampled in the background)
+    GpuMonitor::setSampleInterval(config.gpuSampleInterval);
     if (GpuMonitor::instance().init()) {
         Log::info("GPU monitoring enabled");
     }
 
+    // CPU package power/temperature for H/s per watt (sampled per telemetry tick)
+    if (config.useCPU && CpuMonitor::instance().init()) {
+        Log::info("CPU monitoring enabled");
+    }
+
     Farm farm;
+
+    // Sample farm, sensor and pool state once per tick for all consumers
+    Telemetry telemetry(farm);
+
+    // API server is created up front so stratum callbacks can publish events;
+    // it only starts listening once mining is running. Declared before the
+    // stratum client so it outlives the client's callbacks.
+    std::unique_ptr<ApiServer> apiServer;
+    if (config.apiPort > 0) {
+        ApiServer::setEventInterval(config.apiEventsInterval);
+        apiServer = std::make_unique<ApiServer>(config.apiPort, telemetry);
+    }
+    ApiServer* events = apiServer.get();
+
     StratumClient stratum;
 
+    telemetry.setPoolSource([&stratum]() {
+        PoolTelemetry pool;
+        pool.connected = stratum.isConnected();
+        pool.authorized = stratum.isAuthorized();
+        pool.difficulty = stratum.getDifficulty();
+        pool.accepted = stratum.getAcceptedShares();
+        pool.rejected = stratum.getRejectedShares();
+        pool.submitLatency = stratum.getSubmitLatency();
+        return pool;
+    });
+
     // Set up stratum callbacks
-    stratum.setWorkCallback([&farm](const WorkPackage& work) {
+    stratum.setWorkCallback([&farm, events](const WorkPackage& work) {
         farm.setWork(work);
+        if (events) {
+            events->publishEvent("job", {{"job_id", work.jobId}, {"height", work.height}});
+        }
     });
 
-    stratum.setShareCallback([&farm](bool accepted, const std::string& reason) {
+    stratum.setShareCallback([&farm, events](bool accepted, const std::string& reason) {
         if (accepted) {
             Log::info("Share accepted");
             farm.recordAcceptedShare();
@@ -152,6 +441,9 @@ void runMining(const MinerConfig& config) {
             Log::warning("Share rejected: " + reason);
             farm.recordRejectedShare();
         }
+        if (events) {
+            events->publishEvent("share", {{"accepted", accepted}, {"reason", reason}});
+        }
     });
 
     // Configure TLS
@@ -179,11 +471,40 @@ void runMining(const MinerConfig& config) {
         return;
     }
 
+    // GPU result integrity sampling
+    Miner::setIntegritySample(config.integritySample);
+    if (config.integritySample > 0) {
+        Log::info("Integrity sampling enabled (" + std::to_string(config.integritySample) +
+                  "% of easy-target hits re-hashed on the CPU)");
+    }
+
+    // GPU batch sizing by kernel duration
+    Miner::setBatchTarget(config.batchTarget);
+
+    // Known-answer self-test at device startup
+    Miner::setSelfTestEnabled(config.selfTest);
+    if (!config.selfTest) {
+        Log::warning("Device self-test disabled (--no-self-test)");
+    }
+
+    // GPUs use their auto-tuned settings, else the profile matching their name,
+    // unless the command line picks a profile or work sizes
+    TuningDatabase tuningDb;
+    if (!config.tuningExplicit) {
+        tuningDb = openTuningDatabase(config);
+    }
+
     // Add miners to farm
 #ifdef WITH_OPENCL
     if (config.useOpenCL) {
         CLMiner::setGlobalWorkSizeMultiplier(config.openclGlobalWorkSize);
         CLMiner::setLocalWorkSize(config.openclLocalWorkSize);
+        CLMiner::setNonceLoop(config.openclNonceLoop);
+        CLMiner::setScratchLayout(config.openclScratch);
+        CLMiner::setPipelineDepth(config.openclPipelineDepth);
+        CLMiner::setOutOfOrder(config.openclOutOfOrder);
+        CLMiner::setProfiling(config.openclProfiling);
+        configureProgramCache(config);
 
         auto devices = CLMiner::enumDevices();
         for (const auto& dev : devices) {
@@ -191,7 +512,13 @@ void runMining(const MinerConfig& config) {
             if (config.openclDevices.empty() ||
                 std::find(config.openclDevices.begin(), config.openclDevices.end(),
                          dev.index) != config.openclDevices.end()) {
-                farm.addMiner(std::make_unique<CLMiner>(dev.index, dev));
+                auto miner = std::make_unique<CLMiner>(dev.index, dev);
+                if (!config.tuningExplicit) {
+                    std::string source;
+                    miner->setTuning(tuningDb.select(MinerType::OpenCL, dev.name, dev.driverVersion, source));
+                    Log::info(miner->getName() + ": Using " + source);
+                }
+                farm.addMiner(std::move(miner));
             }
         }
     }
@@ -201,13 +528,20 @@ void runMining(const MinerConfig& config) {
     if (config.useCUDA) {
         CUDAMiner::setGridSizeMultiplier(config.cudaGridSize);
         CUDAMiner::setBlockSize(config.cudaBlockSize);
+        CUDAMiner::setStreamCount(config.cudaStreams);
 
         auto devices = CUDAMiner::enumDevices();
         for (const auto& dev : devices) {
             if (config.cudaDevices.empty() ||
                 std::find(config.cudaDevices.begin(), config.cudaDevices.end(),
                          dev.index) != config.cudaDevices.end()) {
-                farm.addMiner(std::make_unique<CUDAMiner>(dev.index, dev));
+                auto miner = std::make_unique<CUDAMiner>(dev.index, dev);
+                if (!config.tuningExplicit) {
+                    std::string source;
+                    miner->setTuning(tuningDb.select(MinerType::CUDA, dev.name, dev.driverVersion, source));
+                    Log::info(miner->getName() + ": Using " + source);
+                }
+                farm.addMiner(std::move(miner));
             }
         }
     }
@@ -241,14 +575,80 @@ void runMining(const MinerConfig& config) {
         return;
     }
 
-    // Start API server if configured
-    std::unique_ptr<ApiServer> apiServer;
-    if (config.apiPort > 0) {
-        apiServer = std::make_unique<ApiServer>(config.apiPort, farm, stratum);
-        if (!apiServer->start()) {
-            Log::warning("Failed to start API server, continuing without it");
-            apiServer.reset();
+    // Retry failed devices in the background with backoff
+    std::unique_ptr<RecoverySupervisor> recovery;
+    if (config.recovery.enabled()) {
+        recovery = std::make_unique<RecoverySupervisor>(farm, config.recovery);
+        RecoverySupervisor* r = recovery.get();
+        telemetry.setRecoverySource([r]() { return r->getTelemetry(); });
+        recovery->start();
+    }
+
+    telemetry.setAnomalyConfig(config.anomaly);
+    telemetry.start();
+
+    // Keep devices under temperature/power caps if configured
+    std::unique_ptr<PowerGovernor> governor;
+    unsigned governorListener = 0;
+    if (config.governor.enabled()) {
+        governor = std::make_unique<PowerGovernor>(config.governor, [&farm](const GovernorDecision& d) {
+            farm.setMinerIntensity(d.index, d.to);
+        });
+        PowerGovernor* g = governor.get();
+        governorListener = telemetry.addListener([g](const TelemetrySnapshotPtr& snapshot) {
+            g->update(*snapshot);
+        });
+        Log::info("Power governor enabled" +
+                  (config.governor.tempTarget > 0 ? " (target " + std::to_string(config.governor.tempTarget) + "C)" : std::string()) +
+                  (config.governor.powerCap > 0 ? " (cap " + std::to_string(config.governor.powerCap) + "W)" : std::string()));
+    }
+
+    // Yield CPU threads to other work on shared hosts if configured
+    std::unique_ptr<HostLoadMonitor> hostLoad;
+    std::unique_ptr<HostLoadGovernor> hostGovernor;
+    unsigned hostListener = 0;
+    if (config.useCPU && config.hostLoad.enabled()) {
+        std::vector<unsigned> cpuMiners;
+        auto devices = farm.getDevices();
+        for (size_t i = 0; i < devices.size(); i++) {
+            if (devices[i].type == MinerType::CPU) {
+                cpuMiners.push_back(static_cast<unsigned>(i));
+            }
+        }
+
+        hostLoad = std::make_unique<HostLoadMonitor>();
+        if (config.hostLoad.hostAware && !hostLoad->isAvailable()) {
+            Log::warning("Host load not readable from /proc, applying the CPU share budget only");
+        } else if (config.hostLoad.hostAware && !hostLoad->hasPressure()) {
+            Log::warning("CPU pressure (PSI) unavailable, using the load average only");
         }
+
+        hostGovernor = std::make_unique<HostLoadGovernor>(config.hostLoad, cpuMiners,
+            std::thread::hardware_concurrency(), [&farm](unsigned index, bool parked) {
+                farm.setMinerParked(index, parked);
+            });
+        HostLoadMonitor* monitor = hostLoad.get();
+        HostLoadGovernor* g = hostGovernor.get();
+        hostListener = telemetry.addListener([monitor, g](const TelemetrySnapshotPtr&) {
+            g->update(monitor->sample());
+        });
+        Log::info("Host load governor enabled (budget " + std::to_string(hostGovernor->getBudget()) +
+                  " of " + std::to_string(cpuMiners.size()) + " CPU thread(s))");
+    }
+
+    // Publish stats for local agents if configured
+    std::unique_ptr<ShmStatsPublisher> shmStats;
+    if (!config.shmStatsPath.empty()) {
+        shmStats = std::make_unique<ShmStatsPublisher>(config.shmStatsPath, telemetry);
+        if (!shmStats->start()) {
+            Log::warning("Failed to publish shared memory stats, continuing without it");
+            shmStats.reset();
+        }
+    }
+
+    // Start API server if configured (kept on failure; callbacks hold a pointer)
+    if (apiServer && !apiServer->start()) {
+        Log::warning("Failed to start API server, continuing without it");
     }
 
     // Main loop - print stats periodically
@@ -257,45 +657,72 @@ void runMining(const MinerConfig& config) {
     while (g_running) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
 
+        // Report the tail of any suppressed log storms
+        Log::flushSuppressed();
+
+        // Isolate stalled devices; the recovery supervisor restarts them
+        if (config.anomaly.recover) {
+            auto snapshot = telemetry.latest();
+            for (size_t i = 0; i < snapshot->devices.size(); i++) {
+                const auto& anomaly = snapshot->devices[i].anomaly;
+                if (anomaly.kind == AnomalyKind::Stalled && anomaly.ticks >= config.anomaly.recoverTicks &&
+                    !farm.isMinerFailed(static_cast<unsigned>(i))) {
+                    Log::warning(snapshot->devices[i].device.shortName() + ": Stalled for " +
+                                 std::to_string(anomaly.ticks) + " ticks, restarting");
+                    farm.markMinerFailed(static_cast<unsigned>(i));
+                }
+            }
+        }
+
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration<double>(now - lastStats).count();
 
         if (elapsed >= 10.0) {  // Print stats every 10 seconds
             lastStats = now;
 
-            auto hr = farm.getHashRate();
-            auto stats = farm.getStats();
+            auto snapshot = telemetry.latest();
+            const auto& windows = snapshot->windows;
+            const auto& stats = snapshot->stats;
 
             std::ostringstream ss;
             ss << std::fixed << std::setprecision(2);
 
-            // Use EMA rate for stable display
-            double displayRate = hr.effectiveRate();
+            // Windowed rates from the telemetry history: 10s / 1m / 15m
+            double displayRate = windows.s10 > 0 ? windows.s10 : snapshot->hashRate.effectiveRate();
+            double scale = 1;
+            const char* unit = " H/s";
             if (displayRate >= 1000000) {
-                ss << (displayRate / 1000000) << " MH/s";
+                scale = 1000000;
+                unit = " MH/s";
             } else if (displayRate >= 1000) {
-                ss << (displayRate / 1000) << " KH/s";
-            } else {
-                ss << displayRate << " H/s";
+                scale = 1000;
+                unit = " KH/s";
             }
+            ss << (displayRate / scale) << "/" << (windows.m1 / scale) << "/"
+               << (windows.m15 / scale) << unit << " (10s/1m/15m)";
 
             ss << " | A:" << stats.acceptedShares
                << " R:" << stats.rejectedShares
                << " S:" << stats.staleShares;
 
             // Add GPU temperatures if monitoring is available
-            if (GpuMonitor::instance().isAvailable()) {
-                auto gpuStats = GpuMonitor::instance().getAllStats();
-                if (!gpuStats.empty()) {
-                    ss << " | T:";
-                    bool first = true;
-                    for (const auto& gpu : gpuStats) {
-                        if (gpu.valid && gpu.temperature >= 0) {
-                            if (!first) ss << "/";
-                            ss << gpu.temperature << "C";
-                            first = false;
-                        }
-                    }
+            bool first = true;
+            for (const auto& dev : snapshot->devices) {
+                if (dev.gpu.valid && dev.gpu.temperature >= 0) {
+                    ss << (first ? " | T:" : "/") << dev.gpu.temperature << "C";
+                    first = false;
+                }
+            }
+
+            // CPU package power and efficiency
+            const auto& cpu = snapshot->cpu;
+            if (cpu.valid && cpu.packagePower >= 0) {
+                ss << std::setprecision(1) << " | CPU:" << cpu.packagePower << "W";
+                if (snapshot->cpuHashesPerWatt > 0) {
+                    ss << " " << snapshot->cpuHashesPerWatt << " H/s/W";
+                }
+                if (cpu.temperature >= 0) {
+                    ss << " " << cpu.temperature << "C";
                 }
             }
 
@@ -310,6 +737,19 @@ void runMining(const MinerConfig& config) {
     if (apiServer) {
         apiServer->stop();
     }
+    if (shmStats) {
+        shmStats->stop();
+    }
+    if (governor) {
+        telemetry.removeListener(governorListener);
+    }
+    if (hostGovernor) {
+        telemetry.removeListener(hostListener);
+    }
+    telemetry.stop();
+    if (recovery) {
+        recovery->stop();
+    }
 
     // Stop miners (they might still be submitting solutions)
     farm.stop();
@@ -317,8 +757,9 @@ void runMining(const MinerConfig& config) {
     // Wait for pending share submissions with 5 second timeout
     stratum.gracefulDisconnect(5000);
 
-    // Shutdown GPU monitoring
+    // Shutdown GPU and CPU monitoring
     GpuMonitor::instance().shutdown();
+    CpuMonitor::instance().shutdown();
 
     Log::info("Shutdown complete");
 }
@@ -351,6 +792,14 @@ int main(int argc, char* argv[]) {
 
     Log::setShowTimestamp(true);
 
+    // Configure log storm suppression
+    if (!config.logRateLimit) {
+        Log::disableRateLimits();
+    }
+    for (const auto& [category, limit] : config.logRateLimits) {
+        Log::setRateLimit(category, limit.burst, limit.perSecond);
+    }
+
     // Run appropriate mode
     switch (config.mode) {
         case MiningMode::ListDevices:
@@ -361,6 +810,10 @@ int main(int argc, char* argv[]) {
             runBenchmark(config);
             break;
 
+        case MiningMode::AutoTune:
+            runAutoTune(config);
+            break;
+
         case MiningMode::Stratum:
             if (config.poolUrl.empty()) {
                 Log::error("Pool URL required for mining. Use -P stratum+tcp://host:port");
@@ -5,7 +5,9 @@
 #ifdef WITH_OPENCL
 
 #include "CLMiner.h"
+#include "CLProgramCache.h"
 #include "core/WorkPackage.h"
+#include "toshash/TosHash.h"
 #include "util/Log.h"
 #include "toshash_kernel.cl.h"
 #include <sstream>
@@ -13,12 +15,22 @@
 #include <thread>
 #include <algorithm>
 #include <cctype>
+#include <set>
 
 namespace tos {
 
 // Static members
 unsigned CLMiner::s_globalWorkSizeMultiplier = 16384;  // 16K work items by default
 unsigned CLMiner::s_localWorkSize = 1;  // 1 work item per workgroup (uses 64KB local memory)
+unsigned CLMiner::s_nonceLoop = 0;  // One-shot search kernel by default
+cl_device_type CLMiner::s_deviceType = CL_DEVICE_TYPE_GPU;
+ScratchLayout CLMiner::s_scratchLayout = ScratchLayout::Local;
+unsigned CLMiner::s_pipelineDepth = 2;  // Double buffered by default
+bool CLMiner::s_outOfOrder = false;
+bool CLMiner::s_profiling = false;
+
+// Global scratchpad bytes per work item
+static constexpr size_t SCRATCH_BYTES = TOSHASH_MEMORY_SIZE * sizeof(uint64_t);
 
 CLMiner::CLMiner(unsigned index, const DeviceDescriptor& device)
     : Miner(index, device)
@@ -46,7 +58,7 @@ bool CLMiner::init() {
 
         // Get devices on this platform
         std::vector<cl::Device> devices;
-        platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        platform.getDevices(s_deviceType, &devices);
 
         if (m_device.clDeviceIndex >= devices.size()) {
             Log::error(getName() + ": Invalid device index");
@@ -55,9 +67,40 @@ bool CLMiner::init() {
 
         cl::Device& device = devices[m_device.clDeviceIndex];
 
-        // Create context and queue
+        // Per-device tuning overrides the global settings
+        unsigned globalWorkSize = m_tuned ? m_tuning.openclGlobalWorkSize : s_globalWorkSizeMultiplier;
+        unsigned localWorkSize = m_tuned ? m_tuning.openclLocalWorkSize : s_localWorkSize;
+
+        // Create context and queue; the batch sizer and the device timeline
+        // use profiling events
         m_context = cl::Context(device);
-        m_queue = cl::CommandQueue(m_context, device);
+        m_profiling = getBatchTarget() > 0 || s_profiling;
+        m_timeline.restart();
+        cl_command_queue_properties profiling = m_profiling ? CL_QUEUE_PROFILING_ENABLE : 0;
+        m_queue = cl::CommandQueue(m_context, device, profiling);
+
+        // Persistent kernel: a second queue writes the abort generation while launches run
+        m_nonceLoop = m_tuned ? m_tuning.openclNonceLoop : s_nonceLoop;
+        if (m_nonceLoop > 0) {
+            m_controlQueue = cl::CommandQueue(m_context, device);
+        }
+
+        // One-shot batches and job uploads may use an out-of-order queue;
+        // the self-test and persistent launches stay on the in-order one
+        m_slots.reset(m_tuned ? m_tuning.openclPipelineDepth : s_pipelineDepth);
+        m_batches.assign(m_slots.depth(), PendingBatch());
+        m_outOfOrder = false;
+        m_batchQueue = m_queue;
+        if (s_outOfOrder && m_nonceLoop == 0) {
+            auto supported = device.getInfo<CL_DEVICE_QUEUE_PROPERTIES>();
+            if (supported & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) {
+                m_batchQueue = cl::CommandQueue(m_context, device,
+                                                profiling | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE);
+                m_outOfOrder = true;
+            } else {
+                Log::warning(getName() + ": Out-of-order queues not supported, using an in-order queue");
+            }
+        }
 
         // Get device properties
         size_t maxWorkGroupSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
@@ -69,10 +112,20 @@ bool CLMiner::init() {
            << ", max workgroup: " << maxWorkGroupSize << ")";
         Log::info(ss.str());
 
-        // Check local memory is sufficient for scratchpad (64KB)
-        if (localMemSize < 65536) {
-            Log::warning(getName() + ": Insufficient local memory, falling back to global memory");
-            // Could implement a fallback kernel here
+        if (localWorkSize > maxWorkGroupSize) {
+            Log::error(getName() + ": Local work size " + std::to_string(localWorkSize) +
+                       " exceeds the device maximum of " + std::to_string(maxWorkGroupSize));
+            return false;
+        }
+
+        // A __local scratchpad needs 64KB of local memory and one work item per
+        // group (it is shared by the group); otherwise use global scratchpads
+        m_scratchLayout = m_tuned ? m_tuning.openclScratch : s_scratchLayout;
+        if (m_scratchLayout == ScratchLayout::Local && (localMemSize < SCRATCH_BYTES || localWorkSize > 1)) {
+            Log::warning(getName() + (localMemSize < SCRATCH_BYTES ? ": Insufficient local memory"
+                                                                   : ": Local work size above 1")
+                         + ", using interleaved global scratchpads");
+            m_scratchLayout = ScratchLayout::Interleaved;
         }
 
         // Compile kernel
@@ -80,18 +133,50 @@ bool CLMiner::init() {
             return false;
         }
 
+        // Set work sizes
+        // Each work item needs full local memory (64KB), so local size = 1
+        m_localWorkSize = localWorkSize;
+        m_globalWorkSize = globalWorkSize;
+        if (getBatchTarget() > 0) {
+            m_globalWorkSize *= BATCH_GROWTH;
+        }
+
+        // Global scratchpads are one allocation of 64KB per work item
+        if (scratchLayoutIsGlobal(m_scratchLayout)) {
+            size_t maxItems = static_cast<size_t>(device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>() / SCRATCH_BYTES);
+            maxItems -= maxItems % std::max<size_t>(1, m_localWorkSize);
+            if (maxItems == 0) {
+                Log::error(getName() + ": Device cannot allocate a global scratchpad");
+                return false;
+            }
+            if (m_globalWorkSize > maxItems) {
+                Log::warning(getName() + ": Global work size " + std::to_string(m_globalWorkSize) +
+                             " exceeds the scratchpad allocation limit, using " + std::to_string(maxItems));
+                m_globalWorkSize = maxItems;
+            }
+        }
+
+        size_t local = std::max<size_t>(1, m_localWorkSize);
+        m_batchSizer.configure(globalWorkSize, globalWorkSize / BATCH_SHRINK,
+                               m_globalWorkSize, local);
+        m_batchSizer.setTarget(getBatchTarget() / 1000.0);
+        m_integrityBits = integrityBits(m_batchSizer.size() * std::max(1u, m_nonceLoop));
+
         // Allocate buffers
         if (!allocateBuffers()) {
             return false;
         }
 
-        // Set work sizes
-        // Each work item needs full local memory (64KB), so local size = 1
-        m_localWorkSize = s_localWorkSize;
-        m_globalWorkSize = s_globalWorkSizeMultiplier;
-
         Log::info(getName() + ": Initialized (global work size: " +
-                  std::to_string(m_globalWorkSize) + ")");
+                  std::to_string(m_batchSizer.size()) +
+                  ", " + scratchLayoutName(m_scratchLayout) + " scratchpads" +
+                  (m_batchSizer.enabled() ? ", batches sized for " + std::to_string(getBatchTarget()) + " ms" +
+                                            " up to " + std::to_string(m_globalWorkSize)
+                                          : std::string()) +
+                  (m_nonceLoop > 0 ? ", persistent kernel, " + std::to_string(m_nonceLoop) + " nonces per work item"
+                                   : std::string()) +
+                  ", " + std::to_string(m_slots.depth()) + " batches in flight" +
+                  (m_outOfOrder ? ", out-of-order queue" : "") + ")");
 
         return true;
 
@@ -112,9 +197,6 @@ bool CLMiner::compileKernel() {
         // Get kernel source from embedded header
         std::string source(reinterpret_cast<const char*>(toshash_cl_source), toshash_cl_source_len);
 
-        // Build program with platform-specific options
-        m_program = cl::Program(m_context, source);
-
         // Detect platform for optimization
         std::string buildOptions = "-cl-std=CL1.2";
 
@@ -138,21 +220,28 @@ bool CLMiner::compileKernel() {
             Log::info(getName() + ": Using Intel optimizations");
         }
 
-        try {
-            m_program.build(buildOptions);
-        } catch (const cl::Error&) {
-            // Get build log
-            auto devices = m_context.getInfo<CL_CONTEXT_DEVICES>();
-            std::string buildLog = m_program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0]);
+        buildOptions += " -DSCRATCH_LAYOUT=" + std::to_string(static_cast<int>(m_scratchLayout)) +
+                        " -DSCRATCH_BLOCK=" + std::to_string(SCRATCH_BLOCK_WORDS);
+
+        // Build, reusing a binary from an identical device or the disk cache
+        auto devices = m_context.getInfo<CL_CONTEXT_DEVICES>();
+        CLProgramCache::Origin origin;
+        std::string buildLog;
+        auto started = std::chrono::steady_clock::now();
+        if (!CLProgramCache::build(m_context, devices[0], source, buildOptions, m_program, buildLog, origin)) {
             Log::error(getName() + ": Kernel build failed:\n" + buildLog);
             return false;
         }
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started).count();
 
         // Create kernels
         m_searchKernel = cl::Kernel(m_program, "toshash_search");
         m_benchmarkKernel = cl::Kernel(m_program, "toshash_benchmark");
+        m_persistentKernel = cl::Kernel(m_program, "toshash_search_persistent");
 
-        Log::info(getName() + ": Kernel compiled successfully");
+        Log::info(getName() + ": Kernel loaded from " + CLProgramCache::originName(origin) +
+                  " in " + std::to_string(elapsed) + " ms");
         return true;
 
     } catch (const cl::Error& e) {
@@ -165,20 +254,54 @@ bool CLMiner::compileKernel() {
 
 bool CLMiner::allocateBuffers() {
     try {
-        // Output buffers: [count] + [nonce_lo, nonce_hi] * MAX_OUTPUTS (double buffered)
-        size_t outputSize = (1 + MAX_OUTPUTS * 2) * sizeof(uint32_t);
-        for (unsigned i = 0; i < c_bufferCount; i++) {
-            m_outputBuffer[i] = cl::Buffer(m_context, CL_MEM_READ_WRITE, outputSize);
-            m_output[i].resize(1 + MAX_OUTPUTS * 2);
+        // Output buffers: [count] + [nonce_lo, nonce_hi] * solution slots,
+        // then the same for integrity check hits (one per pipeline slot).
+        // Sized for the most slots; batches use and read back what the
+        // output sizer gives them.
+        size_t outputSize = outputWords(MAX_OUTPUT_CAPACITY) * sizeof(uint32_t);
+        m_outputBuffer.clear();
+        m_output.assign(m_slots.depth(), std::vector<uint32_t>(outputWords(MAX_OUTPUT_CAPACITY), 0));
+        m_outputSizer.reset();
+        for (unsigned i = 0; i < m_slots.depth(); i++) {
+            m_outputBuffer.push_back(cl::Buffer(m_context, CL_MEM_READ_WRITE, outputSize));
         }
 
-        // Header buffer (constant)
-        m_headerBuffer = cl::Buffer(m_context, CL_MEM_READ_ONLY, INPUT_SIZE);
+        // Header and target buffers, two sets so a job can be uploaded
+        // while the previous job's batches still read the other
+        for (unsigned i = 0; i < 2; i++) {
+            m_headerBuffer[i] = cl::Buffer(m_context, CL_MEM_READ_ONLY, INPUT_SIZE);
+            m_targetBuffer[i] = cl::Buffer(m_context, CL_MEM_READ_ONLY, HASH_SIZE);
+            m_uploads[i].clear();
+        }
 
-        // Target buffer (constant)
-        m_targetBuffer = cl::Buffer(m_context, CL_MEM_READ_ONLY, HASH_SIZE);
+        // Integrity check target (fixed per device)
+        Hash256 checkTarget = integrityTarget(m_integrityBits);
+        m_checkTargetBuffer = cl::Buffer(m_context, CL_MEM_READ_ONLY, HASH_SIZE);
+        m_queue.enqueueWriteBuffer(m_checkTargetBuffer, CL_TRUE, 0, HASH_SIZE, checkTarget.data());
+
+        // Scratchpads; launches share them since kernels run one at a time
+        // (in queue order, or chained on an out-of-order queue)
+        size_t scratchSize = scratchLayoutIsGlobal(m_scratchLayout) ? m_globalWorkSize * SCRATCH_BYTES
+                                                                    : sizeof(uint64_t);
+        m_scratchBuffer = cl::Buffer(m_context, CL_MEM_READ_WRITE, scratchSize);
+
+        // Persistent kernel rings start empty; generation 0 is current
+        if (m_nonceLoop > 0) {
+            std::vector<uint32_t> zero(RING_WORDS, 0);
+            m_ringBuffer = cl::Buffer(m_context, CL_MEM_READ_WRITE, RING_WORDS * sizeof(uint32_t));
+            m_queue.enqueueWriteBuffer(m_ringBuffer, CL_TRUE, 0, RING_WORDS * sizeof(uint32_t), zero.data());
+            m_ring.assign(m_slots.depth(), std::vector<uint32_t>(RING_WORDS, 0));
+
+            m_generation = 0;
+            m_controlBuffer = cl::Buffer(m_context, CL_MEM_READ_WRITE, sizeof(uint32_t));
+            m_queue.enqueueWriteBuffer(m_controlBuffer, CL_TRUE, 0, sizeof(uint32_t), &m_generation);
+
+            m_solutionRing.reset();
+            m_checkRing.reset();
+            m_hashesRead = 0;
+        }
 
-        Log::info(getName() + ": Buffers allocated (double buffered)");
+        Log::info(getName() + ": Buffers allocated (" + std::to_string(m_slots.depth()) + " pipeline slots)");
         return true;
 
     } catch (const cl::Error& e) {
@@ -190,25 +313,19 @@ bool CLMiner::allocateBuffers() {
 }
 
 void CLMiner::mineLoop() {
-    uint64_t nonce = 0;
-    uint64_t batchSize = m_globalWorkSize;
-    m_bufferIndex = 0;
-
-    // Clear pending queue
-    while (!m_pending.empty()) {
-        m_pending.pop();
+    if (m_nonceLoop > 0) {
+        persistentLoop();
+        return;
     }
 
+    uint64_t nonce = 0;
+    resetPipeline();
+
     while (m_running) {
         // Check for pause
         if (m_paused) {
-            // Drain pending batches before pausing
-            while (!m_pending.empty()) {
-                auto& batch = m_pending.front();
-                batch.event.wait();
-                readBatchResults(batch.bufferIndex);
-                m_pending.pop();
-            }
+            // Let pending batches finish before pausing
+            finishBatches();
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
             continue;
         }
@@ -223,22 +340,13 @@ void CLMiner::mineLoop() {
                 continue;
             }
 
-            // Drain pending batches (old work) before switching
-            while (!m_pending.empty()) {
-                auto& batch = m_pending.front();
-                batch.event.wait();
-                // Don't process solutions from old work
-                m_pending.pop();
-            }
-
-            // Upload new header and target
+            // Upload new header and target without waiting; batches of the
+            // old job finish and are verified against it
             try {
-                m_queue.enqueueWriteBuffer(m_headerBuffer, CL_TRUE, 0, INPUT_SIZE, work.header.data());
-                m_queue.enqueueWriteBuffer(m_targetBuffer, CL_TRUE, 0, HASH_SIZE, work.target.data());
+                switchWork(work);
 
                 // Get device-specific starting nonce (non-overlapping range)
-                nonce = work.getDeviceStartNonce(m_index);
-                m_bufferIndex = 0;
+                nonce = work.getDeviceStartNonce(m_nonceSlot);
 
             } catch (const cl::Error& e) {
                 Log::error(getName() + ": Failed to upload work: " + std::string(e.what()));
@@ -246,146 +354,727 @@ void CLMiner::mineLoop() {
             }
         }
 
+        if (!m_setWork[m_workSet].valid) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
         try {
-            // Double buffering async pipeline:
-            // 1. If pending queue is not full, enqueue new batch
-            // 2. If pending queue is full, wait for oldest and process results
-
-            // Enqueue new batches while we have buffer space
-            while (m_pending.size() < c_bufferCount) {
-                PendingBatch batch;
-                batch.startNonce = nonce;
-                batch.bufferIndex = m_bufferIndex;
-
-                // Enqueue batch and capture completion event
-                enqueueBatch(nonce, m_bufferIndex, batch.event);
-                m_pending.push(batch);
-
-                // Advance to next buffer and nonce
-                m_bufferIndex = (m_bufferIndex + 1) % c_bufferCount;
-                nonce += batchSize;
+            // N-deep async pipeline:
+            // 1. Enqueue batches into every free slot
+            // 2. Process whichever batch finishes first (the oldest if none has)
+            launchBatches(nonce);
+            unsigned slot = waitForBatch();
+            auto busy = busyTime(slot);
+            processBatch(slot);
+            throttle(busy);
+
+        } catch (const cl::Error& e) {
+            Log::error(getName() + ": Mining error: " + std::string(e.what()));
+            // Forget pending batches on error
+            resetPipeline();
+
+            // Track errors and attempt recovery if needed
+            if (recordError() && !reinitialize()) {
+                m_running = false;
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+
+        // Clear error counter on successful batch
+        clearErrors();
+    }
+
+    // Drain pending batches on exit
+    try {
+        m_batchQueue.finish();
+        m_queue.finish();
+    } catch (...) {}
+    resetPipeline();
+}
+
+void CLMiner::launchBatches(uint64_t& nonce) {
+    int slot;
+    while (m_slots.busy() < launchLimit() && (slot = m_slots.acquire()) >= 0) {
+        PendingBatch& batch = m_batches[slot];
+        batch.startNonce = nonce;
+        batch.size = batchGlobalWorkSize();
+        batch.workSet = m_workSet;
+        batch.outputs = m_outputSizer.capacity();
+        batch.enqueuedAt = std::chrono::steady_clock::now();
+
+        // Enqueue batch and capture completion event
+        enqueueBatch(nonce, batch.size, static_cast<unsigned>(slot), batch.workSet, batch.outputs,
+                     batch.kernelEvent, batch.event);
+        nonce += batch.size;
+    }
+}
+
+unsigned CLMiner::waitForBatch() {
+    // Slots are listed oldest first: take the first one already done, so a
+    // readback that finished early is not held up behind an older batch
+    auto slots = m_slots.inFlight();
+    for (unsigned slot : slots) {
+        cl_int status = m_batches[slot].event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>();
+        if (status < 0) {
+            throw cl::Error(status, "batch");
+        }
+        if (status == CL_COMPLETE) {
+            return slot;
+        }
+    }
+
+    // Wait ONLY for this specific batch's event (not queue.finish!)
+    // This allows the next batches to continue executing while we process
+    m_batches[slots.front()].event.wait();
+    return slots.front();
+}
+
+void CLMiner::finishBatches(int workSet) {
+    try {
+        for (unsigned slot : m_slots.inFlight()) {
+            if (workSet < 0 || m_batches[slot].workSet == static_cast<unsigned>(workSet)) {
+                m_batches[slot].event.wait();
+                processBatch(slot);
             }
+        }
+    } catch (const cl::Error& e) {
+        Log::error(getName() + ": Failed to drain batches: " + std::string(e.what()));
+        resetPipeline();
+    }
+}
+
+void CLMiner::processBatch(unsigned slot) {
+    PendingBatch& batch = m_batches[slot];
+    const WorkPackage& work = m_setWork[batch.workSet];
+
+    // Read and process results against the job the batch ran for
+    bool overflowed = processSolutions(slot, work);
+    processChecks(slot, work, batch.size);
+
+    // Update hash count; the batch sizer adjusts the next batches
+    updateHashCount(batch.size);
+    recordBatch(batch.size, kernelTime(batch.kernelEvent));
+    recordTimeline(slot);
+
+    // Solutions were dropped: search the batch again in smaller launches
+    if (overflowed) {
+        rescanBatch(slot);
+    }
+
+    m_slots.release(slot);
+}
+
+void CLMiner::switchWork(const WorkPackage& work) {
+    unsigned next = m_workSet ^ 1;
+
+    // Batches of the job before last still read this set, and its last
+    // upload may still be reading the host copy
+    finishBatches(static_cast<int>(next));
+    if (!m_uploads[next].empty()) {
+        cl::Event::waitForEvents(m_uploads[next]);
+    }
+
+    // Non-blocking: the host copy stays in m_setWork until the set is reused
+    m_setWork[next] = work;
+    m_uploads[next].assign(2, cl::Event());
+    m_batchQueue.enqueueWriteBuffer(m_headerBuffer[next], CL_FALSE, 0, INPUT_SIZE,
+                                    m_setWork[next].header.data(), nullptr, &m_uploads[next][0]);
+    m_batchQueue.enqueueWriteBuffer(m_targetBuffer[next], CL_FALSE, 0, HASH_SIZE,
+                                    m_setWork[next].target.data(), nullptr, &m_uploads[next][1]);
+    m_batchQueue.flush();
+    m_workSet = next;
+}
+
+void CLMiner::rescanBatch(unsigned slot) {
+    PendingBatch& batch = m_batches[slot];
+    uint32_t count = readBatchResults(slot);
+    recordOutputOverflow();
+    Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":overflow",
+                 getName() + ": " + std::to_string(count) + " solutions in a batch with " +
+                 std::to_string(batch.outputs) + " slots, rescanning " + std::to_string(batch.size) + " nonces");
+
+    // Nonces the batch returned were already submitted
+    std::vector<uint64_t> returned;
+    readNonces(slot, batch.outputs, returned);
+    std::set<uint64_t> seen(returned.begin(), returned.end());
+
+    unsigned workSet = batch.workSet;
+    std::vector<uint64_t> found;
+    RescanResult result = OutputSizer::rescan(
+        {batch.startNonce, batch.size}, m_localWorkSize, seen,
+        [&](const NonceRange& range, std::vector<uint64_t>& nonces, uint32_t& hits) {
+            searchRange(range, slot, workSet, nonces, hits);
+            return true;
+        },
+        found);
+
+    if (result.unresolved > 0) {
+        Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":unresolved",
+                     getName() + ": Rescan still overflowed in " + std::to_string(result.unresolved) +
+                     " ranges, some solutions lost");
+    }
+    verifyNonces(found, m_setWork[workSet]);
+}
+
+void CLMiner::rescanLaunch(unsigned slot, const std::vector<uint64_t>& drained) {
+    const PendingBatch& launch = m_batches[slot];
+    recordOutputOverflow();
+    Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":ring",
+                 getName() + ": Result ring overflowed, rescanning " + std::to_string(launch.size) + " nonces");
+
+    std::set<uint64_t> seen(drained.begin(), drained.end());
+    std::vector<uint64_t> found;
+    RescanResult result = OutputSizer::rescan(
+        {launch.startNonce, launch.size}, m_localWorkSize, seen,
+        [&](const NonceRange& range, std::vector<uint64_t>& nonces, uint32_t& hits) {
+            searchRange(range, slot, m_workSet, nonces, hits);
+            return true;
+        },
+        found);
+
+    if (result.unresolved > 0) {
+        Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":unresolved",
+                     getName() + ": Rescan still overflowed in " + std::to_string(result.unresolved) +
+                     " ranges, some solutions lost");
+    }
+    verifyNonces(found, m_setWork[m_workSet]);
+}
+
+void CLMiner::searchRange(const NonceRange& range, unsigned bufferIndex, unsigned workSet,
+                          std::vector<uint64_t>& nonces, uint32_t& count) {
+    // Launches cover at most the work items the scratch buffer holds
+    size_t local = std::max<size_t>(1, m_localWorkSize);
+    uint64_t chunk = std::max<uint64_t>(local, m_globalWorkSize - m_globalWorkSize % local);
+
+    count = 0;
+    for (uint64_t done = 0; done < range.size; done += chunk) {
+        size_t size = static_cast<size_t>(std::min(chunk, range.size - done));
+        cl::Event kernelEvent, event;
+        enqueueBatch(range.start + done, size, bufferIndex, workSet, MAX_OUTPUT_CAPACITY, kernelEvent, event);
+        event.wait();
+
+        uint32_t hits = readBatchResults(bufferIndex);
+        readNonces(bufferIndex, std::min(hits, MAX_OUTPUT_CAPACITY), nonces);
+        count += hits;
+    }
+}
+
+void CLMiner::resetPipeline() {
+    m_slots.clear();
+    m_lastKernel = cl::Event();
+}
+
+bool CLMiner::reinitialize() {
+    Log::warning(getName() + ": Attempting recovery...");
+    try {
+        if (!compileKernel() || !allocateBuffers()) {
+            Log::error(getName() + ": Recovery failed, stopping");
+            return false;
+        }
 
-            // Process oldest completed batch
-            if (!m_pending.empty()) {
-                auto& oldest = m_pending.front();
+        // Fresh buffers: restore the current work
+        const WorkPackage& work = m_setWork[m_workSet];
+        if (work.valid) {
+            m_queue.enqueueWriteBuffer(m_headerBuffer[m_workSet], CL_TRUE, 0, INPUT_SIZE, work.header.data());
+            m_queue.enqueueWriteBuffer(m_targetBuffer[m_workSet], CL_TRUE, 0, HASH_SIZE, work.target.data());
+        }
 
-                // Wait ONLY for this specific batch's event (not queue.finish!)
-                // This allows the next batch to continue executing while we process
-                oldest.event.wait();
+        Log::info(getName() + ": Recovery successful");
+        return true;
+    } catch (...) {
+        Log::error(getName() + ": Recovery failed with exception");
+        return false;
+    }
+}
 
-                // Read and process results
-                processSolutions(oldest.bufferIndex, oldest.startNonce);
+void CLMiner::persistentLoop() {
+    uint64_t nonce = 0;
+    resetPipeline();
 
-                // Update hash count
-                updateHashCount(batchSize);
+    while (m_running) {
+        // Paused: end launches on the device instead of waiting them out
+        if (m_paused) {
+            abortLaunches();
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
 
-                m_pending.pop();
+        if (hasNewWork()) {
+            clearNewWorkFlag();
+            abortLaunches();
+            WorkPackage work = getWork();
+
+            if (!work.valid) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+
+            // Launches were ended above; the upload is ordered before the next one
+            try {
+                switchWork(work);
+                nonce = work.getDeviceStartNonce(m_nonceSlot);
+
+            } catch (const cl::Error& e) {
+                Log::error(getName() + ": Failed to upload work: " + std::string(e.what()));
+                continue;
+            }
+        }
+
+        if (!m_setWork[m_workSet].valid) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        try {
+            // Keep every slot's launch queued; each covers global size * nonce loop nonces
+            int slot;
+            while (m_slots.busy() < launchLimit() && (slot = m_slots.acquire()) >= 0) {
+                size_t globalSize = batchGlobalWorkSize();
+
+                PendingBatch& launch = m_batches[slot];
+                launch.startNonce = nonce;
+                launch.size = globalSize * m_nonceLoop;
+                launch.enqueuedAt = std::chrono::steady_clock::now();
+
+                enqueueLaunch(nonce, globalSize, static_cast<unsigned>(slot), launch.kernelEvent, launch.event);
+                nonce += launch.size;
+            }
+
+            // Ring counters are cumulative, so launches are drained oldest first
+            unsigned oldest = static_cast<unsigned>(m_slots.oldest());
+            if (waitForLaunch(m_batches[oldest].event)) {
+                auto busy = busyTime(oldest);
+                processRing(oldest);
+                recordBatch(m_batches[oldest].size, kernelTime(m_batches[oldest].kernelEvent));
+                recordTimeline(oldest);
+                m_slots.release(oldest);
+                throttle(busy);
             }
 
         } catch (const cl::Error& e) {
             Log::error(getName() + ": Mining error: " + std::string(e.what()));
-            // Clear pending queue on error
-            while (!m_pending.empty()) {
-                m_pending.pop();
-            }
+            resetPipeline();
 
-            // Track errors and attempt recovery if needed
-            if (recordError()) {
-                Log::warning(getName() + ": Attempting recovery...");
-                // Try to reinitialize
-                try {
-                    if (!compileKernel() || !allocateBuffers()) {
-                        Log::error(getName() + ": Recovery failed, stopping");
-                        m_running = false;
-                        break;
-                    }
-                    Log::info(getName() + ": Recovery successful");
-                } catch (...) {
-                    Log::error(getName() + ": Recovery failed with exception");
-                    m_running = false;
-                    break;
-                }
+            if (recordError() && !reinitialize()) {
+                m_running = false;
+                break;
             }
 
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
 
-        // Clear error counter on successful batch
         clearErrors();
     }
 
-    // Drain pending batches on exit
-    while (!m_pending.empty()) {
-        try {
-            m_queue.finish();
-        } catch (...) {}
-        m_pending.pop();
+    abortLaunches();
+}
+
+bool CLMiner::waitForLaunch(const cl::Event& event) {
+    // Polled rather than waited on, so new work can end a long launch early
+    cl_int status;
+    while ((status = event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>()) != CL_COMPLETE) {
+        if (status < 0) {
+            throw cl::Error(status, "persistent kernel launch");
+        }
+        if (!m_running || m_paused || hasNewWork()) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void CLMiner::abortLaunches() {
+    if (m_slots.empty()) {
+        return;
+    }
+
+    try {
+        // Launches that already finished ran their full range; drain them
+        // oldest first while the work set they searched is still current
+        while (!m_slots.empty()) {
+            unsigned oldest = static_cast<unsigned>(m_slots.oldest());
+            cl_int status = m_batches[oldest].event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>();
+            if (status < 0) {
+                throw cl::Error(status, "persistent kernel launch");
+            }
+            if (status != CL_COMPLETE) {
+                break;
+            }
+            processRing(oldest);
+            recordBatch(m_batches[oldest].size, kernelTime(m_batches[oldest].kernelEvent));
+            recordTimeline(oldest);
+            m_slots.release(oldest);
+        }
+        if (m_slots.empty()) {
+            return;
+        }
+
+        // Work items check the generation before each nonce. The write goes
+        // through the control queue because the mining queue is busy with
+        // the launches it is meant to stop.
+        m_generation++;
+        m_controlQueue.enqueueWriteBuffer(m_controlBuffer, CL_TRUE, 0, sizeof(uint32_t), &m_generation);
+
+        // Stopped launches cover part of their range; what they found is
+        // still valid for the work set they searched
+        for (unsigned slot : m_slots.inFlight()) {
+            m_batches[slot].event.wait();
+            processRing(slot);
+        }
+        m_slots.clear();
+
+        // Ordered before the next launch on the mining queue
+        m_queue.enqueueWriteBuffer(m_controlBuffer, CL_TRUE, 0, sizeof(uint32_t), &m_generation);
+
+    } catch (const cl::Error& e) {
+        Log::error(getName() + ": Failed to abort launches: " + std::string(e.what()));
+        resetPipeline();
     }
 }
 
-void CLMiner::enqueueBatch(uint64_t startNonce, unsigned bufferIndex, cl::Event& completionEvent) {
-    // Clear output buffer (async)
-    uint32_t zero = 0;
-    m_queue.enqueueWriteBuffer(m_outputBuffer[bufferIndex], CL_FALSE, 0, sizeof(uint32_t), &zero);
+void CLMiner::enqueueLaunch(uint64_t startNonce, size_t globalSize, unsigned bufferIndex,
+                            cl::Event& kernelEvent, cl::Event& completionEvent) {
+    uint32_t checkSlots = getIntegritySample() > 0 ? CHECK_RING_SIZE : 0;
+
+    m_persistentKernel.setArg(0, m_ringBuffer);
+    m_persistentKernel.setArg(1, m_headerBuffer[m_workSet]);
+    m_persistentKernel.setArg(2, m_targetBuffer[m_workSet]);
+    m_persistentKernel.setArg(3, startNonce);
+    m_persistentKernel.setArg(4, static_cast<cl_uint>(m_nonceLoop));
+    m_persistentKernel.setArg(5, m_controlBuffer);
+    m_persistentKernel.setArg(6, m_generation);
+    m_persistentKernel.setArg(7, RING_SIZE);
+    m_persistentKernel.setArg(8, m_checkTargetBuffer);
+    m_persistentKernel.setArg(9, checkSlots);
+    m_persistentKernel.setArg(10, m_scratchBuffer);
+
+    m_queue.enqueueNDRangeKernel(
+        m_persistentKernel,
+        cl::NullRange,
+        cl::NDRange(globalSize),
+        cl::NDRange(m_localWorkSize),
+        nullptr,
+        &kernelEvent
+    );
+
+    // Rings are never cleared; the host copy is drained from its own cursors
+    std::vector<cl::Event> waitList = {kernelEvent};
+    m_queue.enqueueReadBuffer(m_ringBuffer, CL_FALSE, 0, RING_WORDS * sizeof(uint32_t),
+                              m_ring[bufferIndex].data(), &waitList, &completionEvent);
+}
+
+void CLMiner::processRing(unsigned bufferIndex) {
+    const uint32_t* ring = m_ring[bufferIndex].data();
+
+    // Counters are cumulative; this launch's share is the change since the last drain
+    uint32_t hashes = ring[2] - m_hashesRead;
+    m_hashesRead = ring[2];
+
+    std::vector<uint64_t> nonces;
+    uint32_t lost = m_solutionRing.drain(ring[0], ring + RING_HEADER, nonces);
+    verifyNonces(nonces, m_setWork[m_workSet]);
+
+    // Overwritten entries are gone; find them again with one-shot launches
+    if (lost > 0) {
+        rescanLaunch(bufferIndex, nonces);
+    }
+
+    if (getIntegritySample() > 0) {
+        uint32_t hits = m_checkRing.pending(ring[1]);
+        nonces.clear();
+        m_checkRing.drain(ring[1], ring + CHECK_RING_OFFSET, nonces);
+
+        std::vector<uint32_t> pairs;
+        for (uint64_t nonce : nonces) {
+            pairs.push_back(static_cast<uint32_t>(nonce));
+            pairs.push_back(static_cast<uint32_t>(nonce >> 32));
+        }
+        checkIntegrity(m_setWork[m_workSet], hashes, m_integrityBits, hits, pairs.data(),
+                       static_cast<uint32_t>(nonces.size()));
+    } else {
+        m_checkRing.skip(ring[1]);
+    }
+
+    updateHashCount(hashes);
+}
+
+size_t CLMiner::batchGlobalWorkSize() const {
+    size_t local = std::max<size_t>(1, m_localWorkSize);
+    size_t size = m_batchSizer.size();
+    size -= size % local;
+    return std::max(size, local);
+}
+
+unsigned CLMiner::launchLimit() const {
+    return getIntensity() < 100 ? 1 : m_slots.depth();
+}
+
+std::chrono::steady_clock::duration CLMiner::busyTime(unsigned slot) const {
+    // Kernel time when profiled, else enqueue to results read
+    double seconds = kernelTime(m_batches[slot].kernelEvent);
+    if (seconds > 0) {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds));
+    }
+    return std::chrono::steady_clock::now() - m_batches[slot].enqueuedAt;
+}
+
+double CLMiner::kernelTime(const cl::Event& kernelEvent) const {
+    if (!m_profiling) {
+        return 0;
+    }
+    try {
+        cl_ulong start = kernelEvent.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        cl_ulong end = kernelEvent.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+        return end > start ? static_cast<double>(end - start) * 1e-9 : 0;
+    } catch (const cl::Error&) {
+        return 0;
+    }
+}
+
+void CLMiner::recordTimeline(unsigned slot) {
+    if (!s_profiling || !m_profiling) {
+        return;
+    }
+
+    auto timing = [](const cl::Event& event, CommandTiming& command) {
+        command.queued = event.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>();
+        command.submit = event.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>();
+        command.start = event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        command.end = event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+    };
+
+    const PendingBatch& batch = m_batches[slot];
+    BatchTiming record;
+    record.startNonce = batch.startNonce;
+    record.size = batch.size;
+    record.slot = slot;
+    try {
+        timing(batch.kernelEvent, record.kernel);
+    } catch (const cl::Error&) {
+        return;
+    }
+    try {
+        timing(batch.event, record.read);
+    } catch (const cl::Error&) {
+        record.read = CommandTiming();
+    }
+    m_timeline.record(record, batch.enqueuedAt);
+}
+
+void CLMiner::enqueueBatch(uint64_t startNonce, size_t globalSize, unsigned bufferIndex, unsigned workSet,
+                           uint32_t outputs, cl::Event& kernelEvent, cl::Event& completionEvent) {
+    // Clear output counters (async; the source must outlive the write).
+    // On an out-of-order queue the kernel waits on the clears and on the
+    // previous kernel, which uses the same scratchpads.
+    static const uint32_t zero = 0;
+    uint32_t maxChecks = getIntegritySample() > 0 ? MAX_CHECKS : 0;
+    std::vector<cl::Event> kernelWait;
+    cl::Event cleared;
+    m_batchQueue.enqueueWriteBuffer(m_outputBuffer[bufferIndex], CL_FALSE, 0, sizeof(uint32_t), &zero,
+                                    nullptr, m_outOfOrder ? &cleared : nullptr);
+    if (m_outOfOrder) {
+        kernelWait.push_back(cleared);
+    }
+    if (maxChecks > 0) {
+        m_batchQueue.enqueueWriteBuffer(m_outputBuffer[bufferIndex], CL_FALSE, checkOffset(outputs) * sizeof(uint32_t),
+                                        sizeof(uint32_t), &zero, nullptr, m_outOfOrder ? &cleared : nullptr);
+        if (m_outOfOrder) {
+            kernelWait.push_back(cleared);
+        }
+    }
+    if (m_outOfOrder && m_lastKernel() != nullptr) {
+        kernelWait.push_back(m_lastKernel);
+    }
+    if (m_outOfOrder) {
+        kernelWait.insert(kernelWait.end(), m_uploads[workSet].begin(), m_uploads[workSet].end());
+    }
 
     // Set kernel arguments
     m_searchKernel.setArg(0, m_outputBuffer[bufferIndex]);
-    m_searchKernel.setArg(1, m_headerBuffer);
-    m_searchKernel.setArg(2, m_targetBuffer);
+    m_searchKernel.setArg(1, m_headerBuffer[workSet]);
+    m_searchKernel.setArg(2, m_targetBuffer[workSet]);
     m_searchKernel.setArg(3, startNonce);
-    m_searchKernel.setArg(4, MAX_OUTPUTS);
+    m_searchKernel.setArg(4, outputs);
+    m_searchKernel.setArg(5, m_checkTargetBuffer);
+    m_searchKernel.setArg(6, maxChecks);
+    m_searchKernel.setArg(7, m_scratchBuffer);
 
     // Execute kernel (async)
-    cl::Event kernelEvent;
-    m_queue.enqueueNDRangeKernel(
+    m_batchQueue.enqueueNDRangeKernel(
         m_searchKernel,
         cl::NullRange,
-        cl::NDRange(m_globalWorkSize),
+        cl::NDRange(globalSize),
         cl::NDRange(m_localWorkSize),
-        nullptr,
+        m_outOfOrder ? &kernelWait : nullptr,
         &kernelEvent
     );
+    m_lastKernel = kernelEvent;
 
-    // Enqueue async read of results (depends on kernel completion)
+    // Enqueue async read of results (depends on kernel completion), only
+    // the slots this batch was given
     // The event returned here is what we wait on to know results are ready
     std::vector<cl::Event> waitList = {kernelEvent};
-    m_queue.enqueueReadBuffer(m_outputBuffer[bufferIndex], CL_FALSE, 0,
-                              m_output[bufferIndex].size() * sizeof(uint32_t),
+    m_batchQueue.enqueueReadBuffer(m_outputBuffer[bufferIndex], CL_FALSE, 0,
+                              outputWords(outputs) * sizeof(uint32_t),
                               m_output[bufferIndex].data(),
                               &waitList,
                               &completionEvent);
 }
 
+bool CLMiner::hashBatch(const WorkPackage& work, uint64_t startNonce, unsigned count,
+                        std::vector<Hash256>& hashes) {
+    try {
+        // Own buffers: leaves the mining header untouched
+        cl::Buffer header(m_context, CL_MEM_READ_ONLY, INPUT_SIZE);
+        m_queue.enqueueWriteBuffer(header, CL_TRUE, 0, INPUT_SIZE, work.header.data());
+
+        // Launches cover at most the work items the scratch buffer holds
+        std::vector<uint64_t> words(count * 4);
+        for (unsigned done = 0; done < count;) {
+            unsigned launch = static_cast<unsigned>(std::min<size_t>(count - done, m_globalWorkSize));
+            cl::Buffer output(m_context, CL_MEM_WRITE_ONLY, launch * 4 * sizeof(uint64_t));
+
+            m_benchmarkKernel.setArg(0, output);
+            m_benchmarkKernel.setArg(1, header);
+            m_benchmarkKernel.setArg(2, startNonce + done);
+            m_benchmarkKernel.setArg(3, 1u);
+            m_benchmarkKernel.setArg(4, m_scratchBuffer);
+            m_queue.enqueueNDRangeKernel(m_benchmarkKernel, cl::NullRange, cl::NDRange(launch), cl::NDRange(1));
+
+            m_queue.enqueueReadBuffer(output, CL_TRUE, 0, launch * 4 * sizeof(uint64_t), &words[done * 4]);
+            done += launch;
+        }
+
+        // Kernel stores each hash as four little-endian words
+        hashes.resize(count);
+        for (unsigned i = 0; i < count; i++) {
+            for (unsigned b = 0; b < HASH_SIZE; b++) {
+                hashes[i][b] = static_cast<uint8_t>(words[i * 4 + b / 8] >> ((b % 8) * 8));
+            }
+        }
+        return true;
+
+    } catch (const cl::Error& e) {
+        std::ostringstream ss;
+        ss << getName() << ": Self-test kernel error: " << e.what() << " (" << e.err() << ")";
+        Log::error(ss.str());
+        return false;
+    }
+}
+
+double CLMiner::benchmark(uint64_t minHashes) {
+    try {
+        // Header contents do not affect the work per hash; a zero target is never met
+        std::array<uint8_t, INPUT_SIZE> pattern;
+        for (size_t i = 0; i < INPUT_SIZE; i++) {
+            pattern[i] = static_cast<uint8_t>(i);
+        }
+        Hash256 target{};
+        finishBatches();
+        m_queue.enqueueWriteBuffer(m_headerBuffer[m_workSet], CL_TRUE, 0, INPUT_SIZE, pattern.data());
+        m_queue.enqueueWriteBuffer(m_targetBuffer[m_workSet], CL_TRUE, 0, HASH_SIZE, target.data());
+
+        // Warm-up batch absorbs first-use costs (page mapping, clocks ramping)
+        size_t globalSize = m_batchSizer.size();
+        cl::Event kernelEvent, event;
+        enqueueBatch(0, globalSize, 0, m_workSet, MIN_OUTPUT_CAPACITY, kernelEvent, event);
+        event.wait();
+        resetPipeline();
+
+        // Same loop as mining: keep every slot busy, recycle whichever finishes
+        uint64_t nonce = globalSize;
+        uint64_t hashes = 0;
+        auto started = std::chrono::steady_clock::now();
+        while (hashes < minHashes || hashes < 2 * globalSize) {
+            launchBatches(nonce);
+            unsigned slot = waitForBatch();
+            hashes += m_batches[slot].size;
+            m_slots.release(slot);
+        }
+        for (unsigned slot : m_slots.inFlight()) {
+            m_batches[slot].event.wait();
+            hashes += m_batches[slot].size;
+        }
+        resetPipeline();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        // Put the mining work back
+        const WorkPackage& work = m_setWork[m_workSet];
+        if (work.valid) {
+            m_queue.enqueueWriteBuffer(m_headerBuffer[m_workSet], CL_TRUE, 0, INPUT_SIZE, work.header.data());
+            m_queue.enqueueWriteBuffer(m_targetBuffer[m_workSet], CL_TRUE, 0, HASH_SIZE, work.target.data());
+        }
+
+        return seconds > 0 ? static_cast<double>(hashes) / seconds : 0.0;
+
+    } catch (const cl::Error& e) {
+        resetPipeline();
+        std::ostringstream ss;
+        ss << getName() << ": Benchmark error: " << e.what() << " (" << e.err() << ")";
+        Log::error(ss.str());
+        return 0.0;
+    }
+}
+
 uint32_t CLMiner::readBatchResults(unsigned bufferIndex) {
     return m_output[bufferIndex][0];  // Solution count
 }
 
-void CLMiner::processSolutions(unsigned bufferIndex, uint64_t startNonce) {
-    uint32_t solutionCount = readBatchResults(bufferIndex);
+void CLMiner::readNonces(unsigned bufferIndex, uint32_t count, std::vector<uint64_t>& nonces) const {
+    const std::vector<uint32_t>& output = m_output[bufferIndex];
+    for (uint32_t i = 0; i < count; i++) {
+        nonces.push_back(output[1 + i * 2] | (static_cast<uint64_t>(output[1 + i * 2 + 1]) << 32));
+    }
+}
+
+void CLMiner::verifyNonces(const std::vector<uint64_t>& nonces, const WorkPackage& work) {
+    for (uint64_t solNonce : nonces) {
+        // Basic sanity check on nonce value
+        if (solNonce == 0 || solNonce == UINT64_MAX) {
+            Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":suspicious",
+                         getName() + ": Suspicious nonce value " + std::to_string(solNonce) + ", skipping");
+            continue;
+        }
 
-    // Bounds check - cap solution count to prevent buffer overflow
-    if (solutionCount > MAX_OUTPUTS) {
-        Log::warning(getName() + ": GPU returned invalid solution count " +
-                    std::to_string(solutionCount) + ", capping to " + std::to_string(MAX_OUTPUTS));
-        solutionCount = MAX_OUTPUTS;
+        // Verify on CPU against the batch's job before submitting
+        verifySolution(solNonce, work);
     }
+}
 
-    if (solutionCount > 0) {
-        for (uint32_t i = 0; i < solutionCount; i++) {
-            uint64_t solNonce = m_output[bufferIndex][1 + i * 2] |
-                               (static_cast<uint64_t>(m_output[bufferIndex][1 + i * 2 + 1]) << 32);
+bool CLMiner::processSolutions(unsigned bufferIndex, const WorkPackage& work) {
+    const PendingBatch& batch = m_batches[bufferIndex];
+    uint32_t solutionCount = readBatchResults(bufferIndex);
 
-            // Basic sanity check on nonce value
-            if (solNonce == 0 || solNonce == UINT64_MAX) {
-                Log::warning(getName() + ": Suspicious nonce value " + std::to_string(solNonce) + ", skipping");
-                continue;
-            }
+    // More solutions than nonces can only be a device fault: take the
+    // stored ones, but do not size buffers or rescan for it
+    bool overflowed = false;
+    if (solutionCount > batch.size) {
+        Log::limited(LogLevel::Warning, LogCategory::Device, getName() + ":count",
+                     getName() + ": GPU returned invalid solution count " + std::to_string(solutionCount) +
+                     " for " + std::to_string(batch.size) + " nonces");
+    } else {
+        overflowed = m_outputSizer.record(solutionCount, batch.outputs);
+    }
 
-            // Verify on CPU before submitting
-            verifySolution(solNonce);
-        }
+    std::vector<uint64_t> nonces;
+    readNonces(bufferIndex, std::min(solutionCount, batch.outputs), nonces);
+    verifyNonces(nonces, work);
+    return overflowed;
+}
+
+void CLMiner::processChecks(unsigned bufferIndex, const WorkPackage& work, uint64_t hashes) {
+    if (getIntegritySample() == 0) {
+        return;
     }
+
+    const uint32_t* checks = m_output[bufferIndex].data() + checkOffset(m_batches[bufferIndex].outputs);
+    uint32_t hits = checks[0];
+    checkIntegrity(work, hashes, m_integrityBits, hits, checks + 1, std::min(hits, MAX_CHECKS));
 }
 
 std::vector<DeviceDescriptor> CLMiner::enumDevices() {
@@ -400,7 +1089,7 @@ std::vector<DeviceDescriptor> CLMiner::enumDevices() {
         for (unsigned p = 0; p < platforms.size(); p++) {
             std::vector<cl::Device> platformDevices;
             try {
-                platforms[p].getDevices(CL_DEVICE_TYPE_GPU, &platformDevices);
+                platforms[p].getDevices(s_deviceType, &platformDevices);
             } catch (const cl::Error&) {
                 continue;  // No GPUs on this platform
             }
@@ -414,6 +1103,7 @@ std::vector<DeviceDescriptor> CLMiner::enumDevices() {
                 desc.name = platformDevices[d].getInfo<CL_DEVICE_NAME>();
                 desc.totalMemory = platformDevices[d].getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
                 desc.computeUnits = platformDevices[d].getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+                desc.driverVersion = platformDevices[d].getInfo<CL_DRIVER_VERSION>();
                 desc.clPlatformName = platformName;
                 desc.clPlatformIndex = p;
                 desc.clDeviceIndex = d;
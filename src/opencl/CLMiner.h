@@ -9,19 +9,28 @@
 #ifdef WITH_OPENCL
 
 #include "core/Miner.h"
+#include "core/OutputSizer.h"
+#include "core/PipelineSlots.h"
+#include "core/TuningProfiles.h"
+#include "ResultRing.h"
+#include "ScratchLayout.h"
 #include <CL/cl.hpp>
+#include <chrono>
 #include <vector>
-#include <queue>
 
 namespace tos {
 
 /**
- * Pending batch structure for double buffering
+ * Batch in flight in one pipeline slot
  */
 struct PendingBatch {
-    uint64_t startNonce;    // Starting nonce for this batch
-    unsigned bufferIndex;   // Which buffer was used
-    cl::Event event;        // Completion event
+    uint64_t startNonce = 0;  // Starting nonce for this batch
+    size_t size = 0;          // Nonces covered (global work size)
+    unsigned workSet = 0;     // Header/target set the batch reads (see m_setWork)
+    uint32_t outputs = MIN_OUTPUT_CAPACITY;  // Solution slots the batch was given
+    cl::Event kernelEvent;    // Kernel execution (profiled with the batch sizer or setProfiling)
+    cl::Event event;          // Completion event (result readback)
+    std::chrono::steady_clock::time_point enqueuedAt;  // Host time before the kernel was enqueued
 };
 
 /**
@@ -73,12 +82,105 @@ public:
         s_localWorkSize = size;
     }
 
+    /**
+     * Set nonces per work item for the persistent kernel
+     *
+     * @param nonces Nonces each work item hashes per launch (0 = one-shot kernel)
+     */
+    static void setNonceLoop(unsigned nonces) {
+        s_nonceLoop = nonces;
+    }
+
+    /**
+     * Set scratchpad layout (see ScratchLayout)
+     */
+    static void setScratchLayout(ScratchLayout layout) {
+        s_scratchLayout = layout;
+    }
+
+    /**
+     * Set batches kept in flight (1 .. MAX_PIPELINE_DEPTH)
+     */
+    static void setPipelineDepth(unsigned depth) {
+        s_pipelineDepth = PipelineSlots::clampDepth(depth);
+    }
+
+    /**
+     * Run one-shot batches on an out-of-order queue where the device supports it
+     *
+     * Kernels still run one at a time (they share the scratchpads), but
+     * output clears and readbacks no longer wait behind other batches.
+     */
+    static void setOutOfOrder(bool enabled) {
+        s_outOfOrder = enabled;
+    }
+
+    /**
+     * Record device timestamps of every batch's kernel and readback
+     *
+     * Enables CL_QUEUE_PROFILING_ENABLE and feeds the device timeline
+     * (kernel, transfer and idle histograms, trace export).
+     */
+    static void setProfiling(bool enabled) {
+        s_profiling = enabled;
+    }
+
+    /**
+     * Use per-device settings instead of the global ones (call before init)
+     *
+     * @param profile Work sizes, nonce loop, scratchpad layout and pipeline depth (CUDA fields ignored)
+     */
+    void setTuning(const TuningProfile& profile) {
+        m_tuning = profile;
+        m_tuned = true;
+    }
+
+    /**
+     * Get the scratchpad layout the kernel was built with (valid after init)
+     */
+    ScratchLayout getScratchLayout() const { return m_scratchLayout; }
+
+    /**
+     * Get batches kept in flight (valid after init)
+     */
+    unsigned getPipelineDepth() const { return m_slots.depth(); }
+
+    /**
+     * Check whether batches run on an out-of-order queue (valid after init)
+     */
+    bool isOutOfOrder() const { return m_outOfOrder; }
+
+    /**
+     * Measure raw hash rate through the search pipeline (no solutions, no pool)
+     *
+     * Runs the mining kernel against an unreachable target with the
+     * configured number of batches in flight, so pipeline depth and queue
+     * mode show up in the result. Leaves the current work on the device.
+     *
+     * @param minHashes Hash at least this many nonces after a warm-up batch
+     * @return Hashes per second, 0 on error
+     */
+    double benchmark(uint64_t minHashes);
+
+    /**
+     * Set device types to mine on (default GPUs; CPU runtimes such as POCL for tests)
+     */
+    static void setDeviceType(cl_device_type type) {
+        s_deviceType = type;
+    }
+
 protected:
     /**
      * Main mining loop
      */
     void mineLoop() override;
 
+    /**
+     * Hash consecutive nonces with the benchmark kernel (self-test)
+     */
+    bool hashBatch(const WorkPackage& work, uint64_t startNonce, unsigned count,
+                   std::vector<Hash256>& hashes) override;
+
 private:
     /**
      * Compile OpenCL kernel
@@ -90,14 +192,154 @@ private:
      */
     bool allocateBuffers();
 
+    /**
+     * Rebuild kernel and buffers after repeated errors
+     *
+     * @return false if the device could not be reinitialized
+     */
+    bool reinitialize();
+
+    /**
+     * Mining loop for the persistent kernel (see setNonceLoop)
+     */
+    void persistentLoop();
+
+    /**
+     * Wait for a launch, returning early when work changes or mining stops
+     *
+     * @return true if the launch completed
+     */
+    bool waitForLaunch(const cl::Event& event);
+
+    /**
+     * Enqueue one-shot batches into every free pipeline slot
+     *
+     * @param nonce Next nonce to search, advanced past the enqueued batches
+     */
+    void launchBatches(uint64_t& nonce);
+
+    /**
+     * Wait for a batch to finish, taking any completed slot before the oldest
+     *
+     * @return Slot of the finished batch (still marked in flight)
+     */
+    unsigned waitForBatch();
+
+    /**
+     * Wait for batches in flight and process their results
+     *
+     * @param workSet Only batches reading this header/target set (-1 = all)
+     */
+    void finishBatches(int workSet = -1);
+
+    /**
+     * Process a completed batch's results and free its slot
+     */
+    void processBatch(unsigned slot);
+
+    /**
+     * Upload a job into the header/target set batches are not using
+     *
+     * The upload is asynchronous; batches launched afterwards wait for it,
+     * while the previous job's batches keep running from the other set.
+     */
+    void switchWork(const WorkPackage& work);
+
+    /**
+     * Re-search a batch whose solutions overflowed its output buffer
+     *
+     * Runs synchronously in the batch's slot, skipping the nonces the
+     * batch already returned.
+     */
+    void rescanBatch(unsigned slot);
+
+    /**
+     * Re-search a persistent launch whose solution ring wrapped
+     *
+     * @param slot Pipeline slot of the launch
+     * @param drained Nonces already taken from the ring
+     */
+    void rescanLaunch(unsigned slot, const std::vector<uint64_t>& drained);
+
+    /**
+     * Forget batches in flight after an error
+     */
+    void resetPipeline();
+
+    /**
+     * End in-flight persistent launches, draining their results against
+     * the work set they searched (call before switching work)
+     */
+    void abortLaunches();
+
+    /**
+     * Enqueue a persistent kernel launch and the ring readback
+     *
+     * @param startNonce First nonce of the launch
+     * @param globalSize Number of work items
+     * @param bufferIndex Pipeline slot (host ring copy to read into)
+     * @param kernelEvent Output event for the kernel
+     * @param event Output event for completion tracking
+     */
+    void enqueueLaunch(uint64_t startNonce, size_t globalSize, unsigned bufferIndex,
+                       cl::Event& kernelEvent, cl::Event& event);
+
+    /**
+     * Process solutions, check hits and hash count from a launch's ring copy
+     */
+    void processRing(unsigned bufferIndex);
+
+    /**
+     * Get batch sizer's global work size, aligned to the local work size
+     */
+    size_t batchGlobalWorkSize() const;
+
+    /**
+     * Get batches that may be in flight: one while throttled (intensity
+     * below 100), so the idle time after it leaves the device idle
+     */
+    unsigned launchLimit() const;
+
+    /**
+     * Get the time a finished batch kept the device busy (duty cycle)
+     */
+    std::chrono::steady_clock::duration busyTime(unsigned slot) const;
+
+    /**
+     * Get kernel execution time from a profiled event in seconds (0 if not profiled)
+     */
+    double kernelTime(const cl::Event& kernelEvent) const;
+
+    /**
+     * Record a finished batch's kernel and readback timestamps (setProfiling)
+     */
+    void recordTimeline(unsigned slot);
+
     /**
      * Enqueue a batch for async execution
      *
      * @param startNonce Starting nonce
-     * @param bufferIndex Which buffer to use
+     * @param globalSize Number of work items (nonces)
+     * @param bufferIndex Pipeline slot (output buffer to use)
+     * @param workSet Header/target set to search
+     * @param outputs Solution slots to store (up to MAX_OUTPUT_CAPACITY)
+     * @param kernelEvent Output event for the kernel
      * @param event Output event for completion tracking
      */
-    void enqueueBatch(uint64_t startNonce, unsigned bufferIndex, cl::Event& event);
+    void enqueueBatch(uint64_t startNonce, size_t globalSize, unsigned bufferIndex, unsigned workSet,
+                      uint32_t outputs, cl::Event& kernelEvent, cl::Event& event);
+
+    /**
+     * Search a nonce range synchronously in a slot's output buffer (rescans)
+     *
+     * @param range Nonces to search (size a multiple of the local work size)
+     * @param bufferIndex Pipeline slot whose buffers to use
+     * @param workSet Header/target set to search
+     * @param nonces Solutions stored by the device
+     * @param count Solutions the device counted
+     */
+    void searchRange(const NonceRange& range, unsigned bufferIndex, unsigned workSet,
+                     std::vector<uint64_t>& nonces, uint32_t& count);
 
     /**
      * Read results from a completed batch
@@ -107,49 +349,129 @@ private:
      */
     uint32_t readBatchResults(unsigned bufferIndex);
 
+    /**
+     * Read solution nonces from a slot's host copy
+     *
+     * @param bufferIndex Buffer containing results
+     * @param count Solutions to read
+     * @param nonces Output nonces (appended)
+     */
+    void readNonces(unsigned bufferIndex, uint32_t count, std::vector<uint64_t>& nonces) const;
+
+    /**
+     * Verify and submit solution nonces, skipping implausible values
+     *
+     * @param nonces Nonces reported by the device
+     * @param work Work they were computed for
+     */
+    void verifyNonces(const std::vector<uint64_t>& nonces, const WorkPackage& work);
+
     /**
      * Process found solutions
      *
      * @param bufferIndex Buffer containing results
-     * @param startNonce Starting nonce for this batch
+     * @param work Work the batch was computed for
+     * @return true if solutions overflowed the batch's output slots
      */
-    void processSolutions(unsigned bufferIndex, uint64_t startNonce);
+    bool processSolutions(unsigned bufferIndex, const WorkPackage& work);
+
+    /**
+     * Pass a batch's easy-target hits to integrity sampling
+     *
+     * @param bufferIndex Buffer containing results
+     * @param work Work the batch was computed for
+     * @param hashes Nonces covered by the batch
+     */
+    void processChecks(unsigned bufferIndex, const WorkPackage& work, uint64_t hashes);
 
 private:
     // OpenCL objects
     cl::Context m_context;
     cl::CommandQueue m_queue;
+    cl::CommandQueue m_batchQueue;  // One-shot batches: m_queue, or an out-of-order queue
     cl::Program m_program;
     cl::Kernel m_searchKernel;
     cl::Kernel m_benchmarkKernel;
+    cl::Kernel m_persistentKernel;
+
+    // Async pipeline: one output buffer, host copy and batch per slot
+    PipelineSlots m_slots;
+    std::vector<PendingBatch> m_batches;
+    bool m_outOfOrder = false;
+    cl::Event m_lastKernel;  // Out-of-order queue: the next kernel waits on it
+
+    // Solution slots for the next batch (see OutputSizer)
+    OutputSizer m_outputSizer;
+
+    // GPU buffers
+    std::vector<cl::Buffer> m_outputBuffer;  // Solution output buffers (per slot, MAX_OUTPUT_CAPACITY)
+    cl::Buffer m_headerBuffer[2];  // Block header, per work set
+    cl::Buffer m_targetBuffer[2];  // Target hash, per work set
+    cl::Buffer m_checkTargetBuffer;  // Integrity check target (constant)
+    cl::Buffer m_scratchBuffer;  // Global scratchpads, 64KB per work item (one word with the local layout)
 
-    // Double buffering constants
-    static constexpr unsigned c_bufferCount = 2;
+    // Scratchpad layout the kernel was built with
+    ScratchLayout m_scratchLayout = ScratchLayout::Local;
 
-    // GPU buffers (double buffered)
-    cl::Buffer m_outputBuffer[c_bufferCount];   // Solution output buffers
-    cl::Buffer m_headerBuffer;   // Block header (constant)
-    cl::Buffer m_targetBuffer;   // Target hash (constant)
+    // Host-side output buffers (per slot)
+    std::vector<std::vector<uint32_t>> m_output;
 
-    // Host-side output buffers (double buffered)
-    std::vector<uint32_t> m_output[c_bufferCount];
+    // Persistent kernel: result rings, abort generation and the queue that writes it
+    unsigned m_nonceLoop = 0;
+    cl::CommandQueue m_controlQueue;
+    cl::Buffer m_ringBuffer;
+    cl::Buffer m_controlBuffer;
+    std::vector<std::vector<uint32_t>> m_ring;  // Host ring copies (per slot)
+    ResultRing m_solutionRing{RING_SIZE};
+    ResultRing m_checkRing{CHECK_RING_SIZE};
+    uint32_t m_hashesRead = 0;
+    uint32_t m_generation = 0;
 
-    // Pending batch queue for async pipeline
-    std::queue<PendingBatch> m_pending;
+    // Work uploaded to each header/target set and the uploads' events;
+    // new batches use m_workSet (mining thread only)
+    WorkPackage m_setWork[2];
+    std::vector<cl::Event> m_uploads[2];
+    unsigned m_workSet = 0;
 
-    // Current buffer index
-    unsigned m_bufferIndex = 0;
+    // Integrity check target difficulty (see Miner::setIntegritySample)
+    unsigned m_integrityBits = 1;
 
-    // Work sizes
+    // Work sizes; m_globalWorkSize is the most work items a batch may use
+    // (what the scratch buffer holds), the batch sizer picks the current size
     size_t m_globalWorkSize;
     size_t m_localWorkSize;
 
-    // Maximum solutions per batch
-    static constexpr uint32_t MAX_OUTPUTS = 64;
+    // Queue records command timestamps (batch sizer or setProfiling on)
+    bool m_profiling = false;
+
+    // Batch sizer range relative to the configured global work size
+    static constexpr size_t BATCH_GROWTH = 4;
+    static constexpr size_t BATCH_SHRINK = 16;
+
+    // Maximum integrity check hits per batch, stored after the batch's solution slots
+    static constexpr uint32_t MAX_CHECKS = 32;
+    static constexpr uint32_t checkOffset(uint32_t outputs) { return 1 + outputs * 2; }
+    static constexpr uint32_t outputWords(uint32_t outputs) { return checkOffset(outputs) + 1 + MAX_CHECKS * 2; }
+
+    // Persistent kernel rings: [0] solutions, [1] check hits, [2] hashes, [3] unused, then slots
+    static constexpr uint32_t RING_SIZE = 64;
+    static constexpr uint32_t CHECK_RING_SIZE = 32;
+    static constexpr uint32_t RING_HEADER = 4;
+    static constexpr uint32_t CHECK_RING_OFFSET = RING_HEADER + RING_SIZE * 2;
+    static constexpr uint32_t RING_WORDS = CHECK_RING_OFFSET + CHECK_RING_SIZE * 2;
+
+    // Per-device settings (see setTuning), else the static ones below
+    TuningProfile m_tuning;
+    bool m_tuned = false;
 
-    // Static configuration
     static unsigned s_globalWorkSizeMultiplier;
     static unsigned s_localWorkSize;
+    static unsigned s_nonceLoop;
+    static cl_device_type s_deviceType;
+    static ScratchLayout s_scratchLayout;
+    static unsigned s_pipelineDepth;
+    static bool s_outOfOrder;
+    static bool s_profiling;
 };
 
 }  // namespace tos
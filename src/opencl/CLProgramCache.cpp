@@ -0,0 +1,174 @@
+/**
+ * TOS Miner - OpenCL Program Cache Implementation
+ */
+
+#ifdef WITH_OPENCL
+
+#include "CLProgramCache.h"
+#include "util/BinaryCache.h"
+#include "util/Log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+namespace tos {
+
+std::string CLProgramCache::key(const cl::Device& device, const std::string& source, const std::string& options) {
+    cl::Platform platform(device.getInfo<CL_DEVICE_PLATFORM>());
+
+    char sourceHash[17];
+    std::snprintf(sourceHash, sizeof(sourceHash), "%016llx",
+                  static_cast<unsigned long long>(BinaryCache::fnv1a(source.data(), source.size())));
+
+    return device.getInfo<CL_DEVICE_NAME>() + "|" + device.getInfo<CL_DRIVER_VERSION>() + "|" +
+           platform.getInfo<CL_PLATFORM_NAME>() + "|" + platform.getInfo<CL_PLATFORM_VERSION>() + "|" +
+           options + "|" + sourceHash;
+}
+
+std::string CLProgramCache::defaultDirectory() {
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) {
+        return std::string(xdg) + "/tosminer";
+    }
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + "/.cache/tosminer";
+    }
+    return "";
+}
+
+const char* CLProgramCache::originName(Origin origin) {
+    switch (origin) {
+        case Origin::Memory: return "shared build";
+        case Origin::Disk:   return "disk cache";
+        case Origin::Source: return "source";
+    }
+    return "unknown";
+}
+
+bool CLProgramCache::build(const cl::Context& context, const cl::Device& device,
+                           const std::string& source, const std::string& options,
+                           cl::Program& program, std::string& log, Origin& origin) {
+    std::string cacheKey = key(device, source, options);
+
+    // The first device with this key builds; identical devices wait for its binary
+    std::shared_ptr<std::promise<Binary>> leader;
+    std::shared_future<Binary> shared;
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        directory = s_directory;
+        auto it = s_builds.find(cacheKey);
+        if (it != s_builds.end()) {
+            shared = it->second;
+        } else {
+            leader = std::make_shared<std::promise<Binary>>();
+            shared = leader->get_future().share();
+            s_builds[cacheKey] = shared;
+        }
+    }
+
+    if (!leader) {
+        const Binary& binary = shared.get();
+        if (!binary.empty() && buildBinary(context, device, binary, options, program)) {
+            origin = Origin::Memory;
+            return true;
+        }
+        // Leader failed or the binary does not load here: build on our own
+        origin = Origin::Source;
+        return buildSource(context, device, source, options, program, log);
+    }
+
+    BinaryCache disk(directory);
+    Binary binary;
+    bool built = false;
+
+    BinaryCache::Status status = disk.load(cacheKey, binary);
+    if (status == BinaryCache::Status::Hit) {
+        built = buildBinary(context, device, binary, options, program);
+        if (built) {
+            origin = Origin::Disk;
+        } else {
+            Log::warning("Cached OpenCL binary rejected by the driver, rebuilding from source");
+        }
+    } else if (status == BinaryCache::Status::Corrupt) {
+        Log::warning("Corrupt OpenCL binary cache entry removed, rebuilding from source");
+    }
+
+    if (!built) {
+        binary.clear();
+        origin = Origin::Source;
+        built = buildSource(context, device, source, options, program, log);
+        if (built) {
+            binary = programBinary(program);
+            if (!binary.empty() && disk.enabled() && !disk.store(cacheKey, binary)) {
+                Log::warning("Could not write OpenCL binary cache in " + directory);
+            }
+        }
+    }
+
+    leader->set_value(binary);
+    if (binary.empty()) {
+        // Nothing to share; let the next caller try again
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_builds.erase(cacheKey);
+    }
+
+    return built;
+}
+
+bool CLProgramCache::buildSource(const cl::Context& context, const cl::Device& device,
+                                 const std::string& source, const std::string& options,
+                                 cl::Program& program, std::string& log) {
+    try {
+        program = cl::Program(context, source);
+        if (program.build({device}, options.c_str()) == CL_SUCCESS) {
+            return true;
+        }
+    } catch (const cl::Error&) {
+        // Build log below
+    }
+
+    try {
+        log = program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device);
+    } catch (const cl::Error&) {
+        log.clear();
+    }
+    return false;
+}
+
+bool CLProgramCache::buildBinary(const cl::Context& context, const cl::Device& device,
+                                 const Binary& binary, const std::string& options, cl::Program& program) {
+    try {
+        cl::Program::Binaries binaries = {{binary.data(), binary.size()}};
+        std::vector<cl_int> binaryStatus;
+        cl_int error = CL_SUCCESS;
+        program = cl::Program(context, {device}, binaries, &binaryStatus, &error);
+        if (error != CL_SUCCESS || (!binaryStatus.empty() && binaryStatus[0] != CL_SUCCESS)) {
+            return false;
+        }
+        return program.build({device}, options.c_str()) == CL_SUCCESS;
+    } catch (const cl::Error&) {
+        return false;
+    }
+}
+
+CLProgramCache::Binary CLProgramCache::programBinary(const cl::Program& program) {
+    // The C API, since cl.hpp's CL_PROGRAM_BINARIES query needs preallocated buffers
+    size_t size = 0;
+    if (clGetProgramInfo(program(), CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, nullptr) != CL_SUCCESS ||
+        size == 0) {
+        return {};
+    }
+
+    Binary binary(size);
+    unsigned char* pointer = binary.data();
+    if (clGetProgramInfo(program(), CL_PROGRAM_BINARIES, sizeof(pointer), &pointer, nullptr) != CL_SUCCESS) {
+        return {};
+    }
+    return binary;
+}
+
+}  // namespace tos
+
+#endif  // WITH_OPENCL
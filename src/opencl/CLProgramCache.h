@@ -0,0 +1,128 @@
+/**
+ * TOS Miner - OpenCL Program Cache
+ *
+ * Reuses compiled kernel binaries instead of compiling the kernel source
+ * for every device on every start and recovery
+ */
+
+#pragma once
+
+#ifdef WITH_OPENCL
+
+#include <CL/cl.hpp>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Process-wide cache of compiled OpenCL programs
+ *
+ * Binaries are keyed by device name, driver version, platform, build
+ * options and a hash of the kernel source. Devices with the same key
+ * share one build: the first compiles from source while the others wait
+ * for its binary. Binaries are also kept on disk (see BinaryCache), so a
+ * restart loads them instead of compiling. A corrupt entry, or a binary
+ * the driver rejects, falls back to a source build that replaces it.
+ */
+class CLProgramCache {
+public:
+    /**
+     * Where a built program came from
+     */
+    enum class Origin {
+        Memory,     // Binary built earlier in this process
+        Disk,       // Binary from the on-disk cache
+        Source      // Compiled from source
+    };
+
+    /**
+     * Build a program for one device, from a cached binary if possible
+     *
+     * @param context Context containing device
+     * @param device Device to build for
+     * @param source Kernel source
+     * @param options Build options
+     * @param program Output built program
+     * @param log Output build log (on failure)
+     * @param origin Output where the program came from
+     * @return true if program is built
+     */
+    static bool build(const cl::Context& context, const cl::Device& device,
+                      const std::string& source, const std::string& options,
+                      cl::Program& program, std::string& log, Origin& origin);
+
+    /**
+     * Cache key for a device, source and options
+     */
+    static std::string key(const cl::Device& device, const std::string& source, const std::string& options);
+
+    /**
+     * Set the on-disk cache directory ("" = memory only)
+     */
+    static void setDirectory(const std::string& directory) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_directory = directory;
+    }
+
+    /**
+     * Get the on-disk cache directory
+     */
+    static std::string getDirectory() {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        return s_directory;
+    }
+
+    /**
+     * Default cache directory ($XDG_CACHE_HOME/tosminer or ~/.cache/tosminer)
+     */
+    static std::string defaultDirectory();
+
+    /**
+     * Forget binaries built in this process (the disk cache is kept)
+     */
+    static void clearMemory() {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_builds.clear();
+    }
+
+    /**
+     * Get origin name for logging
+     */
+    static const char* originName(Origin origin);
+
+private:
+    using Binary = std::vector<uint8_t>;
+
+    /**
+     * Build from source
+     */
+    static bool buildSource(const cl::Context& context, const cl::Device& device,
+                            const std::string& source, const std::string& options,
+                            cl::Program& program, std::string& log);
+
+    /**
+     * Build from a device binary
+     *
+     * @return false if the driver rejects the binary
+     */
+    static bool buildBinary(const cl::Context& context, const cl::Device& device,
+                            const Binary& binary, const std::string& options, cl::Program& program);
+
+    /**
+     * Read the device binary of a built single-device program
+     */
+    static Binary programBinary(const cl::Program& program);
+
+    static inline std::mutex s_mutex;
+    static inline std::string s_directory;
+    static inline std::map<std::string, std::shared_future<Binary>> s_builds;  // Empty binary = build failed
+};
+
+}  // namespace tos
+
+#endif  // WITH_OPENCL
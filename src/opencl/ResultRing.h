@@ -0,0 +1,76 @@
+/**
+ * TOS Miner - Persistent Kernel Result Ring
+ *
+ * Host side of the rings the persistent search kernel appends to
+ * (no OpenCL dependency)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Read cursor over a device result ring
+ *
+ * The kernel never clears the ring: it bumps a 32-bit write counter
+ * (wrapping) and stores the nonce at counter % capacity. The host keeps
+ * the count it has read up to and, after each launch, takes the entries
+ * written since. Entries overwritten before they were read are lost.
+ */
+class ResultRing {
+public:
+    /**
+     * @param capacity Ring slots (two 32-bit words each: nonce low, high)
+     */
+    explicit ResultRing(uint32_t capacity) : m_capacity(capacity) {}
+
+    /**
+     * Take the entries written since the last drain
+     *
+     * @param written Device write counter
+     * @param slots Host copy of the ring slots
+     * @param nonces Output nonces, oldest first (appended)
+     * @return Entries lost because the ring wrapped before they were read
+     */
+    uint32_t drain(uint32_t written, const uint32_t* slots, std::vector<uint64_t>& nonces) {
+        uint32_t count = pending(written);
+        uint32_t lost = count > m_capacity ? count - m_capacity : 0;
+
+        for (uint32_t n = m_read + lost; n != written; n++) {
+            uint32_t slot = n % m_capacity;
+            nonces.push_back(slots[slot * 2] | (static_cast<uint64_t>(slots[slot * 2 + 1]) << 32));
+        }
+
+        m_read = written;
+        return lost;
+    }
+
+    /**
+     * Entries written since the last drain (including lost ones)
+     */
+    uint32_t pending(uint32_t written) const { return written - m_read; }
+
+    /**
+     * Discard entries up to the write counter (results for stale work)
+     */
+    void skip(uint32_t written) { m_read = written; }
+
+    /**
+     * Start over with an empty device ring
+     */
+    void reset() { m_read = 0; }
+
+    /**
+     * Get ring capacity
+     */
+    uint32_t capacity() const { return m_capacity; }
+
+private:
+    uint32_t m_capacity;
+    uint32_t m_read = 0;
+};
+
+}  // namespace tos
@@ -0,0 +1,98 @@
+/**
+ * TOS Miner - OpenCL Scratchpad Layouts
+ *
+ * Where the kernel keeps each work item's 64KB scratchpad (no OpenCL
+ * dependency; values match SCRATCH_LAYOUT in toshash_kernel.cl)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace tos {
+
+/**
+ * Scratchpad placement
+ *
+ * Local keeps the scratchpad in __local memory, so only devices with
+ * 64KB of it can run one work item per group. The global layouts use a
+ * device buffer of globalSize * 64KB: contiguous gives each work item its
+ * own 64KB slab, interleaved stores word i of every work item side by
+ * side (neighbouring work items touch neighbouring addresses, which GPUs
+ * coalesce), and blocked interleaves runs of SCRATCH_BLOCK words so each
+ * work item still reads whole cache-line segments.
+ */
+enum class ScratchLayout {
+    Local = 0,
+    Contiguous = 1,
+    Interleaved = 2,
+    Blocked = 3
+};
+
+// Words per run for ScratchLayout::Blocked (SCRATCH_BLOCK in the kernel)
+constexpr size_t SCRATCH_BLOCK_WORDS = 4;
+
+/**
+ * Get layout name as used on the command line
+ */
+inline const char* scratchLayoutName(ScratchLayout layout) {
+    switch (layout) {
+        case ScratchLayout::Local: return "local";
+        case ScratchLayout::Contiguous: return "contiguous";
+        case ScratchLayout::Interleaved: return "interleaved";
+        case ScratchLayout::Blocked: return "blocked";
+    }
+    return "unknown";
+}
+
+/**
+ * Parse a layout name
+ *
+ * @param name Layout name (see scratchLayoutName)
+ * @param layout Output layout
+ * @return false if the name is unknown
+ */
+inline bool parseScratchLayout(const std::string& name, ScratchLayout& layout) {
+    for (ScratchLayout candidate : {ScratchLayout::Local, ScratchLayout::Contiguous,
+                                    ScratchLayout::Interleaved, ScratchLayout::Blocked}) {
+        if (name == scratchLayoutName(candidate)) {
+            layout = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Check whether a layout needs the global scratch buffer
+ */
+inline bool scratchLayoutIsGlobal(ScratchLayout layout) {
+    return layout != ScratchLayout::Local;
+}
+
+/**
+ * Position of a scratch word in the global buffer (mirrors the kernel)
+ *
+ * @param layout Global layout
+ * @param item Work item (global id)
+ * @param word Scratch word index (0 .. MEMORY_SIZE - 1)
+ * @param globalSize Number of work items in the launch
+ * @param memorySize Scratch words per work item
+ * @return Word offset into the buffer
+ */
+inline size_t scratchWordOffset(ScratchLayout layout, size_t item, size_t word,
+                                size_t globalSize, size_t memorySize) {
+    switch (layout) {
+        case ScratchLayout::Interleaved:
+            return word * globalSize + item;
+        case ScratchLayout::Blocked:
+            return (word / SCRATCH_BLOCK_WORDS) * globalSize * SCRATCH_BLOCK_WORDS +
+                   item * SCRATCH_BLOCK_WORDS + word % SCRATCH_BLOCK_WORDS;
+        default:
+            return item * memorySize + word;
+    }
+}
+
+}  // namespace tos
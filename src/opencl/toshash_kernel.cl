@@ -18,19 +18,58 @@
 #define MIX_CONST 0x517cc1b727220a95UL
 #define INPUT_SIZE 112
 #define HASH_SIZE 32
+#define NONCE_OFFSET 40           // Nonce bytes 40-47, big-endian
+
+// Scratchpad layouts, chosen with -DSCRATCH_LAYOUT=n
+#define SCRATCH_LOCAL 0           // __local, one work item per group
+#define SCRATCH_CONTIGUOUS 1      // __global, word i of work item g at g * MEMORY_SIZE + i
+#define SCRATCH_INTERLEAVED 2     // __global, word i of work item g at i * global size + g
+#define SCRATCH_BLOCKED 3         // __global, SCRATCH_BLOCK-word blocks interleaved across work items
+
+#ifndef SCRATCH_LAYOUT
+#define SCRATCH_LAYOUT SCRATCH_LOCAL
+#endif
+#ifndef SCRATCH_BLOCK
+#define SCRATCH_BLOCK 4
+#endif
+
+// Kernels take a global scratch buffer (global size * MEMORY_SIZE words,
+// unused with SCRATCH_LOCAL); scratch points at the work item's first word
+#if SCRATCH_LAYOUT == SCRATCH_LOCAL
+    #define SCRATCH_PTR __local ulong*
+    #define DECLARE_SCRATCH(g_scratch) __local ulong scratch[MEMORY_SIZE]
+#elif SCRATCH_LAYOUT == SCRATCH_CONTIGUOUS
+    #define SCRATCH_PTR __global ulong*
+    #define DECLARE_SCRATCH(g_scratch) __global ulong* scratch = g_scratch + get_global_id(0) * MEMORY_SIZE
+#elif SCRATCH_LAYOUT == SCRATCH_INTERLEAVED
+    #define SCRATCH_PTR __global ulong*
+    #define DECLARE_SCRATCH(g_scratch) __global ulong* scratch = g_scratch + get_global_id(0)
+#else
+    #define SCRATCH_PTR __global ulong*
+    #define DECLARE_SCRATCH(g_scratch) __global ulong* scratch = g_scratch + get_global_id(0) * SCRATCH_BLOCK
+#endif
+
+// Offset of scratch word i from the work item's first word
+#if SCRATCH_LAYOUT == SCRATCH_INTERLEAVED
+    #define SCRATCH_INDEX(i) ((size_t)(i) * get_global_size(0))
+#elif SCRATCH_LAYOUT == SCRATCH_BLOCKED
+    #define SCRATCH_INDEX(i) \
+        ((size_t)(i) / SCRATCH_BLOCK * get_global_size(0) * SCRATCH_BLOCK + (i) % SCRATCH_BLOCK)
+#else
+    #define SCRATCH_INDEX(i) (i)
+#endif
 
 // Blake3 constants
 #define BLAKE3_OUT_LEN 32
-#define BLAKE3_KEY_LEN 32
 #define BLAKE3_BLOCK_LEN 64
-#define BLAKE3_CHUNK_LEN 1024
+#define BLAKE3_CHUNK_START 1
+#define BLAKE3_CHUNK_END 2
+#define BLAKE3_ROOT 8
 
 // Blake3 IV
-__constant ulong BLAKE3_IV[8] = {
-    0x6A09E667F3BCC908UL, 0xBB67AE8584CAA73BUL,
-    0x3C6EF372FE94F82BUL, 0xA54FF53A5F1D36F1UL,
-    0x510E527FADE682D1UL, 0x9B05688C2B3E6C1FUL,
-    0x1F83D9ABFB41BD6BUL, 0x5BE0CD19137E2179UL
+__constant uint BLAKE3_IV[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
 };
 
 // Blake3 message schedule
@@ -95,20 +134,25 @@ inline ulong toshash_mix(ulong a, ulong b, ulong round) {
     return z ^ rotr64(y, rot / 2);
 }
 
+// 32-bit rotate right (rotate() rotates left)
+inline uint rotr32(uint x, uint r) {
+    return rotate(x, 32u - r);
+}
+
 // Blake3 G function (quarter round)
-inline void blake3_g(ulong* state, uint a, uint b, uint c, uint d, ulong mx, ulong my) {
+inline void blake3_g(uint* state, uint a, uint b, uint c, uint d, uint mx, uint my) {
     state[a] = state[a] + state[b] + mx;
-    state[d] = rotr64(state[d] ^ state[a], 32);
+    state[d] = rotr32(state[d] ^ state[a], 16);
     state[c] = state[c] + state[d];
-    state[b] = rotr64(state[b] ^ state[c], 24);
+    state[b] = rotr32(state[b] ^ state[c], 12);
     state[a] = state[a] + state[b] + my;
-    state[d] = rotr64(state[d] ^ state[a], 16);
+    state[d] = rotr32(state[d] ^ state[a], 8);
     state[c] = state[c] + state[d];
-    state[b] = rotr64(state[b] ^ state[c], 63);
+    state[b] = rotr32(state[b] ^ state[c], 7);
 }
 
 // Blake3 round
-inline void blake3_round(ulong* state, __private ulong* m, uint round) {
+inline void blake3_round(uint* state, __private uint* m, uint round) {
     // Column step
     blake3_g(state, 0, 4, 8, 12, m[MSG_SCHEDULE[round][0]], m[MSG_SCHEDULE[round][1]]);
     blake3_g(state, 1, 5, 9, 13, m[MSG_SCHEDULE[round][2]], m[MSG_SCHEDULE[round][3]]);
@@ -122,53 +166,78 @@ inline void blake3_round(ulong* state, __private ulong* m, uint round) {
     blake3_g(state, 3, 4, 9, 14, m[MSG_SCHEDULE[round][14]], m[MSG_SCHEDULE[round][15]]);
 }
 
-// Simplified Blake3 hash for our use case (single block input up to 128 bytes)
-void blake3_hash(__private uchar* input, uint input_len, __private uchar* output) {
-    // Initialize state with IV
-    ulong state[16];
+// Blake3 compression of one 64-byte block into the chaining value
+void blake3_compress(uint* cv, __private uint* m, uint block_len, uint flags) {
+    uint state[16];
     for (int i = 0; i < 8; i++) {
-        state[i] = BLAKE3_IV[i];
+        state[i] = cv[i];
     }
-
-    // Block 1 setup
     state[8] = BLAKE3_IV[0];
     state[9] = BLAKE3_IV[1];
     state[10] = BLAKE3_IV[2];
     state[11] = BLAKE3_IV[3];
     state[12] = 0;  // counter low
     state[13] = 0;  // counter high
-    state[14] = input_len;  // block length
-    state[15] = 0x0B;  // flags: CHUNK_START | CHUNK_END | ROOT
+    state[14] = block_len;
+    state[15] = flags;
 
-    // Prepare message block (pad with zeros)
-    ulong m[16];
-    for (int i = 0; i < 16; i++) {
-        m[i] = 0;
+    // 7 rounds
+    for (uint round = 0; round < 7; round++) {
+        blake3_round(state, m, round);
     }
 
-    // Copy input to message block (little-endian)
-    for (uint i = 0; i < input_len && i < 128; i++) {
-        uint word = i / 8;
-        uint byte_pos = i % 8;
-        m[word] |= ((ulong)input[i]) << (byte_pos * 8);
+    for (int i = 0; i < 8; i++) {
+        cv[i] = state[i] ^ state[i + 8];
     }
+}
 
-    // 7 rounds
-    for (uint round = 0; round < 7; round++) {
-        blake3_round(state, m, round);
+// Blake3 hash of a single-chunk input (up to 1024 bytes; we hash 112 and 32)
+void blake3_hash(__private uchar* input, uint input_len, __private uchar* output) {
+    uint cv[8];
+    for (int i = 0; i < 8; i++) {
+        cv[i] = BLAKE3_IV[i];
     }
 
-    // Output (XOR of first and last 8 words)
-    for (int i = 0; i < 4; i++) {
-        ulong out_word = state[i] ^ state[i + 8];
-        for (int j = 0; j < 8; j++) {
-            output[i * 8 + j] = (uchar)((out_word >> (j * 8)) & 0xFF);
+    uint blocks = input_len == 0 ? 1 : (input_len + BLAKE3_BLOCK_LEN - 1) / BLAKE3_BLOCK_LEN;
+    for (uint block = 0; block < blocks; block++) {
+        uint offset = block * BLAKE3_BLOCK_LEN;
+        uint block_len = min(input_len - offset, (uint)BLAKE3_BLOCK_LEN);
+
+        // Message words, little-endian, zero padded
+        uint m[16];
+        for (int i = 0; i < 16; i++) {
+            m[i] = 0;
+        }
+        for (uint i = 0; i < block_len; i++) {
+            m[i / 4] |= ((uint)input[offset + i]) << ((i % 4) * 8);
         }
+
+        uint flags = 0;
+        if (block == 0) flags |= BLAKE3_CHUNK_START;
+        if (block == blocks - 1) flags |= BLAKE3_CHUNK_END | BLAKE3_ROOT;
+        blake3_compress(cv, m, block_len, flags);
+    }
+
+    // Output: chaining value, little-endian
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 4; j++) {
+            output[i * 4 + j] = (uchar)(cv[i] >> (j * 8));
+        }
+    }
+}
+
+// Header with the nonce at NONCE_OFFSET (big-endian), as the CPU hashes it
+inline void prepare_input(__constant uchar* header, ulong nonce, __private uchar* input) {
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        input[i] = header[i];
+    }
+    for (int i = 0; i < 8; i++) {
+        input[NONCE_OFFSET + i] = (uchar)(nonce >> ((7 - i) * 8));
     }
 }
 
 // Stage 1: Initialize scratchpad
-void stage1_init(__private uchar* input, uint input_len, __local ulong* scratch) {
+void stage1_init(__private uchar* input, uint input_len, SCRATCH_PTR scratch) {
     // Hash input to get 256-bit seed
     uchar hash[32];
     blake3_hash(input, input_len, hash);
@@ -186,36 +255,36 @@ void stage1_init(__private uchar* input, uint input_len, __local ulong* scratch)
     for (uint i = 0; i < MEMORY_SIZE; i++) {
         uint idx = i % 4;
         state[idx] = toshash_mix(state[idx], state[(idx + 1) % 4], i);
-        scratch[i] = state[idx];
+        scratch[SCRATCH_INDEX(i)] = state[idx];
     }
 }
 
 // Stage 2: Sequential memory mixing
-void stage2_mix(__local ulong* scratch) {
+void stage2_mix(SCRATCH_PTR scratch) {
     for (uint pass = 0; pass < MEMORY_PASSES; pass++) {
         if (pass % 2 == 0) {
             // Forward pass
-            ulong carry = scratch[MEMORY_SIZE - 1];
+            ulong carry = scratch[SCRATCH_INDEX(MEMORY_SIZE - 1)];
             for (uint i = 0; i < MEMORY_SIZE; i++) {
-                ulong prev = (i > 0) ? scratch[i - 1] : scratch[MEMORY_SIZE - 1];
-                scratch[i] = toshash_mix(scratch[i], prev ^ carry, pass);
-                carry = scratch[i];
+                ulong prev = (i > 0) ? scratch[SCRATCH_INDEX(i - 1)] : scratch[SCRATCH_INDEX(MEMORY_SIZE - 1)];
+                scratch[SCRATCH_INDEX(i)] = toshash_mix(scratch[SCRATCH_INDEX(i)], prev ^ carry, pass);
+                carry = scratch[SCRATCH_INDEX(i)];
             }
         } else {
             // Backward pass
-            ulong carry = scratch[0];
+            ulong carry = scratch[SCRATCH_INDEX(0)];
             for (uint i = MEMORY_SIZE; i > 0; i--) {
                 uint idx = i - 1;
-                ulong next = (idx < MEMORY_SIZE - 1) ? scratch[idx + 1] : scratch[0];
-                scratch[idx] = toshash_mix(scratch[idx], next ^ carry, pass);
-                carry = scratch[idx];
+                ulong next = (idx < MEMORY_SIZE - 1) ? scratch[SCRATCH_INDEX(idx + 1)] : scratch[SCRATCH_INDEX(0)];
+                scratch[SCRATCH_INDEX(idx)] = toshash_mix(scratch[SCRATCH_INDEX(idx)], next ^ carry, pass);
+                carry = scratch[SCRATCH_INDEX(idx)];
             }
         }
     }
 }
 
 // Stage 3: Strided memory mixing
-void stage3_strided(__local ulong* scratch) {
+void stage3_strided(SCRATCH_PTR scratch) {
     for (uint round = 0; round < MIXING_ROUNDS; round++) {
         ulong stride = STRIDES[round % 4];
 
@@ -223,21 +292,21 @@ void stage3_strided(__local ulong* scratch) {
             uint j = (i + stride) % MEMORY_SIZE;
             uint k = (i + stride * 2) % MEMORY_SIZE;
 
-            ulong a = scratch[i];
-            ulong b = scratch[j];
-            ulong c = scratch[k];
+            ulong a = scratch[SCRATCH_INDEX(i)];
+            ulong b = scratch[SCRATCH_INDEX(j)];
+            ulong c = scratch[SCRATCH_INDEX(k)];
 
-            scratch[i] = toshash_mix(a, b ^ c, round);
+            scratch[SCRATCH_INDEX(i)] = toshash_mix(a, b ^ c, round);
         }
     }
 }
 
 // Stage 4: Finalize to 256-bit hash
-void stage4_finalize(__local ulong* scratch, __private uchar* output) {
+void stage4_finalize(SCRATCH_PTR scratch, __private uchar* output) {
     // XOR-fold to 256 bits (4 x 64-bit words)
     ulong folded[4] = {0, 0, 0, 0};
     for (uint i = 0; i < MEMORY_SIZE; i++) {
-        folded[i % 4] ^= scratch[i];
+        folded[i % 4] ^= scratch[SCRATCH_INDEX(i)];
     }
 
     // Convert to bytes
@@ -269,31 +338,29 @@ bool meets_target(__private uchar* hash, __constant uchar* target) {
  * 2. Computes full TOS Hash V3
  * 3. Checks against target
  * 4. Reports solutions atomically
+ * 5. Reports hashes meeting the easier check target (integrity sampling)
  *
  * Workgroup size should be 1 to give each work item full local memory
  */
 __kernel void toshash_search(
-    __global uint* g_output,           // [0] = count, [1..MAX] = solution nonces
-    __constant uchar* g_header,        // Block header (104 bytes, nonce goes in last 8)
+    __global uint* g_output,           // [0] = count, [1..MAX] = solution nonces, then check hits
+    __constant uchar* g_header,        // Block header (112 bytes, nonce goes at NONCE_OFFSET)
     __constant uchar* g_target,        // Target hash (32 bytes)
     ulong start_nonce,                 // Starting nonce for this batch
-    uint max_outputs                   // Maximum solutions to store
+    uint max_outputs,                  // Maximum solutions to store
+    __constant uchar* g_check_target,  // Easy integrity check target (32 bytes)
+    uint max_checks,                   // Maximum check hits to store (0 = no checks)
+    __global ulong* g_scratch          // Global scratchpads (unused with SCRATCH_LOCAL)
 ) {
     uint gid = get_global_id(0);
     ulong nonce = start_nonce + gid;
 
     // Local memory scratchpad (64KB)
-    __local ulong scratch[MEMORY_SIZE];
+    DECLARE_SCRATCH(g_scratch);
 
     // Prepare input with nonce
     uchar input[INPUT_SIZE];
-    for (int i = 0; i < INPUT_SIZE - 8; i++) {
-        input[i] = g_header[i];
-    }
-    // Set nonce (last 8 bytes, little-endian)
-    for (int i = 0; i < 8; i++) {
-        input[INPUT_SIZE - 8 + i] = (uchar)(nonce >> (i * 8));
-    }
+    prepare_input(g_header, nonce, input);
 
     // Compute TOS Hash V3
     stage1_init(input, INPUT_SIZE, scratch);
@@ -312,9 +379,84 @@ __kernel void toshash_search(
             g_output[1 + slot * 2] = (uint)(nonce & 0xFFFFFFFF);
             g_output[1 + slot * 2 + 1] = (uint)(nonce >> 32);
         }
+    } else if (max_checks > 0 && meets_target(hash, g_check_target)) {
+        // Check hit: [0] = count, then nonces; counted even when full
+        __global uint* g_checks = g_output + 1 + max_outputs * 2;
+        uint slot = atomic_inc(&g_checks[0]);
+        if (slot < max_checks) {
+            g_checks[1 + slot * 2] = (uint)(nonce & 0xFFFFFFFF);
+            g_checks[1 + slot * 2 + 1] = (uint)(nonce >> 32);
+        }
     }
 }
 
+/**
+ * Persistent search kernel
+ *
+ * Each work item hashes nonce_loop nonces, start_nonce + gid + i * global
+ * size, so one launch covers global size * nonce_loop nonces. Results are
+ * appended to rings that are never cleared: g_ring[0] and g_ring[1] count
+ * solutions and check hits ever written (the slot is the count modulo the
+ * ring size) and g_ring[2] counts hashes done. The host drains the rings
+ * after each launch.
+ *
+ * Before each nonce the work item compares g_control[0] with its launch
+ * generation; the host bumps it from a second queue to end launches for
+ * stale work early.
+ */
+__kernel void toshash_search_persistent(
+    __global uint* g_ring,             // [0..2] counters, [3] unused, solution ring, check ring
+    __constant uchar* g_header,        // Block header (112 bytes, nonce goes at NONCE_OFFSET)
+    __constant uchar* g_target,        // Target hash (32 bytes)
+    ulong start_nonce,                 // First nonce of this launch
+    uint nonce_loop,                   // Nonces per work item
+    __global volatile uint* g_control, // [0] = current generation
+    uint generation,                   // Generation this launch belongs to
+    uint ring_size,                    // Solution ring slots
+    __constant uchar* g_check_target,  // Easy integrity check target (32 bytes)
+    uint check_ring_size,              // Check ring slots (0 = no checks)
+    __global ulong* g_scratch          // Global scratchpads (unused with SCRATCH_LOCAL)
+) {
+    ulong gid = get_global_id(0);
+    ulong stride = get_global_size(0);
+
+    DECLARE_SCRATCH(g_scratch);
+    __global uint* g_solutions = g_ring + 4;
+    __global uint* g_checks = g_solutions + ring_size * 2;
+
+    uint done = 0;
+    for (uint i = 0; i < nonce_loop; i++) {
+        if (g_control[0] != generation) {
+            break;
+        }
+
+        ulong nonce = start_nonce + gid + i * stride;
+
+        uchar input[INPUT_SIZE];
+        prepare_input(g_header, nonce, input);
+
+        stage1_init(input, INPUT_SIZE, scratch);
+        stage2_mix(scratch);
+        stage3_strided(scratch);
+
+        uchar hash[32];
+        stage4_finalize(scratch, hash);
+        done++;
+
+        if (meets_target(hash, g_target)) {
+            uint slot = atomic_inc(&g_ring[0]) % ring_size;
+            g_solutions[slot * 2] = (uint)(nonce & 0xFFFFFFFF);
+            g_solutions[slot * 2 + 1] = (uint)(nonce >> 32);
+        } else if (check_ring_size > 0 && meets_target(hash, g_check_target)) {
+            uint slot = atomic_inc(&g_ring[1]) % check_ring_size;
+            g_checks[slot * 2] = (uint)(nonce & 0xFFFFFFFF);
+            g_checks[slot * 2 + 1] = (uint)(nonce >> 32);
+        }
+    }
+
+    atomic_add(&g_ring[2], done);
+}
+
 /**
  * Benchmark kernel - same as search but without target check
  * Used to measure raw hash rate
@@ -323,20 +465,16 @@ __kernel void toshash_benchmark(
     __global ulong* g_hashes,          // Output hashes for verification (optional)
     __constant uchar* g_header,        // Block header
     ulong start_nonce,                 // Starting nonce
-    uint store_hashes                  // Whether to store computed hashes
+    uint store_hashes,                 // Whether to store computed hashes
+    __global ulong* g_scratch          // Global scratchpads (unused with SCRATCH_LOCAL)
 ) {
     uint gid = get_global_id(0);
     ulong nonce = start_nonce + gid;
 
-    __local ulong scratch[MEMORY_SIZE];
+    DECLARE_SCRATCH(g_scratch);
 
     uchar input[INPUT_SIZE];
-    for (int i = 0; i < INPUT_SIZE - 8; i++) {
-        input[i] = g_header[i];
-    }
-    for (int i = 0; i < 8; i++) {
-        input[INPUT_SIZE - 8 + i] = (uchar)(nonce >> (i * 8));
-    }
+    prepare_input(g_header, nonce, input);
 
     stage1_init(input, INPUT_SIZE, scratch);
     stage2_mix(scratch);
@@ -356,3 +494,54 @@ __kernel void toshash_benchmark(
         }
     }
 }
+
+// Order-sensitive scratchpad checksum (matches TosHash::checksum)
+ulong scratch_checksum(SCRATCH_PTR scratch) {
+    ulong sum = 0;
+    for (uint i = 0; i < MEMORY_SIZE; i++) {
+        sum = rotl64(sum, 1) ^ scratch[SCRATCH_INDEX(i)];
+    }
+    return sum;
+}
+
+/**
+ * Trace kernel - one hash with intermediate results (conformance tests)
+ *
+ * g_trace: [0..3] Blake3 seed, [4..6] scratchpad checksum after stages
+ * 1-3, [7..10] final hash; hashes stored as little-endian words
+ */
+__kernel void toshash_trace(
+    __global ulong* g_trace,
+    __constant uchar* g_header,
+    ulong nonce,
+    __global ulong* g_scratch
+) {
+    DECLARE_SCRATCH(g_scratch);
+
+    uchar input[INPUT_SIZE];
+    prepare_input(g_header, nonce, input);
+
+    uchar seed[32];
+    blake3_hash(input, INPUT_SIZE, seed);
+
+    stage1_init(input, INPUT_SIZE, scratch);
+    g_trace[4] = scratch_checksum(scratch);
+    stage2_mix(scratch);
+    g_trace[5] = scratch_checksum(scratch);
+    stage3_strided(scratch);
+    g_trace[6] = scratch_checksum(scratch);
+
+    uchar hash[32];
+    stage4_finalize(scratch, hash);
+
+    for (int i = 0; i < 4; i++) {
+        ulong s = 0;
+        ulong h = 0;
+        for (int j = 0; j < 8; j++) {
+            s |= ((ulong)seed[i * 8 + j]) << (j * 8);
+            h |= ((ulong)hash[i * 8 + j]) << (j * 8);
+        }
+        g_trace[i] = s;
+        g_trace[7 + i] = h;
+    }
+}
@@ -201,7 +201,8 @@ void StratumClient::setCredentials(const std::string& user, const std::string& p
 
 void StratumClient::submitSolution(const Solution& solution, const std::string& jobId) {
     if (m_state != StratumState::Authorized) {
-        Log::warning("Cannot submit: not authorized");
+        Log::limited(LogLevel::Warning, LogCategory::Network, "stratum:submit",
+                     "Cannot submit: not authorized");
         return;
     }
 
@@ -394,7 +395,8 @@ void StratumClient::doConnect() {
 
     } catch (const std::exception& e) {
         m_lastError = e.what();
-        Log::error("Connection setup failed: " + m_lastError);
+        Log::limited(LogLevel::Error, LogCategory::Network, "stratum:setup",
+                     "Connection setup failed: " + m_lastError);
         handleReconnect();
     }
 }
@@ -404,7 +406,8 @@ void StratumClient::handleConnect(const boost::system::error_code& ec) {
 
     if (ec) {
         m_lastError = ec.message();
-        Log::error("Failed to connect to pool: " + m_lastError);
+        Log::limited(LogLevel::Error, LogCategory::Network, "stratum:connect",
+                     "Failed to connect to pool: " + m_lastError);
         handleReconnect();
         return;
     }
@@ -450,7 +453,7 @@ void StratumClient::handleHandshake(const boost::system::error_code& ec) {
 
     if (ec) {
         m_lastError = "TLS handshake failed: " + ec.message();
-        Log::error(m_lastError);
+        Log::limited(LogLevel::Error, LogCategory::Network, "stratum:tls", m_lastError);
         handleReconnect();
         return;
     }
@@ -515,7 +518,8 @@ void StratumClient::handleRead(const boost::system::error_code& ec, size_t bytes
             } else {
                 m_lastError = ec.message();
             }
-            Log::error("Read error: " + m_lastError);
+            Log::limited(LogLevel::Error, LogCategory::Network, "stratum:read",
+                         "Read error: " + m_lastError);
             // Clear buffer to avoid immediate not_found on reconnect.
             m_readBuffer.consume(m_readBuffer.size());
             m_state = StratumState::Disconnected;
@@ -597,6 +601,9 @@ void StratumClient::handleResponse(const json& response) {
         auto it = m_pendingRequests.find(id);
         if (it != m_pendingRequests.end()) {
             method = it->second.method;
+            if (method == "mining.submit") {
+                m_submitLatency.observe(std::chrono::steady_clock::now() - it->second.timestamp);
+            }
             m_pendingRequests.erase(it);
         }
     }
@@ -1073,7 +1080,8 @@ void StratumClient::handleReconnect() {
 
     // Exponential backoff with jitter
     unsigned delay = m_reconnectDelay * (1 << std::min(m_reconnectAttempts, 5u));
-    Log::info("Reconnecting in " + std::to_string(delay) + " seconds...");
+    Log::limited(LogLevel::Info, LogCategory::Network, "stratum:reconnect",
+                 "Reconnecting in " + std::to_string(delay) + " seconds...");
 
     m_reconnectTimer->expires_after(std::chrono::seconds(delay));
     m_reconnectTimer->async_wait([this](const boost::system::error_code& ec) {
@@ -9,6 +9,7 @@
 
 #include "core/Types.h"
 #include "core/WorkPackage.h"
+#include "util/Histogram.h"
 #include <boost/asio.hpp>
 #include <boost/asio/steady_timer.hpp>
 #ifdef WITH_TLS
@@ -251,6 +252,11 @@ public:
      */
     uint64_t getRejectedShares() const { return m_rejectedShares; }
 
+    /**
+     * Get share submit round-trip latency histogram
+     */
+    HistogramSnapshot getSubmitLatency() const { return m_submitLatency.snapshot(); }
+
     /**
      * Get pool version (if provided by pool)
      */
@@ -434,6 +440,9 @@ private:
     std::map<uint64_t, PendingRequest> m_pendingRequests;
     mutable std::mutex m_requestMutex;
 
+    // Submit -> response round trip
+    LatencyHistogram m_submitLatency;
+
     // Callbacks
     WorkCallback m_workCallback;
     ShareCallback m_shareCallback;
@@ -128,6 +128,33 @@ void TosHash::hash(const uint8_t* input, uint8_t* output, ScratchPad& scratch) {
     stage4Finalize(scratch, output);
 }
 
+TosHashTrace TosHash::trace(const uint8_t* input, ScratchPad& scratch) {
+    TosHashTrace result;
+
+    blake3_hasher hasher;
+    blake3_hasher_init(&hasher);
+    blake3_hasher_update(&hasher, input, INPUT_SIZE);
+    blake3_hasher_finalize(&hasher, result.seed.data(), 32);
+
+    stage1Init(input, INPUT_SIZE, scratch);
+    result.stage1 = checksum(scratch);
+    stage2Mix(scratch);
+    result.stage2 = checksum(scratch);
+    stage3Strided(scratch);
+    result.stage3 = checksum(scratch);
+    stage4Finalize(scratch, result.hash.data());
+
+    return result;
+}
+
+uint64_t TosHash::checksum(const ScratchPad& scratch) {
+    uint64_t sum = 0;
+    for (uint64_t word : scratch) {
+        sum = rotl64(sum, 1) ^ word;
+    }
+    return sum;
+}
+
 Solution TosHash::search(const WorkPackage& work, Nonce nonce, ScratchPad& scratch) {
     // Prepare input with nonce
     std::array<uint8_t, INPUT_SIZE> input;
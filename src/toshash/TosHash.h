@@ -22,6 +22,17 @@ constexpr uint64_t TOSHASH_MIX_CONST = 0x517cc1b727220a95ULL;
 // Scratchpad type
 using ScratchPad = std::array<uint64_t, TOSHASH_MEMORY_SIZE>;
 
+/**
+ * Intermediate results of one hash, for checking GPU kernels stage by stage
+ */
+struct TosHashTrace {
+    Hash256 seed;       // Blake3 of the input (stage 1 seed)
+    uint64_t stage1;    // Scratchpad checksum after stage 1
+    uint64_t stage2;    // ... after stage 2
+    uint64_t stage3;    // ... after stage 3
+    Hash256 hash;       // Final hash
+};
+
 /**
  * TOS Hash V3 class
  *
@@ -44,6 +55,20 @@ public:
      */
     void hash(const uint8_t* input, uint8_t* output, ScratchPad& scratch);
 
+    /**
+     * Compute hash with intermediate results
+     *
+     * @param input Block header data (112 bytes)
+     * @param scratch Reusable scratchpad (64KB)
+     * @return Seed, per-stage scratchpad checksums and final hash
+     */
+    TosHashTrace trace(const uint8_t* input, ScratchPad& scratch);
+
+    /**
+     * Order-sensitive scratchpad checksum (sum = rotl(sum, 1) ^ word)
+     */
+    static uint64_t checksum(const ScratchPad& scratch);
+
     /**
      * Compute hash and check against target
      *
@@ -0,0 +1,190 @@
+/**
+ * TOS Miner - On-Disk Binary Cache
+ *
+ * Stores blobs (e.g. compiled OpenCL programs) under a string key. Each
+ * entry records its full key and a checksum of the payload, so a hash
+ * collision, a truncated write or a corrupted file reads as a miss
+ * instead of handing back wrong data.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace tos {
+
+/**
+ * Directory of checksummed cache entries, one file per key
+ *
+ * Writes go to a temporary file renamed into place, so concurrent
+ * processes never see a partial entry. An empty directory disables the
+ * cache (every load misses, stores do nothing).
+ */
+class BinaryCache {
+public:
+    /**
+     * Result of a lookup
+     */
+    enum class Status {
+        Hit,        // Entry found and intact
+        Miss,       // No entry for the key
+        Corrupt     // Entry unreadable, truncated or for another key (removed)
+    };
+
+    /**
+     * @param directory Cache directory, created on first store ("" = disabled)
+     */
+    explicit BinaryCache(std::string directory = "") : m_directory(std::move(directory)) {}
+
+    /**
+     * Check if the cache has a directory
+     */
+    bool enabled() const { return !m_directory.empty(); }
+
+    /**
+     * Get cache directory
+     */
+    const std::string& directory() const { return m_directory; }
+
+    /**
+     * File holding the entry for key
+     */
+    std::string path(const std::string& key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(fnv1a(key.data(), key.size())));
+        return (std::filesystem::path(m_directory) / name).string();
+    }
+
+    /**
+     * Load the entry for key
+     *
+     * @param key Cache key
+     * @param data Output payload (valid on Hit)
+     * @return Hit, Miss, or Corrupt (the bad entry is deleted)
+     */
+    Status load(const std::string& key, std::vector<uint8_t>& data) const {
+        if (!enabled()) {
+            return Status::Miss;
+        }
+
+        std::string file = path(key);
+        std::ifstream in(file, std::ios::binary);
+        if (!in) {
+            return Status::Miss;
+        }
+
+        Header header{};
+        std::string storedKey;
+        bool ok = static_cast<bool>(in.read(reinterpret_cast<char*>(&header), sizeof(header))) &&
+                  std::memcmp(header.magic, c_magic, sizeof(header.magic)) == 0 &&
+                  header.version == c_version && header.keySize == key.size() &&
+                  header.dataSize <= c_maxDataSize;
+        if (ok) {
+            storedKey.resize(header.keySize);
+            data.resize(header.dataSize);
+            ok = in.read(&storedKey[0], storedKey.size()) &&
+                 in.read(reinterpret_cast<char*>(data.data()), data.size()) &&
+                 in.peek() == std::char_traits<char>::eof() &&
+                 storedKey == key && fnv1a(data.data(), data.size()) == header.checksum;
+        }
+        in.close();
+
+        if (!ok) {
+            data.clear();
+            std::error_code ec;
+            std::filesystem::remove(file, ec);
+            return Status::Corrupt;
+        }
+        return Status::Hit;
+    }
+
+    /**
+     * Store data under key, replacing any existing entry
+     *
+     * @return true if written
+     */
+    bool store(const std::string& key, const std::vector<uint8_t>& data) const {
+        if (!enabled() || data.size() > c_maxDataSize) {
+            return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(m_directory, ec);
+
+        std::string file = path(key);
+        std::string temp = file + ".tmp" + std::to_string(processId());
+
+        Header header{};
+        std::memcpy(header.magic, c_magic, sizeof(header.magic));
+        header.version = c_version;
+        header.keySize = static_cast<uint32_t>(key.size());
+        header.dataSize = data.size();
+        header.checksum = fnv1a(data.data(), data.size());
+
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(key.data(), key.size());
+            out.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!out.flush()) {
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temp, file, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * 64-bit FNV-1a hash
+     */
+    static uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ULL) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t keySize;
+        uint64_t dataSize;
+        uint64_t checksum;     // FNV-1a of the payload
+    };
+
+    static long processId() {
+#ifndef _WIN32
+        return static_cast<long>(::getpid());
+#else
+        return 0;
+#endif
+    }
+
+    static constexpr char c_magic[8] = {'T', 'O', 'S', 'C', 'A', 'C', 'H', 'E'};
+    static constexpr uint32_t c_version = 1;
+    static constexpr uint64_t c_maxDataSize = 256ULL * 1024 * 1024;
+
+    std::string m_directory;
+};
+
+}  // namespace tos
@@ -0,0 +1,217 @@
+/**
+ * TOS Miner - CPU Monitoring Implementation
+ */
+
+#include "CpuMonitor.h"
+#include "Log.h"
+#include "Guards.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+
+namespace tos {
+
+namespace {
+
+// Directory entries matching prefix, sorted by their numeric suffix
+std::vector<std::filesystem::path> listNumbered(const std::string& dir, const std::string& prefix) {
+    std::vector<std::pair<long, std::filesystem::path>> entries;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        char* end = nullptr;
+        long number = std::strtol(name.c_str() + prefix.size(), &end, 10);
+        if (end == name.c_str() + prefix.size() || *end != '\0') {
+            continue;
+        }
+        entries.emplace_back(number, entry.path());
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    std::vector<std::filesystem::path> paths;
+    for (auto& entry : entries) {
+        paths.push_back(std::move(entry.second));
+    }
+    return paths;
+}
+
+// Thermal zone types that report CPU package/die temperature
+bool isCpuZone(const std::string& type) {
+    static const char* types[] = {"x86_pkg_temp", "cpu", "soc", "k10temp", "coretemp", "tctl"};
+    for (const char* t : types) {
+        if (type.find(t) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+CpuMonitor& CpuMonitor::instance() {
+    static CpuMonitor instance;
+    return instance;
+}
+
+bool CpuMonitor::init() {
+    Guard lock(m_mutex);
+    if (m_initialized) {
+        return true;
+    }
+
+    // RAPL: top-level zones intel-rapl:N named package-N are packages
+    // (intel-rapl:N:M are subzones; psys and dram zones overlap the packages)
+    for (const auto& path : listNumbered(Sysfs::path("class/powercap"), "intel-rapl:")) {
+        RaplPackage pkg;
+        pkg.name = SysfsFile(path.string() + "/name").readString();
+        if (pkg.name.compare(0, 8, "package-") != 0) {
+            Log::debug("RAPL " + path.filename().string() + " (" + pkg.name + ") is not a package, skipped");
+            continue;
+        }
+        if (!pkg.energy.open(path.string() + "/energy_uj") || pkg.energy.readInt() < 0) {
+            Log::debug("RAPL " + path.filename().string() + " not readable (energy_uj needs privileges)");
+            continue;
+        }
+        int64_t range = SysfsFile(path.string() + "/max_energy_range_uj").readInt();
+        pkg.maxRange = range > 0 ? static_cast<uint64_t>(range) : 0;
+        m_packages.push_back(std::move(pkg));
+    }
+
+    // Thermal zones: prefer CPU zones, fall back to all zones
+    std::vector<ThermalZone> all;
+    for (const auto& path : listNumbered(Sysfs::path("class/thermal"), "thermal_zone")) {
+        ThermalZone zone;
+        zone.type = SysfsFile(path.string() + "/type").readString();
+        if (!zone.temp.open(path.string() + "/temp")) {
+            continue;
+        }
+        if (isCpuZone(zone.type)) {
+            m_zones.push_back(std::move(zone));
+        } else {
+            all.push_back(std::move(zone));
+        }
+    }
+    if (m_zones.empty()) {
+        m_zones = std::move(all);
+    }
+
+    // cpufreq
+    for (const auto& path : listNumbered(Sysfs::path("devices/system/cpu"), "cpu")) {
+        SysfsFile freq(path.string() + "/cpufreq/scaling_cur_freq");
+        if (freq.isOpen()) {
+            m_frequencies.push_back(std::move(freq));
+        }
+    }
+
+    m_initialized = !m_packages.empty() || !m_zones.empty() || !m_frequencies.empty();
+    if (m_initialized) {
+        Log::info("CPU monitoring initialized: " + std::to_string(m_packages.size()) + " RAPL package(s), " +
+                  std::to_string(m_zones.size()) + " thermal zone(s), " +
+                  std::to_string(m_frequencies.size()) + " cpufreq CPU(s)");
+    } else {
+        Log::debug("No CPU sensors found for monitoring");
+    }
+    return m_initialized;
+}
+
+void CpuMonitor::shutdown() {
+    Guard lock(m_mutex);
+    m_packages.clear();
+    m_zones.clear();
+    m_frequencies.clear();
+    m_energy = 0;
+    m_stats = CpuStats();
+    m_initialized = false;
+}
+
+bool CpuMonitor::isAvailable() const {
+    Guard lock(m_mutex);
+    return m_initialized;
+}
+
+CpuStats CpuMonitor::sample(std::chrono::steady_clock::time_point now) {
+    Guard lock(m_mutex);
+    if (!m_initialized) {
+        return m_stats;
+    }
+
+    CpuStats stats;
+    stats.valid = true;
+    stats.packages = static_cast<int>(m_packages.size());
+
+    // Energy deltas (microjoules), unwrapping at max_energy_range_uj
+    double elapsed = std::chrono::duration<double>(now - m_lastSample).count();
+    uint64_t delta = 0;
+    bool complete = !m_packages.empty();
+
+    for (auto& pkg : m_packages) {
+        int64_t value = pkg.energy.readInt();
+        if (value < 0) {
+            complete = false;
+            continue;
+        }
+
+        uint64_t current = static_cast<uint64_t>(value);
+        if (pkg.haveLast) {
+            if (current >= pkg.last) {
+                delta += current - pkg.last;
+            } else if (pkg.maxRange > pkg.last) {
+                delta += (pkg.maxRange - pkg.last) + current;
+            } else {
+                complete = false;  // Unknown range: skip this interval
+            }
+        } else {
+            complete = false;      // First reading only sets the baseline
+        }
+        pkg.last = current;
+        pkg.haveLast = true;
+    }
+
+    m_energy += static_cast<double>(delta) / 1e6;
+    stats.energy = m_energy;
+    if (complete && elapsed > 0) {
+        stats.packagePower = static_cast<double>(delta) / 1e6 / elapsed;
+    } else if (!complete && m_stats.packagePower >= 0) {
+        stats.packagePower = m_stats.packagePower;  // Keep last good reading
+    }
+    m_lastSample = now;
+
+    // Hottest zone
+    for (const auto& zone : m_zones) {
+        int64_t temp = zone.temp.readInt();
+        if (temp > 0) {
+            stats.temperature = std::max(stats.temperature, static_cast<int>(temp / 1000));
+        }
+    }
+
+    // Frequencies (kHz)
+    int64_t sum = 0;
+    int count = 0;
+    for (const auto& freq : m_frequencies) {
+        int64_t khz = freq.readInt();
+        if (khz > 0) {
+            sum += khz;
+            count++;
+            stats.frequencyMax = std::max(stats.frequencyMax, static_cast<int>(khz / 1000));
+        }
+    }
+    if (count > 0) {
+        stats.frequency = static_cast<int>(sum / count / 1000);
+    }
+
+    m_stats = stats;
+    return stats;
+}
+
+CpuStats CpuMonitor::getStats() const {
+    Guard lock(m_mutex);
+    return m_stats;
+}
+
+}  // namespace tos
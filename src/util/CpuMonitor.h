@@ -0,0 +1,109 @@
+/**
+ * TOS Miner - CPU Monitoring
+ *
+ * Package power from RAPL energy counters, temperature from thermal
+ * zones and core frequency from cpufreq, all read through sysfs.
+ */
+
+#pragma once
+
+#include "Sysfs.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tos {
+
+/**
+ * CPU monitoring data
+ *
+ * Fields are -1 when the corresponding sensor is unavailable.
+ */
+struct CpuStats {
+    int packages{0};              // RAPL packages found
+    double packagePower{-1};      // Watts, all packages, averaged since last sample
+    double energy{0};             // Joules consumed since init (all packages)
+    int temperature{-1};          // Celsius, hottest CPU thermal zone
+    int frequency{-1};            // MHz, average over online CPUs
+    int frequencyMax{-1};         // MHz, fastest CPU
+    bool valid{false};            // Any sensor available
+};
+
+/**
+ * CPU monitor
+ *
+ * Attributes are opened once at init(). sample() reads them and derives
+ * power from the RAPL energy delta since the previous sample, handling
+ * counter wraparound at max_energy_range_uj.
+ */
+class CpuMonitor {
+public:
+    /**
+     * Get shared instance
+     */
+    static CpuMonitor& instance();
+
+    CpuMonitor() = default;
+
+    // Non-copyable
+    CpuMonitor(const CpuMonitor&) = delete;
+    CpuMonitor& operator=(const CpuMonitor&) = delete;
+
+    /**
+     * Find RAPL packages, thermal zones and cpufreq entries below the sysfs root
+     * @return true if any sensor was found
+     */
+    bool init();
+
+    /**
+     * Close all attributes
+     */
+    void shutdown();
+
+    /**
+     * Check if any sensor is available
+     */
+    bool isAvailable() const;
+
+    /**
+     * Read sensors now
+     *
+     * @param now Sample time (power is averaged since the previous sample)
+     * @return Updated stats
+     */
+    CpuStats sample(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    /**
+     * Get stats from the last sample
+     */
+    CpuStats getStats() const;
+
+private:
+    struct RaplPackage {
+        std::string name;
+        SysfsFile energy;           // energy_uj
+        uint64_t maxRange{0};       // max_energy_range_uj (0 = unknown)
+        uint64_t last{0};
+        bool haveLast{false};
+    };
+
+    struct ThermalZone {
+        std::string type;
+        SysfsFile temp;             // Millidegrees
+    };
+
+    std::vector<RaplPackage> m_packages;
+    std::vector<ThermalZone> m_zones;
+    std::vector<SysfsFile> m_frequencies;   // scaling_cur_freq (kHz)
+
+    std::chrono::steady_clock::time_point m_lastSample;
+    double m_energy{0};
+    bool m_initialized{false};
+
+    CpuStats m_stats;
+    mutable std::mutex m_mutex;
+};
+
+}  // namespace tos
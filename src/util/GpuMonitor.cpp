@@ -4,11 +4,17 @@
 
 #include "GpuMonitor.h"
 #include "Log.h"
+#include "Guards.h"
+
+#include "Sysfs.h"
 
-#include <fstream>
-#include <sstream>
-#include <filesystem>
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <thread>
 
 #ifdef WITH_CUDA
 #include <cuda_runtime.h>
@@ -319,61 +325,108 @@ std::vector<GpuStats> NvmlMonitor::getAllStats() {
 #ifdef WITH_OPENCL
 
 struct AmdMonitor::Impl {
-    bool initialized{false};
-    std::vector<std::string> hwmonPaths;  // Paths to hwmon directories for each GPU
-
-    // Read a value from sysfs file
-    static int readSysfsInt(const std::string& path) {
-        std::ifstream file(path);
-        if (!file) return -1;
-        int value;
-        file >> value;
-        return file.good() ? value : -1;
-    }
+    // Attributes of one GPU, opened once at init
+    struct Device {
+        std::string name;
+        SysfsFile temp1;        // Edge/core temperature (millidegrees)
+        SysfsFile temp2;        // Junction/hotspot
+        SysfsFile temp3;        // Memory
+        SysfsFile pwm1;         // Fan PWM 0-255
+        SysfsFile power;        // power1_average or power1_input (microwatts)
+        SysfsFile powerCap;     // power1_cap (microwatts)
+        SysfsFile sclk;         // pp_dpm_sclk (current level marked with '*')
+    };
 
-    static std::string readSysfsString(const std::string& path) {
-        std::ifstream file(path);
-        if (!file) return "";
-        std::string value;
-        std::getline(file, value);
-        return value;
-    }
+    bool initialized{false};
+    std::vector<Device> devices;
 
-    std::vector<std::string> findAmdGpus() {
-        std::vector<std::string> gpuPaths;
+    std::vector<Device> findAmdGpus() {
+        std::vector<Device> gpus;
 
 #ifdef __linux__
-        // Scan /sys/class/drm for AMD GPUs
-        const std::string drmPath = "/sys/class/drm";
+        // Scan <sysfs>/class/drm for AMD GPUs
+        const std::string drmPath = Sysfs::path("class/drm");
 
         try {
+            // cardN directories (not cardN-connector), in card order
+            std::vector<std::pair<int, std::filesystem::path>> cards;
             for (const auto& entry : std::filesystem::directory_iterator(drmPath)) {
                 std::string name = entry.path().filename().string();
-                // Look for cardN directories (not cardN-something)
                 if (name.find("card") == 0 && name.find("-") == std::string::npos) {
-                    std::string devicePath = entry.path().string() + "/device";
-                    std::string vendorPath = devicePath + "/vendor";
-
-                    std::string vendor = readSysfsString(vendorPath);
-                    // AMD vendor ID is 0x1002
-                    if (vendor.find("0x1002") != std::string::npos) {
-                        // Find hwmon directory
-                        std::string hwmonBase = devicePath + "/hwmon";
-                        if (std::filesystem::exists(hwmonBase)) {
-                            for (const auto& hwmon : std::filesystem::directory_iterator(hwmonBase)) {
-                                gpuPaths.push_back(hwmon.path().string());
-                                break;  // Use first hwmon
-                            }
-                        }
-                    }
+                    cards.emplace_back(std::atoi(name.c_str() + 4), entry.path());
+                }
+            }
+            std::sort(cards.begin(), cards.end());
+
+            for (const auto& card : cards) {
+                std::string devicePath = card.second.string() + "/device";
+
+                // AMD vendor ID is 0x1002
+                std::string vendor = SysfsFile(devicePath + "/vendor").readString();
+                if (vendor.find("0x1002") == std::string::npos) {
+                    continue;
+                }
+
+                // Use first hwmon directory
+                std::string hwmonBase = devicePath + "/hwmon";
+                if (!std::filesystem::exists(hwmonBase)) {
+                    continue;
                 }
+                std::string hwmon;
+                for (const auto& entry : std::filesystem::directory_iterator(hwmonBase)) {
+                    hwmon = entry.path().string();
+                    break;
+                }
+                if (hwmon.empty()) {
+                    continue;
+                }
+
+                Device dev;
+                dev.name = SysfsFile(hwmon + "/name").readString();
+                if (dev.name.empty()) {
+                    dev.name = "AMD GPU " + std::to_string(gpus.size());
+                }
+                dev.temp1.open(hwmon + "/temp1_input");
+                dev.temp2.open(hwmon + "/temp2_input");
+                dev.temp3.open(hwmon + "/temp3_input");
+                dev.pwm1.open(hwmon + "/pwm1");
+                if (!dev.power.open(hwmon + "/power1_average")) {
+                    dev.power.open(hwmon + "/power1_input");
+                }
+                dev.powerCap.open(hwmon + "/power1_cap");
+                dev.sclk.open(devicePath + "/pp_dpm_sclk");
+                gpus.push_back(std::move(dev));
             }
         } catch (const std::exception& e) {
             Log::debug("Error scanning for AMD GPUs: " + std::string(e.what()));
         }
 #endif
 
-        return gpuPaths;
+        return gpus;
+    }
+
+    // Current level of a pp_dpm_* table, e.g. "1: 1800Mhz *"
+    static int readDpmClock(const SysfsFile& file) {
+        char buf[1024];
+        if (file.read(buf, sizeof(buf)) <= 0) {
+            return -1;
+        }
+
+        const char* line = buf;
+        while (*line) {
+            const char* eol = std::strchr(line, '\n');
+            size_t len = eol ? static_cast<size_t>(eol - line) : std::strlen(line);
+            std::string text(line, len);
+            if (text.find('*') != std::string::npos) {
+                size_t pos = text.find(':');
+                return pos != std::string::npos ? std::atoi(text.c_str() + pos + 1) : -1;
+            }
+            if (!eol) {
+                break;
+            }
+            line = eol + 1;
+        }
+        return -1;
     }
 };
 
@@ -386,21 +439,21 @@ AmdMonitor::~AmdMonitor() {
 bool AmdMonitor::init() {
     if (m_impl->initialized) return true;
 
-    m_impl->hwmonPaths = m_impl->findAmdGpus();
+    m_impl->devices = m_impl->findAmdGpus();
 
-    if (m_impl->hwmonPaths.empty()) {
+    if (m_impl->devices.empty()) {
         Log::debug("No AMD GPUs found for monitoring");
         return false;
     }
 
     m_impl->initialized = true;
-    Log::info("AMD GPU monitoring initialized: " + std::to_string(m_impl->hwmonPaths.size()) + " GPU(s) found");
+    Log::info("AMD GPU monitoring initialized: " + std::to_string(m_impl->devices.size()) + " GPU(s) found");
     return true;
 }
 
 void AmdMonitor::shutdown() {
     m_impl->initialized = false;
-    m_impl->hwmonPaths.clear();
+    m_impl->devices.clear();
 }
 
 bool AmdMonitor::isAvailable() const {
@@ -408,7 +461,7 @@ bool AmdMonitor::isAvailable() const {
 }
 
 int AmdMonitor::getDeviceCount() const {
-    return static_cast<int>(m_impl->hwmonPaths.size());
+    return static_cast<int>(m_impl->devices.size());
 }
 
 GpuStats AmdMonitor::getStats(int deviceIndex) {
@@ -416,66 +469,46 @@ GpuStats AmdMonitor::getStats(int deviceIndex) {
     stats.deviceIndex = deviceIndex;
 
     if (!m_impl->initialized || deviceIndex < 0 ||
-        deviceIndex >= static_cast<int>(m_impl->hwmonPaths.size())) {
+        deviceIndex >= static_cast<int>(m_impl->devices.size())) {
         return stats;
     }
 
-    const std::string& hwmon = m_impl->hwmonPaths[deviceIndex];
+    const Impl::Device& dev = m_impl->devices[deviceIndex];
+    stats.name = dev.name;
 
-    // Name
-    stats.name = Impl::readSysfsString(hwmon + "/name");
-    if (stats.name.empty()) {
-        stats.name = "AMD GPU " + std::to_string(deviceIndex);
-    }
-
-    // Temperature (stored in millidegrees)
-    int temp = Impl::readSysfsInt(hwmon + "/temp1_input");
+    // Temperatures (stored in millidegrees)
+    int64_t temp = dev.temp1.readInt();
     if (temp > 0) {
-        stats.temperature = temp / 1000;  // Convert to Celsius
+        stats.temperature = static_cast<int>(temp / 1000);
     }
-
-    // Edge temperature might be temp2
-    temp = Impl::readSysfsInt(hwmon + "/temp2_input");
+    temp = dev.temp2.readInt();
     if (temp > 0) {
-        stats.temperatureHotspot = temp / 1000;
+        stats.temperatureHotspot = static_cast<int>(temp / 1000);
     }
-
-    // Memory temperature might be temp3
-    temp = Impl::readSysfsInt(hwmon + "/temp3_input");
+    temp = dev.temp3.readInt();
     if (temp > 0) {
-        stats.temperatureMemory = temp / 1000;
+        stats.temperatureMemory = static_cast<int>(temp / 1000);
     }
 
     // Fan speed (PWM value 0-255, convert to percent)
-    int pwm = Impl::readSysfsInt(hwmon + "/pwm1");
+    int64_t pwm = dev.pwm1.readInt();
     if (pwm >= 0) {
-        stats.fanSpeed = (pwm * 100) / 255;
+        stats.fanSpeed = static_cast<int>((pwm * 100) / 255);
     }
 
-    // Power (stored in microwatts for some cards)
-    int power = Impl::readSysfsInt(hwmon + "/power1_average");
+    // Power (microwatts)
+    int64_t power = dev.power.readInt();
     if (power > 0) {
-        stats.powerUsage = power / 1000000;  // Convert uW to W
-    }
-
-    // GPU clock (stored in Hz or MHz depending on kernel)
-    // Try pp_dpm_sclk first
-    std::string dpmPath = hwmon + "/../pp_dpm_sclk";
-    std::ifstream dpmFile(dpmPath);
-    if (dpmFile) {
-        std::string line;
-        while (std::getline(dpmFile, line)) {
-            if (line.find("*") != std::string::npos) {
-                // Current frequency has asterisk
-                size_t pos = line.find(":");
-                if (pos != std::string::npos) {
-                    stats.clockCore = std::stoi(line.substr(pos + 1));
-                }
-                break;
-            }
-        }
+        stats.powerUsage = static_cast<int>(power / 1000000);
+    }
+    power = dev.powerCap.readInt();
+    if (power > 0) {
+        stats.powerLimit = static_cast<int>(power / 1000000);
     }
 
+    // Core clock from the active DPM level
+    stats.clockCore = Impl::readDpmClock(dev.sclk);
+
     stats.valid = true;
     return stats;
 }
@@ -502,6 +535,25 @@ struct GpuMonitor::Impl {
     std::unique_ptr<AmdMonitor> amd;
 #endif
     bool initialized{false};
+
+    // Latest readings, replaced as a whole by the sampler
+    struct Readings {
+        std::vector<GpuStats> nvidia;   // Indexed by NVML (CUDA) index
+        std::vector<GpuStats> amd;      // Indexed by AMD (OpenCL) index
+    };
+    std::shared_ptr<const Readings> readings{std::make_shared<Readings>()};
+
+    // Serializes backend access between the sampler and sample()
+    std::mutex sampleMutex;
+
+    std::thread thread;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool running{false};
+
+    std::shared_ptr<const Readings> latest() const {
+        return std::atomic_load(&readings);
+    }
 };
 
 GpuMonitor& GpuMonitor::instance() {
@@ -535,10 +587,33 @@ bool GpuMonitor::init() {
 #endif
 
     m_impl->initialized = anyInitialized;
-    return anyInitialized;
+    if (!anyInitialized) {
+        return false;
+    }
+
+    // Readers get valid data immediately; the sampler refreshes it
+    sample();
+
+    {
+        std::lock_guard<std::mutex> lock(m_impl->wakeMutex);
+        m_impl->running = true;
+    }
+    m_impl->thread = std::thread(&GpuMonitor::run, this);
+    return true;
 }
 
 void GpuMonitor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_impl->wakeMutex);
+        m_impl->running = false;
+    }
+    m_impl->wake.notify_all();
+    if (m_impl->thread.joinable()) {
+        m_impl->thread.join();
+    }
+
+    Guard lock(m_impl->sampleMutex);
+
 #ifdef WITH_CUDA
     if (m_impl->nvml) {
         m_impl->nvml->shutdown();
@@ -552,47 +627,79 @@ void GpuMonitor::shutdown() {
 #endif
 
     m_impl->initialized = false;
+    std::atomic_store(&m_impl->readings, std::make_shared<const Impl::Readings>());
 }
 
 bool GpuMonitor::isAvailable() const {
     return m_impl->initialized;
 }
 
-GpuStats GpuMonitor::getNvidiaStats(int cudaIndex) {
+void GpuMonitor::sample() {
+    Guard lock(m_impl->sampleMutex);
+    if (!m_impl->initialized) {
+        return;
+    }
+
+    auto readings = std::make_shared<Impl::Readings>();
+
 #ifdef WITH_CUDA
     if (m_impl->nvml && m_impl->nvml->isAvailable()) {
-        return m_impl->nvml->getStats(cudaIndex);
+        readings->nvidia = m_impl->nvml->getAllStats();
     }
 #endif
-    return GpuStats();
-}
 
-GpuStats GpuMonitor::getAmdStats(int clIndex) {
 #ifdef WITH_OPENCL
     if (m_impl->amd && m_impl->amd->isAvailable()) {
-        return m_impl->amd->getStats(clIndex);
+        readings->amd = m_impl->amd->getAllStats();
     }
 #endif
-    return GpuStats();
+
+    std::atomic_store(&m_impl->readings, std::shared_ptr<const Impl::Readings>(std::move(readings)));
 }
 
-std::vector<GpuStats> GpuMonitor::getAllStats() {
-    std::vector<GpuStats> all;
+void GpuMonitor::run() {
+    auto next = std::chrono::steady_clock::now();
 
-#ifdef WITH_CUDA
-    if (m_impl->nvml && m_impl->nvml->isAvailable()) {
-        auto nvmlStats = m_impl->nvml->getAllStats();
-        all.insert(all.end(), nvmlStats.begin(), nvmlStats.end());
+    while (true) {
+        next += std::chrono::milliseconds(s_sampleIntervalMs);
+        {
+            std::unique_lock<std::mutex> lock(m_impl->wakeMutex);
+            m_impl->wake.wait_until(lock, next, [this]() { return !m_impl->running; });
+            if (!m_impl->running) {
+                break;
+            }
+        }
+
+        sample();
+
+        // Don't try to catch up after a long stall (e.g. suspend)
+        auto now = std::chrono::steady_clock::now();
+        if (now > next + std::chrono::milliseconds(s_sampleIntervalMs)) {
+            next = now;
+        }
     }
-#endif
+}
 
-#ifdef WITH_OPENCL
-    if (m_impl->amd && m_impl->amd->isAvailable()) {
-        auto amdStats = m_impl->amd->getAllStats();
-        all.insert(all.end(), amdStats.begin(), amdStats.end());
+GpuStats GpuMonitor::getNvidiaStats(int cudaIndex) {
+    auto readings = m_impl->latest();
+    if (cudaIndex >= 0 && cudaIndex < static_cast<int>(readings->nvidia.size())) {
+        return readings->nvidia[cudaIndex];
     }
-#endif
+    return GpuStats();
+}
+
+GpuStats GpuMonitor::getAmdStats(int clIndex) {
+    auto readings = m_impl->latest();
+    if (clIndex >= 0 && clIndex < static_cast<int>(readings->amd.size())) {
+        return readings->amd[clIndex];
+    }
+    return GpuStats();
+}
 
+std::vector<GpuStats> GpuMonitor::getAllStats() {
+    auto readings = m_impl->latest();
+    std::vector<GpuStats> all(readings->nvidia);
+    all.insert(all.end(), readings->amd.begin(), readings->amd.end());
     return all;
 }
 
@@ -2,7 +2,7 @@
  * TOS Miner - GPU Monitoring Interface
  *
  * Provides unified access to GPU temperature, power, and fan speed
- * through NVML (NVIDIA) and ADL (AMD) libraries.
+ * through NVML (NVIDIA) and sysfs (AMD).
  */
 
 #pragma once
@@ -165,7 +165,9 @@ private:
 /**
  * Unified GPU Monitor
  *
- * Automatically detects and uses appropriate backends.
+ * Automatically detects and uses appropriate backends. A background
+ * thread samples all backends at a fixed interval; the getters return
+ * the cached readings and never touch NVML or sysfs themselves.
  */
 class GpuMonitor {
 public:
@@ -175,16 +177,21 @@ public:
     static GpuMonitor& instance();
 
     /**
-     * Initialize all available backends
+     * Initialize all available backends and start the sampler thread
      * @return true if at least one backend initialized
      */
     bool init();
 
     /**
-     * Shutdown all backends
+     * Stop the sampler thread and shutdown all backends
      */
     void shutdown();
 
+    /**
+     * Read all backends now and replace the cached readings
+     */
+    void sample();
+
     /**
      * Check if monitoring is available
      */
@@ -210,6 +217,16 @@ public:
      */
     bool anyOverheating(int threshold = 85);
 
+    /**
+     * Set sensor sampling interval in milliseconds (default 1000)
+     */
+    static void setSampleInterval(unsigned ms) { s_sampleIntervalMs = ms > 0 ? ms : 1000; }
+
+    /**
+     * Get sensor sampling interval in milliseconds
+     */
+    static unsigned getSampleInterval() { return s_sampleIntervalMs; }
+
     // Prevent copying
     GpuMonitor(const GpuMonitor&) = delete;
     GpuMonitor& operator=(const GpuMonitor&) = delete;
@@ -218,8 +235,15 @@ private:
     GpuMonitor();
     ~GpuMonitor();
 
+    /**
+     * Sampler thread loop
+     */
+    void run();
+
     struct Impl;
     std::unique_ptr<Impl> m_impl;
+
+    static inline unsigned s_sampleIntervalMs = 1000;
 };
 
 }  // namespace tos
@@ -0,0 +1,269 @@
+/**
+ * TOS Miner - Multi-Resolution Hash Rate History
+ *
+ * Fixed-memory history of a hash rate at several resolutions. Samples
+ * enter the finest tier and are averaged into the next tier as each
+ * group of samples completes, so long windows stay cheap to keep.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Ring buffer of integer samples stored as 32-bit deltas
+ *
+ * Rates are quantized to whole H/s. Only the oldest absolute value and
+ * the newest value are kept; every slot holds the difference to the
+ * previous sample, which halves memory compared to 64-bit values.
+ */
+class DeltaRing {
+public:
+    explicit DeltaRing(size_t capacity = 0)
+        : m_deltas(capacity)
+    {}
+
+    /**
+     * Append a sample, evicting the oldest one when full
+     */
+    void push(int64_t value) {
+        if (m_deltas.empty()) {
+            return;
+        }
+
+        if (m_size == 0) {
+            m_oldest = value;
+            m_newest = value;
+            m_deltas[m_head] = 0;
+            m_head = (m_head + 1) % m_deltas.size();
+            m_size = 1;
+            return;
+        }
+
+        // Clamp to int32; m_newest tracks the stored (not requested) value
+        // so reconstruction stays consistent
+        int64_t delta = value - m_newest;
+        delta = std::max<int64_t>(delta, std::numeric_limits<int32_t>::min());
+        delta = std::min<int64_t>(delta, std::numeric_limits<int32_t>::max());
+
+        if (m_size == m_deltas.size()) {
+            // Evict oldest: the next sample becomes the new base
+            size_t tail = m_head;  // Oldest slot when full
+            size_t next = (tail + 1) % m_deltas.size();
+            m_oldest += m_deltas[next];
+            m_deltas[next] = 0;
+            m_size--;
+        }
+
+        m_deltas[m_head] = static_cast<int32_t>(delta);
+        m_head = (m_head + 1) % m_deltas.size();
+        m_newest += delta;
+        m_size++;
+    }
+
+    /**
+     * Get samples oldest first
+     */
+    std::vector<int64_t> values() const {
+        std::vector<int64_t> out;
+        out.reserve(m_size);
+        if (m_size == 0) {
+            return out;
+        }
+
+        size_t start = (m_head + m_deltas.size() - m_size) % m_deltas.size();
+        int64_t value = m_oldest;
+        out.push_back(value);
+        for (size_t i = 1; i < m_size; i++) {
+            value += m_deltas[(start + i) % m_deltas.size()];
+            out.push_back(value);
+        }
+        return out;
+    }
+
+    /**
+     * Get average of the newest n samples
+     */
+    double averageNewest(size_t n) const {
+        if (m_size == 0 || n == 0) {
+            return 0;
+        }
+        n = std::min(n, m_size);
+
+        // Walk back from the newest value
+        int64_t value = m_newest;
+        double sum = 0;
+        size_t slot = (m_head + m_deltas.size() - 1) % m_deltas.size();
+        for (size_t i = 0; i < n; i++) {
+            sum += static_cast<double>(value);
+            value -= m_deltas[slot];
+            slot = (slot + m_deltas.size() - 1) % m_deltas.size();
+        }
+        return sum / n;
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_deltas.size(); }
+
+private:
+    std::vector<int32_t> m_deltas;
+    size_t m_head{0};       // Next slot to write
+    size_t m_size{0};
+    int64_t m_oldest{0};    // Absolute value of the oldest sample
+    int64_t m_newest{0};    // Absolute value of the newest sample
+};
+
+/**
+ * Hash rates averaged over standard windows
+ */
+struct HashRateWindows {
+    double s10{0};
+    double m1{0};
+    double m15{0};
+    double h1{0};
+    double h24{0};
+};
+
+/**
+ * Multi-resolution hash rate history
+ *
+ * With the default 1 s base interval the tiers are 1 s x 300 (5 min),
+ * 10 s x 360 (1 h), 1 min x 1440 (24 h), 15 min x 672 (7 d) and
+ * 1 h x 720 (30 d), about 14 KB per device.
+ */
+class HashRateHistory {
+public:
+    static constexpr size_t TIERS = 5;
+
+    /**
+     * Constructor
+     * @param baseSeconds Interval between add() calls
+     */
+    explicit HashRateHistory(double baseSeconds = 1.0)
+        : m_baseSeconds(baseSeconds > 0 ? baseSeconds : 1.0)
+    {
+        static constexpr std::array<unsigned, TIERS> factor{1, 10, 6, 15, 4};
+        static constexpr std::array<size_t, TIERS> capacity{300, 360, 1440, 672, 720};
+
+        unsigned multiple = 1;
+        for (size_t i = 0; i < TIERS; i++) {
+            multiple *= factor[i];
+            m_tiers[i].ring = DeltaRing(capacity[i]);
+            m_tiers[i].factor = factor[i];
+            m_tiers[i].resolution = m_baseSeconds * multiple;
+        }
+    }
+
+    /**
+     * Add a sample taken at the base interval
+     */
+    void add(double rate) {
+        push(0, rate);
+    }
+
+    /**
+     * Get tier resolution in seconds
+     */
+    double resolution(size_t tier) const {
+        return tier < TIERS ? m_tiers[tier].resolution : 0;
+    }
+
+    /**
+     * Find tier with the given resolution
+     * @return Tier index, or -1 if none matches
+     */
+    int findTier(double seconds) const {
+        for (size_t i = 0; i < TIERS; i++) {
+            if (std::fabs(m_tiers[i].resolution - seconds) < 1e-6) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * Get samples of a tier, oldest first
+     */
+    std::vector<int64_t> samples(size_t tier) const {
+        return tier < TIERS ? m_tiers[tier].ring.values() : std::vector<int64_t>();
+    }
+
+    /**
+     * Get average rate over the newest window
+     *
+     * Uses the finest tier that covers the window; until enough history
+     * exists the average covers whatever is available.
+     */
+    double average(double seconds) const {
+        size_t tier = TIERS - 1;
+        for (size_t i = 0; i < TIERS; i++) {
+            const Tier& t = m_tiers[i];
+            if (t.resolution * t.ring.capacity() + 1e-6 >= seconds) {
+                tier = i;
+                break;
+            }
+        }
+
+        size_t n = std::max<size_t>(1, static_cast<size_t>(
+            std::ceil(seconds / m_tiers[tier].resolution - 1e-6)));
+
+        // Coarser tiers fill slowly; while empty, use all of a finer tier
+        while (tier > 0 && m_tiers[tier].ring.size() == 0) {
+            tier--;
+            n = m_tiers[tier].ring.capacity();
+        }
+
+        return m_tiers[tier].ring.averageNewest(n);
+    }
+
+    /**
+     * Get the standard window averages
+     */
+    HashRateWindows windows() const {
+        HashRateWindows w;
+        w.s10 = average(10);
+        w.m1 = average(60);
+        w.m15 = average(900);
+        w.h1 = average(3600);
+        w.h24 = average(86400);
+        return w;
+    }
+
+private:
+    struct Tier {
+        DeltaRing ring;
+        unsigned factor{1};     // Samples of the previous tier per sample here
+        double resolution{0};   // Seconds per sample
+        double pendingSum{0};   // Accumulated samples of the previous tier
+        unsigned pendingCount{0};
+    };
+
+    void push(size_t tier, double rate) {
+        Tier& t = m_tiers[tier];
+        t.ring.push(std::llround(rate));
+
+        // Roll up into the next tier once a full group is collected
+        if (tier + 1 < TIERS) {
+            Tier& next = m_tiers[tier + 1];
+            next.pendingSum += rate;
+            if (++next.pendingCount >= next.factor) {
+                double avg = next.pendingSum / next.pendingCount;
+                next.pendingSum = 0;
+                next.pendingCount = 0;
+                push(tier + 1, avg);
+            }
+        }
+    }
+
+    double m_baseSeconds;
+    std::array<Tier, TIERS> m_tiers;
+};
+
+}  // namespace tos
@@ -0,0 +1,130 @@
+/**
+ * TOS Miner - Latency Histogram
+ *
+ * Fixed-bucket histogram with atomic counters, cheap enough to record
+ * from mining and network threads and read from the telemetry sampler.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace tos {
+
+/**
+ * Copyable histogram state
+ *
+ * counts[i] is the number of observations <= bounds[i] that were not
+ * counted in a lower bucket; counts[bounds.size()] is the +Inf bucket.
+ */
+struct HistogramSnapshot {
+    std::vector<double> bounds;     // Upper bounds in seconds
+    std::vector<uint64_t> counts;   // bounds.size() + 1 entries
+    uint64_t count{0};
+    double sum{0};                  // Seconds
+
+    /**
+     * Get approximate quantile (upper bound of the bucket holding it)
+     */
+    double quantile(double q) const {
+        if (count == 0 || bounds.empty()) return 0;
+        uint64_t rank = static_cast<uint64_t>(q * count);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bounds.size(); i++) {
+            seen += counts[i];
+            if (seen > rank) return bounds[i];
+        }
+        return bounds.back();
+    }
+};
+
+/**
+ * Latency histogram
+ *
+ * Buckets are exponential from 1 ms to ~16 s by default, which covers
+ * both job switches (ms) and share round trips over slow links (seconds).
+ * Device timings use a lower first bound (e.g. 10 us to ~164 ms).
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKETS = 15;
+
+    /**
+     * Constructor
+     *
+     * @param firstBoundMicros Upper bound of the first bucket; each next one doubles
+     */
+    explicit LatencyHistogram(int64_t firstBoundMicros = 1000)
+        : m_firstBound(firstBoundMicros > 0 ? firstBoundMicros : 1) {
+        for (auto& c : m_counts) {
+            c.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * Record an observation
+     */
+    void observe(std::chrono::steady_clock::duration latency) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        if (us < 0) us = 0;
+
+        size_t bucket = BUCKETS;  // +Inf
+        for (size_t i = 0; i < BUCKETS; i++) {
+            if (us <= boundMicros(i)) {
+                bucket = i;
+                break;
+            }
+        }
+
+        m_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_sumMicros.fetch_add(static_cast<uint64_t>(us), std::memory_order_relaxed);
+    }
+
+    /**
+     * Get a copy of the current state
+     */
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot s;
+        s.bounds.reserve(BUCKETS);
+        s.counts.reserve(BUCKETS + 1);
+        for (size_t i = 0; i < BUCKETS; i++) {
+            s.bounds.push_back(boundMicros(i) / 1e6);
+        }
+        for (size_t i = 0; i <= BUCKETS; i++) {
+            uint64_t c = m_counts[i].load(std::memory_order_relaxed);
+            s.counts.push_back(c);
+            s.count += c;
+        }
+        s.sum = m_sumMicros.load(std::memory_order_relaxed) / 1e6;
+        return s;
+    }
+
+    /**
+     * Reset all buckets
+     */
+    void reset() {
+        for (auto& c : m_counts) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        m_sumMicros.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // e.g. 1ms, 2ms, 4ms ... 16.384s
+    int64_t boundMicros(size_t i) const {
+        return m_firstBound << i;
+    }
+
+    int64_t m_firstBound;
+    std::array<std::atomic<uint64_t>, BUCKETS + 1> m_counts;
+    std::atomic<uint64_t> m_sumMicros{0};
+};
+
+}  // namespace tos
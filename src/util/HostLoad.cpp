@@ -0,0 +1,45 @@
+/**
+ * TOS Miner - Host Load Monitoring Implementation
+ */
+
+#include "HostLoad.h"
+#include <cstdio>
+#include <cstring>
+
+namespace tos {
+
+HostLoadMonitor::HostLoadMonitor(const std::string& procRoot) {
+    m_pressure.open(procRoot + "/pressure/cpu");
+    m_loadavg.open(procRoot + "/loadavg");
+}
+
+HostLoad HostLoadMonitor::sample() const {
+    HostLoad load;
+    char buf[512];
+
+    // "some avg10=1.23 avg60=0.50 avg300=0.10 total=123456"
+    if (m_pressure.read(buf, sizeof(buf)) > 0) {
+        const char* some = std::strstr(buf, "some ");
+        double avg10 = 0, avg60 = 0;
+        if (some && std::sscanf(some, "some avg10=%lf avg60=%lf", &avg10, &avg60) == 2) {
+            load.psiSome10 = avg10;
+            load.psiSome60 = avg60;
+            load.valid = true;
+        }
+    }
+
+    // "0.52 0.58 0.59 3/1234 56789"
+    if (m_loadavg.read(buf, sizeof(buf)) > 0) {
+        double load1 = 0, load5 = 0, load15 = 0;
+        int running = 0, total = 0;
+        if (std::sscanf(buf, "%lf %lf %lf %d/%d", &load1, &load5, &load15, &running, &total) == 5) {
+            load.load1 = load1;
+            load.runnable = running;
+            load.valid = true;
+        }
+    }
+
+    return load;
+}
+
+}  // namespace tos
@@ -0,0 +1,63 @@
+/**
+ * TOS Miner - Host Load Monitoring
+ *
+ * CPU pressure stall information (PSI) and load average from procfs,
+ * used to yield CPU mining threads to other work on shared hosts.
+ */
+
+#pragma once
+
+#include "Sysfs.h"
+#include <string>
+
+namespace tos {
+
+/**
+ * Host load at one point in time
+ *
+ * Fields are -1 when the corresponding source is unavailable.
+ */
+struct HostLoad {
+    double psiSome10{-1};         // % of time some task waited for CPU (10 s avg)
+    double psiSome60{-1};         // Same, 60 s average
+    double load1{-1};             // 1 minute load average
+    int runnable{-1};             // Currently runnable tasks
+    bool valid{false};            // Any source available
+};
+
+/**
+ * Host load monitor
+ *
+ * Opens /proc/pressure/cpu (Linux 4.20+, CONFIG_PSI) and /proc/loadavg
+ * once and re-reads them with pread() on every sample.
+ */
+class HostLoadMonitor {
+public:
+    /**
+     * Constructor
+     *
+     * @param procRoot procfs mount point (tests point this at a fixture tree)
+     */
+    explicit HostLoadMonitor(const std::string& procRoot = "/proc");
+
+    /**
+     * Check if PSI is available
+     */
+    bool hasPressure() const { return m_pressure.isOpen(); }
+
+    /**
+     * Check if any source is available
+     */
+    bool isAvailable() const { return m_pressure.isOpen() || m_loadavg.isOpen(); }
+
+    /**
+     * Read current host load
+     */
+    HostLoad sample() const;
+
+private:
+    SysfsFile m_pressure;         // pressure/cpu
+    SysfsFile m_loadavg;          // loadavg
+};
+
+}  // namespace tos
@@ -3,10 +3,138 @@
  */
 
 #include "Log.h"
+#include <algorithm>
 
 namespace tos {
 
-// Static members are defined inline in header (C++17)
-// This file exists for potential future non-inline implementations
+// Default limits per category: {burst, refill per second}
+LogRateLimit Log::s_limits[static_cast<size_t>(LogCategory::Count)] = {
+    {20, 5.0},   // General
+    {10, 0.5},   // Solution
+    {10, 0.5},   // Device
+    {5, 0.2},    // Network
+    {5, 0.2},    // Api
+};
+
+void Log::limited(LogLevel level, LogCategory category,
+                  const std::string& site, const std::string& msg) {
+    if (level < s_level) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    const LogRateLimit& limit = s_limits[static_cast<size_t>(category)];
+    if (limit.burst == 0) {
+        write(level, msg);
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+
+    auto it = s_buckets.find(site);
+    if (it == s_buckets.end()) {
+        // Bound memory: drop idle buckets when the table gets large. Only
+        // buckets refilled to the burst go; a drained one would hand a site
+        // that is still storming a fresh burst.
+        if (s_buckets.size() >= MAX_SITES) {
+            for (auto b = s_buckets.begin(); b != s_buckets.end();) {
+                refill(b->second, now);
+                if (b->second.suppressed == 0 &&
+                    b->second.tokens >= s_limits[static_cast<size_t>(b->second.category)].burst) {
+                    b = s_buckets.erase(b);
+                } else {
+                    ++b;
+                }
+            }
+        }
+
+        SiteBucket bucket;
+        bucket.category = category;
+        bucket.tokens = limit.burst;
+        bucket.lastRefill = now;
+        it = s_buckets.emplace(site, bucket).first;
+    }
+
+    SiteBucket& bucket = it->second;
+    bucket.level = level;
+    refill(bucket, now);
+
+    if (bucket.tokens < 1.0) {
+        if (bucket.suppressed == 0) {
+            bucket.firstSuppressed = now;
+        }
+        bucket.suppressed++;
+        return;
+    }
+
+    bucket.tokens -= 1.0;
+    if (bucket.suppressed > 0) {
+        writeSummary(site, bucket, now);
+    }
+    write(level, msg);
+}
+
+void Log::flushSuppressed() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    auto now = std::chrono::steady_clock::now();
+    for (auto& [site, bucket] : s_buckets) {
+        if (bucket.suppressed == 0) {
+            continue;
+        }
+        refill(bucket, now);
+        // Only report once the storm has calmed enough to admit a message
+        if (bucket.tokens >= 1.0) {
+            writeSummary(site, bucket, now);
+        }
+    }
+}
+
+void Log::setRateLimit(LogCategory category, unsigned burst, double perSecond) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_limits[static_cast<size_t>(category)] = {burst, perSecond};
+}
+
+LogRateLimit Log::getRateLimit(LogCategory category) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_limits[static_cast<size_t>(category)];
+}
+
+void Log::disableRateLimits() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto& limit : s_limits) {
+        limit = {0, 0};
+    }
+}
+
+bool Log::parseCategory(const std::string& name, LogCategory& category) {
+    if (name == "general")  { category = LogCategory::General;  return true; }
+    if (name == "solution") { category = LogCategory::Solution; return true; }
+    if (name == "device")   { category = LogCategory::Device;   return true; }
+    if (name == "network")  { category = LogCategory::Network;  return true; }
+    if (name == "api")      { category = LogCategory::Api;      return true; }
+    return false;
+}
+
+void Log::refill(SiteBucket& bucket, std::chrono::steady_clock::time_point now) {
+    const LogRateLimit& limit = s_limits[static_cast<size_t>(bucket.category)];
+    double elapsed = std::chrono::duration<double>(now - bucket.lastRefill).count();
+    bucket.tokens = std::min(static_cast<double>(limit.burst),
+                             bucket.tokens + elapsed * limit.perSecond);
+    bucket.lastRefill = now;
+}
+
+void Log::writeSummary(const std::string& site, SiteBucket& bucket,
+                       std::chrono::steady_clock::time_point now) {
+    double span = std::chrono::duration<double>(now - bucket.firstSuppressed).count();
+
+    std::ostringstream ss;
+    ss << bucket.suppressed << " similar message(s) suppressed [" << site << "] over "
+       << std::fixed << std::setprecision(1) << span << "s";
+    write(bucket.level, ss.str());
+
+    bucket.suppressed = 0;
+}
 
 }  // namespace tos
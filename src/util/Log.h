@@ -5,11 +5,13 @@
 #pragma once
 
 #include <string>
+#include <cstdint>
 #include <mutex>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <unordered_map>
 
 namespace tos {
 
@@ -23,6 +25,29 @@ enum class LogLevel {
     Error
 };
 
+/**
+ * Log category for rate limiting
+ *
+ * Each category has its own token bucket parameters so that noisy
+ * subsystems (e.g. a faulty GPU) can be throttled independently.
+ */
+enum class LogCategory {
+    General,
+    Solution,   // Solution verification (duplicates, invalid results)
+    Device,     // Device/kernel level faults
+    Network,    // Pool connection errors and reconnects
+    Api,        // API server
+    Count
+};
+
+/**
+ * Token bucket parameters for a log category
+ */
+struct LogRateLimit {
+    unsigned burst{0};       // Messages allowed back-to-back (0 = unlimited)
+    double perSecond{0};     // Token refill rate
+};
+
 /**
  * Simple logging class
  */
@@ -86,7 +111,63 @@ public:
         }
 
         std::lock_guard<std::mutex> lock(s_mutex);
+        write(level, msg);
+    }
+
+    /**
+     * Log a rate-limited message
+     *
+     * Messages sharing the same site key draw from one token bucket sized
+     * by the category limits. Dropped messages are counted and reported as
+     * a single "N similar messages suppressed" line once the bucket refills.
+     *
+     * @param level Log level
+     * @param category Category whose limits apply
+     * @param site Call-site key (e.g. "CL0:duplicate")
+     * @param msg Message text
+     */
+    static void limited(LogLevel level, LogCategory category,
+                        const std::string& site, const std::string& msg);
+
+    /**
+     * Emit pending suppression summaries for sites that have gone quiet
+     *
+     * Call periodically so that the tail of a storm is reported even when
+     * no further messages arrive on that site.
+     */
+    static void flushSuppressed();
+
+    /**
+     * Set rate limit for a category (burst = 0 disables limiting)
+     */
+    static void setRateLimit(LogCategory category, unsigned burst, double perSecond);
 
+    /**
+     * Get rate limit for a category
+     */
+    static LogRateLimit getRateLimit(LogCategory category);
+
+    /**
+     * Disable rate limiting for all categories
+     */
+    static void disableRateLimits();
+
+    /**
+     * Parse category name ("general", "solution", "device", "network", "api")
+     *
+     * @return true if name was recognized
+     */
+    static bool parseCategory(const std::string& name, LogCategory& category);
+
+    // Rate-limited sites tracked before idle ones (bucket full, nothing
+    // suppressed) are dropped; sites still limited are always kept
+    static constexpr size_t MAX_SITES = 1024;
+
+private:
+    /**
+     * Write a formatted line (caller holds s_mutex)
+     */
+    static void write(LogLevel level, const std::string& msg) {
         std::ostream& out = (level >= LogLevel::Warning) ? std::cerr : std::cout;
 
         if (s_showTimestamp) {
@@ -96,7 +177,22 @@ public:
         out << getLevelPrefix(level) << " " << msg << std::endl;
     }
 
-private:
+    /**
+     * Per-site token bucket state
+     */
+    struct SiteBucket {
+        LogCategory category{LogCategory::General};
+        LogLevel level{LogLevel::Info};
+        double tokens{0};
+        uint64_t suppressed{0};
+        std::chrono::steady_clock::time_point lastRefill;
+        std::chrono::steady_clock::time_point firstSuppressed;
+    };
+
+    static void refill(SiteBucket& bucket, std::chrono::steady_clock::time_point now);
+    static void writeSummary(const std::string& site, SiteBucket& bucket,
+                             std::chrono::steady_clock::time_point now);
+
     static std::string getTimestamp() {
         auto now = std::chrono::system_clock::now();
         auto time = std::chrono::system_clock::to_time_t(now);
@@ -122,6 +218,10 @@ private:
     static inline LogLevel s_level = LogLevel::Info;
     static inline bool s_showTimestamp = true;
     static inline std::mutex s_mutex;
+
+    // Rate limiting state (guarded by s_mutex)
+    static LogRateLimit s_limits[static_cast<size_t>(LogCategory::Count)];
+    static inline std::unordered_map<std::string, SiteBucket> s_buckets;
 };
 
 }  // namespace tos
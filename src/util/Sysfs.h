@@ -0,0 +1,168 @@
+/**
+ * TOS Miner - Sysfs Access
+ *
+ * Persistent sysfs attribute handles. Attributes are opened once and
+ * re-read with pread(), so periodic sensor sampling costs one syscall
+ * per value instead of open/read/close through a stream.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace tos {
+
+/**
+ * Sysfs root configuration
+ */
+class Sysfs {
+public:
+    /**
+     * Set sysfs mount point (default /sys; tests point this at a fixture tree)
+     */
+    static void setRoot(const std::string& root) {
+        s_root = root.empty() ? "/sys" : root;
+        while (s_root.size() > 1 && s_root.back() == '/') {
+            s_root.pop_back();
+        }
+    }
+
+    /**
+     * Get sysfs mount point
+     */
+    static const std::string& getRoot() { return s_root; }
+
+    /**
+     * Resolve a path below the root (e.g. "class/drm")
+     */
+    static std::string path(const std::string& relative) {
+        return s_root + "/" + relative;
+    }
+
+private:
+    static inline std::string s_root = "/sys";
+};
+
+/**
+ * Open sysfs attribute
+ *
+ * Move-only; the descriptor is closed on destruction. Reads return -1
+ * (or an empty string) when the attribute is missing or unreadable.
+ */
+class SysfsFile {
+public:
+    SysfsFile() = default;
+
+    explicit SysfsFile(const std::string& path) {
+        open(path);
+    }
+
+    ~SysfsFile() {
+        close();
+    }
+
+    SysfsFile(SysfsFile&& other) noexcept : m_fd(other.m_fd) {
+        other.m_fd = -1;
+    }
+
+    SysfsFile& operator=(SysfsFile&& other) noexcept {
+        if (this != &other) {
+            close();
+            m_fd = other.m_fd;
+            other.m_fd = -1;
+        }
+        return *this;
+    }
+
+    SysfsFile(const SysfsFile&) = delete;
+    SysfsFile& operator=(const SysfsFile&) = delete;
+
+    /**
+     * Open attribute (closes any previous one)
+     * @return true if the attribute exists and is readable
+     */
+    bool open(const std::string& path) {
+        close();
+#ifndef _WIN32
+        m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#else
+        (void)path;
+#endif
+        return m_fd >= 0;
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+#endif
+        m_fd = -1;
+    }
+
+    bool isOpen() const { return m_fd >= 0; }
+
+    /**
+     * Read current contents into buf (NUL-terminated)
+     * @return Bytes read, or -1 on error
+     */
+    long read(char* buf, size_t size) const {
+#ifndef _WIN32
+        if (m_fd < 0 || size == 0) {
+            return -1;
+        }
+        ssize_t n = ::pread(m_fd, buf, size - 1, 0);
+        if (n < 0) {
+            return -1;
+        }
+        buf[n] = '\0';
+        return static_cast<long>(n);
+#else
+        (void)buf;
+        (void)size;
+        return -1;
+#endif
+    }
+
+    /**
+     * Read integer attribute
+     * @return Value, or -1 if unavailable
+     */
+    int64_t readInt() const {
+        char buf[64];
+        if (read(buf, sizeof(buf)) <= 0) {
+            return -1;
+        }
+        char* end = nullptr;
+        long long value = std::strtoll(buf, &end, 10);
+        return end != buf ? static_cast<int64_t>(value) : -1;
+    }
+
+    /**
+     * Read string attribute (first line)
+     */
+    std::string readString() const {
+        char buf[4096];
+        if (read(buf, sizeof(buf)) <= 0) {
+            return "";
+        }
+        std::string value(buf);
+        size_t eol = value.find('\n');
+        if (eol != std::string::npos) {
+            value.resize(eol);
+        }
+        return value;
+    }
+
+private:
+    int m_fd{-1};
+};
+
+}  // namespace tos
@@ -0,0 +1,113 @@
+/**
+ * TOS Miner - Test Helpers
+ *
+ * Shared by the standalone test executables: [PASS]/[FAIL] reporting,
+ * fixture file creation and a fake miner for farm-level tests.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/core/Miner.h"
+
+// Cleared by the first failed check; main() returns it as the exit status
+inline bool g_passed = true;
+
+inline void check(bool condition, const std::string& what) {
+    std::cout << (condition ? "[PASS] " : "[FAIL] ") << what << "\n";
+    if (!condition) {
+        g_passed = false;
+    }
+}
+
+/**
+ * Write a fixture file, creating its directories and replacing any old content
+ */
+inline void writeFile(const std::filesystem::path& path, const std::string& content) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+/**
+ * Fake miner
+ *
+ * Runs no kernel: the mining loop counts 1000 hashes every 5 ms while
+ * running and not paused, and exits when crash is set. init() fails for
+ * the first initFailures calls. hashBatch() computes the CPU reference
+ * and passes it to onBatch, which may corrupt it or return false to act
+ * as a kernel that failed to run.
+ */
+class FakeMiner : public tos::Miner {
+public:
+    // Batch number (from 1) and the batch's reference hashes
+    using BatchHook = std::function<bool(unsigned batch, std::vector<tos::Hash256>& hashes)>;
+
+    explicit FakeMiner(unsigned index, tos::MinerType type = tos::MinerType::CPU, const std::string& name = "")
+        : Miner(index, descriptor(index, type, name)) {}
+
+    ~FakeMiner() override { stop(); }
+
+    bool init() override {
+        unsigned call = ++initCalls;
+        if (initDelay.count() > 0) {
+            std::this_thread::sleep_for(initDelay);
+        }
+        return call > initFailures;
+    }
+
+    // Nonce the miner would start scanning from for the current job
+    tos::Nonce startNonce() const { return getWork().getDeviceStartNonce(getNonceSlot()); }
+
+    std::string jobId() const { return getWork().jobId; }
+
+    // Result paths of the GPU miners, driven directly by tests
+    using Miner::checkIntegrity;
+    using Miner::computeHash;
+    using Miner::verifySolution;
+
+    unsigned initFailures{0};
+    std::chrono::milliseconds initDelay{0};
+    BatchHook onBatch;
+
+    std::atomic<unsigned> initCalls{0};
+    std::atomic<bool> crash{false};     // Mining loop gives up on the device
+    unsigned batches{0};
+    unsigned hashes{0};                 // Hashes in batches that succeeded
+
+protected:
+    void mineLoop() override {
+        while (m_running && !crash) {
+            if (!m_paused) {
+                updateHashCount(1000);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    bool hashBatch(const tos::WorkPackage& work, uint64_t startNonce, unsigned count,
+                   std::vector<tos::Hash256>& out) override {
+        unsigned batch = ++batches;
+        if (!Miner::hashBatch(work, startNonce, count, out) || (onBatch && !onBatch(batch, out))) {
+            return false;
+        }
+        hashes += count;
+        return true;
+    }
+
+private:
+    static tos::DeviceDescriptor descriptor(unsigned index, tos::MinerType type, const std::string& name) {
+        tos::DeviceDescriptor device;
+        device.type = type;
+        device.index = index;
+        device.name = name.empty() ? "Fake" + std::to_string(index) : name;
+        return device;
+    }
+};
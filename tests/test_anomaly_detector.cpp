@@ -0,0 +1,203 @@
+/**
+ * Test hash rate anomaly detection against simulated devices
+ *
+ * Devices hash at a noisy rate; the test injects drops, throttling,
+ * stalls and slow peers and checks what the detector flags, how fast,
+ * and that normal noise and governor intensity changes are not flagged.
+ */
+
+#include <iostream>
+#include <random>
+#include "../src/core/AnomalyDetector.h"
+#include "../src/core/Telemetry.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+struct SimDevice {
+    std::string name{"Radeon RX 7900 XTX"};
+    double rate{2000000};           // H/s at full speed
+    double noise{0.05};             // Relative standard deviation per tick
+    double factor{1.0};             // Injected slowdown
+    unsigned intensity{100};
+    bool stalled{false};
+    bool parked{false};
+    int temperature{70};
+    int clock{2500};
+    uint64_t count{0};
+};
+
+class Sim {
+public:
+    explicit Sim(std::vector<SimDevice> devices, const AnomalyConfig& config = AnomalyConfig())
+        : devices(std::move(devices)), detector(config), rng(42), start(std::chrono::steady_clock::now()) {}
+
+    TelemetrySnapshot tick() {
+        std::normal_distribution<double> noise(0.0, 1.0);
+
+        TelemetrySnapshot snap;
+        snap.running = true;
+        snap.sampledAt = start + std::chrono::seconds(ticks++);
+
+        for (size_t i = 0; i < devices.size(); i++) {
+            SimDevice& sim = devices[i];
+            if (!sim.stalled && !sim.parked) {
+                double rate = sim.rate * sim.factor * sim.intensity / 100.0 * (1.0 + sim.noise * noise(rng));
+                sim.count += static_cast<uint64_t>(std::max(0.0, rate));
+            }
+
+            DeviceTelemetry dev;
+            dev.device.type = MinerType::OpenCL;
+            dev.device.index = static_cast<unsigned>(i);
+            dev.device.name = sim.name;
+            dev.hashRate.count = sim.count;
+            dev.intensity = sim.intensity;
+            dev.parked = sim.parked;
+            dev.gpu.valid = true;
+            dev.gpu.temperature = sim.temperature;
+            dev.gpu.clockCore = sim.clock;
+            snap.devices.push_back(dev);
+        }
+
+        detector.update(snap);
+        return snap;
+    }
+
+    // Run n ticks; return the first tick index (relative) at which device is in kind, or -1
+    int runUntil(unsigned n, size_t device, AnomalyKind kind) {
+        int first = -1;
+        for (unsigned t = 0; t < n; t++) {
+            TelemetrySnapshot snap = tick();
+            if (first < 0 && snap.devices[device].anomaly.kind == kind) {
+                first = static_cast<int>(t);
+            }
+        }
+        return first;
+    }
+
+    // Count ticks with any anomaly on a device
+    unsigned flagged(unsigned n, size_t device) {
+        unsigned count = 0;
+        for (unsigned t = 0; t < n; t++) {
+            if (tick().devices[device].anomaly.kind != AnomalyKind::None) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    std::vector<SimDevice> devices;
+    AnomalyDetector detector;
+    std::mt19937 rng;
+    std::chrono::steady_clock::time_point start;
+    unsigned ticks{0};
+};
+
+int main() {
+    std::cout << "=== Anomaly Detector Test ===\n\n";
+
+    // Robust statistics
+    check(AnomalyDetector::median({3, 1, 2}) == 2 && AnomalyDetector::median({4, 1, 3, 2}) == 2.5,
+          "Median of odd and even sets");
+    check(AnomalyDetector::mad({1, 1, 2, 2, 4, 6, 9}) == 1, "MAD of a skewed set");
+    check(AnomalyDetector::median({}) == 0, "Median of nothing is zero");
+
+    // Noise alone: no false positives
+    {
+        Sim sim({SimDevice()});
+        unsigned flagged = sim.flagged(1800, 0);
+        check(flagged == 0, "No anomalies from 5% noise over 30 minutes (flagged " + std::to_string(flagged) + ")");
+    }
+
+    // Silent 30% loss: detected within the recent window, stays flagged, clears on recovery
+    {
+        Sim sim({SimDevice()});
+        sim.runUntil(400, 0, AnomalyKind::Degraded);
+        sim.devices[0].factor = 0.7;
+        int detected = sim.runUntil(60, 0, AnomalyKind::Degraded);
+        std::cout << "  30% drop detected after " << detected << " ticks\n";
+        check(detected >= 0 && detected <= 20, "30% drop detected within 20 ticks");
+
+        unsigned flagged = sim.flagged(900, 0);
+        check(flagged == 900, "Lasting drop stays flagged (baseline does not absorb it)");
+
+        TelemetrySnapshot snap = sim.tick();
+        const DeviceAnomaly& anomaly = snap.devices[0].anomaly;
+        check(!anomaly.reasons.empty() && anomaly.reasons[0].find("below baseline") != std::string::npos,
+              "Reason names the baseline");
+        check(anomaly.baselineRate > 1900000 && anomaly.recentRate < 1500000, "Baseline and recent rates reported");
+
+        sim.devices[0].factor = 1.0;
+        int cleared = sim.runUntil(60, 0, AnomalyKind::None);
+        check(cleared >= 0 && cleared <= 20, "Clears after the rate recovers");
+    }
+
+    // Drop while hot: throttled
+    {
+        Sim sim({SimDevice()});
+        sim.runUntil(400, 0, AnomalyKind::None);
+        sim.devices[0].factor = 0.75;
+        sim.devices[0].temperature = 92;
+        check(sim.runUntil(60, 0, AnomalyKind::Throttled) >= 0, "Drop at 92C flagged as throttled");
+    }
+
+    // Drop with falling clock: throttled
+    {
+        Sim sim({SimDevice()});
+        sim.runUntil(400, 0, AnomalyKind::None);
+        sim.devices[0].factor = 0.75;
+        sim.devices[0].clock = 1900;
+        int at = sim.runUntil(60, 0, AnomalyKind::Throttled);
+        check(at >= 0, "Drop with 1900/2500 MHz clock flagged as throttled");
+    }
+
+    // Governor halves intensity: not an anomaly
+    {
+        Sim sim({SimDevice()});
+        sim.runUntil(400, 0, AnomalyKind::None);
+        sim.devices[0].intensity = 50;
+        check(sim.flagged(300, 0) == 0, "Intensity change is not flagged");
+    }
+
+    // Stall: flagged only when others hash or the pool has work
+    {
+        SimDevice a, b;
+        Sim sim({a, b});
+        sim.runUntil(200, 0, AnomalyKind::None);
+        sim.devices[1].stalled = true;
+        int detected = sim.runUntil(60, 1, AnomalyKind::Stalled);
+        check(detected >= 29 && detected <= 31, "Stall flagged after 30 flat ticks");
+
+        sim.devices[0].stalled = true;  // Everything stops: no work, not a device fault
+        unsigned flagged = 0;
+        for (int t = 0; t < 60; t++) {
+            TelemetrySnapshot snap = sim.tick();
+            flagged += snap.devices[0].anomaly.kind != AnomalyKind::None;
+        }
+        check(flagged <= 1, "Farm-wide stop without a pool is not an anomaly");
+
+        sim.devices[1].parked = true;
+        TelemetrySnapshot snap = sim.tick();
+        check(snap.devices[1].anomaly.kind == AnomalyKind::None, "Parked devices are not flagged");
+    }
+
+    // Same-model peers: the slow card is flagged without any baseline history
+    {
+        SimDevice slow;
+        slow.factor = 0.7;
+        SimDevice other;
+        other.name = "GeForce RTX 4090";
+        other.rate = 1400000;
+        Sim sim({SimDevice(), SimDevice(), slow, SimDevice(), other});
+        int detected = sim.runUntil(30, 2, AnomalyKind::Degraded);
+        check(detected >= 0, "Slow card flagged against peers");
+
+        TelemetrySnapshot snap = sim.tick();
+        check(snap.devices[2].anomaly.peerRate > 1900000, "Peer rate reported");
+        check(snap.devices[0].anomaly.kind == AnomalyKind::None && snap.devices[4].anomaly.kind == AnomalyKind::None,
+              "Healthy peers and other models not flagged");
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Anomaly detector test completed" : "[FAIL] Anomaly detector test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
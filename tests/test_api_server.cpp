@@ -0,0 +1,244 @@
+/**
+ * Test the HTTP API server connection handling
+ *
+ * Parses request heads directly, then runs the server on a loopback port
+ * against a farm with no devices and talks to it over raw sockets: a
+ * pipelined burst longer than MAX_PIPELINED, an oversized head (431),
+ * a malformed request (400), a client trickling a head past the request
+ * timeout, and connections beyond MAX_CONNECTIONS (503).
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "../src/api/ApiServer.h"
+#include "../src/util/Log.h"
+#include "TestUtil.h"
+
+using namespace tos;
+using Clock = std::chrono::steady_clock;
+
+static int connectTo(unsigned port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    timeval timeout{};
+    timeout.tv_sec = 10;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+static void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+// Read until the server closes the connection (or the receive timeout)
+static std::string readUntilClosed(int fd, bool& closed) {
+    std::string data;
+    char buf[4096];
+    closed = false;
+    for (;;) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            closed = n == 0 || errno == ECONNRESET;
+            return data;
+        }
+        data.append(buf, static_cast<size_t>(n));
+    }
+}
+
+// Read until the data holds count HTTP responses
+static std::string readResponses(int fd, size_t count) {
+    std::string data;
+    char buf[4096];
+    size_t seen = 0;
+    while (seen < count) {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            break;
+        }
+        data.append(buf, static_cast<size_t>(n));
+        seen = 0;
+        for (size_t pos = 0; (pos = data.find("HTTP/1.1 ", pos)) != std::string::npos; pos++) {
+            seen++;
+        }
+    }
+    return data;
+}
+
+static size_t countOf(const std::string& data, const std::string& what) {
+    size_t count = 0;
+    for (size_t pos = 0; (pos = data.find(what, pos)) != std::string::npos; pos += what.size()) {
+        count++;
+    }
+    return count;
+}
+
+static void testParseRequest() {
+    std::cout << "--- Request parsing ---\n";
+
+    HttpRequest request;
+    bool ok = ApiServer::parseRequest("GET /history?device=1&res=1m HTTP/1.1\r\n"
+                                      "Host: rig01\r\n"
+                                      "If-None-Match:   \"abc\"\r\n"
+                                      "X-Ignored", request);
+    check(ok && request.method == "GET" && request.path == "/history" && request.query == "device=1&res=1m",
+          "Request line split into method, path and query");
+    check(request.header("host") == "rig01" && request.header("if-none-match") == "\"abc\"",
+          "Header names lower-cased, leading whitespace trimmed");
+    check(request.headers.size() == 2, "Lines without a colon ignored");
+    check(request.keepAlive, "HTTP/1.1 keeps the connection alive by default");
+
+    HttpRequest close;
+    ApiServer::parseRequest("GET / HTTP/1.1\r\nConnection: Close", close);
+    HttpRequest old;
+    ApiServer::parseRequest("GET / HTTP/1.0", old);
+    HttpRequest oldKeep;
+    ApiServer::parseRequest("GET / HTTP/1.0\r\nConnection: keep-alive", oldKeep);
+    check(!close.keepAlive && !old.keepAlive && oldKeep.keepAlive, "Connection header and HTTP/1.0 default");
+
+    HttpRequest bad;
+    check(!ApiServer::parseRequest("", bad), "Empty head rejected");
+    check(!ApiServer::parseRequest("GET /", bad), "Missing version rejected");
+    check(!ApiServer::parseRequest("GET / FTP/1.0", bad), "Non-HTTP version rejected");
+}
+
+static void testServer() {
+    std::cout << "--- Server ---\n";
+
+    Farm farm;
+    Telemetry telemetry(farm);
+    telemetry.sample();
+
+    unsigned port = 20000 + static_cast<unsigned>(::getpid()) % 20000;
+    ApiServer server(port, telemetry);
+    if (!server.start()) {
+        check(false, "API server started on port " + std::to_string(port));
+        return;
+    }
+
+    // Burst longer than one write's worth: everything answered, in order
+    {
+        int fd = connectTo(port);
+        size_t total = ApiServer::MAX_PIPELINED + 3;
+        std::string burst;
+        for (size_t i = 0; i < total; i++) {
+            burst += "GET /health HTTP/1.1\r\nHost: test\r\n\r\n";
+        }
+        burst += "GET /nope HTTP/1.1\r\n\r\n";
+        sendAll(fd, burst);
+
+        std::string data = readResponses(fd, total + 1);
+        check(countOf(data, "HTTP/1.1 200") == total, "Every pipelined request beyond MAX_PIPELINED answered");
+        check(countOf(data, "HTTP/1.1 404") == 1 && data.rfind("HTTP/1.1 404") > data.rfind("HTTP/1.1 200"),
+              "Pipelined responses in request order");
+
+        // Still open for another request
+        sendAll(fd, "GET /health HTTP/1.1\r\nConnection: close\r\n\r\n");
+        bool closed;
+        data = readUntilClosed(fd, closed);
+        check(countOf(data, "HTTP/1.1 200") == 1 && closed, "Connection kept alive, then closed on request");
+        ::close(fd);
+    }
+
+    // Head larger than MAX_REQUEST_SIZE
+    {
+        int fd = connectTo(port);
+        sendAll(fd, "GET / HTTP/1.1\r\nX-Fill: " + std::string(ApiServer::MAX_REQUEST_SIZE, 'a'));
+        bool closed;
+        std::string data = readUntilClosed(fd, closed);
+        check(data.compare(0, 12, "HTTP/1.1 431") == 0 && closed, "Oversized head answered with 431 and closed");
+        ::close(fd);
+    }
+
+    // Malformed request line
+    {
+        int fd = connectTo(port);
+        sendAll(fd, "GARBAGE\r\n\r\nGET / HTTP/1.1\r\n\r\n");
+        bool closed;
+        std::string data = readUntilClosed(fd, closed);
+        check(data.compare(0, 12, "HTTP/1.1 400") == 0 && countOf(data, "HTTP/1.1 ") == 1 && closed,
+              "Malformed request answered with 400 and closed");
+        ::close(fd);
+    }
+
+    // Head trickled in a byte at a time: cut off at the request timeout
+    {
+        int fd = connectTo(port);
+        std::string head = "GET /health HTTP/1.1\r\nX-Slow: ";
+        auto start = Clock::now();
+        bool closed = false;
+        for (size_t i = 0; i < head.size() + 20 && !closed; i++) {
+            char c = i < head.size() ? head[i] : 'a';
+            closed = ::send(fd, &c, 1, MSG_NOSIGNAL) <= 0;
+            if (!closed) {
+                char probe;
+                timeval wait{0, 500000};
+                ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof(wait));
+                closed = ::recv(fd, &probe, 1, 0) == 0;
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "  slow client closed after " << seconds << " s\n";
+        check(closed && seconds < ApiServer::REQUEST_TIMEOUT + 2,
+              "Trickled head cut off at the request timeout, not the idle timeout");
+        ::close(fd);
+    }
+
+    // One connection over the limit is refused with 503
+    {
+        std::vector<int> held;
+        for (size_t i = 0; i < ApiServer::MAX_CONNECTIONS; i++) {
+            held.push_back(connectTo(port));
+        }
+        // Let the server accept them all
+        sendAll(held.back(), "GET /health HTTP/1.1\r\n\r\n");
+        readResponses(held.back(), 1);
+
+        int extra = connectTo(port);
+        bool closed;
+        std::string data = readUntilClosed(extra, closed);
+        check(data.compare(0, 12, "HTTP/1.1 503") == 0 && closed, "Connection over MAX_CONNECTIONS gets 503");
+        ::close(extra);
+
+        sendAll(held.front(), "GET /health HTTP/1.1\r\n\r\n");
+        check(countOf(readResponses(held.front(), 1), "HTTP/1.1 200") == 1, "Connections within the limit served");
+        for (int fd : held) {
+            ::close(fd);
+        }
+    }
+
+    server.stop();
+}
+
+int main() {
+    std::cout << "=== API Server Test ===\n\n";
+
+    Log::setLevel(LogLevel::Error);
+    testParseRequest();
+    testServer();
+
+    std::cout << "\n" << (g_passed ? "[PASS] API server test completed"
+                                   : "[FAIL] API server test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,274 @@
+/**
+ * Test the auto-tuner and the tuning database
+ *
+ * The tuner searches a simulated device whose hash rate peaks at one
+ * combination of settings and which cannot run some others. The database
+ * round-trips entries through a JSON file, keys them by driver, and falls
+ * back to the profile detected from the device name.
+ */
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../src/core/AutoTuner.h"
+#include "../src/core/TuningDatabase.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+/**
+ * Simulated OpenCL device
+ *
+ * Fastest with interleaved scratchpads, local size 64 and 65536 work items;
+ * the local layout only runs with one work item per group, and local sizes
+ * above 128 exceed the device maximum.
+ */
+struct SimDevice {
+    double noise{0.0};
+    unsigned runs{0};
+    std::mt19937 rng{11};
+
+    double measure(const TuningProfile& p) {
+        runs++;
+        if (p.openclLocalWorkSize > 128) {
+            return 0.0;
+        }
+        if (p.openclScratch == ScratchLayout::Local && p.openclLocalWorkSize > 1) {
+            return 0.0;
+        }
+
+        double layout = 1.0;
+        switch (p.openclScratch) {
+            case ScratchLayout::Local: layout = 0.7; break;
+            case ScratchLayout::Contiguous: layout = 0.5; break;
+            case ScratchLayout::Interleaved: layout = 1.0; break;
+            case ScratchLayout::Blocked: layout = 0.9; break;
+        }
+        double local = 1.0 - 0.05 * std::abs(std::log2(p.openclLocalWorkSize) - 6.0);
+        double global = 1.0 - 0.15 * std::abs(std::log2(p.openclGlobalWorkSize) - 16.0);
+
+        std::normal_distribution<double> jitter(0.0, 1.0);
+        return 1000.0 * layout * local * global * (1.0 + noise * jitter(rng));
+    }
+};
+
+static void addOpenCLAxes(AutoTuner& tuner, const TuningProfile& start) {
+    tuner.addAxis("scratch", {0, 1, 2, 3},
+                  [](TuningProfile& p, unsigned v) { p.openclScratch = static_cast<ScratchLayout>(v); });
+    tuner.addAxis("local", {1, 32, 64, 128, 256},
+                  [](TuningProfile& p, unsigned v) { p.openclLocalWorkSize = v; });
+    tuner.addAxis("global", AutoTuner::powersAround(start.openclGlobalWorkSize, 2, 2, 1024, 1u << 20),
+                  [](TuningProfile& p, unsigned v) { p.openclGlobalWorkSize = v; });
+}
+
+static void testPowersAround() {
+    std::cout << "--- Candidate values ---\n";
+    auto values = AutoTuner::powersAround(16384, 2, 2, 1024, 1u << 20);
+    check(values == std::vector<unsigned>({4096, 8192, 16384, 32768, 65536}), "Two halvings and doublings around the base");
+
+    values = AutoTuner::powersAround(2048, 2, 1, 1024, 3000);
+    check(values == std::vector<unsigned>({1024, 2048, 3000}), "Values clamped and deduplicated");
+
+    values = AutoTuner::powersAround(0, 1, 1, 1, 8);
+    check(values == std::vector<unsigned>({1, 2}), "Zero base treated as one");
+}
+
+static void testSearch() {
+    std::cout << "--- Search ---\n";
+    SimDevice device;
+    TuningProfile start = TuningProfiles::getProfile("default");  // local layout, local 1, 16384 items
+
+    AutoTuner tuner;
+    addOpenCLAxes(tuner, start);
+    TuningProfile best = tuner.run(start, [&](const TuningProfile& p) { return device.measure(p); });
+
+    check(best.openclScratch == ScratchLayout::Interleaved, "Finds the fastest scratchpad layout");
+    check(best.openclLocalWorkSize == 64, "Finds the fastest local size (" + std::to_string(best.openclLocalWorkSize) + ")");
+    check(best.openclGlobalWorkSize == 65536, "Finds the fastest global size (" + std::to_string(best.openclGlobalWorkSize) + ")");
+    check(std::abs(tuner.bestRate() - 1000.0) < 1e-6, "Reports the best rate");
+    check(device.runs == tuner.measurements(), "Each distinct candidate measured once");
+    check(tuner.measurements() < 4 * 5 * 5 / 2, "Measures far fewer candidates than the full grid (" +
+          std::to_string(tuner.measurements()) + " of 100)");
+    check(best.cudaGridSize == start.cudaGridSize && best.openclNonceLoop == start.openclNonceLoop,
+          "Settings without an axis are kept");
+}
+
+static void testNoise() {
+    std::cout << "--- Noise ---\n";
+    SimDevice device;
+    device.noise = 0.005;
+    TuningProfile start = TuningProfiles::getProfile("default");
+    start.openclScratch = ScratchLayout::Interleaved;
+    start.openclLocalWorkSize = 64;
+    start.openclGlobalWorkSize = 65536;
+
+    AutoTuner tuner;
+    addOpenCLAxes(tuner, start);
+    TuningProfile best = tuner.run(start, [&](const TuningProfile& p) { return device.measure(p); });
+    check(best.openclScratch == start.openclScratch && best.openclLocalWorkSize == start.openclLocalWorkSize &&
+          best.openclGlobalWorkSize == start.openclGlobalWorkSize,
+          "Noise below the minimum gain does not move off the best settings");
+}
+
+static void testNothingRuns() {
+    std::cout << "--- Unusable device ---\n";
+    TuningProfile start = TuningProfiles::getProfile("amd-rdna2");
+    AutoTuner tuner;
+    addOpenCLAxes(tuner, start);
+    TuningProfile best = tuner.run(start, [](const TuningProfile&) { return 0.0; });
+    check(tuner.bestRate() == 0.0, "Best rate is 0 when nothing runs");
+    check(best.openclGlobalWorkSize == start.openclGlobalWorkSize && best.openclScratch == start.openclScratch,
+          "Start settings returned unchanged");
+}
+
+static void testDetect() {
+    std::cout << "--- Profile detection ---\n";
+    struct Case { const char* name; const char* profile; };
+    const Case cases[] = {
+        {"NVIDIA GeForce RTX 4090", "nvidia-ada"},
+        {"NVIDIA GeForce RTX 3060 Ti", "nvidia-ampere"},
+        {"NVIDIA GeForce RTX 2080 SUPER", "nvidia-turing"},
+        {"NVIDIA GeForce GTX 1660", "nvidia-turing"},
+        {"NVIDIA GeForce GTX 1080 Ti", "nvidia-pascal"},
+        {"Quadro RTX 4000", "nvidia-turing"},
+        {"NVIDIA A100-SXM4-40GB", "nvidia-ampere"},
+        {"Tesla T4", "nvidia-turing"},
+        {"AMD Radeon RX 7900 XTX", "amd-rdna3"},
+        {"AMD Radeon RX 6800", "amd-rdna2"},
+        {"AMD Radeon RX 5700 XT", "amd-navi"},
+        {"Radeon RX 580 Series", "amd-polaris"},
+        {"Radeon RX Vega", "amd-vega"},
+        {"gfx1030", "amd-rdna2"},
+        {"gfx1100", "amd-rdna3"},
+        {"gfx906:sramecc+:xnack-", "amd-vega"},
+        {"Ellesmere", "amd-polaris"},
+        {"Intel(R) Arc(TM) A770 Graphics", "intel-arc"},
+        {"AMD A10-7850K Radeon R7", "default"},
+        {"pthread-cpu", "default"},
+    };
+    bool all = true;
+    for (const auto& c : cases) {
+        std::string got = TuningProfiles::detect(c.name);
+        if (got != c.profile) {
+            std::cout << "  " << c.name << ": " << got << ", expected " << c.profile << "\n";
+            all = false;
+        }
+    }
+    check(all, "Device names map to their architecture profiles");
+
+    bool known = true;
+    for (const auto& c : cases) {
+        known = known && TuningProfiles::hasProfile(c.profile);
+    }
+    check(known, "Detected profiles exist");
+}
+
+static void testDatabase() {
+    std::cout << "--- Tuning database ---\n";
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "tosminer_test_auto_tuner";
+    std::filesystem::remove_all(directory);
+    std::string file = (directory / "sub" / "tuning.json").string();
+
+    TuningDatabase empty(file);
+    check(empty.load() && empty.entries().empty(), "Missing file loads as empty");
+
+    TuningEntry cl;
+    cl.backend = MinerType::OpenCL;
+    cl.device = "AMD Radeon RX 6800";
+    cl.driver = "3570.0 (HSA1.1,LC)";
+    cl.profile = TuningProfiles::getProfile("amd-rdna2");
+    cl.profile.openclGlobalWorkSize = 98304;
+    cl.profile.openclLocalWorkSize = 128;
+    cl.profile.openclScratch = ScratchLayout::Blocked;
+    cl.profile.openclPipelineDepth = 3;
+    cl.hashRate = 1234.5;
+    cl.tunedAt = 1700000000;
+
+    TuningEntry cu;
+    cu.backend = MinerType::CUDA;
+    cu.device = "NVIDIA GeForce RTX 3080";
+    cu.driver = "12.4";
+    cu.profile = TuningProfiles::getProfile("nvidia-ampere");
+    cu.profile.cudaGridSize = 40960;
+    cu.profile.cudaStreams = 3;
+    cu.hashRate = 2000.0;
+
+    TuningDatabase database(file);
+    database.store(cl);
+    database.store(cu);
+    cl.hashRate = 1300.0;
+    database.store(cl);
+    check(database.entries().size() == 2, "Storing the same device again replaces its entry");
+    check(database.save() && std::filesystem::exists(file), "Saved, creating the directory");
+
+    TuningDatabase loaded(file);
+    check(loaded.load() && loaded.entries().size() == 2, "Loaded both entries");
+    const TuningEntry* found = loaded.find(MinerType::OpenCL, cl.device, cl.driver);
+    check(found && found->profile.openclGlobalWorkSize == 98304 && found->profile.openclLocalWorkSize == 128 &&
+          found->profile.openclScratch == ScratchLayout::Blocked && found->profile.openclPipelineDepth == 3 &&
+          found->hashRate == 1300.0 &&
+          found->tunedAt == 1700000000, "OpenCL settings round-trip");
+    found = loaded.find(MinerType::CUDA, cu.device, cu.driver);
+    check(found && found->profile.cudaGridSize == 40960 && found->profile.cudaStreams == 3 &&
+          found->profile.cudaBlockSize == cu.profile.cudaBlockSize, "CUDA settings round-trip");
+    check(!loaded.find(MinerType::CUDA, cl.device, cl.driver), "Entries are per backend");
+
+    std::string source;
+    TuningProfile profile = loaded.select(MinerType::OpenCL, cl.device, cl.driver, source);
+    check(profile.openclGlobalWorkSize == 98304 && source == "auto-tuned settings", "Tuned device uses its entry");
+
+    profile = loaded.select(MinerType::OpenCL, cl.device, "3581.0 (HSA1.1,LC)", source);
+    check(profile.openclGlobalWorkSize == TuningProfiles::getProfile("amd-rdna2").openclGlobalWorkSize &&
+          source.find("another driver") != std::string::npos, "New driver falls back to the detected profile");
+
+    profile = loaded.select(MinerType::OpenCL, "AMD Radeon RX 7900 XTX", "1.0", source);
+    check(profile.name == "amd-rdna3" && source == "profile amd-rdna3", "Untuned device uses the detected profile");
+
+    // Damaged files are reported and ignored
+    {
+        std::ofstream out(file, std::ios::trunc);
+        out << "{\"version\": 1, \"devices\": [";
+    }
+    TuningDatabase truncated(file);
+    check(!truncated.load() && truncated.entries().empty(), "Truncated file rejected");
+
+    {
+        std::ofstream out(file, std::ios::trunc);
+        out << "{\"version\": 99, \"devices\": []}";
+    }
+    check(!truncated.load(), "Unknown version rejected");
+
+    {
+        std::ofstream out(file, std::ios::trunc);
+        out << R"({"version": 1, "devices": [
+            {"backend": "opencl", "device": "A", "driver": "1", "opencl": {"global_work": 0, "local_work": 1, "scratch": "local"}},
+            {"backend": "opencl", "device": "B", "driver": "1", "opencl": {"global_work": 4096, "local_work": 1, "scratch": "sideways"}},
+            {"backend": "metal", "device": "C", "driver": "1"},
+            {"backend": "cuda", "device": "D", "driver": "1", "cuda": {"grid": 8192, "block": 1}}]})";
+    }
+    check(truncated.load() && truncated.entries().size() == 1 && truncated.find(MinerType::CUDA, "D", "1"),
+          "Invalid entries skipped, valid ones kept");
+
+    TuningDatabase memory;
+    check(memory.load() && !memory.save(), "No path: nothing read or written");
+
+    std::filesystem::remove_all(directory);
+}
+
+int main() {
+    std::cout << "=== Auto-Tuner Test ===\n\n";
+
+    testPowersAround();
+    testSearch();
+    testNoise();
+    testNothingRuns();
+    testDetect();
+    testDatabase();
+
+    std::cout << "\n" << (g_passed ? "[PASS] Auto-tuner test completed"
+                                   : "[FAIL] Auto-tuner test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
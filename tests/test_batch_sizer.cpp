@@ -0,0 +1,165 @@
+/**
+ * Test batch sizing against simulated kernel timings
+ *
+ * A simulated device takes a fixed launch overhead plus a per-nonce
+ * time (with noise) for each batch. The test checks that the sizer
+ * reaches the target duration from either side, steps at most 2x,
+ * respects its bounds and granularity, ignores noise and follows a
+ * device that slows down.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include "../src/core/BatchSizer.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+struct SimDevice {
+    double overhead{0.0005};     // Seconds per launch
+    double perNonce{2e-6};       // Seconds per nonce
+    double noise{0.0};           // Relative standard deviation per batch
+    std::mt19937 rng{7};
+
+    double run(size_t batch) {
+        std::normal_distribution<double> jitter(0.0, 1.0);
+        double seconds = overhead + perNonce * static_cast<double>(batch);
+        return seconds * std::max(0.5, 1.0 + noise * jitter(rng));
+    }
+};
+
+// Run batches until the size stops changing; returns batches run
+static unsigned settle(BatchSizer& sizer, SimDevice& device, unsigned maxBatches = 50) {
+    unsigned quiet = 0;
+    unsigned batches = 0;
+    while (batches < maxBatches && quiet < 5) {
+        size_t size = sizer.size();
+        quiet = sizer.record(size, device.run(size)) ? 0 : quiet + 1;
+        batches++;
+    }
+    return batches;
+}
+
+static bool nearTarget(const BatchSizer& sizer, const SimDevice& device, double tolerance) {
+    double seconds = device.overhead + device.perNonce * static_cast<double>(sizer.size());
+    return std::abs(seconds - sizer.getTarget()) <= sizer.getTarget() * tolerance;
+}
+
+static void testFixed() {
+    std::cout << "--- Fixed size ---\n";
+    BatchSizer sizer;
+    SimDevice device;
+    sizer.configure(16384, 1024, 65536, 64);
+    unsigned changes = 0;
+    for (int i = 0; i < 10; i++) {
+        changes += sizer.record(sizer.size(), device.run(sizer.size())) ? 1 : 0;
+    }
+    check(!sizer.enabled() && changes == 0 && sizer.size() == 16384, "No target: size stays at the initial value");
+    check(sizer.perNonce() > 0, "Time per nonce still estimated");
+}
+
+static void testConverges() {
+    std::cout << "--- Convergence ---\n";
+
+    // 2 us per nonce: 100 ms is about 50000 nonces
+    SimDevice device;
+    BatchSizer grow;
+    grow.configure(4096, 256, 1 << 20, 64);
+    grow.setTarget(0.1);
+
+    size_t previous = grow.size();
+    bool bounded = true;
+    check(!grow.record(previous, device.run(previous) * 20), "First (warm-up) batch ignored");
+    for (int i = 0; i < 20; i++) {
+        grow.record(grow.size(), device.run(grow.size()));
+        bounded = bounded && grow.size() <= previous * 2 && grow.size() * 2 >= previous;
+        previous = grow.size();
+    }
+    check(nearTarget(grow, device, 0.25), "Short batches grow to the target (" + std::to_string(grow.size()) + ")");
+    check(bounded, "Each step at most doubles or halves");
+    check(grow.size() % 64 == 0, "Size is a multiple of the granularity");
+
+    BatchSizer shrink;
+    shrink.configure(1 << 20, 256, 1 << 20, 64);
+    shrink.setTarget(0.1);
+    unsigned batches = settle(shrink, device);
+    check(nearTarget(shrink, device, 0.25), "Long batches shrink to the target (" + std::to_string(shrink.size()) +
+          " after " + std::to_string(batches) + " batches)");
+}
+
+static void testBounds() {
+    std::cout << "--- Bounds ---\n";
+    SimDevice device;
+
+    BatchSizer capped;
+    capped.configure(4096, 1024, 20000, 64);
+    capped.setTarget(0.1);
+    settle(capped, device);
+    check(capped.size() == 19968, "Growth stops at the largest multiple of the granularity under the maximum");
+
+    BatchSizer floor;
+    floor.configure(4096, 1000, 65536, 64);
+    floor.setTarget(0.0001);
+    settle(floor, device);
+    check(floor.size() == 1024, "Shrinking stops at the minimum rounded up to the granularity");
+
+    BatchSizer odd;
+    odd.configure(100, 1, 10, 64);
+    check(odd.size() == 64, "Bounds below the granularity clamp to one group");
+}
+
+static void testNoise() {
+    std::cout << "--- Noise ---\n";
+    SimDevice device;
+    device.noise = 0.08;
+    BatchSizer sizer;
+    sizer.configure(4096, 256, 1 << 20, 64);
+    sizer.setTarget(0.1);
+    for (int i = 0; i < 30; i++) {
+        sizer.record(sizer.size(), device.run(sizer.size()));
+    }
+
+    unsigned changes = 0;
+    for (int i = 0; i < 200; i++) {
+        changes += sizer.record(sizer.size(), device.run(sizer.size())) ? 1 : 0;
+    }
+    check(nearTarget(sizer, device, 0.25), "Settles near the target with 8% timing noise");
+    check(changes <= 2, "Noise causes at most rare resizes (" + std::to_string(changes) + " in 200 batches)");
+}
+
+static void testSlowdown() {
+    std::cout << "--- Slowdown ---\n";
+    SimDevice device;
+    BatchSizer sizer;
+    sizer.configure(4096, 256, 1 << 20, 64);
+    sizer.setTarget(0.1);
+    settle(sizer, device);
+    size_t before = sizer.size();
+
+    // Thermal throttling: every nonce takes three times as long
+    device.perNonce *= 3;
+    unsigned batches = settle(sizer, device);
+    check(sizer.size() < before / 2 && nearTarget(sizer, device, 0.25),
+          "Follows a 3x slowdown (" + std::to_string(before) + " -> " + std::to_string(sizer.size()) +
+          " in " + std::to_string(batches) + " batches)");
+
+    // Reconfiguring starts over
+    sizer.configure(4096, 256, 1 << 20, 64);
+    check(sizer.size() == 4096 && sizer.perNonce() == 0, "configure() resets the estimate");
+}
+
+int main() {
+    std::cout << "=== Batch Sizer Test ===\n\n";
+
+    testFixed();
+    testConverges();
+    testBounds();
+    testNoise();
+    testSlowdown();
+
+    std::cout << "\n" << (g_passed ? "[PASS] Batch sizer test completed"
+                                   : "[FAIL] Batch sizer test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
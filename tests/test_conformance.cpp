@@ -0,0 +1,363 @@
+/**
+ * Cross-backend TOS Hash V3 conformance test
+ *
+ * Golden vectors (full hash, Blake3 seed and a scratchpad checksum after
+ * each stage) checked against:
+ * - the CPU reference (TosHash)
+ * - the CUDA device code, compiled for the host
+ * - the OpenCL kernel on every OpenCL device found, including CPU
+ *   runtimes such as POCL, built with each scratchpad layout
+ *
+ * Usage: test_conformance [--require-opencl]
+ * With --require-opencl a machine without an OpenCL device fails instead
+ * of skipping the OpenCL checks (for CI runners with POCL installed).
+ */
+
+#include <blake3.h>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../src/toshash/TosHash.h"
+#include "../src/cuda/toshash_device.cuh"
+#include "../src/opencl/ScratchLayout.h"
+#include "TestUtil.h"
+
+#ifdef WITH_OPENCL
+#include <CL/cl.hpp>
+#include "toshash_kernel.cl.h"
+#endif
+
+using namespace tos;
+
+enum class HeaderKind { Zero, Counting, Random };
+
+struct GoldenVector {
+    HeaderKind header;
+    uint64_t nonce;
+    const char* seed;       // Blake3 of the 112-byte input
+    uint64_t stage1;        // TosHash::checksum after each stage
+    uint64_t stage2;
+    uint64_t stage3;
+    const char* hash;
+};
+
+// Nonce placed big-endian at NONCE_OFFSET; the second vector tests the 32-bit carry
+static const GoldenVector c_vectors[] = {
+    {HeaderKind::Zero, 0,
+     "09da4dc6a3e1b9e7714e6d8c1b1fa803e1a25c86215539ebfa3fad46d2e06cd4",
+     0x6d521b95be004f45ULL, 0x23af564edbe7baafULL, 0x7b48b5d7c1a1aee5ULL,
+     "b9685f2eaa611ecf95862c8b2fd9376db7891f01d62dff24bc3fdb60d6906c02"},
+    {HeaderKind::Counting, 0xFFFFFFFFULL,
+     "4944b509f65c7f368bce9ef062732d8c5faebc9f8569e33245756f7f6e2c6075",
+     0x555ce430ba8b6508ULL, 0x5073262e253c4aabULL, 0x1346b68dd4e063eaULL,
+     "4c3f3a4351a32dfe2862f2e2ddca5a61769edb3cc6f1bf486121e2ba49aebc57"},
+    {HeaderKind::Random, 0xFEDCBA9876543210ULL,
+     "22efd4024682272f221c6066665a4c8da958efaa1d6dd8c24bc5362aa6568cc0",
+     0xa5543b009709653dULL, 0x7e6755731f43b7aaULL, 0x44651cbf8ab91096ULL,
+     "d1c4b450493742e2eb8151998e80488e0a5137e81b7a09ea51d81f3b97a63592"},
+};
+
+static std::array<uint8_t, INPUT_SIZE> makeHeader(HeaderKind kind) {
+    std::array<uint8_t, INPUT_SIZE> header{};
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < header.size(); i++) {
+        if (kind == HeaderKind::Counting) {
+            header[i] = static_cast<uint8_t>(i);
+        } else if (kind == HeaderKind::Random) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            header[i] = static_cast<uint8_t>(state);
+        }
+    }
+    return header;
+}
+
+// Host-side input layout: what TosHash::search and Miner::verifySolution hash
+static std::array<uint8_t, INPUT_SIZE> makeInput(HeaderKind kind, uint64_t nonce) {
+    auto input = makeHeader(kind);
+    for (int i = 0; i < 8; i++) {
+        input[NONCE_OFFSET + i] = static_cast<uint8_t>(nonce >> ((7 - i) * 8));
+    }
+    return input;
+}
+
+static std::string label(size_t v) {
+    return "vector " + std::to_string(v);
+}
+
+static void checkTrace(const std::string& backend, size_t v, const Hash256& seed,
+                       uint64_t stage1, uint64_t stage2, uint64_t stage3, const Hash256& hash) {
+    const GoldenVector& golden = c_vectors[v];
+    std::string name = backend + " " + label(v) + ": ";
+    check(toHex(seed) == golden.seed, name + "Blake3 seed");
+    check(stage1 == golden.stage1 && stage2 == golden.stage2 && stage3 == golden.stage3,
+          name + "stage 1-3 scratchpad checksums");
+    check(toHex(hash) == golden.hash, name + "final hash");
+}
+
+static void testCpuReference() {
+    std::cout << "--- CPU reference ---\n";
+    TosHash hasher;
+    auto scratch = std::make_unique<ScratchPad>();
+
+    for (size_t v = 0; v < sizeof(c_vectors) / sizeof(c_vectors[0]); v++) {
+        auto input = makeInput(c_vectors[v].header, c_vectors[v].nonce);
+        TosHashTrace trace = hasher.trace(input.data(), *scratch);
+        checkTrace("CPU", v, trace.seed, trace.stage1, trace.stage2, trace.stage3, trace.hash);
+
+        // search() builds the input from the header itself
+        WorkPackage work;
+        auto header = makeHeader(c_vectors[v].header);
+        std::memcpy(work.header.data(), header.data(), INPUT_SIZE);
+        work.target.fill(0xFF);
+        Solution solution = hasher.search(work, c_vectors[v].nonce, *scratch);
+        check(toHex(solution.hash) == c_vectors[v].hash, "CPU " + label(v) + ": search() nonce layout");
+    }
+}
+
+static void testCudaDeviceCode() {
+    std::cout << "--- CUDA device code (host build) ---\n";
+
+    check(cuda::INPUT_SIZE == INPUT_SIZE && cuda::NONCE_OFFSET == NONCE_OFFSET && cuda::HASH_SIZE == HASH_SIZE,
+          "CUDA input size and nonce offset match the host");
+
+    // Blake3 against the reference library, across block boundaries
+    bool blake3Ok = true;
+    for (uint32_t len : {0u, 1u, 32u, 63u, 64u, 65u, 112u, 128u, 1024u}) {
+        std::vector<uint8_t> data(len);
+        for (uint32_t i = 0; i < len; i++) {
+            data[i] = static_cast<uint8_t>(i % 251);
+        }
+        uint8_t expected[32];
+        blake3_hasher hasher;
+        blake3_hasher_init(&hasher);
+        blake3_hasher_update(&hasher, data.data(), len);
+        blake3_hasher_finalize(&hasher, expected, 32);
+
+        uint8_t actual[32];
+        cuda::blake3_hash(data.data(), len, actual);
+        if (std::memcmp(expected, actual, 32) != 0) {
+            std::cout << "  Blake3 mismatch at length " << len << "\n";
+            blake3Ok = false;
+        }
+    }
+    check(blake3Ok, "CUDA Blake3 matches the reference for 0-1024 byte inputs");
+
+    std::vector<uint64_t> scratch(cuda::MEMORY_SIZE);
+    for (size_t v = 0; v < sizeof(c_vectors) / sizeof(c_vectors[0]); v++) {
+        auto header = makeHeader(c_vectors[v].header);
+
+        // Input as the kernel builds it from the uploaded header
+        uint8_t input[cuda::INPUT_SIZE];
+        cuda::prepare_input(header.data(), c_vectors[v].nonce, input);
+        auto expected = makeInput(c_vectors[v].header, c_vectors[v].nonce);
+        check(std::memcmp(input, expected.data(), INPUT_SIZE) == 0, "CUDA " + label(v) + ": input layout");
+
+        Hash256 seed;
+        cuda::blake3_hash(input, cuda::INPUT_SIZE, seed.data());
+        cuda::stage1_init(input, cuda::INPUT_SIZE, scratch.data());
+        uint64_t stage1 = cuda::scratch_checksum(scratch.data());
+        cuda::stage2_mix(scratch.data());
+        uint64_t stage2 = cuda::scratch_checksum(scratch.data());
+        cuda::stage3_strided(scratch.data());
+        uint64_t stage3 = cuda::scratch_checksum(scratch.data());
+
+        Hash256 hash;
+        cuda::toshash_hash(header.data(), c_vectors[v].nonce, scratch.data(), hash.data());
+        checkTrace("CUDA", v, seed, stage1, stage2, stage3, hash);
+    }
+}
+
+static const ScratchLayout c_layouts[] = {
+    ScratchLayout::Local, ScratchLayout::Contiguous, ScratchLayout::Interleaved, ScratchLayout::Blocked
+};
+
+static void testScratchLayouts() {
+    std::cout << "--- Scratchpad layouts ---\n";
+
+    // Every (work item, word) pair maps to its own slot of the global buffer
+    for (ScratchLayout layout : c_layouts) {
+        if (!scratchLayoutIsGlobal(layout)) {
+            continue;
+        }
+        for (size_t globalSize : {1u, 3u, 64u}) {
+            std::vector<bool> used(globalSize * TOSHASH_MEMORY_SIZE, false);
+            bool ok = true;
+            for (size_t item = 0; item < globalSize && ok; item++) {
+                for (size_t word = 0; word < TOSHASH_MEMORY_SIZE; word++) {
+                    size_t offset = scratchWordOffset(layout, item, word, globalSize, TOSHASH_MEMORY_SIZE);
+                    if (offset >= used.size() || used[offset]) {
+                        ok = false;
+                        break;
+                    }
+                    used[offset] = true;
+                }
+            }
+            check(ok, std::string(scratchLayoutName(layout)) + ": " + std::to_string(globalSize) +
+                      " work items fill the buffer without overlap");
+        }
+    }
+
+    // Neighbouring work items touch neighbouring words
+    check(scratchWordOffset(ScratchLayout::Interleaved, 1, 5, 64, TOSHASH_MEMORY_SIZE) ==
+          scratchWordOffset(ScratchLayout::Interleaved, 0, 5, 64, TOSHASH_MEMORY_SIZE) + 1,
+          "interleaved: adjacent work items are adjacent");
+    check(scratchWordOffset(ScratchLayout::Blocked, 0, 3, 64, TOSHASH_MEMORY_SIZE) ==
+          scratchWordOffset(ScratchLayout::Blocked, 0, 2, 64, TOSHASH_MEMORY_SIZE) + 1 &&
+          scratchWordOffset(ScratchLayout::Blocked, 1, 0, 64, TOSHASH_MEMORY_SIZE) == SCRATCH_BLOCK_WORDS,
+          "blocked: runs of " + std::to_string(SCRATCH_BLOCK_WORDS) + " words per work item");
+
+    bool namesOk = true;
+    for (ScratchLayout layout : c_layouts) {
+        ScratchLayout parsed = ScratchLayout::Local;
+        namesOk = namesOk && parseScratchLayout(scratchLayoutName(layout), parsed) && parsed == layout;
+    }
+    ScratchLayout unused;
+    check(namesOk && !parseScratchLayout("coalesced", unused), "Layout names round-trip");
+}
+
+#ifdef WITH_OPENCL
+// Kernel output stores hashes as four little-endian words
+static Hash256 fromWords(const uint64_t* words) {
+    Hash256 hash;
+    for (unsigned b = 0; b < HASH_SIZE; b++) {
+        hash[b] = static_cast<uint8_t>(words[b / 8] >> ((b % 8) * 8));
+    }
+    return hash;
+}
+
+// Trace and batch the golden vectors with the kernel built for one scratchpad layout
+static bool testOpenCLLayout(cl::Device& device, const std::string& source, ScratchLayout layout) {
+    std::string name = "OpenCL " + device.getInfo<CL_DEVICE_NAME>() + " [" + scratchLayoutName(layout) + "]";
+    try {
+        cl::Context context(device);
+        cl::CommandQueue queue(context, device);
+        cl::Program program(context, source);
+        std::string options = "-cl-std=CL1.2 -DSCRATCH_LAYOUT=" + std::to_string(static_cast<int>(layout)) +
+                              " -DSCRATCH_BLOCK=" + std::to_string(SCRATCH_BLOCK_WORDS);
+        try {
+            program.build(options.c_str());
+        } catch (const cl::Error&) {
+            std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << "\n";
+            check(false, name + ": kernel builds");
+            return false;
+        }
+
+        cl::Kernel trace(program, "toshash_trace");
+        cl::Kernel benchmark(program, "toshash_benchmark");
+        cl::Buffer headerBuffer(context, CL_MEM_READ_ONLY, INPUT_SIZE);
+        cl::Buffer output(context, CL_MEM_WRITE_ONLY, 11 * sizeof(uint64_t));
+        const unsigned batch = 4;
+        cl::Buffer hashes(context, CL_MEM_WRITE_ONLY, batch * 4 * sizeof(uint64_t));
+        cl::Buffer scratchBuffer(context, CL_MEM_READ_WRITE, batch * TOSHASH_MEMORY_SIZE * sizeof(uint64_t));
+
+        for (size_t v = 0; v < sizeof(c_vectors) / sizeof(c_vectors[0]); v++) {
+            auto header = makeHeader(c_vectors[v].header);
+            queue.enqueueWriteBuffer(headerBuffer, CL_TRUE, 0, INPUT_SIZE, header.data());
+
+            // Trace: [0..3] seed, [4..6] stage checksums, [7..10] hash
+            trace.setArg(0, output);
+            trace.setArg(1, headerBuffer);
+            trace.setArg(2, static_cast<cl_ulong>(c_vectors[v].nonce));
+            trace.setArg(3, scratchBuffer);
+            queue.enqueueNDRangeKernel(trace, cl::NullRange, cl::NDRange(1), cl::NDRange(1));
+            uint64_t words[11];
+            queue.enqueueReadBuffer(output, CL_TRUE, 0, sizeof(words), words);
+            checkTrace(name, v, fromWords(words), words[4], words[5], words[6], fromWords(words + 7));
+
+            // Mining path: one work item per nonce from start_nonce, sharing the scratch buffer
+            benchmark.setArg(0, hashes);
+            benchmark.setArg(1, headerBuffer);
+            benchmark.setArg(2, static_cast<cl_ulong>(c_vectors[v].nonce));
+            benchmark.setArg(3, 1u);
+            benchmark.setArg(4, scratchBuffer);
+            queue.enqueueNDRangeKernel(benchmark, cl::NullRange, cl::NDRange(batch), cl::NDRange(1));
+            uint64_t batchWords[batch * 4];
+            queue.enqueueReadBuffer(hashes, CL_TRUE, 0, sizeof(batchWords), batchWords);
+
+            TosHash hasher;
+            auto scratch = std::make_unique<ScratchPad>();
+            bool batchOk = true;
+            for (unsigned i = 0; i < batch; i++) {
+                auto input = makeInput(c_vectors[v].header, c_vectors[v].nonce + i);
+                Hash256 expected;
+                hasher.hash(input.data(), expected.data(), *scratch);
+                batchOk = batchOk && fromWords(batchWords + i * 4) == expected;
+            }
+            check(batchOk, name + " " + label(v) + ": batch of " + std::to_string(batch) + " nonces");
+        }
+        return true;
+
+    } catch (const cl::Error& e) {
+        check(false, name + ": OpenCL error " + std::string(e.what()) + " (" + std::to_string(e.err()) + ")");
+        return false;
+    }
+}
+
+// Returns the number of devices tested
+static unsigned testOpenCL() {
+    std::cout << "--- OpenCL kernel ---\n";
+
+    std::vector<cl::Platform> platforms;
+    try {
+        cl::Platform::get(&platforms);
+    } catch (const cl::Error&) {
+        // No ICD installed
+    }
+
+    unsigned tested = 0;
+    std::string source(reinterpret_cast<const char*>(toshash_cl_source), toshash_cl_source_len);
+
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_ALL, &devices);
+        } catch (const cl::Error&) {
+            continue;
+        }
+
+        for (auto& device : devices) {
+            bool ran = false;
+            for (ScratchLayout layout : c_layouts) {
+                ran = testOpenCLLayout(device, source, layout) || ran;
+            }
+            if (ran) {
+                tested++;
+            }
+        }
+    }
+
+    return tested;
+}
+#endif
+
+int main(int argc, char** argv) {
+    std::cout << "=== TOS Hash Conformance Test ===\n\n";
+
+    bool requireOpenCL = argc > 1 && std::string(argv[1]) == "--require-opencl";
+
+    testCpuReference();
+    testCudaDeviceCode();
+    testScratchLayouts();
+
+#ifdef WITH_OPENCL
+    unsigned devices = testOpenCL();
+#else
+    unsigned devices = 0;
+    std::cout << "--- OpenCL kernel ---\n";
+#endif
+    if (devices == 0) {
+        if (requireOpenCL) {
+            check(false, "OpenCL device available (install POCL to run the kernel on the CPU)");
+        } else {
+            std::cout << "[SKIP] No OpenCL device; install POCL to run the kernel on the CPU\n";
+        }
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Conformance test completed"
+                                   : "[FAIL] Conformance test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/**
+ * Test CPU monitoring against a fixture tree
+ *
+ * Builds fake powercap, thermal and cpufreq layouts in a temp directory
+ * and checks package power (including RAPL counter wraparound),
+ * temperature selection and frequency averaging.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include "../src/util/CpuMonitor.h"
+#include "../src/util/Sysfs.h"
+#include "TestUtil.h"
+
+using namespace tos;
+namespace fs = std::filesystem;
+
+// Rewrite in place (same inode), like the kernel updating an attribute
+static bool near(double value, double expected) {
+    return std::fabs(value - expected) < 0.01;
+}
+
+int main() {
+    std::cout << "=== CPU Monitor Test ===\n\n";
+
+    fs::path root = fs::temp_directory_path() / ("tosminer-cpu-" + std::to_string(::getpid()));
+    fs::remove_all(root);
+
+    // Two packages plus a core subzone that must not be double counted
+    fs::path rapl0 = root / "class/powercap/intel-rapl:0";
+    fs::path rapl1 = root / "class/powercap/intel-rapl:1";
+    writeFile(rapl0 / "name", "package-0\n");
+    writeFile(rapl0 / "energy_uj", "1000000\n");
+    writeFile(rapl0 / "max_energy_range_uj", "262143328850\n");
+    writeFile(root / "class/powercap/intel-rapl:0:0/name", "core\n");
+    writeFile(root / "class/powercap/intel-rapl:0:0/energy_uj", "500000\n");
+    writeFile(rapl1 / "name", "package-1\n");
+    writeFile(rapl1 / "energy_uj", "262143000000\n");
+    writeFile(rapl1 / "max_energy_range_uj", "262143328850\n");
+
+    // Platform (psys) zone covers the packages and more; it must not be added
+    writeFile(root / "class/powercap/intel-rapl:2/name", "psys\n");
+    writeFile(root / "class/powercap/intel-rapl:2/energy_uj", "7000000\n");
+    writeFile(root / "class/powercap/intel-rapl:2/max_energy_range_uj", "262143328850\n");
+
+    // A CPU zone and a cooler ACPI zone; only the CPU zone counts
+    writeFile(root / "class/thermal/thermal_zone0/type", "acpitz\n");
+    writeFile(root / "class/thermal/thermal_zone0/temp", "91000\n");
+    writeFile(root / "class/thermal/thermal_zone1/type", "x86_pkg_temp\n");
+    writeFile(root / "class/thermal/thermal_zone1/temp", "67500\n");
+    writeFile(root / "class/thermal/cooling_device0/type", "Processor\n");
+
+    // Two CPUs with cpufreq, cpuidle directory without
+    writeFile(root / "devices/system/cpu/cpu0/cpufreq/scaling_cur_freq", "3400000\n");
+    writeFile(root / "devices/system/cpu/cpu1/cpufreq/scaling_cur_freq", "2600000\n");
+    fs::create_directories(root / "devices/system/cpu/cpuidle");
+
+    Sysfs::setRoot(root.string());
+
+    CpuMonitor monitor;
+    check(monitor.init(), "Fixture sensors found");
+
+    auto t0 = std::chrono::steady_clock::now();
+    CpuStats stats = monitor.sample(t0);
+    check(stats.valid, "Stats valid");
+    check(stats.packages == 2, "Two RAPL packages (subzone and psys skipped)");
+    check(stats.packagePower < 0, "No power before a second sample");
+    check(stats.temperature == 67, "Temperature from the CPU zone only");
+    check(stats.frequency == 3000 && stats.frequencyMax == 3400, "Frequency averaged over CPUs");
+
+    // Package 0: +50 J. Package 1 wraps: 328850 uj to the top, then 29671150 uj.
+    writeFile(rapl0 / "energy_uj", "51000000\n");
+    writeFile(rapl1 / "energy_uj", "29671150\n");
+    writeFile(root / "class/powercap/intel-rapl:2/energy_uj", "107000000\n");
+    writeFile(root / "class/thermal/thermal_zone1/temp", "72000\n");
+
+    stats = monitor.sample(t0 + std::chrono::seconds(2));
+    std::cout << "  power " << stats.packagePower << " W, energy " << stats.energy << " J\n";
+    check(near(stats.packagePower, 40.0), "Power from energy delta (80 J over 2 s, with wraparound)");
+    check(near(stats.energy, 80.0), "Energy accumulated");
+    check(stats.temperature == 72, "Temperature updated through the persistent handle");
+    check(monitor.getStats().packagePower == stats.packagePower, "getStats returns the last sample");
+
+    // Idle interval
+    stats = monitor.sample(t0 + std::chrono::seconds(4));
+    check(near(stats.packagePower, 0.0), "No energy used reads as zero watts");
+
+    monitor.shutdown();
+    check(!monitor.isAvailable(), "Shutdown releases sensors");
+
+    // Empty tree: nothing found, sample is a no-op
+    fs::path empty = root / "empty";
+    fs::create_directories(empty);
+    Sysfs::setRoot(empty.string());
+    CpuMonitor none;
+    check(!none.init(), "No sensors in an empty tree");
+    check(!none.sample().valid, "Sample without sensors is invalid");
+
+    Sysfs::setRoot("/sys");
+    fs::remove_all(root);
+
+    std::cout << "\n" << (g_passed ? "[PASS] CPU monitor test completed" : "[FAIL] CPU monitor test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+/**
+ * Test device timelines from profiling timestamps
+ *
+ * Simulated batches with known kernel, readback and idle times must land
+ * in the right histogram buckets; overlapping and late-recorded kernels
+ * count as no gap. Device timestamps are mapped to the host clock with
+ * the closest enqueue offset, and the recent batch ring keeps the newest
+ * entries oldest first.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/core/DeviceTimeline.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+using Clock = std::chrono::steady_clock;
+
+// Device clock starts at 5 s; host enqueue happens 1 us before QUEUED
+static const Clock::time_point HOST_BASE = Clock::time_point(std::chrono::seconds(1000));
+static const uint64_t DEVICE_BASE = 5000000000ULL;
+
+// Batch whose kernel runs [start, start + kernel) after a 20 us launch delay
+static BatchTiming batch(uint64_t index, uint64_t start, uint64_t kernel, uint64_t transfer) {
+    BatchTiming b;
+    b.startNonce = index * 1000;
+    b.size = 1000;
+    b.slot = static_cast<unsigned>(index % 2);
+    b.kernel = {start - 20000, start - 10000, start, start + kernel};
+    if (transfer > 0) {
+        b.read = {start - 15000, start + kernel + 1000, start + kernel + 2000, start + kernel + 2000 + transfer};
+    }
+    return b;
+}
+
+static Clock::time_point enqueued(const BatchTiming& b, uint64_t lag = 1000) {
+    return HOST_BASE + std::chrono::nanoseconds(b.kernel.queued - DEVICE_BASE - lag);
+}
+
+// Number of observations in the bucket whose upper bound is bound seconds
+static uint64_t bucket(const HistogramSnapshot& h, double bound) {
+    for (size_t i = 0; i < h.bounds.size(); i++) {
+        if (h.bounds[i] > bound * 0.999 && h.bounds[i] < bound * 1.001) {
+            return h.counts[i];
+        }
+    }
+    return UINT64_MAX;
+}
+
+static void testHistograms() {
+    std::cout << "--- Histograms ---\n";
+    DeviceTimeline timeline;
+
+    // Back to back 50 ms kernels, 500 us readbacks, then a 3 ms host stall
+    uint64_t t = DEVICE_BASE;
+    for (uint64_t i = 0; i < 4; i++) {
+        BatchTiming b = batch(i, t, 50000000, 500000);
+        timeline.record(b, enqueued(b));
+        t += 50000000;
+    }
+    t += 3000000;
+    BatchTiming late = batch(4, t, 50000000, 500000);
+    timeline.record(late, enqueued(late));
+
+    TimelineStats stats = timeline.stats();
+    check(stats.kernel.count == 5 && bucket(stats.kernel, 0.0512) == 5, "Kernel times in the 51.2 ms bucket");
+    check(stats.transfer.count == 5 && bucket(stats.transfer, 0.00064) == 5, "Readbacks in the 640 us bucket");
+    check(stats.idle.count == 4 && bucket(stats.idle, 0.00001) == 3, "Back to back kernels have no gap");
+    check(bucket(stats.idle, 0.00512) == 1, "Host stall lands in the 5.12 ms bucket");
+    check(stats.idle.sum > 0.0029 && stats.idle.sum < 0.0031, "Idle sum is the stall");
+    check(stats.kernel.bounds.front() < 0.00011 && stats.transfer.bounds.front() < 0.000011,
+          "Device buckets start below a millisecond");
+
+    // Kernel that finished before the last one recorded: no gap
+    BatchTiming early = batch(5, DEVICE_BASE + 10000000, 1000000, 0);
+    timeline.record(early, enqueued(early));
+    stats = timeline.stats();
+    check(stats.kernel.count == 6 && stats.idle.count == 4 && stats.transfer.count == 5,
+          "Late-recorded kernel adds no gap; missing readback adds no transfer");
+
+    // Overlapping kernel (out-of-order queue) counts as no gap
+    BatchTiming overlap = batch(6, t + 40000000, 50000000, 0);
+    timeline.record(overlap, enqueued(overlap));
+    stats = timeline.stats();
+    check(stats.idle.count == 5 && bucket(stats.idle, 0.00001) == 4, "Overlapping kernel counts as no gap");
+
+    // Incomplete timestamps are ignored
+    BatchTiming broken = batch(7, t + 200000000, 1000, 0);
+    broken.kernel.end = broken.kernel.start - 1;
+    timeline.record(broken, enqueued(broken));
+    check(timeline.stats().kernel.count == 7, "Incomplete kernel timestamps ignored");
+}
+
+static void testHostTime() {
+    std::cout << "--- Host time ---\n";
+    DeviceTimeline timeline;
+    int64_t host = std::chrono::duration_cast<std::chrono::nanoseconds>(HOST_BASE.time_since_epoch()).count();
+
+    // First batch enqueued 30 us before QUEUED, later ones 1 us: the closest wins
+    BatchTiming first = batch(0, DEVICE_BASE + 100000, 1000000, 0);
+    timeline.record(first, enqueued(first, 30000));
+    BatchTiming second = batch(1, DEVICE_BASE + 2000000, 1000000, 100000);
+    timeline.record(second, enqueued(second));
+
+    auto recent = timeline.recent();
+    check(recent.size() == 2 && recent[0].startNonce == 0 && recent[1].startNonce == 1000, "Batches oldest first");
+    check(recent.size() == 2 && recent[1].kernel.start == static_cast<uint64_t>(host + 2000000 - 1000),
+          "Device time mapped with the closest offset");
+    check(recent.size() == 2 && recent[0].read.end == 0 && recent[1].read.start > recent[1].kernel.end,
+          "Readback mapped, missing readback stays zero");
+
+    // A new device clock (reinit) starts from scratch
+    timeline.restart();
+    BatchTiming reset = batch(2, 27000, 1000000, 0);
+    timeline.record(reset, HOST_BASE);
+    recent = timeline.recent();
+    check(recent.back().kernel.queued == static_cast<uint64_t>(host) && timeline.stats().idle.count == 1,
+          "Restart forgets the device clock (no gap to the old one)");
+}
+
+static void testRing() {
+    std::cout << "--- Recent ring ---\n";
+    DeviceTimeline timeline;
+    uint64_t t = DEVICE_BASE;
+    size_t total = DeviceTimeline::RECENT + 10;
+    for (uint64_t i = 0; i < total; i++) {
+        BatchTiming b = batch(i, t, 100000, 0);
+        timeline.record(b, enqueued(b));
+        t += 200000;
+    }
+
+    auto recent = timeline.recent();
+    bool ordered = true;
+    for (size_t i = 1; i < recent.size(); i++) {
+        ordered = ordered && recent[i].startNonce == recent[i - 1].startNonce + 1000;
+    }
+    check(recent.size() == DeviceTimeline::RECENT, "Ring keeps the newest batches");
+    check(ordered && recent.front().startNonce == 10 * 1000, "Ring returned oldest first");
+    check(timeline.stats().kernel.count == total, "Histograms count every batch");
+}
+
+int main() {
+    std::cout << "=== Device Timeline Test ===\n\n";
+
+    testHistograms();
+    testHostTime();
+    testRing();
+
+    std::cout << "\n" << (g_passed ? "[PASS] Device timeline test completed"
+                                   : "[FAIL] Device timeline test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
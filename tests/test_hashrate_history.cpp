@@ -0,0 +1,144 @@
+/**
+ * Test the multi-resolution hash rate history
+ *
+ * DeltaRing must reconstruct values far beyond the int32 range from
+ * 32-bit deltas, clamp deltas that overflow while staying consistent,
+ * and evict oldest first. HashRateHistory must roll samples up into
+ * coarser tiers, evict per tier, and average windows from the right tier.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "../src/util/HashRateHistory.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+static bool near(double a, double b) {
+    return std::fabs(a - b) < 1e-6 * std::max(1.0, std::fabs(b));
+}
+
+static void testDeltaRing() {
+    std::cout << "--- Delta ring ---\n";
+
+    // Large absolute values with small steps: only deltas are 32-bit
+    DeltaRing ring(8);
+    std::vector<int64_t> expected;
+    for (int64_t i = 0; i < 5; i++) {
+        int64_t value = 5000000000000LL + i * 1000 - (i % 2) * 3000;
+        ring.push(value);
+        expected.push_back(value);
+    }
+    check(ring.size() == 5 && ring.values() == expected, "Values beyond int32 reconstructed from deltas");
+    check(near(ring.averageNewest(2), (expected[3] + expected[4]) / 2.0), "Average of the newest samples");
+
+    // Steps beyond int32 are clamped; later samples stay consistent with what was stored
+    const int64_t maxDelta = std::numeric_limits<int32_t>::max();
+    const int64_t minDelta = std::numeric_limits<int32_t>::min();
+    DeltaRing clamped(8);
+    clamped.push(0);
+    clamped.push(10000000000LL);
+    clamped.push(maxDelta + 5);
+    clamped.push(-10000000000LL);
+    std::vector<int64_t> values = clamped.values();
+    check(values.size() == 4 && values[1] == maxDelta, "Upward overflow clamped to INT32_MAX");
+    check(values.size() == 4 && values[2] == maxDelta + 5, "Next sample exact relative to the clamped value");
+    check(values.size() == 4 && values[3] == maxDelta + 5 + minDelta, "Downward overflow clamped to INT32_MIN");
+    check(near(clamped.averageNewest(1), static_cast<double>(maxDelta + 5 + minDelta)),
+          "Newest value tracks the stored value");
+
+    // Full ring: oldest evicted first, base value moves forward
+    DeltaRing small(4);
+    for (int64_t v = 1; v <= 10; v++) {
+        small.push(v * 100);
+    }
+    check(small.size() == 4 && small.capacity() == 4, "Size capped at capacity");
+    check(small.values() == std::vector<int64_t>({700, 800, 900, 1000}), "Oldest samples evicted");
+    check(near(small.averageNewest(2), 950) && near(small.averageNewest(100), 850),
+          "Average clipped to the samples held");
+
+    DeltaRing none;
+    none.push(42);
+    check(none.size() == 0 && none.values().empty() && none.averageNewest(1) == 0, "Zero-capacity ring stays empty");
+}
+
+static void testTiers() {
+    std::cout << "--- Tiers ---\n";
+    HashRateHistory history;
+
+    check(history.resolution(0) == 1 && history.resolution(1) == 10 && history.resolution(2) == 60 &&
+          history.resolution(3) == 900 && history.resolution(4) == 3600, "Tier resolutions");
+    check(history.findTier(60) == 2 && history.findTier(5) == -1, "Tier lookup by resolution");
+
+    // Ramp: each tier holds the averages of complete groups of the one below
+    const int total = 1200;
+    for (int i = 0; i < total; i++) {
+        history.add(i);
+    }
+
+    std::vector<int64_t> fine = history.samples(0);
+    check(fine.size() == 300 && fine.front() == total - 300 && fine.back() == total - 1,
+          "Finest tier keeps the newest 300 samples");
+
+    std::vector<int64_t> tens = history.samples(1);
+    check(tens.size() == 120 && tens.front() == std::llround(4.5) && tens.back() == std::llround(1194.5),
+          "10 s tier holds rounded group averages");
+
+    std::vector<int64_t> minutes = history.samples(2);
+    check(minutes.size() == 20 && minutes.front() == std::llround(29.5) && minutes.back() == std::llround(1169.5),
+          "1 min tier averages unrounded 10 s averages");
+    check(history.samples(3).size() == 1 && history.samples(4).empty() && history.samples(9).empty(),
+          "Only complete groups roll up; missing tiers empty");
+
+    // Windows come from the finest tier that covers them
+    check(near(history.average(10), (1190 + 1199) / 2.0), "10 s window from the 1 s tier");
+    // Newest 60 ten-second samples: groups 60..119 stored as 10k + 5
+    check(near(history.average(600), (605 + 1195) / 2.0), "10 min window from the 10 s tier");
+
+    // A coarse tier with no samples yet falls back to all of a finer one
+    HashRateHistory young;
+    for (int i = 1; i <= 5; i++) {
+        young.add(i * 1000.4);
+    }
+    check(young.samples(0) == std::vector<int64_t>({1000, 2001, 3001, 4002, 5002}), "Rates quantized to whole H/s");
+    check(near(young.average(3600), 3001.2) && near(young.windows().h24, 3001.2),
+          "Long windows use what history exists");
+}
+
+static void testEviction() {
+    std::cout << "--- Tier eviction ---\n";
+    HashRateHistory history;
+
+    // 2 h at 1000 H/s, then 10 min at 3000 H/s
+    for (int i = 0; i < 7200; i++) {
+        history.add(1000);
+    }
+    for (int i = 0; i < 600; i++) {
+        history.add(3000);
+    }
+
+    check(history.samples(1).size() == 360 && history.samples(2).size() == 130, "10 s tier evicts at capacity, 1 min tier still filling");
+    std::vector<int64_t> tens = history.samples(1);
+    check(tens.front() == 1000 && tens.back() == 3000, "10 s tier spans the step");
+
+    HashRateWindows w = history.windows();
+    check(near(w.s10, 3000) && near(w.m1, 3000), "Short windows see only the new rate");
+    check(near(w.m15, (5 * 1000 + 10 * 3000) / 15.0), "15 min window mixes both rates");
+    check(near(w.h1, (300 * 1000 + 60 * 3000) / 360.0), "1 h window from the full 10 s tier");
+}
+
+int main() {
+    std::cout << "=== Hash Rate History Test ===\n\n";
+
+    testDeltaRing();
+    testTiers();
+    testEviction();
+
+    std::cout << "\n" << (g_passed ? "[PASS] Hash rate history test completed"
+                                   : "[FAIL] Hash rate history test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,215 @@
+/**
+ * Test host load monitoring and CPU thread parking
+ *
+ * Parses fixture /proc/pressure/cpu and /proc/loadavg files, then drives
+ * the host load governor with simulated tenants and checks that it
+ * yields quickly, returns slowly and respects the CPU share budget.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <unistd.h>
+#include "../src/core/HostLoadGovernor.h"
+#include "../src/util/HostLoad.h"
+#include "TestUtil.h"
+
+using namespace tos;
+namespace fs = std::filesystem;
+
+static HostLoad psi(double some10, double load1 = -1) {
+    HostLoad load;
+    load.psiSome10 = some10;
+    load.psiSome60 = some10;
+    load.load1 = load1;
+    load.valid = true;
+    return load;
+}
+
+static HostLoad tasks(int runnable, double load1 = -1) {
+    HostLoad load = psi(-1, load1);
+    load.runnable = runnable;
+    return load;
+}
+
+int main() {
+    std::cout << "=== Host Load Test ===\n\n";
+
+    // Fixture procfs
+    {
+        fs::path root = fs::temp_directory_path() / ("tosminer-proc-" + std::to_string(::getpid()));
+        fs::remove_all(root);
+        writeFile(root / "pressure/cpu",
+                  "some avg10=12.50 avg60=4.25 avg300=1.00 total=123456\n"
+                  "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+        writeFile(root / "loadavg", "9.52 8.58 7.59 11/1234 56789\n");
+
+        HostLoadMonitor monitor(root.string());
+        check(monitor.isAvailable() && monitor.hasPressure(), "Fixture PSI and loadavg found");
+
+        HostLoad load = monitor.sample();
+        check(load.valid, "Sample valid");
+        check(load.psiSome10 == 12.5 && load.psiSome60 == 4.25, "PSI some averages parsed");
+        check(load.load1 == 9.52 && load.runnable == 11, "Load average and runnable tasks parsed");
+
+        // Updated in place, re-read through the open handle
+        writeFile(root / "pressure/cpu", "some avg10=0.10 avg60=0.20 avg300=0.30 total=123999\n");
+        check(monitor.sample().psiSome10 == 0.1, "PSI re-read after update");
+
+        // Kernel without PSI
+        fs::remove(root / "pressure/cpu");
+        HostLoadMonitor noPsi(root.string());
+        load = noPsi.sample();
+        check(!noPsi.hasPressure() && noPsi.isAvailable(), "Load average without PSI");
+        check(load.psiSome10 < 0 && load.load1 == 9.52, "Missing PSI reads as unavailable");
+
+        fs::remove_all(root);
+    }
+
+    std::vector<unsigned> miners = {2, 3, 4, 5, 6, 7, 8, 9};   // Farm indices after two GPUs
+    std::set<unsigned> parked;
+    auto actuator = [&](unsigned index, bool park) {
+        if (park) {
+            parked.insert(index);
+        } else {
+            parked.erase(index);
+        }
+    };
+
+    // CPU share budget alone: 50% of 8 CPUs = 4 threads, applied on the first tick
+    {
+        parked.clear();
+        HostLoadConfig config;
+        config.cpuShare = 50;
+        HostLoadGovernor governor(config, miners, 8, actuator);
+        check(governor.getBudget() == 4, "Budget from CPU share");
+
+        governor.update(psi(0));
+        check(governor.getActiveThreads() == 4 && parked == std::set<unsigned>({6, 7, 8, 9}),
+              "Threads beyond the budget parked, highest first");
+
+        for (int t = 0; t < 100; t++) {
+            governor.update(psi(50));
+        }
+        check(governor.getActiveThreads() == 4, "Without --host-aware load is ignored");
+    }
+
+    // Tenants arrive, stay for a while, then leave
+    {
+        parked.clear();
+        HostLoadConfig config;
+        config.hostAware = true;
+        HostLoadGovernor governor(config, miners, 8, actuator);
+        governor.update(psi(0));
+        check(governor.getActiveThreads() == 8, "Full budget when idle");
+
+        // Pressure while the miner competes: shrink fast
+        unsigned ticksToYield = 0;
+        for (int t = 1; t <= 60 && governor.getActiveThreads() > 2; t++) {
+            governor.update(psi(30));
+            ticksToYield = t;
+        }
+        std::cout << "  yielded to 2 threads after " << ticksToYield << " ticks\n";
+        check(governor.getActiveThreads() <= 2 && ticksToYield <= 30, "Parks threads quickly under pressure");
+
+        // Short idle gaps between tenant bursts do not bring threads back
+        unsigned before = governor.getActiveThreads();
+        for (int t = 0; t < 60; t++) {
+            governor.update(psi(t % 20 < 15 ? 1.0 : 5.0));
+        }
+        check(governor.getActiveThreads() == before, "Holds through short idle gaps");
+
+        // Sustained idle: one thread back per growTicks
+        for (unsigned t = 0; t < config.growTicks * 3; t++) {
+            governor.update(psi(0.5));
+        }
+        check(governor.getActiveThreads() == before + 3, "Unparks one thread per growTicks of idle");
+
+        for (unsigned t = 0; t < config.growTicks * 20; t++) {
+            governor.update(psi(0.5));
+        }
+        check(governor.getActiveThreads() == 8 && parked.empty(), "Returns to the full budget");
+    }
+
+    // Minimum threads
+    {
+        parked.clear();
+        HostLoadConfig config;
+        config.hostAware = true;
+        config.minThreads = 3;
+        HostLoadGovernor governor(config, miners, 8, actuator);
+        for (int t = 0; t < 200; t++) {
+            governor.update(psi(90));
+        }
+        check(governor.getActiveThreads() == 3 && parked.size() == 5, "Never parks below --host-min-threads");
+    }
+
+    // Runnable tasks only (no PSI): load from other tasks drives parking
+    {
+        parked.clear();
+        HostLoadConfig config;
+        config.hostAware = true;
+        HostLoadGovernor governor(config, miners, 8, actuator);
+        governor.update(tasks(17));
+
+        // 8 miner threads + 8 tenant processes + the sampler, 1.0 per CPU from
+        // others; the 1 minute average lags far behind and is not used
+        for (int t = 0; t < 5; t++) {
+            governor.update(tasks(8 + governor.getActiveThreads() + 1, 2.0));
+        }
+        check(governor.getActiveThreads() == 6, "Runnable load above threshold parks a quarter");
+
+        // Tenants gone: parked threads are not counted, even with a stale load1
+        // still including them
+        for (int t = 0; t < 200; t++) {
+            governor.update(tasks(governor.getActiveThreads() + 1, 16.0));
+        }
+        check(governor.getActiveThreads() == 8, "Own threads do not count as other load");
+    }
+
+    // One busy tick among idle ones does not park threads
+    {
+        parked.clear();
+        HostLoadConfig config;
+        config.hostAware = true;
+        HostLoadGovernor governor(config, miners, 8, actuator);
+        governor.update(tasks(9));
+        for (int t = 0; t < 40; t++) {
+            governor.update(tasks(t % 10 == 9 ? 9 + 6 : 9));
+        }
+        check(governor.getActiveThreads() == 8, "Short runnable spikes are smoothed out");
+    }
+
+    // Load average only: ignored until it can reflect the last change
+    {
+        parked.clear();
+        HostLoadConfig config;
+        config.hostAware = true;
+        HostLoadGovernor governor(config, miners, 8, actuator);
+        governor.update(psi(-1, 16.0));
+
+        int ticks = 0;
+        while (governor.getActiveThreads() == 8 && ticks < 200) {
+            governor.update(psi(-1, 16.0));
+            ticks++;
+        }
+        check(governor.getActiveThreads() == 6 && ticks == static_cast<int>(HostLoadGovernor::LOAD1_SETTLE_TICKS),
+              "Load average acts once settled");
+
+        // Still 16: the average has not caught up with the parked threads yet
+        for (unsigned t = 0; t + 1 < HostLoadGovernor::LOAD1_SETTLE_TICKS; t++) {
+            governor.update(psi(-1, 16.0));
+        }
+        check(governor.getActiveThreads() == 6, "No further parking while the average settles");
+
+        // Settled at the miner's own load: idle again, threads come back
+        for (int t = 0; t < 400; t++) {
+            governor.update(psi(-1, governor.getActiveThreads()));
+        }
+        check(governor.getActiveThreads() == 8, "Settled load average lets threads return");
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Host load test completed" : "[FAIL] Host load test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/**
+ * Test GPU result integrity sampling
+ *
+ * Simulated devices report easy-target hits the way the GPU kernels do:
+ * a correct device reports real hits, a faulty one reports wrong nonces
+ * and a lazy one counts more hashes than it computes. Checks that faults
+ * are caught within a few batches, that the hash rate estimate follows
+ * the hit yield, and that easy-target hits are never submitted.
+ */
+
+#include <iostream>
+#include <random>
+#include "../src/core/Miner.h"
+#include "../src/toshash/TosHash.h"
+#include "../src/util/Log.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+// Report one batch of results to integrity sampling, as the GPU miners do
+static void batch(FakeMiner& device, const WorkPackage& work, uint64_t hashes, unsigned bits,
+                  const std::vector<uint64_t>& nonces) {
+    std::vector<uint32_t> pairs;
+    for (uint64_t nonce : nonces) {
+        pairs.push_back(static_cast<uint32_t>(nonce));
+        pairs.push_back(static_cast<uint32_t>(nonce >> 32));
+    }
+    device.checkIntegrity(work, hashes, bits, static_cast<uint32_t>(nonces.size()), pairs.data(),
+                          static_cast<uint32_t>(nonces.size()));
+}
+
+int main() {
+    std::cout << "=== Integrity Sampling Test ===\n\n";
+
+    Log::setLevel(LogLevel::Error);
+
+    // Easy target sizing
+    check(Miner::integrityBits(16384) == 12 && Miner::integrityBits(65536) == 14 && Miner::integrityBits(3) == 1,
+          "About four hits per batch");
+    Hash256 target = Miner::integrityTarget(12);
+    check(target[0] == 0x00 && target[1] == 0x0F && target[2] == 0xFF && target[31] == 0xFF,
+          "12-bit target clears the top 12 bits");
+
+    // Work that no hash can solve: any submission would be an easy-target leak
+    WorkPackage work;
+    std::mt19937_64 rng(7);
+    for (auto& byte : work.header) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    work.target.fill(0);
+    work.valid = true;
+
+    // Real easy-target hits at 3 bits (1 in 8), computed on the CPU
+    const unsigned bits = 3;
+    const uint64_t batchSize = 32;
+    FakeMiner reference(99, MinerType::OpenCL, "Sim");
+    Hash256 easy = Miner::integrityTarget(bits);
+    std::vector<std::vector<uint64_t>> batches;   // Hits per batch of batchSize nonces
+    std::vector<uint64_t> misses;                 // Nonces that do not meet the easy target
+    for (uint64_t start = 0; start < batchSize * 40; start += batchSize) {
+        std::vector<uint64_t> hits;
+        for (uint64_t nonce = start; nonce < start + batchSize; nonce++) {
+            if (meetsTarget(reference.computeHash(work, nonce), easy)) {
+                hits.push_back(nonce);
+            } else {
+                misses.push_back(nonce);
+            }
+        }
+        batches.push_back(hits);
+    }
+
+    Miner::setIntegritySample(100);
+
+    // Correct device: every sample passes, yield near 1
+    {
+        FakeMiner device(0, MinerType::OpenCL, "Sim");
+        unsigned submitted = 0;
+        device.setSolutionCallback([&](const Solution&, const std::string&) { submitted++; });
+        for (const auto& hits : batches) {
+            batch(device, work, batchSize, bits, hits);
+        }
+        DeviceHealth health = device.getHealth();
+        std::cout << "  correct: " << health.integrityHits << " hits, " << health.integrityExpected
+                  << " expected, ratio " << health.getIntegrityRatio() << "\n";
+        check(health.integrityChecked == health.integrityHits && health.integrityFailed == 0,
+              "Correct device passes every check");
+        check(health.getIntegrityRatio() > 0.75 && health.getIntegrityRatio() < 1.25, "Hit yield near 1");
+        check(health.status == HealthStatus::Healthy, "Correct device stays healthy");
+        check(submitted == 0, "Easy-target hits are never submitted");
+    }
+
+    // Faulty device: wrong hashes, so its reported hits fail CPU verification
+    {
+        FakeMiner device(1, MinerType::OpenCL, "Sim");
+        unsigned batchesToFail = 0;
+        for (size_t b = 0; b < batches.size() && device.getHealthStatus() != HealthStatus::Failed; b++) {
+            std::vector<uint64_t> wrong(misses.begin() + b * 4, misses.begin() + b * 4 + 4);
+            batch(device, work, batchSize, bits, wrong);
+            batchesToFail = static_cast<unsigned>(b + 1);
+        }
+        std::cout << "  faulty device failed after " << batchesToFail << " batches\n";
+        check(device.getHealthStatus() == HealthStatus::Failed && batchesToFail <= 5,
+              "Faulty device marked failed within 5 batches");
+        check(device.getHealth().getIntegrityRatio() < 0.1, "Integrity ratio near 0");
+
+        device.resetHealth();
+        check(device.getHealthStatus() == HealthStatus::Healthy && device.getHealth().integrityChecked == 0,
+              "Recovery resets integrity history");
+    }
+
+    // Lazy device: claims twice the hashes it computes
+    {
+        FakeMiner device(2, MinerType::OpenCL, "Sim");
+        for (const auto& hits : batches) {
+            batch(device, work, batchSize * 2, bits, hits);
+        }
+        double ratio = device.getHealth().getIntegrityRatio();
+        std::cout << "  lazy device ratio " << ratio << "\n";
+        check(ratio > 0.35 && ratio < 0.65, "Lazy device estimated at half its counted rate");
+    }
+
+    // Sampling a fraction; off means nothing is checked
+    {
+        Miner::setIntegritySample(25);
+        FakeMiner device(3, MinerType::OpenCL, "Sim");
+        uint64_t reported = 0;
+        for (const auto& hits : batches) {
+            batch(device, work, batchSize, bits, hits);
+            reported += hits.size();
+        }
+        uint64_t checked = device.getHealth().integrityChecked;
+        check(checked == reported / 4, "25% of hits re-hashed (" + std::to_string(checked) + " of " +
+              std::to_string(reported) + ")");
+
+        Miner::setIntegritySample(0);
+        FakeMiner off(4, MinerType::OpenCL, "Sim");
+        batch(off, work, batchSize, bits, batches[0]);
+        check(off.getHealth().integrityChecked == 0 && off.getHealth().integrityHits == 0, "Sampling off");
+    }
+
+    // Job switch: a batch of the previous job finishing late is verified
+    // against that job and submitted with its id
+    {
+        WorkPackage previous = work;
+        previous.target = easy;
+        previous.jobId = "old";
+        WorkPackage current = work;
+        current.jobId = "new";
+
+        FakeMiner device(5, MinerType::OpenCL, "Sim");
+        std::vector<std::string> jobs;
+        device.setSolutionCallback([&](const Solution&, const std::string& jobId) { jobs.push_back(jobId); });
+        device.setWork(current);
+
+        uint64_t hit = batches[0].empty() ? batches[1][0] : batches[0][0];
+        check(device.verifySolution(hit, previous) && jobs.size() == 1 && jobs[0] == "old",
+              "Previous job's solution submitted for that job");
+        check(!device.verifySolution(hit, current) && jobs.size() == 1, "Same nonce fails the current job's target");
+        check(device.verifySolution(hit, previous) && jobs.size() == 2,
+              "Previous job's nonces are not held against the current job");
+        check(device.getHealth().duplicateSolutions == 0, "No duplicates recorded across jobs");
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Integrity sampling test completed"
+                                   : "[FAIL] Integrity sampling test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
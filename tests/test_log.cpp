@@ -0,0 +1,205 @@
+/**
+ * Test rate-limited logging
+ *
+ * Messages on one site draw from a token bucket: the burst passes, the
+ * rest are counted and reported as one "similar message(s) suppressed"
+ * line, either before the next admitted message or by flushSuppressed()
+ * once the bucket has refilled. When MAX_SITES sites are tracked, idle
+ * sites are dropped; drained sites and sites with pending suppressions
+ * are kept so a storm cannot earn a fresh burst.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "../src/util/Log.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+/**
+ * Captures log output (stdout and stderr) while alive
+ */
+class Capture {
+public:
+    Capture()
+        : m_out(std::cout.rdbuf(m_buffer.rdbuf()))
+        , m_err(std::cerr.rdbuf(m_buffer.rdbuf()))
+    {}
+
+    ~Capture() { release(); }
+
+    std::string release() {
+        if (m_out) {
+            std::cout.rdbuf(m_out);
+            std::cerr.rdbuf(m_err);
+            m_out = nullptr;
+        }
+        return m_buffer.str();
+    }
+
+private:
+    std::ostringstream m_buffer;
+    std::streambuf* m_out;
+    std::streambuf* m_err;
+};
+
+static size_t countOf(const std::string& text, const std::string& what) {
+    size_t count = 0;
+    for (size_t pos = 0; (pos = text.find(what, pos)) != std::string::npos; pos += what.size()) {
+        count++;
+    }
+    return count;
+}
+
+static void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static void testTokenBucket() {
+    std::cout << "--- Token bucket ---\n";
+
+    // Burst of 3, one token every 50 ms
+    Log::setRateLimit(LogCategory::Network, 3, 20.0);
+
+    Capture capture;
+    for (int i = 0; i < 5; i++) {
+        Log::limited(LogLevel::Info, LogCategory::Network, "net", "reconnect " + std::to_string(i));
+    }
+    std::string burst = capture.release();
+    check(countOf(burst, "reconnect") == 3 && countOf(burst, "reconnect 3") == 0, "Burst passes, the rest dropped");
+    check(countOf(burst, "suppressed") == 0, "No summary while the bucket is empty");
+
+    // Refill: the next admitted message is preceded by the summary
+    sleepMs(120);
+    Capture next;
+    Log::limited(LogLevel::Info, LogCategory::Network, "net", "reconnect 5");
+    Log::limited(LogLevel::Info, LogCategory::Network, "net", "reconnect 6");
+    std::string refilled = next.release();
+    size_t summary = refilled.find("2 similar message(s) suppressed [net]");
+    check(summary != std::string::npos && summary < refilled.find("reconnect 5"),
+          "Summary of the dropped messages precedes the next admitted one");
+    check(countOf(refilled, "suppressed") == 1 && countOf(refilled, "reconnect 6") == 1,
+          "Refilled tokens admit messages again");
+
+    // Tokens never exceed the burst, however long the site was quiet
+    sleepMs(500);
+    Capture capped;
+    for (int i = 0; i < 6; i++) {
+        Log::limited(LogLevel::Info, LogCategory::Network, "net", "quiet " + std::to_string(i));
+    }
+    check(countOf(capped.release(), "quiet") == 3, "Refill capped at the burst");
+
+    // Sites are independent
+    Capture other;
+    Log::limited(LogLevel::Info, LogCategory::Network, "net:other", "other site");
+    check(countOf(other.release(), "other site") == 1, "Other site has its own bucket");
+
+    // Messages below the log level don't spend tokens
+    sleepMs(200);
+    Log::setLevel(LogLevel::Warning);
+    Capture filtered;
+    for (int i = 0; i < 10; i++) {
+        Log::limited(LogLevel::Info, LogCategory::Network, "net:level", "filtered");
+    }
+    Log::limited(LogLevel::Warning, LogCategory::Network, "net:level", "warning");
+    Log::setLevel(LogLevel::Info);
+    std::string levels = filtered.release();
+    check(countOf(levels, "filtered") == 0 && countOf(levels, "warning") == 1 &&
+          countOf(levels, "suppressed") == 0, "Filtered messages neither logged nor counted");
+
+    // Burst 0 disables limiting for the category
+    Log::setRateLimit(LogCategory::Network, 0, 0);
+    Capture unlimited;
+    for (int i = 0; i < 50; i++) {
+        Log::limited(LogLevel::Info, LogCategory::Network, "net", "flood");
+    }
+    check(countOf(unlimited.release(), "flood") == 50, "Unlimited category logs everything");
+}
+
+static void testFlush() {
+    std::cout << "--- Flush ---\n";
+    Log::setRateLimit(LogCategory::Device, 2, 20.0);
+
+    Capture storm;
+    for (int i = 0; i < 7; i++) {
+        Log::limited(LogLevel::Warning, LogCategory::Device, "CL0:duplicate", "duplicate");
+    }
+    Log::flushSuppressed();
+    std::string during = storm.release();
+    check(countOf(during, "duplicate") == 2 && countOf(during, "suppressed") == 0,
+          "No flush summary while the bucket is still empty");
+
+    sleepMs(80);
+    Capture tail;
+    Log::flushSuppressed();
+    Log::flushSuppressed();
+    std::string flushed = tail.release();
+    check(countOf(flushed, "5 similar message(s) suppressed [CL0:duplicate] over ") == 1,
+          "Tail of a storm reported once after the bucket refills");
+    check(flushed.find("[W]") != std::string::npos, "Summary logged at the site's level");
+}
+
+static void testEviction() {
+    std::cout << "--- Site eviction ---\n";
+
+    // No refill to speak of: a site's tokens only come back if its bucket is dropped
+    Log::setRateLimit(LogCategory::Solution, 2, 0.001);
+    Log::setLevel(LogLevel::Error);
+
+    // A site that drained its bucket, a site with a pending suppression,
+    // and an idle site whose bucket is still full
+    Capture fill;
+    Log::limited(LogLevel::Error, LogCategory::Solution, "drained", "drained");
+    Log::limited(LogLevel::Error, LogCategory::Solution, "drained", "drained");
+    for (int i = 0; i < 3; i++) {
+        Log::limited(LogLevel::Error, LogCategory::Solution, "pending", "pending");
+    }
+    Log::setRateLimit(LogCategory::General, 2, 0.001);
+    Log::limited(LogLevel::Error, LogCategory::General, "idle", "idle");
+    Log::setRateLimit(LogCategory::General, 2, 1000.0);
+    sleepMs(10);
+    for (size_t i = 0; i < Log::MAX_SITES; i++) {
+        Log::limited(LogLevel::Error, LogCategory::Solution, "site" + std::to_string(i), "fill");
+    }
+    fill.release();
+
+    // A dropped bucket is recreated at the new, larger burst; a kept one
+    // would hold on to its 2 tokens at this refill rate
+    Log::setRateLimit(LogCategory::General, 4, 0.001);
+    Capture after;
+    Log::limited(LogLevel::Error, LogCategory::Solution, "drained", "drained again");
+    Log::limited(LogLevel::Error, LogCategory::Solution, "pending", "pending again");
+    for (int i = 0; i < 5; i++) {
+        Log::limited(LogLevel::Error, LogCategory::General, "idle", "idle again");
+    }
+    std::string text = after.release();
+    check(countOf(text, "drained again") == 0, "Drained site stays limited after the table fills");
+    check(countOf(text, "pending again") == 0, "Site with pending suppressions kept");
+    check(countOf(text, "idle again") == 4, "Idle site with a full bucket dropped at MAX_SITES");
+
+    // The kept site still reports its suppressed messages
+    Log::setRateLimit(LogCategory::Solution, 2, 1000.0);
+    sleepMs(10);
+    Capture summary;
+    Log::flushSuppressed();
+    check(countOf(summary.release(), "2 similar message(s) suppressed [pending]") == 1,
+          "Kept site's suppressed count survives eviction");
+    Log::setRateLimit(LogCategory::General, 20, 5.0);
+    Log::setLevel(LogLevel::Info);
+}
+
+int main() {
+    std::cout << "=== Log Rate Limit Test ===\n\n";
+
+    Log::setShowTimestamp(false);
+    testTokenBucket();
+    testFlush();
+    testEviction();
+
+    std::cout << "\n" << (g_passed ? "[PASS] Log rate limit test completed"
+                                   : "[FAIL] Log rate limit test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
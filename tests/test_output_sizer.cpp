@@ -0,0 +1,172 @@
+/**
+ * Test solution buffer sizing and overflow rescans
+ *
+ * Capacity grows at once when a batch comes close to filling it and
+ * shrinks after a quiet window. A simulated device with a fixed set of
+ * solutions stores only as many as each launch's slots; rescanning an
+ * overflowed range must recover every solution exactly once, with no
+ * launch larger than the original and sizes kept to the granularity.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../src/core/OutputSizer.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+// Device with known solutions; stores the first hits of a launch up to its slots
+struct SimDevice {
+    std::set<uint64_t> solutions;
+    uint64_t granularity{1};
+    uint64_t largest{0};
+    unsigned misaligned{0};
+    unsigned launches{0};
+
+    uint32_t search(const NonceRange& range, uint32_t slots, std::vector<uint64_t>& nonces) {
+        launches++;
+        largest = std::max(largest, range.size);
+        misaligned += range.size % granularity != 0;
+
+        uint32_t count = 0;
+        auto it = solutions.lower_bound(range.start);
+        for (; it != solutions.end() && *it < range.start + range.size; ++it) {
+            if (count < slots) {
+                nonces.push_back(*it);
+            }
+            count++;
+        }
+        return count;
+    }
+
+    OutputSizer::RangeSearch rescanner() {
+        return [this](const NonceRange& range, std::vector<uint64_t>& nonces, uint32_t& count) {
+            count = search(range, MAX_OUTPUT_CAPACITY, nonces);
+            return true;
+        };
+    }
+};
+
+static void testCapacity() {
+    std::cout << "--- Capacity ---\n";
+    OutputSizer sizer;
+    check(sizer.capacity() == MIN_OUTPUT_CAPACITY, "Starts at the minimum");
+
+    check(!sizer.record(3, 64) && sizer.capacity() == MIN_OUTPUT_CAPACITY, "Few hits keep the minimum");
+    check(!sizer.record(40, 64) && sizer.capacity() == 256, "Hits near the capacity grow it at once");
+    check(sizer.record(300, 256) && sizer.capacity() == MAX_OUTPUT_CAPACITY,
+          "Overflow is reported and grows to the maximum at most");
+    check(sizer.record(5000, 1024) && sizer.capacity() == MAX_OUTPUT_CAPACITY, "Capacity never exceeds the maximum");
+
+    // A busy batch keeps its headroom for its window, then capacity shrinks
+    for (unsigned i = 0; i + 1 < OutputSizer::WINDOW; i++) {
+        sizer.record(1, sizer.capacity());
+    }
+    check(sizer.capacity() == MAX_OUTPUT_CAPACITY, "No shrink in a window with a busy batch");
+    for (unsigned i = 0; i + 1 < OutputSizer::WINDOW; i++) {
+        sizer.record(1, sizer.capacity());
+    }
+    check(sizer.capacity() == MAX_OUTPUT_CAPACITY, "No shrink before the window ends");
+    sizer.record(1, sizer.capacity());
+    check(sizer.capacity() == MIN_OUTPUT_CAPACITY, "Quiet window shrinks to the minimum");
+
+    for (unsigned i = 0; i < OutputSizer::WINDOW; i++) {
+        sizer.record(i == 10 ? 30 : 2, sizer.capacity());
+    }
+    check(sizer.capacity() == 128, "Shrink keeps headroom over the window's peak");
+
+    sizer.reset();
+    check(sizer.capacity() == MIN_OUTPUT_CAPACITY, "Reset returns to the minimum");
+}
+
+static void testSplit() {
+    std::cout << "--- Split ---\n";
+    auto parts = OutputSizer::split({1000, 64 * 10}, 8, 64);
+    uint64_t covered = 0;
+    bool contiguous = true;
+    bool aligned = true;
+    uint64_t next = 1000;
+    for (const auto& part : parts) {
+        contiguous = contiguous && part.start == next;
+        aligned = aligned && part.size % 64 == 0 && part.size > 0;
+        next = part.start + part.size;
+        covered += part.size;
+    }
+    check(parts.size() == 8 && covered == 640 && contiguous, "Parts cover the range in order");
+    check(aligned, "Parts are multiples of the granularity");
+
+    check(OutputSizer::split({0, 3 * 32}, 8, 32).size() == 3, "No more parts than granules");
+    check(OutputSizer::split({0, 32}, 8, 32).size() == 1, "A single granule is not split");
+}
+
+static void testRescan(uint64_t batch, uint64_t granularity, unsigned solutionCount, const std::string& name) {
+    std::cout << "--- Rescan: " << name << " ---\n";
+    SimDevice device;
+    device.granularity = granularity;
+    std::mt19937_64 rng(solutionCount);
+    while (device.solutions.size() < solutionCount) {
+        device.solutions.insert(500000 + rng() % batch);
+    }
+
+    // The batch overflows its slots; the stored nonces were already submitted
+    std::vector<uint64_t> stored;
+    uint32_t count = device.search({500000, batch}, MIN_OUTPUT_CAPACITY, stored);
+    check(count == solutionCount && stored.size() == MIN_OUTPUT_CAPACITY, name + ": batch overflows");
+
+    std::set<uint64_t> seen(stored.begin(), stored.end());
+    std::vector<uint64_t> found;
+    device.launches = 0;
+    device.largest = 0;
+    RescanResult result = OutputSizer::rescan({500000, batch}, granularity, seen, device.rescanner(), found);
+
+    std::set<uint64_t> all(stored.begin(), stored.end());
+    all.insert(found.begin(), found.end());
+    check(result.ok && result.unresolved == 0, name + ": no range left overflowing");
+    check(all == device.solutions, name + ": every solution recovered");
+    check(found.size() + stored.size() == solutionCount, name + ": no solution reported twice");
+    check(device.largest <= batch / OutputSizer::RESCAN_SPLIT + granularity && device.misaligned == 0,
+          name + ": smaller launches, sized to the granularity");
+    check(result.launches == device.launches, name + ": " + std::to_string(result.launches) + " launches");
+}
+
+static void testRescanLimits() {
+    std::cout << "--- Rescan limits ---\n";
+
+    // Every nonce a solution (faulty target): bounded work, reported unresolved
+    SimDevice device;
+    for (uint64_t n = 0; n < 200000; n++) {
+        device.solutions.insert(n);
+    }
+    std::set<uint64_t> seen;
+    std::vector<uint64_t> found;
+    RescanResult result = OutputSizer::rescan({0, 200000}, 1, seen, device.rescanner(), found);
+    unsigned most = OutputSizer::RESCAN_SPLIT + OutputSizer::RESCAN_SPLIT * OutputSizer::RESCAN_SPLIT;
+    check(result.launches <= most && result.unresolved > 0,
+          "Split depth bounds the launches (" + std::to_string(result.launches) + ")");
+
+    // A failed launch stops the rescan
+    unsigned calls = 0;
+    result = OutputSizer::rescan({0, 1024}, 1, seen,
+                                 [&](const NonceRange&, std::vector<uint64_t>&, uint32_t&) { return ++calls < 3; },
+                                 found);
+    check(!result.ok && calls == 3, "Device error ends the rescan");
+}
+
+int main() {
+    std::cout << "=== Output Sizer Test ===\n\n";
+
+    testCapacity();
+    testSplit();
+    testRescan(65536, 64, 300, "300 solutions");
+    testRescan(65536, 1, 20000, "20000 solutions, split twice");
+    testRescan(64 * 100, 64, 100, "uneven split");
+    testRescanLimits();
+
+    std::cout << "\n" << (g_passed ? "[PASS] Output sizer test completed"
+                                   : "[FAIL] Output sizer test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
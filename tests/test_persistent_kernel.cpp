@@ -0,0 +1,357 @@
+/**
+ * Test the persistent OpenCL search kernel
+ *
+ * The host ring cursor always runs: entries drain in order, a wrapped
+ * ring reports lost entries and the 32-bit counters may wrap. With an
+ * OpenCL device (POCL runs it on the CPU) the kernel's solutions, check
+ * hits and hash counter are compared with the CPU reference, a launch
+ * for a stale generation does no work, and CLMiner mines through two
+ * jobs in persistent mode with every solution verified.
+ */
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/opencl/ResultRing.h"
+#include "TestUtil.h"
+
+#ifdef WITH_OPENCL
+#include "../src/opencl/CLMiner.h"
+#include "../src/toshash/TosHash.h"
+#include "../src/util/Log.h"
+#include "toshash_kernel.cl.h"
+#endif
+
+using namespace tos;
+
+// Write nonce into ring slots the way the kernel does
+static void append(std::vector<uint32_t>& slots, uint32_t& written, uint64_t nonce) {
+    uint32_t slot = written++ % (slots.size() / 2);
+    slots[slot * 2] = static_cast<uint32_t>(nonce);
+    slots[slot * 2 + 1] = static_cast<uint32_t>(nonce >> 32);
+}
+
+static void testResultRing() {
+    std::cout << "--- Result ring ---\n";
+
+    std::vector<uint32_t> slots(8 * 2, 0);
+    ResultRing ring(8);
+    uint32_t written = 0;
+    std::vector<uint64_t> nonces;
+
+    check(ring.drain(written, slots.data(), nonces) == 0 && nonces.empty(), "Empty ring drains nothing");
+
+    append(slots, written, 0x100000001ULL);
+    append(slots, written, 0x200000002ULL);
+    append(slots, written, 0x300000003ULL);
+    check(ring.drain(written, slots.data(), nonces) == 0 && nonces.size() == 3 &&
+          nonces[0] == 0x100000001ULL && nonces[2] == 0x300000003ULL, "Entries drain oldest first");
+
+    nonces.clear();
+    check(ring.drain(written, slots.data(), nonces) == 0 && nonces.empty(), "Drained entries are not repeated");
+
+    // 11 entries into 8 slots: the 3 oldest are overwritten
+    for (uint64_t n = 10; n < 21; n++) {
+        append(slots, written, n);
+    }
+    uint32_t lost = ring.drain(written, slots.data(), nonces);
+    check(lost == 3 && nonces.size() == 8 && nonces.front() == 13 && nonces.back() == 20,
+          "Wrapped ring reports 3 lost entries and keeps the newest 8");
+
+    nonces.clear();
+    append(slots, written, 99);
+    ring.skip(written);
+    check(ring.drain(written, slots.data(), nonces) == 0 && nonces.empty(), "Skipped entries are discarded");
+
+    // Write counter wrapping at 2^32 (ring size a power of two, as in CLMiner)
+    ResultRing wrapping(8);
+    uint32_t counter = 0xFFFFFFFEu;
+    wrapping.skip(counter);
+    append(slots, counter, 7);
+    append(slots, counter, 8);
+    append(slots, counter, 9);
+    nonces.clear();
+    check(counter == 1 && wrapping.pending(counter) == 3 && wrapping.drain(counter, slots.data(), nonces) == 0 &&
+          nonces.size() == 3 && nonces[0] == 7 && nonces[2] == 9, "Write counter wraps at 2^32");
+}
+
+#ifdef WITH_OPENCL
+using Header = std::array<uint8_t, INPUT_SIZE>;
+
+static Header randomHeader(uint64_t seed) {
+    Header header{};
+    for (auto& byte : header) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        byte = static_cast<uint8_t>(seed);
+    }
+    return header;
+}
+
+// Target met by about one hash in 2^bits
+static Hash256 easyTarget(unsigned bits) {
+    return Miner::integrityTarget(bits);
+}
+
+static Hash256 cpuHash(const Header& header, uint64_t nonce) {
+    static TosHash hasher;
+    static auto scratch = std::make_unique<ScratchPad>();
+    Header input = header;
+    for (int i = 0; i < 8; i++) {
+        input[NONCE_OFFSET + i] = static_cast<uint8_t>(nonce >> ((7 - i) * 8));
+    }
+    Hash256 hash;
+    hasher.hash(input.data(), hash.data(), *scratch);
+    return hash;
+}
+
+// Runs the kernel directly; returns the number of devices tested
+static unsigned testKernel() {
+    std::cout << "--- Persistent kernel ---\n";
+
+    std::vector<cl::Platform> platforms;
+    try {
+        cl::Platform::get(&platforms);
+    } catch (const cl::Error&) {
+        // No ICD installed
+    }
+
+    unsigned tested = 0;
+    std::string source(reinterpret_cast<const char*>(toshash_cl_source), toshash_cl_source_len);
+
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_ALL, &devices);
+        } catch (const cl::Error&) {
+            continue;
+        }
+
+        for (auto& device : devices) {
+            std::string name = "OpenCL " + device.getInfo<CL_DEVICE_NAME>();
+            try {
+                cl::Context context(device);
+                cl::CommandQueue queue(context, device);
+                cl::Program program(context, source);
+                try {
+                    program.build("-cl-std=CL1.2");
+                } catch (const cl::Error&) {
+                    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << "\n";
+                    check(false, name + ": kernel builds");
+                    continue;
+                }
+                cl::Kernel kernel(program, "toshash_search_persistent");
+
+                const uint32_t ringSize = 16;
+                const uint32_t checkSize = 16;
+                const uint32_t words = 4 + (ringSize + checkSize) * 2;
+                const size_t global = 16;
+                const uint32_t loop = 8;
+                const uint64_t start = 1000;
+
+                Header header = randomHeader(42);
+                Hash256 target = easyTarget(4);
+                Hash256 checkTarget = easyTarget(2);
+
+                std::vector<uint32_t> ring(words, 0);
+                uint32_t generation = 5;
+                cl::Buffer ringBuffer(context, CL_MEM_READ_WRITE, words * sizeof(uint32_t));
+                cl::Buffer headerBuffer(context, CL_MEM_READ_ONLY, INPUT_SIZE);
+                cl::Buffer targetBuffer(context, CL_MEM_READ_ONLY, HASH_SIZE);
+                cl::Buffer checkBuffer(context, CL_MEM_READ_ONLY, HASH_SIZE);
+                cl::Buffer control(context, CL_MEM_READ_WRITE, sizeof(uint32_t));
+                cl::Buffer scratch(context, CL_MEM_READ_WRITE, sizeof(uint64_t));  // Unused: local scratchpads
+                queue.enqueueWriteBuffer(ringBuffer, CL_TRUE, 0, words * sizeof(uint32_t), ring.data());
+                queue.enqueueWriteBuffer(headerBuffer, CL_TRUE, 0, INPUT_SIZE, header.data());
+                queue.enqueueWriteBuffer(targetBuffer, CL_TRUE, 0, HASH_SIZE, target.data());
+                queue.enqueueWriteBuffer(checkBuffer, CL_TRUE, 0, HASH_SIZE, checkTarget.data());
+                queue.enqueueWriteBuffer(control, CL_TRUE, 0, sizeof(uint32_t), &generation);
+
+                auto launch = [&](uint64_t startNonce, uint32_t launchGeneration) {
+                    kernel.setArg(0, ringBuffer);
+                    kernel.setArg(1, headerBuffer);
+                    kernel.setArg(2, targetBuffer);
+                    kernel.setArg(3, static_cast<cl_ulong>(startNonce));
+                    kernel.setArg(4, loop);
+                    kernel.setArg(5, control);
+                    kernel.setArg(6, launchGeneration);
+                    kernel.setArg(7, ringSize);
+                    kernel.setArg(8, checkBuffer);
+                    kernel.setArg(9, checkSize);
+                    kernel.setArg(10, scratch);
+                    queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(global), cl::NDRange(1));
+                    queue.enqueueReadBuffer(ringBuffer, CL_TRUE, 0, words * sizeof(uint32_t), ring.data());
+                };
+
+                // CPU reference over both launches
+                const uint64_t perLaunch = global * loop;
+                std::set<uint64_t> solutions[2];
+                std::set<uint64_t> checks[2];
+                for (int l = 0; l < 2; l++) {
+                    for (uint64_t nonce = start + l * perLaunch; nonce < start + (l + 1) * perLaunch; nonce++) {
+                        Hash256 hash = cpuHash(header, nonce);
+                        if (meetsTarget(hash, target)) {
+                            solutions[l].insert(nonce);
+                        } else if (meetsTarget(hash, checkTarget)) {
+                            checks[l].insert(nonce);
+                        }
+                    }
+                }
+
+                ResultRing solutionRing(ringSize);
+                ResultRing checkRing(checkSize);
+                uint32_t hashesRead = 0;
+                bool ringsOk = true;
+                for (int l = 0; l < 2; l++) {
+                    launch(start + l * perLaunch, generation);
+
+                    std::vector<uint64_t> found;
+                    uint32_t lost = solutionRing.drain(ring[0], ring.data() + 4, found);
+                    std::vector<uint64_t> hits;
+                    checkRing.drain(ring[1], ring.data() + 4 + ringSize * 2, hits);
+
+                    ringsOk = ringsOk && ring[2] - hashesRead == perLaunch;
+                    hashesRead = ring[2];
+                    ringsOk = ringsOk && lost == 0 &&
+                              std::set<uint64_t>(found.begin(), found.end()) == solutions[l] &&
+                              std::set<uint64_t>(hits.begin(), hits.end()) == checks[l];
+                }
+                std::cout << "  " << solutions[0].size() + solutions[1].size() << " solutions, "
+                          << checks[0].size() + checks[1].size() << " check hits in " << 2 * perLaunch
+                          << " nonces\n";
+                check(ringsOk, name + ": two launches match the CPU reference");
+
+                // Launch for a generation the host has moved past
+                uint32_t written = ring[0];
+                launch(start, generation - 1);
+                check(ring[2] == hashesRead && ring[0] == written, name + ": stale generation launch hashes nothing");
+                tested++;
+
+            } catch (const cl::Error& e) {
+                check(false, name + ": OpenCL error " + std::string(e.what()) + " (" + std::to_string(e.err()) + ")");
+            }
+        }
+    }
+
+    return tested;
+}
+
+// Mines two jobs through CLMiner in persistent mode
+static void testMiner() {
+    std::cout << "--- CLMiner persistent mode ---\n";
+
+    CLMiner::setDeviceType(CL_DEVICE_TYPE_ALL);
+    CLMiner::setGlobalWorkSizeMultiplier(32);
+    CLMiner::setLocalWorkSize(1);
+    CLMiner::setNonceLoop(4);
+    Miner::setIntegritySample(100);
+
+    for (const auto& descriptor : CLMiner::enumDevices()) {
+        std::string name = "CLMiner " + descriptor.name;
+        CLMiner miner(descriptor.index, descriptor);
+        if (!miner.init()) {
+            check(false, name + ": init");
+            continue;
+        }
+
+        std::mutex mutex;
+        std::vector<std::pair<uint64_t, std::string>> found;
+        miner.setSolutionCallback([&](const Solution& solution, const std::string& jobId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            found.push_back({solution.nonce, jobId});
+        });
+
+        WorkPackage jobs[2];
+        for (int j = 0; j < 2; j++) {
+            auto header = randomHeader(100 + j);
+            std::copy(header.begin(), header.end(), jobs[j].header.begin());
+            jobs[j].target = easyTarget(5);
+            jobs[j].jobId = "job" + std::to_string(j);
+            jobs[j].startNonce = 1 + j * 1000000ULL;
+            jobs[j].valid = true;
+        }
+
+        auto waitFor = [&](const std::string& jobId, size_t count) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(120);
+            while (std::chrono::steady_clock::now() < deadline) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    size_t n = 0;
+                    for (const auto& f : found) {
+                        n += f.second == jobId;
+                    }
+                    if (n >= count) {
+                        return true;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return false;
+        };
+
+        miner.setWork(jobs[0]);
+        miner.start();
+        bool first = waitFor("job0", 3);
+        miner.setWork(jobs[1]);
+        bool second = waitFor("job1", 3);
+        miner.stop();
+
+        check(first && second, name + ": solutions for both jobs");
+
+        bool verified = true;
+        for (const auto& [nonce, jobId] : found) {
+            const WorkPackage& job = jobId == "job0" ? jobs[0] : jobs[1];
+            Header header;
+            std::copy(job.header.begin(), job.header.end(), header.begin());
+            verified = verified && meetsTarget(cpuHash(header, nonce), job.target);
+        }
+        DeviceHealth health = miner.getHealth();
+        check(verified && health.invalidSolutions == 0, name + ": every solution verifies on the CPU");
+        check(health.integrityChecked > 0 && health.integrityFailed == 0, name + ": integrity checks pass");
+        check(miner.getHashRate().count > 0, name + ": hashes counted");
+
+        HistogramSnapshot latency = miner.getJobSwitchLatency();
+        std::cout << "  job switch latency p50 " << latency.quantile(0.5) * 1000 << " ms\n";
+    }
+
+    CLMiner::setDeviceType(CL_DEVICE_TYPE_GPU);
+    CLMiner::setNonceLoop(0);
+}
+#endif
+
+int main(int argc, char** argv) {
+    std::cout << "=== Persistent Kernel Test ===\n\n";
+
+    bool requireOpenCL = argc > 1 && std::string(argv[1]) == "--require-opencl";
+
+    testResultRing();
+
+#ifdef WITH_OPENCL
+    Log::setLevel(LogLevel::Error);
+    unsigned devices = testKernel();
+    if (devices > 0) {
+        testMiner();
+    }
+#else
+    unsigned devices = 0;
+    std::cout << "--- Persistent kernel ---\n";
+#endif
+    if (devices == 0) {
+        if (requireOpenCL) {
+            check(false, "OpenCL device available (install POCL to run the kernel on the CPU)");
+        } else {
+            std::cout << "[SKIP] No OpenCL device; install POCL to run the kernel on the CPU\n";
+        }
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Persistent kernel test completed"
+                                   : "[FAIL] Persistent kernel test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+/**
+ * Test the N-deep GPU batch pipeline
+ *
+ * Slot bookkeeping always runs: slots are taken lowest first, released
+ * in any order and listed oldest launch first. With an OpenCL device
+ * (POCL runs it on the CPU) CLMiner mines two jobs at several pipeline
+ * depths, on in-order and out-of-order queues and with the persistent
+ * kernel, with every solution verified, and the pipelined benchmark runs.
+ * Profiled runs must record ordered kernel and readback timestamps.
+ * A target every hash meets overflows the solution buffers and result
+ * rings; the rescans must still report every nonce exactly once.
+ */
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/core/PipelineSlots.h"
+#include "TestUtil.h"
+
+#ifdef WITH_OPENCL
+#include "../src/opencl/CLMiner.h"
+#include "../src/toshash/TosHash.h"
+#include "../src/util/Log.h"
+#endif
+
+using namespace tos;
+
+static void testSlots() {
+    std::cout << "--- Pipeline slots ---\n";
+
+    check(PipelineSlots(0).depth() == 1 && PipelineSlots(100).depth() == MAX_PIPELINE_DEPTH,
+          "Depth is clamped to 1 .. MAX_PIPELINE_DEPTH");
+
+    PipelineSlots slots(3);
+    check(slots.depth() == 3 && slots.empty() && !slots.full() && slots.oldest() == -1, "New slots are free");
+
+    int a = slots.acquire();
+    int b = slots.acquire();
+    int c = slots.acquire();
+    check(a == 0 && b == 1 && c == 2 && slots.full() && slots.acquire() == -1,
+          "Slots are taken lowest first until full");
+
+    // Middle batch finishes first; its slot is reused by the next launch
+    slots.release(1);
+    check(slots.busy() == 2 && !slots.full(), "Released slot is free");
+    check(slots.acquire() == 1, "Freed slot is reused");
+    auto order = slots.inFlight();
+    check(order.size() == 3 && order[0] == 0 && order[1] == 2 && order[2] == 1,
+          "In-flight slots list in launch order, not slot order");
+
+    slots.release(0);
+    check(slots.oldest() == 2, "Oldest follows the launch order");
+
+    slots.release(7);
+    check(slots.busy() == 2, "Releasing an out-of-range slot is ignored");
+
+    slots.clear();
+    check(slots.empty() && slots.depth() == 3, "Clear frees every slot");
+
+    slots.reset(5);
+    check(slots.depth() == 5 && slots.empty() && slots.acquire() == 0, "Reset changes the depth");
+}
+
+#ifdef WITH_OPENCL
+using Header = std::array<uint8_t, INPUT_SIZE>;
+
+static Header randomHeader(uint64_t seed) {
+    Header header{};
+    for (auto& byte : header) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        byte = static_cast<uint8_t>(seed);
+    }
+    return header;
+}
+
+static Hash256 cpuHash(const Header& header, uint64_t nonce) {
+    static TosHash hasher;
+    static auto scratch = std::make_unique<ScratchPad>();
+    Header input = header;
+    for (int i = 0; i < 8; i++) {
+        input[NONCE_OFFSET + i] = static_cast<uint8_t>(nonce >> ((7 - i) * 8));
+    }
+    Hash256 hash;
+    hasher.hash(input.data(), hash.data(), *scratch);
+    return hash;
+}
+
+struct PipelineConfig {
+    unsigned depth;
+    bool outOfOrder;
+    unsigned nonceLoop;
+    bool profiling;
+};
+
+// Mines two jobs through CLMiner with one pipeline configuration; returns devices tested
+static unsigned testMiner(const PipelineConfig& config) {
+    std::string mode = "depth " + std::to_string(config.depth) +
+                       (config.outOfOrder ? ", out-of-order" : ", in-order") +
+                       (config.nonceLoop > 0 ? ", persistent" : "") +
+                       (config.profiling ? ", profiled" : "");
+    std::cout << "--- CLMiner " << mode << " ---\n";
+
+    CLMiner::setDeviceType(CL_DEVICE_TYPE_ALL);
+    CLMiner::setGlobalWorkSizeMultiplier(32);
+    CLMiner::setLocalWorkSize(1);
+    CLMiner::setNonceLoop(config.nonceLoop);
+    CLMiner::setPipelineDepth(config.depth);
+    CLMiner::setOutOfOrder(config.outOfOrder);
+    CLMiner::setProfiling(config.profiling);
+    Miner::setIntegritySample(100);
+
+    unsigned tested = 0;
+    for (const auto& descriptor : CLMiner::enumDevices()) {
+        std::string name = "CLMiner " + descriptor.name + " (" + mode + ")";
+        CLMiner miner(descriptor.index, descriptor);
+        if (!miner.init()) {
+            check(false, name + ": init");
+            continue;
+        }
+        check(miner.getPipelineDepth() == config.depth, name + ": pipeline depth applied");
+        if (config.outOfOrder && !miner.isOutOfOrder()) {
+            std::cout << "  device has no out-of-order queue, using an in-order queue\n";
+        }
+
+        std::mutex mutex;
+        std::vector<std::pair<uint64_t, std::string>> found;
+        miner.setSolutionCallback([&](const Solution& solution, const std::string& jobId) {
+            std::lock_guard<std::mutex> lock(mutex);
+            found.push_back({solution.nonce, jobId});
+        });
+
+        WorkPackage jobs[2];
+        for (int j = 0; j < 2; j++) {
+            auto header = randomHeader(200 + j);
+            std::copy(header.begin(), header.end(), jobs[j].header.begin());
+            jobs[j].target = Miner::integrityTarget(5);
+            jobs[j].jobId = "job" + std::to_string(j);
+            jobs[j].startNonce = 1 + j * 1000000ULL;
+            jobs[j].valid = true;
+        }
+
+        auto waitFor = [&](const std::string& jobId, size_t count) {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(120);
+            while (std::chrono::steady_clock::now() < deadline) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    size_t n = 0;
+                    for (const auto& f : found) {
+                        n += f.second == jobId;
+                    }
+                    if (n >= count) {
+                        return true;
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return false;
+        };
+
+        miner.setWork(jobs[0]);
+        miner.start();
+        bool first = waitFor("job0", 4);
+        miner.setWork(jobs[1]);
+        bool second = waitFor("job1", 4);
+        miner.stop();
+
+        check(first && second, name + ": solutions for both jobs");
+
+        bool verified = true;
+        std::set<std::pair<uint64_t, std::string>> unique;
+        for (const auto& [nonce, jobId] : found) {
+            const WorkPackage& job = jobId == "job0" ? jobs[0] : jobs[1];
+            Header header;
+            std::copy(job.header.begin(), job.header.end(), header.begin());
+            verified = verified && meetsTarget(cpuHash(header, nonce), job.target);
+            unique.insert({nonce, jobId});
+        }
+        DeviceHealth health = miner.getHealth();
+        check(verified && health.invalidSolutions == 0, name + ": every solution verifies on the CPU");
+        check(unique.size() == found.size(), name + ": no nonce is reported twice");
+        check(health.integrityChecked > 0 && health.integrityFailed == 0, name + ": integrity checks pass");
+        check(miner.getHashRate().count > 0, name + ": hashes counted");
+
+        if (config.profiling) {
+            auto batches = miner.getRecentBatches();
+            TimelineStats stats = miner.getTimelineStats();
+            bool ordered = !batches.empty();
+            for (const auto& b : batches) {
+                ordered = ordered && b.kernel.queued <= b.kernel.submit && b.kernel.submit <= b.kernel.start &&
+                          b.kernel.start <= b.kernel.end && b.read.start >= b.kernel.end &&
+                          b.read.start <= b.read.end;
+            }
+            check(ordered, name + ": kernel and readback timestamps recorded in order");
+            check(stats.kernel.count >= batches.size() && stats.transfer.count > 0 && stats.idle.count > 0,
+                  name + ": kernel, transfer and idle histograms filled");
+        } else {
+            check(miner.getTimelineStats().kernel.count == 0, name + ": no timeline without profiling");
+        }
+
+        if (config.nonceLoop == 0) {
+            double rate = miner.benchmark(256);
+            std::cout << "  pipelined benchmark " << rate << " H/s\n";
+            check(rate > 0, name + ": pipelined benchmark runs");
+        }
+        tested++;
+    }
+
+    CLMiner::setDeviceType(CL_DEVICE_TYPE_GPU);
+    CLMiner::setNonceLoop(0);
+    CLMiner::setPipelineDepth(2);
+    CLMiner::setOutOfOrder(false);
+    CLMiner::setProfiling(false);
+    return tested;
+}
+
+// Mines a job every nonce solves, so each batch overflows its solution slots
+static void testOverflow(unsigned nonceLoop) {
+    std::string mode = nonceLoop > 0 ? "persistent" : "one-shot";
+    std::cout << "--- CLMiner overflow (" << mode << ") ---\n";
+
+    CLMiner::setDeviceType(CL_DEVICE_TYPE_ALL);
+    CLMiner::setGlobalWorkSizeMultiplier(256);
+    CLMiner::setLocalWorkSize(1);
+    CLMiner::setNonceLoop(nonceLoop);
+    Miner::setIntegritySample(0);
+
+    for (const auto& descriptor : CLMiner::enumDevices()) {
+        std::string name = "CLMiner " + descriptor.name + " (" + mode + " overflow)";
+        CLMiner miner(descriptor.index, descriptor);
+        if (!miner.init()) {
+            check(false, name + ": init");
+            continue;
+        }
+
+        std::mutex mutex;
+        std::vector<uint64_t> found;
+        miner.setSolutionCallback([&](const Solution& solution, const std::string&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            found.push_back(solution.nonce);
+        });
+
+        WorkPackage job;
+        auto header = randomHeader(300);
+        std::copy(header.begin(), header.end(), job.header.begin());
+        job.target.fill(0xFF);
+        job.jobId = "flood";
+        job.startNonce = 1;
+        job.valid = true;
+
+        // A second overflow is recorded only after the first one's rescan finished
+        miner.setWork(job);
+        miner.start();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(120);
+        while (miner.getHealth().outputOverflows < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        miner.stop();
+
+        std::set<uint64_t> unique(found.begin(), found.end());
+        uint64_t first = 256 * std::max(1u, nonceLoop);
+        bool complete = true;
+        for (uint64_t nonce = job.startNonce; nonce < job.startNonce + first; nonce++) {
+            complete = complete && unique.count(nonce) == 1;
+        }
+        check(miner.getHealth().outputOverflows >= 2, name + ": overflows counted");
+        check(complete, name + ": every nonce of the first batch reported");
+        check(unique.size() == found.size() && miner.getHealth().duplicateSolutions == 0,
+              name + ": no nonce is reported twice");
+    }
+
+    CLMiner::setDeviceType(CL_DEVICE_TYPE_GPU);
+    CLMiner::setNonceLoop(0);
+}
+#endif
+
+int main(int argc, char** argv) {
+    std::cout << "=== GPU Pipeline Test ===\n\n";
+
+    bool requireOpenCL = argc > 1 && std::string(argv[1]) == "--require-opencl";
+
+    testSlots();
+
+    unsigned devices = 0;
+#ifdef WITH_OPENCL
+    Log::setLevel(LogLevel::Error);
+    for (const PipelineConfig& config : {PipelineConfig{1, false, 0, false}, PipelineConfig{3, false, 0, true},
+                                         PipelineConfig{4, true, 0, false}, PipelineConfig{3, false, 4, true}}) {
+        devices = testMiner(config);
+        if (devices == 0) {
+            break;
+        }
+    }
+    if (devices > 0) {
+        testOverflow(0);
+        testOverflow(4);
+    }
+#endif
+    if (devices == 0) {
+        if (requireOpenCL) {
+            check(false, "OpenCL device available (install POCL to run the kernel on the CPU)");
+        } else {
+            std::cout << "[SKIP] No OpenCL device; install POCL to run the pipeline on the CPU\n";
+        }
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Pipeline test completed"
+                                   : "[FAIL] Pipeline test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
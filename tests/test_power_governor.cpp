@@ -0,0 +1,303 @@
+/**
+ * Test power governor against simulated devices
+ *
+ * A first-order thermal model stands in for real GPUs: power grows with
+ * intensity and temperature lags behind power. The governor must hold
+ * caps without oscillating and back off when raising costs efficiency.
+ * CPU threads are governed as one from the package sensors. The last
+ * case feeds it readings from a fake sysfs tree.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include "../src/core/PowerGovernor.h"
+#include "../src/util/GpuMonitor.h"
+#include "../src/util/Sysfs.h"
+#include "TestUtil.h"
+
+using namespace tos;
+namespace fs = std::filesystem;
+
+/**
+ * Simulated GPU
+ *
+ * power = idle + perPercent * intensity
+ * temperature approaches ambient + thermalResistance * power
+ * hash rate is linear in intensity up to knee, then falls (throttling)
+ */
+struct SimDevice {
+    double ambient{30};
+    double idlePower{60};
+    double perPercent{2.4};
+    double thermalResistance{0.2};
+    double lag{0.2};
+    double maxRate{1000000};
+    unsigned knee{100};
+
+    unsigned intensity{100};
+    double temperature{45};
+
+    double power() const { return idlePower + perPercent * intensity; }
+
+    double rate() const {
+        double effective = intensity <= knee ? intensity : knee - (intensity - knee) * 0.5;
+        return maxRate * effective / 100.0;
+    }
+
+    void tick() {
+        double equilibrium = ambient + thermalResistance * power();
+        temperature += (equilibrium - temperature) * lag;
+    }
+
+    DeviceTelemetry telemetry() const {
+        DeviceTelemetry dev;
+        dev.device.type = MinerType::OpenCL;
+        dev.hashRate = HashRate(rate(), rate(), 0, 0);
+        dev.windows.s10 = rate();
+        dev.intensity = intensity;
+        dev.gpu.valid = true;
+        dev.gpu.temperature = static_cast<int>(std::lround(temperature));
+        dev.gpu.powerUsage = static_cast<int>(std::lround(power()));
+        return dev;
+    }
+};
+
+struct Run {
+    std::vector<unsigned> intensity;
+    std::vector<double> temperature;
+    std::vector<double> power;
+    unsigned reversals{0};      // Direction changes in the second half
+};
+
+static Run simulate(SimDevice& sim, const GovernorConfig& config, unsigned ticks) {
+    Run run;
+    int lastDirection = 0;
+
+    PowerGovernor governor(config, [&](const GovernorDecision& d) {
+        int direction = d.to > d.from ? 1 : -1;
+        if (lastDirection != 0 && direction != lastDirection && run.intensity.size() > ticks / 2) {
+            run.reversals++;
+        }
+        lastDirection = direction;
+        sim.intensity = d.to;
+    });
+
+    for (unsigned t = 0; t < ticks; t++) {
+        sim.tick();
+        TelemetrySnapshot snap;
+        snap.devices.push_back(sim.telemetry());
+        governor.update(snap);
+
+        run.intensity.push_back(sim.intensity);
+        run.temperature.push_back(sim.temperature);
+        run.power.push_back(sim.power());
+    }
+    return run;
+}
+
+int main() {
+    std::cout << "=== Power Governor Test ===\n\n";
+
+    // Temperature cap: 100% would settle at 90C
+    {
+        SimDevice sim;
+        GovernorConfig config;
+        config.tempTarget = 80;
+        Run run = simulate(sim, config, 1200);
+
+        double peak = *std::max_element(run.temperature.begin() + 600, run.temperature.end());
+        unsigned lowest = *std::min_element(run.intensity.begin() + 600, run.intensity.end());
+        std::cout << "  temp cap: final " << run.intensity.back() << "%, "
+                  << sim.temperature << "C, peak " << peak << "C, reversals " << run.reversals << "\n";
+        check(peak <= 81.0, "Temperature held at target");
+        check(lowest >= 60, "Intensity stays near the cap (not over-throttled)");
+        check(run.reversals <= 12, "Hysteresis limits oscillation");
+    }
+
+    // Power cap: 200W allows about 58%
+    {
+        SimDevice sim;
+        GovernorConfig config;
+        config.powerCap = 200;
+        Run run = simulate(sim, config, 600);
+
+        double peak = *std::max_element(run.power.begin() + 300, run.power.end());
+        std::cout << "  power cap: final " << run.intensity.back() << "%, " << sim.power() << "W\n";
+        check(peak <= 200.0, "Power held under cap");
+        check(sim.power() >= 180.0, "Power cap not over-throttled");
+    }
+
+    // Minimum intensity: can't reach the target, must not go below the floor
+    {
+        SimDevice sim;
+        sim.ambient = 85;
+        GovernorConfig config;
+        config.tempTarget = 80;
+        config.minIntensity = 40;
+        simulate(sim, config, 400);
+        check(sim.intensity == 40, "Intensity floors at --min-intensity");
+    }
+
+    // Efficiency: above 70% the device throttles, so raising past it
+    // costs H/s per watt. Start hot so the governor climbs from the floor.
+    {
+        SimDevice sim;
+        sim.knee = 70;
+        sim.ambient = 0;    // Never near the temperature cap
+        sim.intensity = 30;
+        GovernorConfig config;
+        config.tempTarget = 95;
+        config.minIntensity = 30;
+
+        unsigned intensity = 30;
+        PowerGovernor governor(config, [&](const GovernorDecision& d) {
+            intensity = d.to;
+        });
+
+        // First force the governor down to the floor, then let it climb
+        SimDevice hot = sim;
+        hot.ambient = 100;
+        hot.temperature = 100;
+        for (int t = 0; t < 300; t++) {
+            hot.intensity = intensity;
+            TelemetrySnapshot snap;
+            snap.devices.push_back(hot.telemetry());
+            governor.update(snap);
+        }
+        check(intensity == 30, "Hot start drives intensity to the floor");
+
+        unsigned highest = 0;
+        for (int t = 0; t < 600; t++) {
+            sim.intensity = intensity;
+            sim.tick();
+            TelemetrySnapshot snap;
+            snap.devices.push_back(sim.telemetry());
+            governor.update(snap);
+            highest = std::max(highest, intensity);
+        }
+        std::cout << "  efficiency: final " << intensity << "%, highest " << highest << "%\n";
+        check(intensity == 70, "Settles at the most efficient intensity");
+        check(highest <= 75, "Only one probe past the knee");
+    }
+
+    // Devices without sensor data or isolated as failed are left alone
+    {
+        unsigned decisions = 0;
+        GovernorConfig config;
+        config.tempTarget = 60;
+        PowerGovernor governor(config, [&](const GovernorDecision&) { decisions++; });
+
+        TelemetrySnapshot snap;
+        DeviceTelemetry cpu;
+        cpu.device.type = MinerType::CPU;
+        snap.devices.push_back(cpu);
+
+        SimDevice sim;
+        sim.temperature = 90;
+        DeviceTelemetry failed = sim.telemetry();
+        failed.failed = true;
+        snap.devices.push_back(failed);
+
+        for (int t = 0; t < 50; t++) {
+            governor.update(snap);
+        }
+        check(decisions == 0, "No decisions without sensors or for failed devices");
+    }
+
+    // CPU threads: governed together from the package sensors
+    {
+        std::vector<GovernorDecision> decisions;
+        GovernorConfig config;
+        config.tempTarget = 80;
+        config.powerCap = 100;
+        PowerGovernor governor(config, [&](const GovernorDecision& d) { decisions.push_back(d); });
+
+        TelemetrySnapshot snap;
+        DeviceTelemetry cpu;
+        cpu.device.type = MinerType::CPU;
+        snap.devices.assign(3, cpu);
+        snap.devices[2].failed = true;
+        snap.cpu.valid = true;
+        snap.cpu.temperature = 70;
+        snap.cpu.packagePower = 120.4;
+        governor.update(snap);
+
+        check(decisions.size() == 2 && decisions[0].index == 0 && decisions[1].index == 1,
+              "Package over the cap throttles every running CPU thread");
+        check(decisions.size() == 2 && decisions[0].to == 75 && decisions[1].to == 75 &&
+              decisions[0].reason.find("120W above 100W cap") != std::string::npos,
+              "Cap applies to package power, not per thread");
+
+        // Recovered thread joins at the shared level, no new control step yet
+        decisions.clear();
+        snap.devices[2].failed = false;
+        governor.update(snap);
+        check(decisions.size() == 1 && decisions[0].index == 2 && decisions[0].from == 100 && decisions[0].to == 75,
+              "Thread back from isolation brought to the shared intensity");
+
+        // Hot package after the settle period
+        decisions.clear();
+        snap.cpu.temperature = 86;
+        snap.cpu.packagePower = 90;
+        for (unsigned t = 0; t < config.settleTicks; t++) {
+            governor.update(snap);
+        }
+        check(decisions.size() == 3 && governor.getIntensity(0) == 60 && governor.getIntensity(2) == 60,
+              "Package temperature steps all threads down together");
+    }
+
+    // Readings from a fake sysfs tree
+#ifdef WITH_OPENCL
+    {
+        fs::path root = fs::temp_directory_path() / ("tosminer-governor-" + std::to_string(::getpid()));
+        fs::remove_all(root);
+        fs::path dev = root / "class/drm/card0/device";
+        writeFile(dev / "vendor", "0x1002\n");
+        writeFile(dev / "hwmon/hwmon0/temp1_input", "86000\n");
+        writeFile(dev / "hwmon/hwmon0/power1_average", "200000000\n");
+        Sysfs::setRoot(root.string());
+
+        AmdMonitor amd;
+        check(amd.init(), "Fixture GPU found");
+
+        std::vector<GovernorDecision> decisions;
+        GovernorConfig config;
+        config.tempTarget = 80;
+        config.powerCap = 250;
+        PowerGovernor governor(config, [&](const GovernorDecision& d) { decisions.push_back(d); });
+
+        TelemetrySnapshot snap;
+        DeviceTelemetry gpu;
+        gpu.device.type = MinerType::OpenCL;
+        gpu.gpu = amd.getStats(0);
+        snap.devices.push_back(gpu);
+        governor.update(snap);
+
+        check(decisions.size() == 1 && decisions[0].from == 100 && decisions[0].to == 85,
+              "86C reading throttles three steps (6C over, 3C hysteresis)");
+        check(!decisions.empty() && decisions[0].reason.find("86C") != std::string::npos,
+              "Decision reason names the reading");
+        check(governor.getIntensity(0) == 85, "Governor tracks the new intensity");
+
+        // Cool down: after the settle period the governor raises again
+        writeFile(dev / "hwmon/hwmon0/temp1_input", "70000\n");
+        gpu.gpu = amd.getStats(0);
+        snap.devices[0] = gpu;
+        for (unsigned t = 0; t <= config.settleTicks; t++) {
+            governor.update(snap);
+        }
+        check(decisions.size() == 2 && decisions[1].to == 90, "Raises after cooling below target - hysteresis");
+
+        fs::remove_all(root);
+    }
+#else
+    std::cout << "[SKIP] Sysfs fixture case needs the AMD backend (WITH_OPENCL off)\n";
+#endif
+
+    std::cout << "\n" << (g_passed ? "[PASS] Power governor test completed" : "[FAIL] Power governor test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
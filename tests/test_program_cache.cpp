@@ -0,0 +1,202 @@
+/**
+ * Test the compiled OpenCL program cache
+ *
+ * The on-disk layer always runs: entries round-trip, and corrupt,
+ * truncated or mismatched entries read as misses and are removed. With
+ * an OpenCL device (POCL runs it on the CPU) the kernel is built from
+ * source once, reused in-process, loaded from disk after a restart, and
+ * rebuilt from source when the disk entry is damaged.
+ */
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/util/BinaryCache.h"
+#include "TestUtil.h"
+
+#ifdef WITH_OPENCL
+#include "../src/opencl/CLProgramCache.h"
+#include "../src/util/Log.h"
+#include "toshash_kernel.cl.h"
+#endif
+
+using namespace tos;
+
+// Overwrite one byte of a file
+static void corrupt(const std::string& file, std::streamoff offset) {
+    std::fstream f(file, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(offset);
+    char byte = 0;
+    f.read(&byte, 1);
+    f.seekp(offset);
+    byte = static_cast<char>(byte ^ 0x5A);
+    f.write(&byte, 1);
+}
+
+static void testDiskCache(const std::string& directory) {
+    std::cout << "--- Disk cache ---\n";
+
+    BinaryCache cache(directory);
+    std::vector<uint8_t> data(4096);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    std::vector<uint8_t> loaded;
+    check(cache.load("device-a", loaded) == BinaryCache::Status::Miss, "Missing entry is a miss");
+
+    check(cache.store("device-a", data), "Store entry (creates directory)");
+    check(cache.load("device-a", loaded) == BinaryCache::Status::Hit && loaded == data, "Entry round-trips");
+    check(cache.load("device-b", loaded) == BinaryCache::Status::Miss, "Other key misses");
+
+    std::string file = cache.path("device-a");
+
+    // Flipped payload byte fails the checksum
+    corrupt(file, static_cast<std::streamoff>(std::filesystem::file_size(file) - 10));
+    check(cache.load("device-a", loaded) == BinaryCache::Status::Corrupt && loaded.empty(),
+          "Corrupt payload rejected");
+    check(!std::filesystem::exists(file), "Corrupt entry removed");
+
+    // Truncated write
+    cache.store("device-a", data);
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) / 2);
+    check(cache.load("device-a", loaded) == BinaryCache::Status::Corrupt, "Truncated entry rejected");
+
+    // Trailing garbage
+    cache.store("device-a", data);
+    {
+        std::ofstream out(file, std::ios::binary | std::ios::app);
+        out << "junk";
+    }
+    check(cache.load("device-a", loaded) == BinaryCache::Status::Corrupt, "Oversized entry rejected");
+
+    // Entry written for a different key (hash collision) under this key's file
+    cache.store("device-c", data);
+    std::filesystem::rename(cache.path("device-c"), file);
+    check(cache.load("device-a", loaded) == BinaryCache::Status::Corrupt, "Entry for another key rejected");
+
+    // Replacing an entry
+    cache.store("device-a", data);
+    std::vector<uint8_t> updated(100, 0xAB);
+    cache.store("device-a", updated);
+    check(cache.load("device-a", loaded) == BinaryCache::Status::Hit && loaded == updated, "Entry replaced");
+
+    BinaryCache disabled("");
+    check(!disabled.enabled() && !disabled.store("device-a", data) &&
+          disabled.load("device-a", loaded) == BinaryCache::Status::Miss, "Empty directory disables the cache");
+}
+
+#ifdef WITH_OPENCL
+// Returns the number of devices tested
+static unsigned testProgramCache(const std::string& directory) {
+    std::cout << "--- OpenCL program cache ---\n";
+
+    std::vector<cl::Platform> platforms;
+    try {
+        cl::Platform::get(&platforms);
+    } catch (const cl::Error&) {
+        // No ICD installed
+    }
+
+    unsigned tested = 0;
+    std::string source(reinterpret_cast<const char*>(toshash_cl_source), toshash_cl_source_len);
+    const std::string options = "-cl-std=CL1.2";
+    CLProgramCache::setDirectory(directory);
+
+    for (auto& platform : platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(CL_DEVICE_TYPE_ALL, &devices);
+        } catch (const cl::Error&) {
+            continue;
+        }
+
+        for (auto& device : devices) {
+            std::string name = "OpenCL " + device.getInfo<CL_DEVICE_NAME>();
+            try {
+                cl::Context context(device);
+                std::string key = CLProgramCache::key(device, source, options);
+                std::string file = BinaryCache(directory).path(key);
+                std::filesystem::remove(file);
+                CLProgramCache::clearMemory();
+
+                cl::Program program;
+                std::string log;
+                CLProgramCache::Origin origin;
+
+                bool built = CLProgramCache::build(context, device, source, options, program, log, origin);
+                check(built && origin == CLProgramCache::Origin::Source, name + ": first build from source");
+                if (!built) {
+                    std::cout << log << "\n";
+                    continue;
+                }
+                check(std::filesystem::exists(file), name + ": binary written to disk");
+
+                built = CLProgramCache::build(context, device, source, options, program, log, origin);
+                check(built && origin == CLProgramCache::Origin::Memory, name + ": second build shared in-process");
+
+                CLProgramCache::clearMemory();
+                built = CLProgramCache::build(context, device, source, options, program, log, origin);
+                check(built && origin == CLProgramCache::Origin::Disk, name + ": restart loads from disk");
+                cl_int error = CL_SUCCESS;
+                cl::Kernel kernel(program, "toshash_search", &error);
+                check(error == CL_SUCCESS, name + ": kernel created from cached binary");
+
+                CLProgramCache::clearMemory();
+                corrupt(file, static_cast<std::streamoff>(std::filesystem::file_size(file) / 2));
+                built = CLProgramCache::build(context, device, source, options, program, log, origin);
+                check(built && origin == CLProgramCache::Origin::Source, name + ": corrupt entry rebuilt from source");
+
+                CLProgramCache::clearMemory();
+                built = CLProgramCache::build(context, device, source, options, program, log, origin);
+                check(built && origin == CLProgramCache::Origin::Disk, name + ": rebuilt entry loads from disk");
+
+                check(CLProgramCache::key(device, source, options + " -DPLATFORM_AMD") != key &&
+                      CLProgramCache::key(device, source + " ", options) != key,
+                      name + ": key covers options and source");
+                tested++;
+
+            } catch (const cl::Error& e) {
+                check(false, name + ": OpenCL error " + std::string(e.what()) + " (" + std::to_string(e.err()) + ")");
+            }
+        }
+    }
+
+    CLProgramCache::clearMemory();
+    return tested;
+}
+#endif
+
+int main(int argc, char** argv) {
+    std::cout << "=== Program Cache Test ===\n\n";
+
+    bool requireOpenCL = argc > 1 && std::string(argv[1]) == "--require-opencl";
+
+    std::string directory = (std::filesystem::temp_directory_path() / "tosminer_test_program_cache").string();
+    std::filesystem::remove_all(directory);
+
+    testDiskCache(directory);
+
+#ifdef WITH_OPENCL
+    Log::setLevel(LogLevel::Error);
+    unsigned devices = testProgramCache(directory);
+#else
+    unsigned devices = 0;
+    std::cout << "--- OpenCL program cache ---\n";
+#endif
+    if (devices == 0) {
+        if (requireOpenCL) {
+            check(false, "OpenCL device available (install POCL to run the kernel on the CPU)");
+        } else {
+            std::cout << "[SKIP] No OpenCL device; install POCL to run the kernel on the CPU\n";
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+
+    std::cout << "\n" << (g_passed ? "[PASS] Program cache test completed"
+                                   : "[FAIL] Program cache test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/**
+ * Test failed-device recovery with backoff
+ *
+ * Runs a farm of fake miners whose init() fails a set number of times,
+ * blocks, or whose mining loop exits, and drives the recovery supervisor
+ * with a simulated clock. Checks the backoff schedule, the attempt limit,
+ * that the farm stays usable while a device reinitializes, and that a
+ * recovered device mines its own nonce range again.
+ */
+
+#include <future>
+#include <iostream>
+#include <thread>
+#include "../src/core/Farm.h"
+#include "../src/core/RecoverySupervisor.h"
+#include "../src/util/Log.h"
+#include "TestUtil.h"
+
+using namespace tos;
+using Clock = std::chrono::steady_clock;
+
+// Miner whose init() fails the first failures times
+static FakeMiner* fakeMiner(unsigned index, unsigned failures) {
+    auto* miner = new FakeMiner(index);
+    miner->initFailures = failures;
+    return miner;
+}
+
+static WorkPackage makeWork() {
+    WorkPackage work;
+    work.jobId = "job1";
+    work.valid = true;
+    work.target.fill(0);
+    work.startNonce = 0;
+    return work;
+}
+
+int main() {
+    std::cout << "=== Recovery Supervisor Test ===\n\n";
+
+    Log::setLevel(LogLevel::Warning);
+    auto t0 = Clock::now();
+    auto at = [t0](int seconds) { return t0 + std::chrono::seconds(seconds); };
+
+    // Backoff doubles up to the cap
+    {
+        Farm farm;
+        RecoveryConfig config;
+        config.initialBackoff = 10;
+        config.maxBackoff = 40;
+        RecoverySupervisor supervisor(farm, config);
+        check(supervisor.backoff(0) == std::chrono::seconds(10) && supervisor.backoff(1) == std::chrono::seconds(20) &&
+              supervisor.backoff(2) == std::chrono::seconds(40) && supervisor.backoff(9) == std::chrono::seconds(40),
+              "Backoff 10s, 20s, 40s, capped at 40s");
+    }
+
+    // Device fails at start and on the first two attempts, then recovers
+    {
+        Farm farm;
+        auto* healthy = new FakeMiner(0);
+        auto* flaky = fakeMiner(1, 3);
+        farm.addMiner(std::unique_ptr<Miner>(healthy));
+        farm.addMiner(std::unique_ptr<Miner>(flaky));
+        farm.start();
+        farm.setWork(makeWork());
+        check(farm.isMinerFailed(1) && !farm.isMinerFailed(0), "Init failure at start marks the device failed");
+
+        Nonce healthyStart = healthy->startNonce();
+        RecoverySupervisor supervisor(farm);
+
+        supervisor.poll(at(0));
+        supervisor.poll(at(9));
+        check(flaky->initCalls == 1, "No attempt before the initial backoff");
+
+        supervisor.poll(at(10));
+        check(flaky->initCalls == 2 && farm.isMinerFailed(1), "First attempt after 10s fails");
+        supervisor.poll(at(29));
+        check(flaky->initCalls == 2, "Second attempt waits 20s");
+        supervisor.poll(at(30));
+        check(flaky->initCalls == 3, "Second attempt after 20s fails");
+
+        RecoveryTelemetry telemetry = supervisor.getTelemetry(at(50));
+        check(telemetry.devices.size() == 1 && telemetry.devices[0].attempts == 2 &&
+              telemetry.devices[0].nextAttempt == 20, "Pending device reported with next attempt");
+
+        supervisor.poll(at(70));
+        check(flaky->initCalls == 4 && !farm.isMinerFailed(1) && farm.isMinerRunning(1),
+              "Third attempt after 40s recovers the device");
+
+        telemetry = supervisor.getTelemetry(at(70));
+        check(telemetry.devices.empty() && telemetry.recoveries == 1 && telemetry.failures == 2,
+              "Recovery counted");
+        check(telemetry.history.size() == 3 && telemetry.history[0].success && telemetry.history[0].attempt == 3 &&
+              !telemetry.history[2].success, "History lists attempts, most recent first");
+
+        // The recovered device scans its own range; the healthy one kept its range throughout
+        WorkPackage work = makeWork();
+        work.totalDevices = 2;
+        check(flaky->jobId() == "job1", "Recovered device got the current job");
+        check(flaky->startNonce() == work.getDeviceStartNonce(1) && healthy->startNonce() == healthyStart &&
+              healthyStart == work.getDeviceStartNonce(0), "Recovered device rejoins its own nonce range");
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        check(farm.getMinerHashRate(1).count > 0, "Recovered device is hashing");
+        farm.stop();
+    }
+
+    // Device that never comes back: stops after maxAttempts
+    {
+        Farm farm;
+        auto* broken = fakeMiner(0, 1000);
+        farm.addMiner(std::unique_ptr<Miner>(new FakeMiner(0)));
+        farm.addMiner(std::unique_ptr<Miner>(broken));
+        farm.start();
+
+        RecoveryConfig config;
+        config.maxAttempts = 3;
+        RecoverySupervisor supervisor(farm, config);
+        for (int t = 0; t <= 3600; t += 5) {
+            supervisor.poll(at(t));
+        }
+        check(broken->initCalls == 4, "Gives up after 3 attempts");
+
+        RecoveryTelemetry telemetry = supervisor.getTelemetry(at(3600));
+        check(telemetry.devices.size() == 1 && telemetry.devices[0].gaveUp && farm.isMinerFailed(1),
+              "Device reported as given up and stays isolated");
+        farm.stop();
+    }
+
+    // Mining loop exits: detected, restarted; failing again soon keeps the backoff
+    {
+        Farm farm;
+        auto* crashing = new FakeMiner(0);
+        farm.addMiner(std::unique_ptr<Miner>(crashing));
+        farm.addMiner(std::unique_ptr<Miner>(new FakeMiner(1)));
+        farm.start();
+        farm.setWork(makeWork());
+
+        RecoverySupervisor supervisor(farm);
+        crashing->crash = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        supervisor.poll(at(0));
+        check(farm.isMinerFailed(0), "Exited mining loop marks the device failed");
+
+        crashing->crash = false;
+        supervisor.poll(at(10));
+        check(farm.isMinerRunning(0) && !farm.isMinerFailed(0), "Restarted after the backoff");
+
+        // Crash again within the stability window: next delay is 20s, not 10s
+        crashing->crash = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        crashing->crash = false;
+        supervisor.poll(at(60));
+        supervisor.poll(at(75));
+        check(farm.isMinerFailed(0), "Flapping device does not restart its backoff");
+        supervisor.poll(at(80));
+        check(!farm.isMinerFailed(0), "Flapping device retried after 20s");
+
+        // Failing again after a stable period starts over
+        crashing->crash = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        crashing->crash = false;
+        supervisor.poll(at(1000));
+        supervisor.poll(at(1010));
+        check(!farm.isMinerFailed(0), "Backoff resets after a stable period");
+        farm.stop();
+    }
+
+    // Only device failed: jobs are kept for it and it recovers paused with the farm
+    {
+        Farm farm;
+        auto* only = new FakeMiner(0);
+        farm.addMiner(std::unique_ptr<Miner>(only));
+        farm.start();
+        farm.setWork(makeWork());
+
+        RecoverySupervisor supervisor(farm);
+        only->crash = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        supervisor.poll(at(0));
+        check(farm.isMinerFailed(0), "Only device failed");
+
+        WorkPackage next = makeWork();
+        next.jobId = "job2";
+        farm.setWork(next);
+        farm.pause();
+
+        only->crash = false;
+        supervisor.poll(at(10));
+        check(!farm.isMinerFailed(0) && only->jobId() == "job2",
+              "Job set while every device was failed reaches the recovered device");
+        uint64_t hashes = farm.getMinerHashRate(0).count;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        check(only->isPaused() && farm.getMinerHashRate(0).count == hashes,
+              "Device recovered while the farm is paused starts paused");
+
+        farm.resume();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        check(farm.getMinerHashRate(0).count > hashes, "Resumes with the farm");
+        farm.stop();
+    }
+
+    // Slow reinitialization doesn't block the farm
+    {
+        Farm farm;
+        auto* slow = fakeMiner(0, 1);
+        farm.addMiner(std::unique_ptr<Miner>(new FakeMiner(0)));
+        farm.addMiner(std::unique_ptr<Miner>(slow));
+        farm.start();
+
+        RecoverySupervisor supervisor(farm);
+        supervisor.poll(at(0));
+        slow->initDelay = std::chrono::milliseconds(500);
+        auto attempt = std::async(std::launch::async, [&]() { supervisor.poll(at(10)); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        auto begin = Clock::now();
+        farm.getHashRate();
+        farm.getMinerHashRate(0);
+        farm.setWork(makeWork());
+        farm.getDevices();
+        supervisor.getTelemetry();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+        std::cout << "  farm calls during init took " << ms << " ms\n";
+        check(ms < 100 && attempt.wait_for(std::chrono::seconds(0)) != std::future_status::ready,
+              "Farm and telemetry calls don't wait for a device init");
+
+        attempt.get();
+        check(!farm.isMinerFailed(1) && slow->jobId() == "job1", "Slow device recovered with new work");
+        farm.stop();
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Recovery supervisor test completed"
+                                   : "[FAIL] Recovery supervisor test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/**
+ * Test the startup known-answer self-test
+ *
+ * Runs a farm with simulated devices: one hashing correctly, one whose
+ * kernel gets a byte wrong, one whose kernel does not run. Checks that
+ * only the correct device starts, that the broken ones are marked failed,
+ * and that --no-self-test lets them through.
+ */
+
+#include <iostream>
+#include "../src/core/Farm.h"
+#include "../src/util/Log.h"
+#include "TestUtil.h"
+
+using namespace tos;
+
+enum class Fault { None, WrongHash, NoKernel };
+
+// Simulated GPU whose kernel has the given fault
+static FakeMiner* simDevice(unsigned index, Fault fault) {
+    auto* device = new FakeMiner(index, MinerType::OpenCL, "Sim");
+    if (fault == Fault::WrongHash) {
+        device->onBatch = [](unsigned batch, std::vector<Hash256>& hashes) {
+            if (batch % 3 == 0) {
+                hashes.back()[31] ^= 0x01;   // One bit off in the last vector
+            }
+            return true;
+        };
+    } else if (fault == Fault::NoKernel) {
+        device->onBatch = [](unsigned, std::vector<Hash256>&) { return false; };
+    }
+    return device;
+}
+
+int main() {
+    std::cout << "=== Device Self-Test Test ===\n\n";
+
+    Log::setLevel(LogLevel::Warning);
+
+    // Direct runs
+    {
+        std::unique_ptr<FakeMiner> good(simDevice(0, Fault::None));
+        check(good->selfTest() && good->hashes >= 12, "Correct device passes all known answers");
+        check(good->getSelfTestTime() > 0, "Self-test duration recorded");
+
+        std::unique_ptr<FakeMiner> wrong(simDevice(1, Fault::WrongHash));
+        check(!wrong->selfTest(), "Single wrong bit fails the self-test");
+
+        std::unique_ptr<FakeMiner> dead(simDevice(2, Fault::NoKernel));
+        check(!dead->selfTest() && dead->batches == 1, "Device that can't run the kernel fails at once");
+    }
+
+    // Farm excludes failing devices before they mine
+    {
+        Farm farm;
+        auto* good = simDevice(0, Fault::None);
+        auto* wrong = simDevice(1, Fault::WrongHash);
+        auto* dead = simDevice(2, Fault::NoKernel);
+        farm.addMiner(std::unique_ptr<Miner>(good));
+        farm.addMiner(std::unique_ptr<Miner>(wrong));
+        farm.addMiner(std::unique_ptr<Miner>(dead));
+
+        check(farm.start(), "Farm starts with the passing device");
+        check(farm.isMinerRunning(0) && !farm.isMinerFailed(0), "Passing device mines");
+        check(farm.isMinerFailed(1) && !farm.isMinerRunning(1), "Wrong-hash device excluded");
+        check(farm.isMinerFailed(2) && !farm.isMinerRunning(2), "Kernel-less device excluded");
+
+        // Recovery runs the self-test again
+        check(!farm.recoverMiner(1) && farm.isMinerFailed(1), "Recovery re-runs the self-test");
+        farm.stop();
+    }
+
+    // No devices pass: farm does not start
+    {
+        Farm farm;
+        farm.addMiner(std::unique_ptr<Miner>(simDevice(0, Fault::NoKernel)));
+        check(!farm.start(), "Farm with only failing devices does not start");
+    }
+
+    // Disabled: every device that initializes starts
+    {
+        Miner::setSelfTestEnabled(false);
+        Farm farm;
+        auto* wrong = simDevice(0, Fault::WrongHash);
+        farm.addMiner(std::unique_ptr<Miner>(wrong));
+        check(farm.start() && farm.isMinerRunning(0) && wrong->batches == 0, "--no-self-test skips the test");
+        farm.stop();
+        Miner::setSelfTestEnabled(true);
+    }
+
+    std::cout << "\n" << (g_passed ? "[PASS] Device self-test test completed"
+                                   : "[FAIL] Device self-test test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
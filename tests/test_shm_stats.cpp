@@ -0,0 +1,190 @@
+/**
+ * Test the shared memory stats block
+ *
+ * A writer thread updates a block under the sequence lock while readers
+ * copy it; every copy must be consistent. The publisher must refuse a
+ * symlink or foreign file at its path, replace a stale stats file, and
+ * report devices beyond SHM_STATS_MAX_DEVICES as truncated.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../src/api/ShmStatsPublisher.h"
+#include "../src/core/Telemetry.h"
+#include "../src/util/Log.h"
+#include "TestUtil.h"
+
+using namespace tos;
+namespace fs = std::filesystem;
+
+// Every field the writer sets carries the same value
+static bool consistent(const ShmStatsBlock& b) {
+    if (b.hashes != b.sequence || b.hashrate != static_cast<double>(b.sequence) ||
+        b.deviceCount != b.sequence % SHM_STATS_MAX_DEVICES) {
+        return false;
+    }
+    for (const auto& d : b.devices) {
+        if (d.hashes != b.sequence || d.name[0] != static_cast<char>('a' + b.sequence % 26)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void testSeqlock() {
+    std::cout << "--- Sequence lock ---\n";
+    auto block = std::make_unique<ShmStatsBlock>();
+    std::memset(block.get(), 0, sizeof(ShmStatsBlock));
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (uint64_t i = 1; !done; i++) {
+            uint32_t seq = shmStatsBeginWrite(block.get());
+            block->sequence = i;
+            block->hashes = i;
+            block->hashrate = static_cast<double>(i);
+            block->deviceCount = static_cast<uint32_t>(i % SHM_STATS_MAX_DEVICES);
+            for (auto& d : block->devices) {
+                d.hashes = i;
+                std::memset(d.name, 'a' + i % 26, sizeof(d.name) - 1);
+            }
+            shmStatsEndWrite(block.get(), seq);
+
+            // Far faster than a telemetry tick, but readers get a window
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    });
+
+    std::atomic<uint64_t> reads{0}, torn{0}, timeouts{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; r++) {
+        readers.emplace_back([&] {
+            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(300);
+            ShmStatsBlock copy;
+            while (std::chrono::steady_clock::now() < end) {
+                if (!shmStatsRead(block.get(), copy)) {
+                    timeouts++;
+                    continue;
+                }
+                reads++;
+                if (copy.sequence > 0 && !consistent(copy)) {
+                    torn++;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    done = true;
+    writer.join();
+
+    std::cout << "  " << reads << " reads, " << timeouts << " timeouts, "
+              << block->sequence << " writes\n";
+    check(reads > 0, "Readers got copies while the writer was busy");
+    check(torn == 0, "No torn copies");
+    check((shmLoadSeq(block->seq) & 1) == 0, "Sequence even after the last update");
+
+    // A writer that never finishes: readers give up instead of copying
+    shmStatsBeginWrite(block.get());
+    ShmStatsBlock copy;
+    check(!shmStatsRead(block.get(), copy, 10), "No copy while an update is in progress");
+}
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void testPublisher() {
+    std::cout << "--- Publisher ---\n";
+    fs::path dir = fs::temp_directory_path() / ("tosminer_shm_" + std::to_string(::getpid()));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::path path = dir / "tosminer.stats";
+
+    Farm farm;
+    for (unsigned i = 0; i < SHM_STATS_MAX_DEVICES + 2; i++) {
+        farm.addMiner(std::make_unique<FakeMiner>(i));
+    }
+    Telemetry telemetry(farm);
+    telemetry.sample();
+
+    // Symlink to another file: refused, target untouched
+    fs::path target = dir / "target";
+    writeFile(target, "keep");
+    fs::create_symlink(target, path);
+    {
+        ShmStatsPublisher publisher(path.string(), telemetry);
+        check(!publisher.start(), "Symlink at the path refused");
+    }
+    check(readFile(target) == "keep" && fs::is_symlink(path), "Symlink target untouched");
+    fs::remove(path);
+
+    // Some other file: refused
+    writeFile(path, "not a stats file");
+    {
+        ShmStatsPublisher publisher(path.string(), telemetry);
+        check(!publisher.start(), "Foreign file at the path refused");
+    }
+    check(readFile(path) == "not a stats file", "Foreign file untouched");
+    fs::remove(path);
+
+    // Stats file of a process that is gone: replaced
+    ShmStatsBlock stale;
+    std::memset(&stale, 0, sizeof(stale));
+    stale.magic = SHM_STATS_MAGIC;
+    stale.pid = 0x7ffffff0;
+    writeFile(path, std::string(reinterpret_cast<const char*>(&stale), sizeof(stale)));
+
+    ShmStatsPublisher publisher(path.string(), telemetry);
+    check(publisher.start(), "Stale stats file replaced");
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    void* addr = fd >= 0 ? ::mmap(nullptr, sizeof(ShmStatsBlock), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    check(addr != MAP_FAILED, "Stats file mapped");
+    if (addr != MAP_FAILED) {
+        const auto* block = static_cast<const ShmStatsBlock*>(addr);
+        ShmStatsBlock copy;
+        bool read = shmStatsRead(block, copy);
+        check(read && copy.magic == SHM_STATS_MAGIC && copy.version == SHM_STATS_VERSION &&
+              copy.pid == static_cast<uint32_t>(::getpid()), "Header written by this process");
+        check(read && copy.deviceCount == SHM_STATS_MAX_DEVICES && copy.truncatedDevices == 2,
+              "Devices beyond the limit reported as truncated");
+        check(read && std::strcmp(copy.devices[SHM_STATS_MAX_DEVICES - 1].name, "Fake31") == 0,
+              "Published devices in farm order");
+
+        publisher.stop();
+        check(!fs::exists(path), "File removed on stop");
+        check(block->running == 0 && (shmLoadSeq(block->seq) & 1) == 0,
+              "Readers still mapping it see the miner stopped");
+        ::munmap(addr, sizeof(ShmStatsBlock));
+    }
+
+    fs::remove_all(dir);
+}
+
+int main() {
+    std::cout << "=== Shared Memory Stats Test ===\n\n";
+
+    Log::setLevel(LogLevel::Error);
+    testSeqlock();
+    testPublisher();
+
+    std::cout << "\n" << (g_passed ? "[PASS] Shared memory stats test completed"
+                                   : "[FAIL] Shared memory stats test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
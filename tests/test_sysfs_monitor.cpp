@@ -0,0 +1,125 @@
+/**
+ * Test sysfs GPU monitoring against a fixture tree
+ *
+ * Builds a fake /sys/class/drm layout in a temp directory and checks that
+ * the AMD backend reads it through persistent handles and that the
+ * GpuMonitor sampler picks up changes.
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include "../src/util/GpuMonitor.h"
+#include "../src/util/Sysfs.h"
+#include "TestUtil.h"
+
+using namespace tos;
+namespace fs = std::filesystem;
+
+// Rewrite in place (same inode), like the kernel updating an attribute
+static fs::path makeFixture() {
+    fs::path root = fs::temp_directory_path() / ("tosminer-sysfs-" + std::to_string(::getpid()));
+    fs::remove_all(root);
+
+    // card0: NVIDIA (ignored by the AMD backend)
+    writeFile(root / "class/drm/card0/device/vendor", "0x10de\n");
+
+    // card1: AMD with full sensor set
+    fs::path dev = root / "class/drm/card1/device";
+    writeFile(dev / "vendor", "0x1002\n");
+    writeFile(dev / "pp_dpm_sclk", "0: 500Mhz\n1: 1800Mhz *\n2: 2500Mhz\n");
+    fs::path hwmon = dev / "hwmon/hwmon3";
+    writeFile(hwmon / "name", "amdgpu\n");
+    writeFile(hwmon / "temp1_input", "65000\n");
+    writeFile(hwmon / "temp2_input", "78000\n");
+    writeFile(hwmon / "temp3_input", "70000\n");
+    writeFile(hwmon / "pwm1", "128\n");
+    writeFile(hwmon / "power1_average", "215000000\n");
+    writeFile(hwmon / "power1_cap", "250000000\n");
+
+    // card1-DP-1: connector, not a GPU
+    writeFile(root / "class/drm/card1-DP-1/status", "connected\n");
+
+    // card2: AMD with only power1_input and no fan/clock attributes
+    fs::path dev2 = root / "class/drm/card2/device";
+    writeFile(dev2 / "vendor", "0x1002\n");
+    writeFile(dev2 / "hwmon/hwmon4/temp1_input", "55000\n");
+    writeFile(dev2 / "hwmon/hwmon4/power1_input", "90000000\n");
+
+    return root;
+}
+
+int main() {
+    std::cout << "=== Sysfs Monitor Test ===\n\n";
+
+    fs::path root = makeFixture();
+    Sysfs::setRoot(root.string() + "/");
+    check(Sysfs::getRoot() == root.string(), "Sysfs root strips trailing slash");
+
+    // SysfsFile basics
+    {
+        SysfsFile missing(Sysfs::path("class/drm/card9/device/vendor"));
+        check(!missing.isOpen() && missing.readInt() == -1 && missing.readString().empty(),
+              "Missing attribute reads as unavailable");
+
+        SysfsFile temp(Sysfs::path("class/drm/card1/device/hwmon/hwmon3/temp1_input"));
+        check(temp.readInt() == 65000, "Reads integer attribute");
+        writeFile(root / "class/drm/card1/device/hwmon/hwmon3/temp1_input", "66000\n");
+        check(temp.readInt() == 66000, "Re-read through same handle sees new value");
+        writeFile(root / "class/drm/card1/device/hwmon/hwmon3/temp1_input", "65000\n");
+    }
+
+#ifdef WITH_OPENCL
+    // AMD backend directly
+    {
+        AmdMonitor amd;
+        check(amd.init(), "AMD backend finds fixture GPUs");
+        check(amd.getDeviceCount() == 2, "Only AMD cards are counted");
+
+        GpuStats s = amd.getStats(0);
+        check(s.valid && s.name == "amdgpu", "Device 0 name");
+        check(s.temperature == 65 && s.temperatureHotspot == 78 && s.temperatureMemory == 70,
+              "Device 0 temperatures");
+        check(s.fanSpeed == 50, "Device 0 fan speed from PWM");
+        check(s.powerUsage == 215 && s.powerLimit == 250, "Device 0 power and cap");
+        check(s.clockCore == 1800, "Device 0 clock from active DPM level");
+
+        GpuStats s2 = amd.getStats(1);
+        check(s2.valid && s2.temperature == 55 && s2.powerUsage == 90,
+              "Device 1 falls back to power1_input");
+        check(s2.fanSpeed == -1 && s2.clockCore == -1, "Device 1 missing sensors stay -1");
+        check(!amd.getStats(2).valid, "Out of range device is invalid");
+    }
+
+    // Unified monitor: cached readings refreshed by the sampler thread
+    {
+        GpuMonitor::setSampleInterval(50);
+        GpuMonitor& monitor = GpuMonitor::instance();
+        check(monitor.init(), "GpuMonitor starts with fixture tree");
+        check(monitor.getAmdStats(0).temperature == 65, "Initial reading cached at init");
+
+        writeFile(root / "class/drm/card1/device/hwmon/hwmon3/temp1_input", "91000\n");
+
+        bool updated = false;
+        for (int i = 0; i < 40 && !updated; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(25));
+            updated = monitor.getAmdStats(0).temperature == 91;
+        }
+        check(updated, "Sampler thread publishes new reading");
+        check(monitor.anyOverheating(85), "Overheating detected from cached reading");
+
+        monitor.shutdown();
+        check(!monitor.getAmdStats(0).valid, "Readings cleared after shutdown");
+    }
+#else
+    std::cout << "[SKIP] AMD backend not compiled (WITH_OPENCL off)\n";
+#endif
+
+    fs::remove_all(root);
+
+    std::cout << "\n" << (g_passed ? "[PASS] Sysfs monitor test completed" : "[FAIL] Sysfs monitor test failed") << "\n";
+    return g_passed ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+/**
+ * TOS Miner - Shared Memory Stats Reader
+ *
+ * Reads the stats block published with --shm-stats and prints it.
+ * Uses the read protocol in api/ShmStatsLayout.h.
+ *
+ * Usage: tosminer-shmread [--watch SECONDS] [PATH]
+ */
+
+#include "api/ShmStatsLayout.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace tos;
+
+namespace {
+
+const char* typeName(uint32_t type) {
+    switch (type) {
+        case SHM_DEVICE_CPU: return "CPU";
+        case SHM_DEVICE_OPENCL: return "OpenCL";
+        case SHM_DEVICE_CUDA: return "CUDA";
+        default: return "?";
+    }
+}
+
+const char* healthName(uint32_t health) {
+    switch (health) {
+        case 0: return "healthy";
+        case 1: return "degraded";
+        case 2: return "unhealthy";
+        case 3: return "failed";
+        default: return "?";
+    }
+}
+
+void print(const ShmStatsBlock& b) {
+    auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    double age = (static_cast<double>(nowMs) - static_cast<double>(b.updatedMs)) / 1000.0;
+
+    std::printf("pid %u  seq %llu  age %.1fs  %s%s\n",
+                b.pid, static_cast<unsigned long long>(b.sequence), age,
+                b.running ? "running" : "stopped", b.paused ? " (paused)" : "");
+    std::printf("hashrate %.2f H/s  10s %.2f  1m %.2f  15m %.2f  hashes %llu\n",
+                b.hashrate, b.hashrate10s, b.hashrate1m, b.hashrate15m,
+                static_cast<unsigned long long>(b.hashes));
+    std::printf("shares A:%llu R:%llu S:%llu  miners %u/%u active\n",
+                static_cast<unsigned long long>(b.acceptedShares),
+                static_cast<unsigned long long>(b.rejectedShares),
+                static_cast<unsigned long long>(b.staleShares),
+                b.activeMinerCount, b.minerCount);
+    std::printf("pool %s%s  difficulty %.6g  accepted %llu  rejected %llu\n",
+                b.pool.connected ? "connected" : "disconnected",
+                b.pool.authorized ? ", authorized" : "",
+                b.pool.difficulty,
+                static_cast<unsigned long long>(b.pool.accepted),
+                static_cast<unsigned long long>(b.pool.rejected));
+
+    uint32_t count = b.deviceCount < SHM_STATS_MAX_DEVICES ? b.deviceCount : SHM_STATS_MAX_DEVICES;
+    for (uint32_t i = 0; i < count; i++) {
+        const ShmDeviceStats& d = b.devices[i];
+        char name[SHM_STATS_NAME_LEN];
+        std::memcpy(name, d.name, sizeof(name));
+        name[sizeof(name) - 1] = '\0';
+
+        std::printf("  [%u] %-6s %-24s %12.2f H/s  1m %12.2f  %s%s  sol %llu/%llu/%llu  hw %llu",
+                    i, typeName(d.type), name, d.hashrateEma, d.hashrate1m,
+                    healthName(d.health), d.failed ? " (isolated)" : "",
+                    static_cast<unsigned long long>(d.validSolutions),
+                    static_cast<unsigned long long>(d.invalidSolutions),
+                    static_cast<unsigned long long>(d.duplicateSolutions),
+                    static_cast<unsigned long long>(d.hardwareErrors));
+        if (d.temperature >= 0) {
+            std::printf("  %dC", d.temperature);
+        }
+        if (d.powerUsage >= 0) {
+            std::printf("  %dW", d.powerUsage);
+        }
+        if (d.fanSpeed >= 0) {
+            std::printf("  fan %d%%", d.fanSpeed);
+        }
+        std::printf("\n");
+    }
+    if (b.truncatedDevices > 0) {
+        std::printf("  ... %u more device(s) not published\n", b.truncatedDevices);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path = SHM_STATS_DEFAULT_PATH;
+    unsigned watch = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            std::printf("Usage: %s [--watch SECONDS] [PATH]\n", argv[0]);
+            return 0;
+        } else if (arg == "-w" || arg == "--watch") {
+            watch = i + 1 < argc ? static_cast<unsigned>(std::atoi(argv[++i])) : 1;
+            if (watch == 0) {
+                watch = 1;
+            }
+        } else {
+            path = arg;
+        }
+    }
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "Cannot open %s: %s\n", path.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmStatsBlock)) {
+        std::fprintf(stderr, "%s is too small for a stats block\n", path.c_str());
+        ::close(fd);
+        return 1;
+    }
+
+    void* addr = ::mmap(nullptr, sizeof(ShmStatsBlock), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::fprintf(stderr, "Cannot map %s: %s\n", path.c_str(), std::strerror(errno));
+        return 1;
+    }
+    const auto* block = static_cast<const ShmStatsBlock*>(addr);
+
+    if (block->magic != SHM_STATS_MAGIC) {
+        std::fprintf(stderr, "%s is not a tosminer stats file\n", path.c_str());
+        return 1;
+    }
+    if (block->version != SHM_STATS_VERSION || block->size < sizeof(ShmStatsBlock)) {
+        std::fprintf(stderr, "Unsupported stats layout (version %u, size %u; expected %u, %zu)\n",
+                     block->version, block->size, SHM_STATS_VERSION, sizeof(ShmStatsBlock));
+        return 1;
+    }
+
+    int status = 0;
+    do {
+        ShmStatsBlock copy;
+        if (!shmStatsRead(block, copy)) {
+            std::fprintf(stderr, "Timed out waiting for a consistent read\n");
+            status = 1;
+            break;
+        }
+        print(copy);
+
+        if (watch > 0) {
+            if (!copy.running) {
+                break;
+            }
+            std::printf("\n");
+            std::fflush(stdout);
+            std::this_thread::sleep_for(std::chrono::seconds(watch));
+        }
+    } while (watch > 0);
+
+    ::munmap(addr, sizeof(ShmStatsBlock));
+    return status;
+}